@@ -58,7 +58,9 @@ FrameProcessor::~FrameProcessor()
 
 bool CalibProcessor::detectAndParseChessboard(const cv::Mat &frame)
 {
-    int chessBoardFlags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE | cv::CALIB_CB_FAST_CHECK;
+    // locate the board on a downscaled frame and search around the board found in the previous frame first
+    int chessBoardFlags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE | cv::CALIB_CB_FAST_CHECK |
+            cv::CALIB_CB_COARSE_TO_FINE | cv::CALIB_CB_USE_PREVIOUS_CORNERS;
     bool isTemplateFound = cv::findChessboardCorners(frame, mBoardSize, mCurrentImagePoints, chessBoardFlags);
 
     if (isTemplateFound) {
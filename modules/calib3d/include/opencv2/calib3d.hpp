@@ -243,7 +243,9 @@ enum { SOLVEPNP_ITERATIVE = 0,
 enum { CALIB_CB_ADAPTIVE_THRESH = 1,
        CALIB_CB_NORMALIZE_IMAGE = 2,
        CALIB_CB_FILTER_QUADS    = 4,
-       CALIB_CB_FAST_CHECK      = 8
+       CALIB_CB_FAST_CHECK      = 8,
+       CALIB_CB_COARSE_TO_FINE  = 16,
+       CALIB_CB_USE_PREVIOUS_CORNERS = 32
      };
 
 enum { CALIB_CB_SYMMETRIC_GRID  = 1,
@@ -274,6 +276,7 @@ enum { CALIB_USE_INTRINSIC_GUESS = 0x00001,
        // for stereo rectification
        CALIB_ZERO_DISPARITY      = 0x00400,
        CALIB_USE_LU              = (1 << 17), //!< use LU instead of SVD decomposition for solving. much faster but potentially less precise
+       CALIB_USE_SCHUR           = (1 << 21)  //!< eliminate the per-view extrinsics through the Schur complement. Scales linearly with the number of views
      };
 
 //! the algorithm for finding fundamental matrix
@@ -631,6 +634,33 @@ CV_EXPORTS_W bool solvePnPRansac( InputArray objectPoints, InputArray imagePoint
                                   float reprojectionError = 8.0, double confidence = 0.99,
                                   OutputArray inliers = noArray(), int flags = SOLVEPNP_ITERATIVE );
 
+/** @brief Finds the object poses for a batch of independent PnP problems sharing the same camera.
+
+@param objectPoints Vector of object point sets, one per problem, each in the format accepted by
+solvePnP. If it contains a single point set, that set is used for all the problems (e.g. many
+instances of the same marker).
+@param imagePoints Vector of image point sets, one per problem, each in the format accepted by
+solvePnP.
+@param cameraMatrix Input camera matrix \f$A = \vecthreethree{fx}{0}{cx}{0}{fy}{cy}{0}{0}{1}\f$ .
+@param distCoeffs Input vector of distortion coefficients, see solvePnP.
+@param rvecs Output vector of rotation vectors, one CV_64F 3x1 vector per problem.
+@param tvecs Output vector of translation vectors, one CV_64F 3x1 vector per problem.
+@param useExtrinsicGuess Parameter used for SOLVEPNP_ITERATIVE. If true, rvecs and tvecs must
+contain the initial approximations of all the poses.
+@param flags Method for solving the PnP problems (see solvePnP ).
+
+The problems are solved in parallel. For SOLVEPNP_ITERATIVE the function uses a specialized solver
+that works on fixed-size matrices and reuses its point buffers between problems: it is initialized
+the same way as solvePnP and then refines each pose with a 6-DoF Levenberg-Marquardt optimization
+of the reprojection error of the undistorted image points. The other methods call solvePnP for
+every problem. The function returns the number of problems for which a pose was found; the poses of
+the remaining problems (which may happen with SOLVEPNP_P3P and SOLVEPNP_AP3P) are set to zero.
+ */
+CV_EXPORTS_W int solvePnPBatch( InputArrayOfArrays objectPoints, InputArrayOfArrays imagePoints,
+                                InputArray cameraMatrix, InputArray distCoeffs,
+                                OutputArrayOfArrays rvecs, OutputArrayOfArrays tvecs,
+                                bool useExtrinsicGuess = false, int flags = SOLVEPNP_ITERATIVE );
+
 /** @brief Finds an initial camera matrix from 3D-2D point correspondences.
 
 @param objectPoints Vector of vectors of the calibration pattern points in the calibration pattern
@@ -666,6 +696,13 @@ square-like shape) to filter out false quads extracted at the contour retrieval
 -   **CALIB_CB_FAST_CHECK** Run a fast check on the image that looks for chessboard corners,
 and shortcut the call if none is found. This can drastically speed up the call in the
 degenerate condition when no chessboard is observed.
+-   **CALIB_CB_COARSE_TO_FINE** Look for the board on a downscaled level of the image pyramid
+(the longer side is reduced to at most 1280 pixels), then refine the corners level by level
+with cornerSubPix up to the full resolution. This is much faster for high-resolution images,
+but the board squares must stay large enough to be detected at the coarse level.
+-   **CALIB_CB_USE_PREVIOUS_CORNERS** If corners contains patternSize.width\*patternSize.height
+points (e.g. the board found in the previous video frame), the search is first done in the
+region around them, and only then, if the board is not found there, in the whole image.
 
 The function attempts to determine whether the input image is a view of the chessboard pattern and
 locate the internal chessboard corners. The function returns a non-zero value if all of the corners
@@ -861,6 +898,11 @@ set, the function computes and returns only 5 distortion coefficients.
 -   **CALIB_FIX_TAUX_TAUY** The coefficients of the tilted sensor model are not changed during
 the optimization. If CALIB_USE_INTRINSIC_GUESS is set, the coefficient from the
 supplied distCoeffs matrix is used. Otherwise, it is set to 0.
+-   **CALIB_USE_SCHUR** The extrinsic parameters of every view are eliminated from the normal
+equations through the Schur complement instead of solving the dense system over all the
+parameters. The result is the same, but the time and memory grow linearly with the number of
+views, which pays off for hundreds of views. CALIB_USE_LU and CALIB_USE_QR then apply to the
+reduced system over the intrinsic parameters.
 @param criteria Termination criteria for the iterative optimization algorithm.
 
 @return the overall RMS re-projection error.
@@ -1006,6 +1048,8 @@ set, the function computes and returns only 5 distortion coefficients.
 -   **CALIB_FIX_TAUX_TAUY** The coefficients of the tilted sensor model are not changed during
 the optimization. If CALIB_USE_INTRINSIC_GUESS is set, the coefficient from the
 supplied distCoeffs matrix is used. Otherwise, it is set to 0.
+-   **CALIB_USE_SCHUR** Eliminate the per-view poses through the Schur complement, so the
+optimization scales linearly with the number of views. See calibrateCamera .
 @param criteria Termination criteria for the iterative optimization algorithm.
 
 The function estimates transformation between two cameras making a stereo pair. If you have a stereo
@@ -1530,6 +1574,8 @@ it can be also a vector of feature points or two-channel matrix of size 1xN or N
 
 The function reconstructs 3-dimensional points (in homogeneous coordinates) by using their
 observations with a stereo camera. Projections matrices can be obtained from stereoRectify.
+Each output column is normalized to the unit length, and its sign is chosen so that the
+homogeneous coordinate W is non-negative.
 
 @note
    Keep in mind that all input data should be of float type in order for this function to work.
@@ -1869,7 +1915,8 @@ public:
         MODE_SGBM = 0,
         MODE_HH   = 1,
         MODE_SGBM_3WAY = 2,
-        MODE_HH4  = 3
+        MODE_HH4  = 3,
+        MODE_HH_STRIPED = 4 //!< MODE_HH computed in parallel overlapping horizontal stripes with bounded memory
     };
 
     CV_WRAP virtual int getPreFilterCap() const = 0;
@@ -1918,7 +1965,10 @@ public:
     Normally, 1 or 2 is good enough.
     @param mode Set it to StereoSGBM::MODE_HH to run the full-scale two-pass dynamic programming
     algorithm. It will consume O(W\*H\*numDisparities) bytes, which is large for 640x480 stereo and
-    huge for HD-size pictures. By default, it is set to false .
+    huge for HD-size pictures. By default, it is set to false . StereoSGBM::MODE_HH_STRIPED runs the
+    same algorithm in overlapping horizontal stripes, in parallel, so that every stripe needs at most
+    about 128 MB for its cost volumes. Since the vertical and the diagonal paths start at the stripe
+    borders, the result is close to, but not exactly the same as, that of StereoSGBM::MODE_HH.
 
     The first constructor initializes StereoSGBM with all the default parameters. So, you only have to
     set StereoSGBM::numDisparities at minimum. The second constructor enables you to set each parameter
@@ -157,3 +157,76 @@ PERF_TEST_P(PointsNum, DISABLED_SolvePnPRansac, testing::Values(5, 3*9, 7*13))
     SANITY_CHECK(rvec, 1e-6);
     SANITY_CHECK(tvec, 1e-6);
 }
+
+typedef std::tr1::tuple<int, int> ProblemsNum_PointsNum_t;
+typedef perf::TestBaseWithParam<ProblemsNum_PointsNum_t> ProblemsNum_PointsNum;
+
+static void generatePnPProblems(int problemsNum, int pointsNum, const Mat& intrinsics,
+                                vector<vector<Point3f> >& points3d, vector<vector<Point2f> >& points2d)
+{
+    RNG rng(0);
+    points3d.resize(problemsNum);
+    points2d.resize(problemsNum);
+    for (int i = 0; i < problemsNum; i++)
+    {
+        points3d[i].resize(pointsNum);
+        for (int j = 0; j < pointsNum; j++)
+            points3d[i][j] = Point3f(rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f));
+        Mat rvec = (Mat_<double>(3, 1) << rng.uniform(-0.5, 0.5), rng.uniform(-0.5, 0.5), rng.uniform(-0.5, 0.5));
+        Mat tvec = (Mat_<double>(3, 1) << rng.uniform(-1., 1.), rng.uniform(-1., 1.), rng.uniform(5., 10.));
+        projectPoints(points3d[i], rvec, tvec, intrinsics, noArray(), points2d[i]);
+        for (int j = 0; j < pointsNum; j++)
+            points2d[i][j] += Point2f((float)rng.gaussian(0.5), (float)rng.gaussian(0.5));
+    }
+}
+
+PERF_TEST_P(ProblemsNum_PointsNum, solvePnPBatch,
+            testing::Combine(
+                testing::Values(100, 1000),
+                testing::Values(5, 3*9)
+                )
+            )
+{
+    int problemsNum = get<0>(GetParam());
+    int pointsNum = get<1>(GetParam());
+
+    Mat intrinsics = (Mat_<double>(3, 3) << 400, 0, 640 / 2, 0, 400, 480 / 2, 0, 0, 1);
+    vector<vector<Point3f> > points3d;
+    vector<vector<Point2f> > points2d;
+    generatePnPProblems(problemsNum, pointsNum, intrinsics, points3d, points2d);
+
+    vector<Mat> rvecs, tvecs;
+
+    TEST_CYCLE()
+    {
+        solvePnPBatch(points3d, points2d, intrinsics, noArray(), rvecs, tvecs);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(ProblemsNum_PointsNum, solvePnPLoop,
+            testing::Combine(
+                testing::Values(100, 1000),
+                testing::Values(5, 3*9)
+                )
+            )
+{
+    int problemsNum = get<0>(GetParam());
+    int pointsNum = get<1>(GetParam());
+
+    Mat intrinsics = (Mat_<double>(3, 3) << 400, 0, 640 / 2, 0, 400, 480 / 2, 0, 0, 1);
+    vector<vector<Point3f> > points3d;
+    vector<vector<Point2f> > points2d;
+    generatePnPProblems(problemsNum, pointsNum, intrinsics, points3d, points2d);
+
+    vector<Mat> rvecs(problemsNum), tvecs(problemsNum);
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < problemsNum; i++)
+            solvePnP(points3d[i], points2d[i], intrinsics, noArray(), rvecs[i], tvecs[i]);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
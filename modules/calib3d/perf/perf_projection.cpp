@@ -0,0 +1,82 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<int, int> PointsNum_Depth_t;
+typedef perf::TestBaseWithParam<PointsNum_Depth_t> PointsNum_Depth;
+
+PERF_TEST_P(PointsNum_Depth, triangulatePoints,
+            testing::Combine(
+                testing::Values(10000, 1000000),
+                testing::Values(CV_32F, CV_64F)
+                )
+            )
+{
+    int pointsNum = get<0>(GetParam());
+    int depth = get<1>(GetParam());
+
+    Matx33d K(800, 0, 320, 0, 800, 240, 0, 0, 1);
+    Matx34d P1 = K*Matx34d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0);
+    Matx34d P2 = K*Matx34d(1, 0, 0, -1, 0, 1, 0, 0, 0, 0, 1, 0);
+
+    Mat points1(2, pointsNum, depth), points2(2, pointsNum, depth), points4D;
+    randu(points1, 0, 640);
+    points1.copyTo(points2);
+    Mat shift(1, pointsNum, depth);
+    randu(shift, -100, 0);
+    points2.row(0) += shift;
+
+    declare.in(points1, points2);
+
+    TEST_CYCLE()
+    {
+        triangulatePoints(P1, P2, points1, points2, points4D);
+    }
+
+    // throughput, in the XML report
+    performance_metrics& m = calcMetrics();
+    RecordProperty("points_per_sec", cvRound(pointsNum*m.frequency/m.median));
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef std::tr1::tuple<int, int, int> PointsNum_Depth_DistNum_t;
+typedef perf::TestBaseWithParam<PointsNum_Depth_DistNum_t> PointsNum_Depth_DistNum;
+
+PERF_TEST_P(PointsNum_Depth_DistNum, projectPoints,
+            testing::Combine(
+                testing::Values(10000, 1000000),
+                testing::Values(CV_32F, CV_64F),
+                testing::Values(0, 5, 8)
+                )
+            )
+{
+    int pointsNum = get<0>(GetParam());
+    int depth = get<1>(GetParam());
+    int distNum = get<2>(GetParam());
+
+    Mat objectPoints(pointsNum, 1, CV_MAKETYPE(depth, 3)), imagePoints;
+    randu(objectPoints, Scalar(-1, -1, 4), Scalar(1, 1, 10));
+
+    Mat cameraMatrix = (Mat_<double>(3, 3) << 800, 0, 320, 0, 800, 240, 0, 0, 1);
+    double k[] = { -0.3, 0.1, 0.001, -0.002, 0.01, 0.02, -0.01, 0.005 };
+    Mat distCoeffs(1, distNum, CV_64F, k);
+    Mat rvec = (Mat_<double>(3, 1) << 0.1, -0.2, 0.3), tvec = (Mat_<double>(3, 1) << 0.5, -0.1, 1);
+
+    declare.in(objectPoints);
+
+    TEST_CYCLE()
+    {
+        projectPoints(objectPoints, rvec, tvec, cameraMatrix, distCoeffs, imagePoints);
+    }
+
+    // throughput, in the XML report
+    performance_metrics& m = calcMetrics();
+    RecordProperty("points_per_sec", cvRound(pointsNum*m.frequency/m.median));
+
+    SANITY_CHECK_NOTHING();
+}
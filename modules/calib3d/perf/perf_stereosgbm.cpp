@@ -79,6 +79,37 @@ PERF_TEST_P( TestStereoCorresp, SGBM, Combine(Values(Size(1280,720),Size(640,480
     SANITY_CHECK(dst, .01, ERROR_RELATIVE);
 }
 
+CV_ENUM(SGBMFullDPModes, StereoSGBM::MODE_HH, StereoSGBM::MODE_HH_STRIPED);
+typedef tuple<Size, SGBMFullDPModes> SGBMFullDPParams;
+typedef TestBaseWithParam<SGBMFullDPParams> TestStereoCorrespFullDP;
+
+PERF_TEST_P( TestStereoCorrespFullDP, SGBM_HH, Combine(Values(Size(1280,720),Size(640,480)), SGBMFullDPModes::all()) )
+{
+    RNG rng(0);
+
+    SGBMFullDPParams params = GetParam();
+
+    Size sz  = get<0>(params);
+    int mode = get<1>(params);
+
+    Mat src_left(sz, CV_8UC1);
+    Mat src_right(sz, CV_8UC1);
+    Mat dst(sz, CV_16S);
+
+    MakeArtificialExample(rng,src_left,src_right);
+
+    cv::setNumThreads(cv::getNumberOfCPUs());
+    int wsize = 3;
+    int P1 = 8*src_left.channels()*wsize*wsize;
+    TEST_CYCLE()
+    {
+        Ptr<StereoSGBM> sgbm = StereoSGBM::create(0,128,wsize,P1,4*P1,1,63,25,0,0,mode);
+        sgbm->compute(src_left,src_right,dst);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
 void MakeArtificialExample(RNG rng, Mat& dst_left_view, Mat& dst_right_view)
 {
     int w = dst_left_view.cols;
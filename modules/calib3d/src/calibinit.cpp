@@ -420,6 +420,58 @@ static bool icvBinarizationHistogramBased( Mat & img )
     return true;
 }
 
+// a single dilation level of the histogram-based chessboard search
+struct ChessBoardDilationTrial
+{
+    Mat thresh;
+    std::vector<CvPoint2D32f> corners;
+    int corner_count;
+    int quad_count;
+    bool found;
+};
+
+class ChessBoardDilationInvoker : public ParallelLoopBody
+{
+public:
+    ChessBoardDilationInvoker( ChessBoardDilationTrial* _trials, CvSize _pattern_size, int _flags )
+        : trials(_trials), pattern_size(_pattern_size), flags(_flags) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            ChessBoardDilationTrial& trial = trials[i];
+            CvCBQuad *quads = 0;
+            CvCBCorner *corners = 0;
+            cv::Ptr<CvMemStorage> storage(cvCreateMemStorage(0));
+            int max_quad_buf_size = 0, prev_sqr_size = 0;
+
+            trial.corners.resize(pattern_size.width*pattern_size.height);
+            trial.corner_count = 0;
+            trial.found = false;
+            try
+            {
+                trial.quad_count = icvGenerateQuads( &quads, &corners, storage, trial.thresh, flags, &max_quad_buf_size );
+                SHOW_QUADS("New quads", trial.thresh, quads, trial.quad_count);
+                trial.found = processQuads(quads, trial.quad_count, pattern_size, max_quad_buf_size, storage, corners,
+                                           &trial.corners[0], &trial.corner_count, prev_sqr_size);
+            }
+            catch(...)
+            {
+                cvFree(&quads);
+                cvFree(&corners);
+                throw;
+            }
+            cvFree(&quads);
+            cvFree(&corners);
+        }
+    }
+
+    ChessBoardDilationTrial* trials;
+    CvSize pattern_size;
+    int flags;
+};
+
 CV_IMPL
 int cvFindChessboardCorners( const void* arr, CvSize pattern_size,
                              CvPoint2D32f* out_corners, int* out_corner_count,
@@ -482,26 +534,48 @@ int cvFindChessboardCorners( const void* arr, CvSize pattern_size,
     // This is necessary because some squares simply do not separate properly with a single dilation.  However,
     // we want to use the minimum number of dilations possible since dilations cause the squares to become smaller,
     // making it difficult to detect smaller squares.
-    for( int dilations = min_dilations; dilations <= max_dilations; dilations++ )
+    // With several threads, the next getNumThreads() dilation levels are tried at once and the smallest
+    // successful one is taken, so the result is the same as with the sequential search.
+    int ntrials = std::max(std::min(getNumThreads(), max_dilations - min_dilations + 1), 1);
+    std::vector<ChessBoardDilationTrial> trials(ntrials);
+    for( int dilations = min_dilations; dilations <= max_dilations && !found; dilations += ntrials )
     {
-        if (found)
-            break;      // already found it
+        int n = std::min(ntrials, max_dilations - dilations + 1);
+        for( k = 0; k < n; k++ )
+        {
+            //USE BINARY IMAGE COMPUTED USING icvBinarizationHistogramBased METHOD
+            dilate( thresh_img_new, thresh_img_new, Mat(), Point(-1, -1), 1 );
 
-        //USE BINARY IMAGE COMPUTED USING icvBinarizationHistogramBased METHOD
-        dilate( thresh_img_new, thresh_img_new, Mat(), Point(-1, -1), 1 );
+            // So we can find rectangles that go to the edge, we draw a white line around the image edge.
+            // Otherwise FindContours will miss those clipped rectangle contours.
+            // The border color will be the image mean, because otherwise we risk screwing up filters like cvSmooth()...
+            rectangle( thresh_img_new, Point(0,0), Point(thresh_img_new.cols-1, thresh_img_new.rows-1), Scalar(255,255,255), 3, LINE_8);
 
-        // So we can find rectangles that go to the edge, we draw a white line around the image edge.
-        // Otherwise FindContours will miss those clipped rectangle contours.
-        // The border color will be the image mean, because otherwise we risk screwing up filters like cvSmooth()...
-        rectangle( thresh_img_new, Point(0,0), Point(thresh_img_new.cols-1, thresh_img_new.rows-1), Scalar(255,255,255), 3, LINE_8);
-        int max_quad_buf_size = 0;
-        cvFree(&quads);
-        cvFree(&corners);
-        int quad_count = icvGenerateQuads( &quads, &corners, storage, thresh_img_new, flags, &max_quad_buf_size );
-        PRINTF("Quad count: %d/%d\n", quad_count, (pattern_size.width/2+1)*(pattern_size.height/2+1));
-        SHOW_QUADS("New quads", thresh_img_new, quads, quad_count);
-        if (processQuads(quads, quad_count, pattern_size, max_quad_buf_size, storage, corners, out_corners, out_corner_count, prev_sqr_size))
-            found = 1;
+            // the contour retrieval modifies the image, but keeps its non-zero mask that the next dilation uses
+            if( n == 1 )
+                trials[k].thresh = thresh_img_new;
+            else
+                thresh_img_new.copyTo(trials[k].thresh);
+        }
+
+        parallel_for_(Range(0, n), ChessBoardDilationInvoker(&trials[0], pattern_size, flags), n);
+
+        for( k = 0; k < n; k++ )
+        {
+            const ChessBoardDilationTrial& trial = trials[k];
+            PRINTF("Quad count: %d/%d\n", trial.quad_count, (pattern_size.width/2+1)*(pattern_size.height/2+1));
+            if( trial.found || (out_corner_count && trial.corner_count > *out_corner_count) )
+            {
+                std::copy(trial.corners.begin(), trial.corners.begin() + trial.corner_count, out_corners);
+                if( out_corner_count )
+                    *out_corner_count = trial.corner_count;
+            }
+            if( trial.found )
+            {
+                found = 1;
+                break;
+            }
+        }
     }
 
     PRINTF("Chessboard detection result 0: %d\n", found);
@@ -2046,11 +2120,126 @@ cvDrawChessboardCorners( CvArr* _image, CvSize pattern_size,
     }
 }
 
+// CALIB_CB_COARSE_TO_FINE: the longer side of the coarse pyramid level and
+// the smallest expected square size there, when it is known from the previous corners
+static const int CB_COARSE_MAX_SIZE = 1280;
+static const float CB_COARSE_MIN_SQUARE = 12.f;
+
+static float icvMinCornerDistance( const std::vector<Point2f>& corners, Size patternSize )
+{
+    float d = FLT_MAX;
+    for( int y = 0; y < patternSize.height; y++ )
+        for( int x = 0; x < patternSize.width; x++ )
+        {
+            const Point2f& p = corners[y*patternSize.width + x];
+            if( x + 1 < patternSize.width )
+                d = std::min(d, (float)norm(p - corners[y*patternSize.width + x + 1]));
+            if( y + 1 < patternSize.height )
+                d = std::min(d, (float)norm(p - corners[(y + 1)*patternSize.width + x]));
+        }
+    return d;
+}
+
+static int icvChessboardCoarseLevels( Size size, float squareSize, int flags )
+{
+    int levels = 0;
+    if( !(flags & CALIB_CB_COARSE_TO_FINE) )
+        return 0;
+    while( (std::max(size.width, size.height) >> levels) > CB_COARSE_MAX_SIZE )
+        levels++;
+    while( levels > 0 && squareSize/(1 << levels) < CB_COARSE_MIN_SQUARE )
+        levels--;
+    return levels;
+}
+
+// detects the board on the given level of the pyramid built from gray(roi),
+// then refines the corners level by level up to the full resolution
+static bool icvFindChessboardCornersPyr( const Mat& gray, Rect roi, Size patternSize,
+                                         std::vector<Point2f>& corners, int flags, int levels )
+{
+    std::vector<Mat> pyr;
+    buildPyramid(gray(roi), pyr, levels);
+
+    Mat img = pyr[levels];
+    CvMat c_image = img;
+    int count = patternSize.area()*2;
+    corners.resize(count+1);
+    bool found = cvFindChessboardCorners(&c_image, patternSize,
+        (CvPoint2D32f*)&corners[0], &count, flags ) > 0;
+    corners.resize(std::max(count, 0));
+
+    for( int l = levels - 1; l >= 0; l-- )
+    {
+        for( size_t i = 0; i < corners.size(); i++ )
+            corners[i] *= 2.f;
+        if( found )
+        {
+            int wsize = cvFloor(icvMinCornerDistance(corners, patternSize)*0.25f);
+            wsize = std::min(std::max(wsize, 2), 5);
+            cornerSubPix(pyr[l], corners, Size(wsize, wsize), Size(-1, -1),
+                         TermCriteria(TermCriteria::EPS + TermCriteria::COUNT, 15, 0.1));
+        }
+    }
+
+    for( size_t i = 0; i < corners.size(); i++ )
+        corners[i] += Point2f((float)roi.x, (float)roi.y);
+    return found;
+}
+
+static bool icvFindChessboardCornersCoarseToFine( const Mat& image, Size patternSize,
+                                                  std::vector<Point2f>& corners,
+                                                  const std::vector<Point2f>& prevCorners, int flags )
+{
+    if( image.depth() != CV_8U || (image.channels() != 1 && image.channels() != 3 && image.channels() != 4) )
+       CV_Error( CV_StsUnsupportedFormat, "Only 8-bit grayscale or color images are supported" );
+
+    Mat gray = image;
+    if( image.channels() != 1 )
+        cvtColor(image, gray, COLOR_BGR2GRAY);
+
+    int cbFlags = flags & ~(CALIB_CB_COARSE_TO_FINE | CALIB_CB_USE_PREVIOUS_CORNERS);
+    Rect full(0, 0, gray.cols, gray.rows);
+
+    if( !prevCorners.empty() )
+    {
+        // the outer squares, the white border around them and some motion between the frames
+        float squareSize = icvMinCornerDistance(prevCorners, patternSize);
+        int margin = cvCeil(squareSize*2) + 16;
+        Rect roi = boundingRect(prevCorners);
+        roi = Rect(roi.x - margin, roi.y - margin, roi.width + margin*2, roi.height + margin*2) & full;
+        if( roi.area() > 0 &&
+            icvFindChessboardCornersPyr(gray, roi, patternSize, corners, cbFlags,
+                                        icvChessboardCoarseLevels(roi.size(), squareSize, flags)) )
+            return true;
+    }
+
+    return icvFindChessboardCornersPyr(gray, full, patternSize, corners, cbFlags,
+                                       icvChessboardCoarseLevels(full.size(), FLT_MAX, flags));
+}
+
 bool cv::findChessboardCorners( InputArray _image, Size patternSize,
                             OutputArray corners, int flags )
 {
     CV_INSTRUMENT_REGION()
 
+    if( flags & (CALIB_CB_COARSE_TO_FINE | CALIB_CB_USE_PREVIOUS_CORNERS) )
+    {
+        std::vector<Point2f> prevCorners, tmpcorners;
+        if( (flags & CALIB_CB_USE_PREVIOUS_CORNERS) && !corners.empty() )
+        {
+            Mat prev = corners.getMat();
+            if( prev.checkVector(2, CV_32F) == patternSize.area() )
+                prev.copyTo(prevCorners);
+        }
+
+        bool ok = icvFindChessboardCornersCoarseToFine(_image.getMat(), patternSize, tmpcorners, prevCorners, flags);
+        if( !tmpcorners.empty() )
+            Mat(tmpcorners).copyTo(corners);
+        else
+            corners.release();
+        return ok;
+    }
+
     int count = patternSize.area()*2;
     std::vector<Point2f> tmpcorners(count+1);
     Mat image = _image.getMat(); CvMat c_image = image;
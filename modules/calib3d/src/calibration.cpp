@@ -44,6 +44,7 @@
 #include "opencv2/imgproc/imgproc_c.h"
 #include "opencv2/imgproc/detail/distortion_model.hpp"
 #include "opencv2/calib3d/calib3d_c.h"
+#include "opencv2/core/hal/intrin.hpp"
 #include <stdio.h>
 #include <iterator>
 
@@ -1292,6 +1293,404 @@ static void subMatrix(const cv::Mat& src, cv::Mat& dst, const std::vector<uchar>
     }
 }
 
+/*
+   Levenberg-Marquardt engine for the normal equations of the calibration problems.
+   Every view contributes a block of 6 private parameters (its extrinsics), and all
+   the views share a few global ones (intrinsics and, for stereo, the inter-camera pose).
+   JtJ therefore has the block-arrow structure
+
+        | U    W_0^T  ...  W_{n-1}^T |
+        | W_0  V_0                   |
+        | ...         ...            |
+        | W_{n-1}          V_{n-1}   |
+
+   Instead of the dense (nglobal + 6*n)^2 matrix only U, W_i and V_i are stored, and the
+   per-view blocks are eliminated through the Schur complement, so every step costs O(n)
+   instead of O(n^3). The state machine is the same as in CvLevMarq::updateAlt(); the
+   per-view parameters occupy param[blockOfs : blockOfs + 6*n], the rest are global.
+*/
+class CvLevMarqSchur : public CvLevMarq
+{
+public:
+    enum { BLOCK_SIZE = 6 };
+
+    CvLevMarqSchur( int nparams, int blockOfs, int nblocks, CvTermCriteria criteria );
+
+    bool updateAlt( const CvMat*& param, CvMat*& JtErr, double*& errNorm );
+    void step();
+    void clearJtJ();
+    // diagonal of the inverted JtJ, as the dense path gets it with cv::invert(JtJN, DECOMP_SVD)
+    void calcJtJinvDiag( Mat& diag ) const;
+
+    // maps the index in the parameter vector to the index in U and the columns of W
+    int globalIdx( int paramIdx ) const
+    {
+        return paramIdx < blockOfs ? paramIdx : paramIdx - nblocks*BLOCK_SIZE;
+    }
+
+    Mat U; // nglobal x nglobal, the upper triangle is used
+    Mat W; // (nblocks*6) x nglobal, rows [i*6, i*6 + 6) keep W_i
+    Mat V; // (nblocks*6) x 6, rows [i*6, i*6 + 6) keep V_i
+
+protected:
+    void eliminateBlocks( double lambda, const std::vector<int>& gparams,
+                          Mat& S, Mat& Wm, Mat& Vinv, Mat& Y ) const;
+
+    int blockOfs;
+    int nblocks;
+};
+
+CvLevMarqSchur::CvLevMarqSchur( int nparams, int _blockOfs, int _nblocks, CvTermCriteria criteria0 )
+{
+    int nglobal = nparams - _nblocks*BLOCK_SIZE;
+    CV_Assert( _nblocks > 0 && nglobal >= 0 && 0 <= _blockOfs && _blockOfs <= nglobal );
+
+    blockOfs = _blockOfs;
+    nblocks = _nblocks;
+
+    // the same as CvLevMarq::init(), but without the dense JtJ
+    mask.reset(cvCreateMat( nparams, 1, CV_8U ));
+    cvSet(mask, cvScalarAll(1));
+    prevParam.reset(cvCreateMat( nparams, 1, CV_64F ));
+    param.reset(cvCreateMat( nparams, 1, CV_64F ));
+    JtErr.reset(cvCreateMat( nparams, 1, CV_64F ));
+    U.create(nglobal, nglobal, CV_64F);
+    W.create(nblocks*BLOCK_SIZE, nglobal, CV_64F);
+    V.create(nblocks*BLOCK_SIZE, BLOCK_SIZE, CV_64F);
+
+    errNorm = prevErrNorm = DBL_MAX;
+    lambdaLg10 = -3;
+    criteria = criteria0;
+    if( criteria.type & CV_TERMCRIT_ITER )
+        criteria.max_iter = MIN(MAX(criteria.max_iter,1),1000);
+    else
+        criteria.max_iter = 30;
+    if( criteria.type & CV_TERMCRIT_EPS )
+        criteria.epsilon = MAX(criteria.epsilon, 0);
+    else
+        criteria.epsilon = DBL_EPSILON;
+    state = STARTED;
+    iters = 0;
+    completeSymmFlag = false;
+    solveMethod = DECOMP_SVD;
+}
+
+void CvLevMarqSchur::clearJtJ()
+{
+    U = Scalar::all(0);
+    W = Scalar::all(0);
+    V = Scalar::all(0);
+    cvZero( JtErr );
+}
+
+bool CvLevMarqSchur::updateAlt( const CvMat*& _param, CvMat*& _JtErr, double*& _errNorm )
+{
+    if( state == DONE )
+    {
+        _param = param;
+        return false;
+    }
+
+    if( state == STARTED )
+    {
+        _param = param;
+        clearJtJ();
+        errNorm = 0;
+        _JtErr = JtErr;
+        _errNorm = &errNorm;
+        state = CALC_J;
+        return true;
+    }
+
+    if( state == CALC_J )
+    {
+        cvCopy( param, prevParam );
+        step();
+        _param = param;
+        prevErrNorm = errNorm;
+        errNorm = 0;
+        _errNorm = &errNorm;
+        state = CHECK_ERR;
+        return true;
+    }
+
+    assert( state == CHECK_ERR );
+    if( errNorm > prevErrNorm )
+    {
+        if( ++lambdaLg10 <= 16 )
+        {
+            step();
+            _param = param;
+            errNorm = 0;
+            _errNorm = &errNorm;
+            state = CHECK_ERR;
+            return true;
+        }
+    }
+
+    lambdaLg10 = MAX(lambdaLg10-1, -16);
+    if( ++iters >= criteria.max_iter ||
+        cvNorm(param, prevParam, CV_RELATIVE_L2) < criteria.epsilon )
+    {
+        _param = param;
+        _JtErr = JtErr;
+        state = DONE;
+        return false;
+    }
+
+    prevErrNorm = errNorm;
+    clearJtJ();
+    _param = param;
+    _JtErr = JtErr;
+    state = CALC_J;
+    return true;
+}
+
+class SchurBlockInvoker : public ParallelLoopBody
+{
+public:
+    SchurBlockInvoker( const Mat& _V, const Mat& _Wm, Mat& _Vinv, Mat& _Y, double _lambda )
+        : V(&_V), Wm(&_Wm), Vinv(&_Vinv), Y(&_Y), lambda(_lambda) {}
+
+    void operator()( const Range& range ) const
+    {
+        const int bs = 6;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Matx66d Vi = V->rowRange(i*bs, (i+1)*bs), Vi_inv;
+            if( lambda != 0 )
+            {
+                for( int k = 0; k < bs; k++ )
+                    Vi(k, k) *= 1. + lambda;
+                if( !invert(Vi, Vi_inv, DECOMP_CHOLESKY) )
+                    invert(Vi, Vi_inv, DECOMP_SVD);
+            }
+            else
+                invert(Vi, Vi_inv, DECOMP_SVD);
+            Mat(Vi_inv).copyTo(Vinv->rowRange(i*bs, (i+1)*bs));
+            Mat Yi = Y->rowRange(i*bs, (i+1)*bs);
+            gemm(Mat(Vi_inv), Wm->rowRange(i*bs, (i+1)*bs), 1, noArray(), 0, Yi);
+        }
+    }
+
+    const Mat* V;
+    const Mat* Wm;
+    Mat* Vinv;
+    Mat* Y;
+    double lambda;
+};
+
+/* Builds the Schur complement S = U - sum_i W_i^T V_i^-1 W_i over the unmasked global
+   parameters gparams, with the diagonal of JtJ scaled by (1 + lambda).
+   Also returns Wm (the unmasked columns of W), V_i^-1 and Y_i = V_i^-1 W_i. */
+void CvLevMarqSchur::eliminateBlocks( double lambda, const std::vector<int>& gparams,
+                                      Mat& S, Mat& Wm, Mat& Vinv, Mat& Y ) const
+{
+    int ng = (int)gparams.size(), nb = nblocks*BLOCK_SIZE;
+
+    S.create(ng, ng, CV_64F);
+    Wm.create(nb, ng, CV_64F);
+    for( int j = 0; j < ng; j++ )
+    {
+        int gj = globalIdx(gparams[j]);
+        for( int i = 0; i < ng; i++ )
+        {
+            int gi = globalIdx(gparams[i]);
+            S.at<double>(i, j) = U.at<double>(std::min(gi, gj), std::max(gi, gj));
+        }
+        W.col(gj).copyTo(Wm.col(j));
+    }
+    if( lambda != 0 )
+        S.diag() *= 1. + lambda;
+
+    Vinv.create(nb, BLOCK_SIZE, CV_64F);
+    Y.create(nb, ng, CV_64F);
+
+    parallel_for_(Range(0, nblocks), SchurBlockInvoker(V, Wm, Vinv, Y, lambda));
+
+    if( ng > 0 )
+        gemm(Wm, Y, -1, S, 1, S, GEMM_1_T);
+}
+
+void CvLevMarqSchur::step()
+{
+    const double LOG10 = log(10.);
+    double lambda = exp(lambdaLg10*LOG10);
+    int nparams = param->rows, nb = nblocks*BLOCK_SIZE;
+    const uchar* m = mask->data.ptr;
+    const double* pp = prevParam->data.db;
+    double* p = param->data.db;
+
+    std::vector<int> gparams;
+    for( int i = 0; i < nparams; i++ )
+    {
+        if( i >= blockOfs && i < blockOfs + nb )
+            CV_Assert( m[i] ); // per-view parameters can not be fixed
+        else if( m[i] )
+            gparams.push_back(i);
+    }
+    int ng = (int)gparams.size();
+
+    Mat S, Wm, Vinv, Y;
+    eliminateBlocks(lambda, gparams, S, Wm, Vinv, Y);
+
+    Mat JtErrAll = cvarrToMat(JtErr);
+    Mat bb = JtErrAll.rowRange(blockOfs, blockOfs + nb), bg(ng, 1, CV_64F), dg, c;
+    for( int j = 0; j < ng; j++ )
+        bg.at<double>(j) = JtErrAll.at<double>(gparams[j]);
+
+    if( ng > 0 )
+    {
+        // (U - W^T V^-1 W) dg = bg - W^T V^-1 bb
+        gemm(Y, bb, -1, bg, 1, bg, GEMM_1_T);
+        solve(S, bg, dg, solveMethod);
+        // V db = bb - W dg
+        gemm(Wm, dg, -1, bb, 1, c);
+    }
+    else
+        c = bb;
+
+    for( int j = 0; j < ng; j++ )
+        p[gparams[j]] = pp[gparams[j]] - dg.at<double>(j);
+
+    for( int i = 0; i < nblocks; i++ )
+    {
+        Matx61d db = Matx66d(Vinv.rowRange(i*BLOCK_SIZE, (i+1)*BLOCK_SIZE)) *
+                     Matx61d(c.rowRange(i*BLOCK_SIZE, (i+1)*BLOCK_SIZE));
+        for( int k = 0; k < BLOCK_SIZE; k++ )
+        {
+            int idx = blockOfs + i*BLOCK_SIZE + k;
+            p[idx] = pp[idx] - db(k);
+        }
+    }
+
+    for( int i = 0; i < nparams; i++ )
+        if( !m[i] )
+            p[i] = pp[i];
+}
+
+void CvLevMarqSchur::calcJtJinvDiag( Mat& diag ) const
+{
+    int nparams = param->rows;
+    const uchar* m = mask->data.ptr;
+
+    std::vector<int> gparams;
+    for( int i = 0; i < nparams; i++ )
+        if( m[i] && (i < blockOfs || i >= blockOfs + nblocks*BLOCK_SIZE) )
+            gparams.push_back(i);
+    int ng = (int)gparams.size();
+
+    Mat S, Wm, Vinv, Y, Sinv;
+    eliminateBlocks(0, gparams, S, Wm, Vinv, Y);
+    invert(S, Sinv, DECOMP_SVD);
+
+    diag.create(nparams, 1, CV_64F);
+    diag = Scalar::all(0);
+    for( int j = 0; j < ng; j++ )
+        diag.at<double>(gparams[j]) = Sinv.at<double>(j, j);
+
+    // the diagonal blocks of the inverse are V_i^-1 + Y_i S^-1 Y_i^T
+    Mat YSinv = ng > 0 ? Y * Sinv : Mat::zeros(Y.size(), CV_64F);
+    for( int r = 0; r < nblocks*BLOCK_SIZE; r++ )
+        diag.at<double>(blockOfs + r) = Vinv.at<double>(r, r % BLOCK_SIZE) + YSinv.row(r).dot(Y.row(r));
+}
+
+/* Projects the views of cvCalibrateCamera2Internal() in parallel and fills the blocks of
+   CvLevMarqSchur. The global terms Ji^T*Ji and Ji^T*err are stored per view and summed up
+   by the caller in the view order, so the result does not depend on the number of threads. */
+class CalibrateViewsInvoker : public ParallelLoopBody
+{
+public:
+    CalibrateViewsInvoker( const Mat& _objPoints, const Mat& _imgPoints, const std::vector<int>& _viewOfs,
+                           const CvMat* _param, const CvMat* _matA, const CvMat* _distCoeffs,
+                           int _flags, double _aspectRatio, bool _calcJ, int _maxPoints,
+                           CvLevMarqSchur* _solver, Mat& _JiJi, Mat& _JiErr,
+                           std::vector<double>& _viewErrs, Mat* _allErrors )
+        : objPoints(&_objPoints), imgPoints(&_imgPoints), viewOfs(&_viewOfs), param(_param),
+          matA(_matA), distCoeffs(_distCoeffs), flags(_flags), aspectRatio(_aspectRatio),
+          calcJ(_calcJ), maxPoints(_maxPoints), solver(_solver), JiJi(&_JiJi), JiErr(&_JiErr),
+          viewErrs(&_viewErrs), allErrors(_allErrors) {}
+
+    void operator()( const Range& range ) const
+    {
+        const int NINTRINSIC = CV_CALIB_NINTRINSIC;
+        Mat _Ji( maxPoints*2, NINTRINSIC, CV_64FC1, Scalar(0));
+        Mat _Je( maxPoints*2, 6, CV_64FC1 );
+        Mat _err( maxPoints*2, 1, CV_64FC1 );
+        Mat JtErr = cvarrToMat(solver->JtErr);
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            CvMat _ri, _ti;
+            int pos = (*viewOfs)[i], ni = (*viewOfs)[i+1] - pos;
+
+            cvGetRows( param, &_ri, NINTRINSIC + i*6, NINTRINSIC + i*6 + 3 );
+            cvGetRows( param, &_ti, NINTRINSIC + i*6 + 3, NINTRINSIC + i*6 + 6 );
+
+            CvMat _Mi(objPoints->colRange(pos, pos + ni));
+            CvMat _mi(imgPoints->colRange(pos, pos + ni));
+
+            Mat Ji = _Ji.rowRange(0, ni*2), Je = _Je.rowRange(0, ni*2), err = _err.rowRange(0, ni*2);
+            CvMat _dpdr(Je.colRange(0, 3));
+            CvMat _dpdt(Je.colRange(3, 6));
+            CvMat _dpdf(Ji.colRange(0, 2));
+            CvMat _dpdc(Ji.colRange(2, 4));
+            CvMat _dpdk(Ji.colRange(4, NINTRINSIC));
+            CvMat _mp(err.reshape(2, 1));
+
+            if( calcJ )
+            {
+                cvProjectPoints2( &_Mi, &_ri, &_ti, matA, distCoeffs, &_mp, &_dpdr, &_dpdt,
+                                  (flags & CALIB_FIX_FOCAL_LENGTH) ? 0 : &_dpdf,
+                                  (flags & CALIB_FIX_PRINCIPAL_POINT) ? 0 : &_dpdc, &_dpdk,
+                                  (flags & CALIB_FIX_ASPECT_RATIO) ? aspectRatio : 0);
+            }
+            else
+                cvProjectPoints2( &_Mi, &_ri, &_ti, matA, distCoeffs, &_mp );
+
+            cvSub( &_mp, &_mi, &_mp );
+            if( allErrors )
+            {
+                CvMat _me(allErrors->colRange(pos, pos + ni));
+                cvCopy(&_mp, &_me);
+            }
+
+            if( calcJ )
+            {
+                Mat JiJi_i = JiJi->rowRange(i*NINTRINSIC, (i+1)*NINTRINSIC);
+                Mat JiErr_i = JiErr->rowRange(i*NINTRINSIC, (i+1)*NINTRINSIC);
+                Mat V_i = solver->V.rowRange(i*6, (i+1)*6);
+                Mat W_i = solver->W.rowRange(i*6, (i+1)*6);
+                Mat JeErr_i = JtErr.rowRange(NINTRINSIC + i*6, NINTRINSIC + (i+1)*6);
+
+                mulTransposed(Ji, JiJi_i, true);
+                mulTransposed(Je, V_i, true);
+                gemm(Je, Ji, 1, noArray(), 0, W_i, GEMM_1_T);
+                gemm(Ji, err, 1, noArray(), 0, JiErr_i, GEMM_1_T);
+                gemm(Je, err, 1, noArray(), 0, JeErr_i, GEMM_1_T);
+            }
+
+            (*viewErrs)[i] = norm(err, NORM_L2SQR);
+        }
+    }
+
+    const Mat* objPoints;
+    const Mat* imgPoints;
+    const std::vector<int>* viewOfs;
+    const CvMat* param;
+    const CvMat* matA;
+    const CvMat* distCoeffs;
+    int flags;
+    double aspectRatio;
+    bool calcJ;
+    int maxPoints;
+    CvLevMarqSchur* solver;
+    Mat* JiJi;
+    Mat* JiErr;
+    std::vector<double>* viewErrs;
+    Mat* allErrors;
+};
+
 static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
                     const CvMat* imagePoints, const CvMat* npoints,
                     CvSize imageSize, CvMat* cameraMatrix, CvMat* distCoeffs,
@@ -1480,7 +1879,16 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
         cvInitIntrinsicParams2D( &_matM, &m, npoints, imageSize, &matA, aspectRatio );
     }
 
-    CvLevMarq solver( nparams, 0, termCrit );
+    // with CALIB_USE_SCHUR the per-view extrinsics are eliminated from the normal equations
+    // instead of solving the dense nparams x nparams system
+    const bool useSchur = (flags & CALIB_USE_SCHUR) != 0;
+    CvLevMarq denseSolver;
+    Ptr<CvLevMarqSchur> schurSolver;
+    if( useSchur )
+        schurSolver = makePtr<CvLevMarqSchur>(nparams, NINTRINSIC, nimages, termCrit);
+    else
+        denseSolver.init( nparams, 0, termCrit );
+    CvLevMarq& solver = useSchur ? *schurSolver : denseSolver;
 
     if(flags & CALIB_USE_LU) {
         solver.solveMethod = DECOMP_LU;
@@ -1550,13 +1958,27 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
         cvFindExtrinsicCameraParams2( &_Mi, &_mi, &matA, &_k, &_ri, &_ti );
     }
 
+    std::vector<int> viewOfs;
+    std::vector<double> viewErrs;
+    Mat JiJi, JiErr;
+    if( useSchur )
+    {
+        viewOfs.resize(nimages + 1, 0);
+        for( i = 0; i < nimages; i++ )
+            viewOfs[i+1] = viewOfs[i] + npoints->data.i[i*npstep];
+        viewErrs.resize(nimages);
+        JiJi.create(nimages*NINTRINSIC, NINTRINSIC, CV_64F);
+        JiErr.create(nimages*NINTRINSIC, 1, CV_64F);
+    }
+
     // 3. run the optimization
     for(;;)
     {
         const CvMat* _param = 0;
         CvMat *_JtJ = 0, *_JtErr = 0;
         double* _errNorm = 0;
-        bool proceed = solver.updateAlt( _param, _JtJ, _JtErr, _errNorm );
+        bool proceed = useSchur ? schurSolver->updateAlt( _param, _JtErr, _errNorm ) :
+                                  solver.updateAlt( _param, _JtJ, _JtErr, _errNorm );
         double *param = solver.param->data.db, *pparam = solver.prevParam->data.db;
         bool calcJ = solver.state == CvLevMarq::CALC_J || (!proceed && stdDevs);
 
@@ -1572,58 +1994,85 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
         if ( !proceed && !stdDevs && !perViewErrors )
             break;
         else if ( !proceed && stdDevs )
-            cvZero(_JtJ);
+        {
+            if( useSchur )
+                schurSolver->clearJtJ();
+            else
+                cvZero(_JtJ);
+        }
 
         reprojErr = 0;
 
-        for( i = 0, pos = 0; i < nimages; i++, pos += ni )
+        if( useSchur )
         {
-            CvMat _ri, _ti;
-            ni = npoints->data.i[i*npstep];
+            parallel_for_(Range(0, nimages),
+                          CalibrateViewsInvoker(matM, _m, viewOfs, solver.param, &matA, &_k,
+                                                flags, aspectRatio, calcJ, maxPoints,
+                                                schurSolver.get(), JiJi, JiErr, viewErrs,
+                                                perViewErrors || stdDevs ? &allErrors : 0));
+            if( calcJ )
+            {
+                Mat JtErr = cvarrToMat(schurSolver->JtErr).rowRange(0, NINTRINSIC);
+                for( i = 0; i < nimages; i++ )
+                {
+                    schurSolver->U += JiJi.rowRange(i*NINTRINSIC, (i+1)*NINTRINSIC);
+                    JtErr += JiErr.rowRange(i*NINTRINSIC, (i+1)*NINTRINSIC);
+                }
+            }
+            for( i = 0; i < nimages; i++ )
+                reprojErr += viewErrs[i];
+        }
+        else
+        {
+            for( i = 0, pos = 0; i < nimages; i++, pos += ni )
+            {
+                CvMat _ri, _ti;
+                ni = npoints->data.i[i*npstep];
 
-            cvGetRows( solver.param, &_ri, NINTRINSIC + i*6, NINTRINSIC + i*6 + 3 );
-            cvGetRows( solver.param, &_ti, NINTRINSIC + i*6 + 3, NINTRINSIC + i*6 + 6 );
+                cvGetRows( solver.param, &_ri, NINTRINSIC + i*6, NINTRINSIC + i*6 + 3 );
+                cvGetRows( solver.param, &_ti, NINTRINSIC + i*6 + 3, NINTRINSIC + i*6 + 6 );
 
-            CvMat _Mi(matM.colRange(pos, pos + ni));
-            CvMat _mi(_m.colRange(pos, pos + ni));
-            CvMat _me(allErrors.colRange(pos, pos + ni));
+                CvMat _Mi(matM.colRange(pos, pos + ni));
+                CvMat _mi(_m.colRange(pos, pos + ni));
+                CvMat _me(allErrors.colRange(pos, pos + ni));
 
-            _Je.resize(ni*2); _Ji.resize(ni*2); _err.resize(ni*2);
-            CvMat _dpdr(_Je.colRange(0, 3));
-            CvMat _dpdt(_Je.colRange(3, 6));
-            CvMat _dpdf(_Ji.colRange(0, 2));
-            CvMat _dpdc(_Ji.colRange(2, 4));
-            CvMat _dpdk(_Ji.colRange(4, NINTRINSIC));
-            CvMat _mp(_err.reshape(2, 1));
+                _Je.resize(ni*2); _Ji.resize(ni*2); _err.resize(ni*2);
+                CvMat _dpdr(_Je.colRange(0, 3));
+                CvMat _dpdt(_Je.colRange(3, 6));
+                CvMat _dpdf(_Ji.colRange(0, 2));
+                CvMat _dpdc(_Ji.colRange(2, 4));
+                CvMat _dpdk(_Ji.colRange(4, NINTRINSIC));
+                CvMat _mp(_err.reshape(2, 1));
 
-            if( calcJ )
-            {
-                 cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp, &_dpdr, &_dpdt,
-                                  (flags & CALIB_FIX_FOCAL_LENGTH) ? 0 : &_dpdf,
-                                  (flags & CALIB_FIX_PRINCIPAL_POINT) ? 0 : &_dpdc, &_dpdk,
-                                  (flags & CALIB_FIX_ASPECT_RATIO) ? aspectRatio : 0);
-            }
-            else
-                cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp );
+                if( calcJ )
+                {
+                     cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp, &_dpdr, &_dpdt,
+                                      (flags & CALIB_FIX_FOCAL_LENGTH) ? 0 : &_dpdf,
+                                      (flags & CALIB_FIX_PRINCIPAL_POINT) ? 0 : &_dpdc, &_dpdk,
+                                      (flags & CALIB_FIX_ASPECT_RATIO) ? aspectRatio : 0);
+                }
+                else
+                    cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp );
 
-            cvSub( &_mp, &_mi, &_mp );
-            if (perViewErrors || stdDevs)
-                cvCopy(&_mp, &_me);
+                cvSub( &_mp, &_mi, &_mp );
+                if (perViewErrors || stdDevs)
+                    cvCopy(&_mp, &_me);
 
-            if( calcJ )
-            {
-                Mat JtJ(cvarrToMat(_JtJ)), JtErr(cvarrToMat(_JtErr));
+                if( calcJ )
+                {
+                    Mat JtJ(cvarrToMat(_JtJ)), JtErr(cvarrToMat(_JtErr));
 
-                // see HZ: (A6.14) for details on the structure of the Jacobian
-                JtJ(Rect(0, 0, NINTRINSIC, NINTRINSIC)) += _Ji.t() * _Ji;
-                JtJ(Rect(NINTRINSIC + i * 6, NINTRINSIC + i * 6, 6, 6)) = _Je.t() * _Je;
-                JtJ(Rect(NINTRINSIC + i * 6, 0, 6, NINTRINSIC)) = _Ji.t() * _Je;
+                    // see HZ: (A6.14) for details on the structure of the Jacobian
+                    JtJ(Rect(0, 0, NINTRINSIC, NINTRINSIC)) += _Ji.t() * _Ji;
+                    JtJ(Rect(NINTRINSIC + i * 6, NINTRINSIC + i * 6, 6, 6)) = _Je.t() * _Je;
+                    JtJ(Rect(NINTRINSIC + i * 6, 0, 6, NINTRINSIC)) = _Ji.t() * _Je;
 
-                JtErr.rowRange(0, NINTRINSIC) += _Ji.t() * _err;
-                JtErr.rowRange(NINTRINSIC + i * 6, NINTRINSIC + (i + 1) * 6) = _Je.t() * _err;
-            }
+                    JtErr.rowRange(0, NINTRINSIC) += _Ji.t() * _err;
+                    JtErr.rowRange(NINTRINSIC + i * 6, NINTRINSIC + (i + 1) * 6) = _Je.t() * _err;
+                }
 
-            reprojErr += norm(_err, NORM_L2SQR);
+                reprojErr += norm(_err, NORM_L2SQR);
+            }
         }
         if( _errNorm )
             *_errNorm = reprojErr;
@@ -1634,25 +2083,34 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
             {
                 Mat mask = cvarrToMat(solver.mask);
                 int nparams_nz = countNonZero(mask);
-                Mat JtJinv, JtJN;
-                JtJN.create(nparams_nz, nparams_nz, CV_64F);
-                subMatrix(cvarrToMat(_JtJ), JtJN, mask, mask);
-                completeSymm(JtJN, false);
-                cv::invert(JtJN, JtJinv, DECOMP_SVD);
+                Mat JtJinvDiag;
+                if( useSchur )
+                {
+                    schurSolver->calcJtJinvDiag(JtJinvDiag);
+                }
+                else
+                {
+                    Mat JtJinv, JtJN;
+                    JtJN.create(nparams_nz, nparams_nz, CV_64F);
+                    subMatrix(cvarrToMat(_JtJ), JtJN, mask, mask);
+                    completeSymm(JtJN, false);
+                    cv::invert(JtJN, JtJinv, DECOMP_SVD);
+                    JtJinvDiag = Mat::zeros(nparams, 1, CV_64F);
+                    for ( int s = 0, j = 0; s < nparams; s++ )
+                        if( mask.data[s] )
+                        {
+                            JtJinvDiag.at<double>(s) = JtJinv.at<double>(j,j);
+                            j++;
+                        }
+                }
                 //sigma2 is deviation of the noise
                 //see any papers about variance of the least squares estimator for
                 //detailed description of the variance estimation methods
                 double sigma2 = norm(allErrors, NORM_L2SQR) / (total - nparams_nz);
                 Mat stdDevsM = cvarrToMat(stdDevs);
-                int j = 0;
                 for ( int s = 0; s < nparams; s++ )
-                    if( mask.data[s] )
-                    {
-                        stdDevsM.at<double>(s) = std::sqrt(JtJinv.at<double>(j,j) * sigma2);
-                        j++;
-                    }
-                    else
-                        stdDevsM.at<double>(s) = 0.;
+                    stdDevsM.at<double>(s) = mask.data[s] ?
+                        std::sqrt(JtJinvDiag.at<double>(s) * sigma2) : 0.;
             }
             break;
         }
@@ -1864,7 +2322,15 @@ double cvStereoCalibrate( const CvMat* _objectPoints, const CvMat* _imagePoints1
     // storage for initial [om(R){i}|t{i}] (in order to compute the median for each component)
     RT0.reset(cvCreateMat( 6, nimages, CV_64F ));
 
-    CvLevMarq solver( nparams, 0, termCrit );
+    // the per-view poses of the left camera follow the inter-camera R, T
+    const bool useSchur = (flags & CALIB_USE_SCHUR) != 0;
+    CvLevMarq denseSolver;
+    Ptr<CvLevMarqSchur> schurSolver;
+    if( useSchur )
+        schurSolver = makePtr<CvLevMarqSchur>(nparams, 6, nimages, termCrit);
+    else
+        denseSolver.init( nparams, 0, termCrit );
+    CvLevMarq& solver = useSchur ? *schurSolver : denseSolver;
 
     if(flags & CALIB_USE_LU) {
         solver.solveMethod = DECOMP_LU;
@@ -2012,7 +2478,8 @@ double cvStereoCalibrate( const CvMat* _objectPoints, const CvMat* _imagePoints1
         CvMat dpdrot_hdr, dpdt_hdr, dpdf_hdr, dpdc_hdr, dpdk_hdr;
         CvMat *dpdrot = &dpdrot_hdr, *dpdt = &dpdt_hdr, *dpdf = 0, *dpdc = 0, *dpdk = 0;
 
-        if( !solver.updateAlt( param, JtJ, JtErr, _errNorm ))
+        if( useSchur ? !schurSolver->updateAlt( param, JtErr, _errNorm ) :
+                       !solver.updateAlt( param, JtJ, JtErr, _errNorm ) )
             break;
         reprojErr = 0;
 
@@ -2106,7 +2573,35 @@ double cvStereoCalibrate( const CvMat* _objectPoints, const CvMat* _imagePoints1
                 if( JtJ || JtErr )
                 {
                     int iofs = (nimages+1)*6 + k*NINTRINSIC, eofs = (i+1)*6;
-                    assert( JtJ && JtErr );
+                    // the blocks of JtJ: LR-LR, view-view, intrinsics-intrinsics,
+                    // view-intrinsics and LR-intrinsics (the upper triangle)
+                    CvMat JtJ_LR, JtJ_e, JtJ_i, JtJ_ei, JtJ_LRi;
+                    assert( (JtJ || useSchur) && JtErr );
+
+                    if( useSchur )
+                    {
+                        CvMat U = schurSolver->U, W = schurSolver->W, V = schurSolver->V;
+                        cvGetSubRect( &U, &JtJ_LR, cvRect(0, 0, 6, 6) );
+                        cvGetSubRect( &V, &JtJ_e, cvRect(0, i*6, 6, 6) );
+                        if( recomputeIntrinsics )
+                        {
+                            int gofs = schurSolver->globalIdx(iofs);
+                            cvGetSubRect( &U, &JtJ_i, cvRect(gofs, gofs, NINTRINSIC, NINTRINSIC) );
+                            cvGetSubRect( &W, &JtJ_ei, cvRect(gofs, i*6, NINTRINSIC, 6) );
+                            cvGetSubRect( &U, &JtJ_LRi, cvRect(gofs, 0, NINTRINSIC, 6) );
+                        }
+                    }
+                    else
+                    {
+                        cvGetSubRect( JtJ, &JtJ_LR, cvRect(0, 0, 6, 6) );
+                        cvGetSubRect( JtJ, &JtJ_e, cvRect(eofs, eofs, 6, 6) );
+                        if( recomputeIntrinsics )
+                        {
+                            cvGetSubRect( JtJ, &JtJ_i, cvRect(iofs, iofs, NINTRINSIC, NINTRINSIC) );
+                            cvGetSubRect( JtJ, &JtJ_ei, cvRect(iofs, eofs, NINTRINSIC, 6) );
+                            cvGetSubRect( JtJ, &JtJ_LRi, cvRect(iofs, 0, NINTRINSIC, 6) );
+                        }
+                    }
 
                     if( k == 1 )
                     {
@@ -2134,33 +2629,36 @@ double cvStereoCalibrate( const CvMat* _objectPoints, const CvMat* _imagePoints1
                             cvCopy( &de3dt1, &de3dt3 );
                         }
 
-                        cvGetSubRect( JtJ, &_part, cvRect(0, 0, 6, 6) );
-                        cvGEMM( J_LR, J_LR, 1, &_part, 1, &_part, CV_GEMM_A_T );
+                        cvGEMM( J_LR, J_LR, 1, &JtJ_LR, 1, &JtJ_LR, CV_GEMM_A_T );
 
-                        cvGetSubRect( JtJ, &_part, cvRect(eofs, 0, 6, 6) );
-                        cvGEMM( J_LR, Je, 1, 0, 0, &_part, CV_GEMM_A_T );
+                        if( useSchur )
+                        {
+                            // W_i keeps the view rows, so the LR-view block is stored transposed
+                            CvMat W = schurSolver->W;
+                            cvGetSubRect( &W, &_part, cvRect(0, i*6, 6, 6) );
+                            cvGEMM( Je, J_LR, 1, 0, 0, &_part, CV_GEMM_A_T );
+                        }
+                        else
+                        {
+                            cvGetSubRect( JtJ, &_part, cvRect(eofs, 0, 6, 6) );
+                            cvGEMM( J_LR, Je, 1, 0, 0, &_part, CV_GEMM_A_T );
+                        }
 
                         cvGetRows( JtErr, &_part, 0, 6 );
                         cvGEMM( J_LR, err, 1, &_part, 1, &_part, CV_GEMM_A_T );
                     }
 
-                    cvGetSubRect( JtJ, &_part, cvRect(eofs, eofs, 6, 6) );
-                    cvGEMM( Je, Je, 1, &_part, 1, &_part, CV_GEMM_A_T );
+                    cvGEMM( Je, Je, 1, &JtJ_e, 1, &JtJ_e, CV_GEMM_A_T );
 
                     cvGetRows( JtErr, &_part, eofs, eofs + 6 );
                     cvGEMM( Je, err, 1, &_part, 1, &_part, CV_GEMM_A_T );
 
                     if( recomputeIntrinsics )
                     {
-                        cvGetSubRect( JtJ, &_part, cvRect(iofs, iofs, NINTRINSIC, NINTRINSIC) );
-                        cvGEMM( Ji, Ji, 1, &_part, 1, &_part, CV_GEMM_A_T );
-                        cvGetSubRect( JtJ, &_part, cvRect(iofs, eofs, NINTRINSIC, 6) );
-                        cvGEMM( Je, Ji, 1, &_part, 1, &_part, CV_GEMM_A_T );
+                        cvGEMM( Ji, Ji, 1, &JtJ_i, 1, &JtJ_i, CV_GEMM_A_T );
+                        cvGEMM( Je, Ji, 1, &JtJ_ei, 1, &JtJ_ei, CV_GEMM_A_T );
                         if( k == 1 )
-                        {
-                            cvGetSubRect( JtJ, &_part, cvRect(iofs, 0, NINTRINSIC, 6) );
-                            cvGEMM( J_LR, Ji, 1, &_part, 1, &_part, CV_GEMM_A_T );
-                        }
+                            cvGEMM( J_LR, Ji, 1, &JtJ_LRi, 1, &JtJ_LRi, CV_GEMM_A_T );
                         cvGetRows( JtErr, &_part, iofs, iofs + NINTRINSIC );
                         cvGEMM( Ji, err, 1, &_part, 1, &_part, CV_GEMM_A_T );
                     }
@@ -3255,6 +3753,152 @@ void cv::composeRT( InputArray _rvec1, InputArray _tvec1,
 }
 
 
+namespace cv
+{
+
+/*
+ projectPoints() without the Jacobian, for the distortion models with up to 8 coefficients
+ (no thin prism and no tilt). The arithmetic is the same as in cvProjectPoints2(), so the
+ results are the same, but the points are projected in parallel, two at a time with SIMD.
+*/
+template<typename _Tp> class ProjectPointsInvoker : public ParallelLoopBody
+{
+public:
+    ProjectPointsInvoker( const Mat& _opoints, Mat& _ipoints, const Matx33d& _R, const Vec3d& _t,
+                          double _fx, double _fy, double _cx, double _cy, const double* _k )
+        : opoints(&_opoints), ipoints(&_ipoints), R(_R), t(_t), fx(_fx), fy(_fy), cx(_cx), cy(_cy)
+    {
+        for( int j = 0; j < 8; j++ )
+            k[j] = _k[j];
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const _Tp* M = opoints->ptr<_Tp>() + range.start*3;
+        _Tp* m = ipoints->ptr<_Tp>() + range.start*2;
+        int i = range.start;
+
+#if CV_SIMD128_64F
+        if( hasSIMD128() )
+        {
+            v_float64x2 vR[9], vt[3], vk[8];
+            for( int j = 0; j < 9; j++ )
+                vR[j] = v_setall_f64(R.val[j]);
+            for( int j = 0; j < 3; j++ )
+                vt[j] = v_setall_f64(t[j]);
+            for( int j = 0; j < 8; j++ )
+                vk[j] = v_setall_f64(k[j]);
+            v_float64x2 vfx = v_setall_f64(fx), vfy = v_setall_f64(fy);
+            v_float64x2 vcx = v_setall_f64(cx), vcy = v_setall_f64(cy);
+            v_float64x2 one = v_setall_f64(1.), two = v_setall_f64(2.), zero = v_setzero_f64();
+            double buf[4];
+
+            for( ; i <= range.end - 2; i += 2, M += 6, m += 4 )
+            {
+                v_float64x2 X((double)M[0], (double)M[3]), Y((double)M[1], (double)M[4]), Z((double)M[2], (double)M[5]);
+                v_float64x2 x = vR[0]*X + vR[1]*Y + vR[2]*Z + vt[0];
+                v_float64x2 y = vR[3]*X + vR[4]*Y + vR[5]*Z + vt[1];
+                v_float64x2 z = vR[6]*X + vR[7]*Y + vR[8]*Z + vt[2];
+
+                z = v_select(z != zero, one/z, one);
+                x = x*z; y = y*z;
+
+                v_float64x2 r2 = x*x + y*y, r4 = r2*r2, r6 = r4*r2;
+                v_float64x2 a1 = two*x*y, a2 = r2 + two*x*x, a3 = r2 + two*y*y;
+                v_float64x2 cdist = one + vk[0]*r2 + vk[1]*r4 + vk[4]*r6;
+                v_float64x2 icdist2 = one/(one + vk[5]*r2 + vk[6]*r4 + vk[7]*r6);
+                v_float64x2 xd = x*cdist*icdist2 + vk[2]*a1 + vk[3]*a2;
+                v_float64x2 yd = y*cdist*icdist2 + vk[2]*a3 + vk[3]*a1;
+
+                v_store(buf, xd*vfx + vcx);
+                v_store(buf + 2, yd*vfy + vcy);
+                m[0] = saturate_cast<_Tp>(buf[0]); m[1] = saturate_cast<_Tp>(buf[2]);
+                m[2] = saturate_cast<_Tp>(buf[1]); m[3] = saturate_cast<_Tp>(buf[3]);
+            }
+        }
+#endif
+
+        for( ; i < range.end; i++, M += 3, m += 2 )
+        {
+            double X = M[0], Y = M[1], Z = M[2];
+            double x = R.val[0]*X + R.val[1]*Y + R.val[2]*Z + t[0];
+            double y = R.val[3]*X + R.val[4]*Y + R.val[5]*Z + t[1];
+            double z = R.val[6]*X + R.val[7]*Y + R.val[8]*Z + t[2];
+
+            z = z ? 1./z : 1;
+            x *= z; y *= z;
+
+            double r2 = x*x + y*y, r4 = r2*r2, r6 = r4*r2;
+            double a1 = 2*x*y, a2 = r2 + 2*x*x, a3 = r2 + 2*y*y;
+            double cdist = 1 + k[0]*r2 + k[1]*r4 + k[4]*r6;
+            double icdist2 = 1./(1 + k[5]*r2 + k[6]*r4 + k[7]*r6);
+            double xd = x*cdist*icdist2 + k[2]*a1 + k[3]*a2;
+            double yd = y*cdist*icdist2 + k[2]*a3 + k[3]*a1;
+
+            m[0] = saturate_cast<_Tp>(xd*fx + cx);
+            m[1] = saturate_cast<_Tp>(yd*fy + cy);
+        }
+    }
+
+    const Mat* opoints;
+    Mat* ipoints;
+    Matx33d R;
+    Vec3d t;
+    double fx, fy, cx, cy, k[8];
+};
+
+static bool projectPointsNoJacobian( const Mat& opoints, const Mat& rvec, const Mat& tvec,
+                                     const Mat& cameraMatrix, const Mat& distCoeffs,
+                                     Mat& imagePoints, double aspectRatio )
+{
+    int npoints = (int)imagePoints.total(), ndist = (int)(distCoeffs.total()*distCoeffs.channels());
+    if( !opoints.isContinuous() || !imagePoints.isContinuous() ||
+        (ndist != 0 && ndist != 4 && ndist != 5 && ndist != 8) ||
+        (ndist != 0 && distCoeffs.depth() != CV_32F && distCoeffs.depth() != CV_64F) ||
+        cameraMatrix.size() != Size(3, 3) || cameraMatrix.channels() != 1 ||
+        (cameraMatrix.depth() != CV_32F && cameraMatrix.depth() != CV_64F) ||
+        (rvec.depth() != CV_32F && rvec.depth() != CV_64F) ||
+        (tvec.depth() != CV_32F && tvec.depth() != CV_64F) ||
+        tvec.total()*tvec.channels() != 3 )
+        return false;
+
+    Matx33d R;
+    if( rvec.total()*rvec.channels() == 3 )
+    {
+        Vec3d r;
+        rvec.reshape(1, 3).convertTo(r, CV_64F);
+        Rodrigues(r, R);
+    }
+    else if( rvec.size() == Size(3, 3) && rvec.channels() == 1 )
+        rvec.convertTo(R, CV_64F);
+    else
+        return false;
+
+    Vec3d t;
+    tvec.reshape(1, 3).convertTo(t, CV_64F);
+    Matx33d A;
+    cameraMatrix.convertTo(A, CV_64F);
+    double k[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    if( ndist > 0 )
+    {
+        Mat _k(distCoeffs.rows, distCoeffs.cols, CV_MAKETYPE(CV_64F, distCoeffs.channels()), k);
+        distCoeffs.convertTo(_k, CV_64F);
+    }
+
+    double fx = A(0, 0), fy = A(1, 1), cx = A(0, 2), cy = A(1, 2);
+    if( aspectRatio > FLT_EPSILON )
+        fx = fy*aspectRatio;
+
+    double nstripes = npoints/4096. + 1;
+    if( opoints.depth() == CV_32F )
+        parallel_for_(Range(0, npoints), ProjectPointsInvoker<float>(opoints, imagePoints, R, t, fx, fy, cx, cy, k), nstripes);
+    else
+        parallel_for_(Range(0, npoints), ProjectPointsInvoker<double>(opoints, imagePoints, R, t, fx, fy, cx, cy, k), nstripes);
+    return true;
+}
+
+}
+
 void cv::projectPoints( InputArray _opoints,
                         InputArray _rvec,
                         InputArray _tvec,
@@ -3278,6 +3922,10 @@ void cv::projectPoints( InputArray _opoints,
     Mat cameraMatrix = _cameraMatrix.getMat();
 
     Mat rvec = _rvec.getMat(), tvec = _tvec.getMat();
+    if( !_jacobian.needed() && npoints > 0 &&
+        projectPointsNoJacobian(opoints, rvec, tvec, cameraMatrix, _distCoeffs.getMat(), imagePoints, aspectRatio) )
+        return;
+
     CvMat c_cameraMatrix = cameraMatrix;
     CvMat c_rvec = rvec, c_tvec = tvec;
 
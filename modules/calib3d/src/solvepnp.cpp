@@ -168,6 +168,429 @@ bool solvePnP( InputArray _opoints, InputArray _ipoints,
     return result;
 }
 
+/* solvePnPBatch: many small PnP problems sharing one camera matrix.
+
+ For SOLVEPNP_ITERATIVE every problem is solved with fixed-size (Matx/Vec) arithmetic: the same
+ initialization as cvFindExtrinsicCameraParams2() (homography decomposition for planar object
+ points, DLT otherwise) followed by a 6-DoF Levenberg-Marquardt on the undistorted points, where
+ the rotation is updated multiplicatively, R <- exp([w]x)*R, so that no Rodrigues derivatives are
+ needed. The point buffers are allocated once per parallel chunk and reused by all its problems.
+*/
+static Matx33d expRotation( const Vec3d& w )
+{
+    double theta = norm(w);
+    Matx33d K(0, -w[2], w[1], w[2], 0, -w[0], -w[1], w[0], 0);
+    if( theta < DBL_EPSILON )
+        return Matx33d::eye() + K;
+    double a = std::sin(theta)/theta, b = (1 - std::cos(theta))/(theta*theta);
+    return Matx33d::eye() + K*a + K*K*b;
+}
+
+static Matx33d nearestRotation( const Matx33d& M )
+{
+    Matx33d U, Vt;
+    Vec3d W;
+    SVD::compute(M, W, U, Vt);
+    return U*Vt;
+}
+
+// normalized DLT; H is scaled so that H(2,2) == 1
+static bool findHomographyDLT( const Point2d* src, const Point2d* dst, int count, Matx33d& H )
+{
+    Point2d cs(0, 0), cd(0, 0);
+    int i, j, k;
+    for( i = 0; i < count; i++ )
+    {
+        cs += src[i];
+        cd += dst[i];
+    }
+    cs *= 1./count;
+    cd *= 1./count;
+
+    double ss = 0, sd = 0;
+    for( i = 0; i < count; i++ )
+    {
+        ss += norm(src[i] - cs);
+        sd += norm(dst[i] - cd);
+    }
+    if( ss < DBL_EPSILON || sd < DBL_EPSILON )
+        return false;
+    ss = count*std::sqrt(2.)/ss;
+    sd = count*std::sqrt(2.)/sd;
+
+    Matx<double, 9, 9> AtA;
+    for( i = 0; i < count; i++ )
+    {
+        double X = (src[i].x - cs.x)*ss, Y = (src[i].y - cs.y)*ss;
+        double u = (dst[i].x - cd.x)*sd, v = (dst[i].y - cd.y)*sd;
+        double r0[] = { X, Y, 1, 0, 0, 0, -u*X, -u*Y, -u };
+        double r1[] = { 0, 0, 0, X, Y, 1, -v*X, -v*Y, -v };
+        for( j = 0; j < 9; j++ )
+            for( k = j; k < 9; k++ )
+                AtA(j, k) += r0[j]*r0[k] + r1[j]*r1[k];
+    }
+    for( j = 0; j < 9; j++ )
+        for( k = 0; k < j; k++ )
+            AtA(j, k) = AtA(k, j);
+
+    Matx<double, 9, 1> W;
+    Matx<double, 9, 9> U, Vt;
+    SVD::compute(AtA, W, U, Vt);
+
+    Matx33d Hn(Vt.val + 8*9);
+    Matx33d Ts(ss, 0, -ss*cs.x, 0, ss, -ss*cs.y, 0, 0, 1);
+    Matx33d Tdinv(1./sd, 0, cd.x, 0, 1./sd, cd.y, 0, 0, 1);
+    H = Tdinv*Hn*Ts;
+    if( std::abs(H(2, 2)) < DBL_EPSILON )
+        return false;
+    H *= 1./H(2, 2);
+    return true;
+}
+
+static void initExtrinsicParams( const Point3d* M, const Point2d* mn, Point2d* Mxy, int count,
+                                 Matx33d& R, Vec3d& t )
+{
+    int i;
+    Vec3d Mc;
+    for( i = 0; i < count; i++ )
+        Mc += Vec3d(M[i]);
+    Mc *= 1./count;
+
+    Matx33d MM, U, Vt;
+    Vec3d W;
+    for( i = 0; i < count; i++ )
+    {
+        Vec3d d = Vec3d(M[i]) - Mc;
+        MM += d*d.t();
+    }
+    SVD::compute(MM, W, U, Vt);
+
+    if( W[2]/W[1] < 1e-3 )
+    {
+        // a planar structure case (all M's lie in the same plane)
+        Matx33d Rt = Vt, H;
+        if( Rt(0, 2)*Rt(0, 2) + Rt(1, 2)*Rt(1, 2) < 1e-10 )
+            Rt = Matx33d::eye();
+        if( determinant(Rt) < 0 )
+            Rt *= -1;
+        Vec3d T = -(Rt*Mc);
+
+        for( i = 0; i < count; i++ )
+        {
+            Vec3d p = Rt*Vec3d(M[i]) + T;
+            Mxy[i] = Point2d(p[0], p[1]);
+        }
+
+        if( findHomographyDLT(Mxy, mn, count, H) )
+        {
+            Vec3d h1(H(0, 0), H(1, 0), H(2, 0)), h2(H(0, 1), H(1, 1), H(2, 1));
+            double h1_norm = norm(h1), h2_norm = norm(h2);
+            t = Vec3d(H(0, 2), H(1, 2), H(2, 2))*(2./std::max(h1_norm + h2_norm, DBL_EPSILON));
+            h1 *= 1./std::max(h1_norm, DBL_EPSILON);
+            h2 *= 1./std::max(h2_norm, DBL_EPSILON);
+            Vec3d h3 = h1.cross(h2);
+            Matx33d Rh = nearestRotation(Matx33d(h1[0], h2[0], h3[0],
+                                                 h1[1], h2[1], h3[1],
+                                                 h1[2], h2[2], h3[2]));
+            t += Rh*T;
+            R = Rh*Rt;
+        }
+        else
+        {
+            R = Matx33d::eye();
+            t = Vec3d();
+        }
+    }
+    else
+    {
+        // non-planar structure. Use DLT method
+        Matx<double, 12, 12> LL;
+        int j, k;
+        for( i = 0; i < count; i++ )
+        {
+            double x = -mn[i].x, y = -mn[i].y;
+            double l0[] = { M[i].x, M[i].y, M[i].z, 1, 0, 0, 0, 0, x*M[i].x, x*M[i].y, x*M[i].z, x };
+            double l1[] = { 0, 0, 0, 0, M[i].x, M[i].y, M[i].z, 1, y*M[i].x, y*M[i].y, y*M[i].z, y };
+            for( j = 0; j < 12; j++ )
+                for( k = j; k < 12; k++ )
+                    LL(j, k) += l0[j]*l0[k] + l1[j]*l1[k];
+        }
+        for( j = 0; j < 12; j++ )
+            for( k = 0; k < j; k++ )
+                LL(j, k) = LL(k, j);
+
+        Matx<double, 12, 1> LW;
+        Matx<double, 12, 12> LU, LVt;
+        SVD::compute(LL, LW, LU, LVt);
+
+        const double* RRt = LVt.val + 11*12;
+        Matx33d RR(RRt[0], RRt[1], RRt[2], RRt[4], RRt[5], RRt[6], RRt[8], RRt[9], RRt[10]);
+        Vec3d tt(RRt[3], RRt[7], RRt[11]);
+        if( determinant(RR) < 0 )
+        {
+            RR *= -1;
+            tt *= -1;
+        }
+        double sc = norm(RR);
+        R = nearestRotation(RR);
+        t = tt*(norm(R)/sc);
+    }
+}
+
+// sum of squared reprojection errors of the undistorted points, in pixels;
+// optionally the normal equations w.r.t. (w, t), where R <- exp([w]x)*R
+static double calcPoseErrors( const Point3d* M, const Point2d* mn, int count, double fx, double fy,
+                              const Matx33d& R, const Vec3d& t, Matx66d* JtJ, Vec6d* JtErr )
+{
+    double errNorm = 0;
+    if( JtJ )
+    {
+        *JtJ = Matx66d();
+        *JtErr = Vec6d();
+    }
+
+    for( int i = 0; i < count; i++ )
+    {
+        Vec3d P = R*Vec3d(M[i]);
+        double X = P[0] + t[0], Y = P[1] + t[1], Z = P[2] + t[2];
+        double iz = Z ? 1./Z : 1.;
+        double x = X*iz, y = Y*iz;
+        double ex = fx*(x - mn[i].x), ey = fy*(y - mn[i].y);
+        errNorm += ex*ex + ey*ey;
+
+        if( JtJ )
+        {
+            // d(x,y)/d(X,Y,Z) times d(X,Y,Z)/d(w,t) = [-[P]x | I]
+            double ax = fx*iz, az = -fx*x*iz, by = fy*iz, bz = -fy*y*iz;
+            double jx[] = { az*P[1], ax*P[2] - az*P[0], -ax*P[1], ax, 0, az };
+            double jy[] = { bz*P[1] - by*P[2], -bz*P[0], by*P[0], 0, by, bz };
+            for( int j = 0; j < 6; j++ )
+            {
+                for( int k = j; k < 6; k++ )
+                    (*JtJ)(j, k) += jx[j]*jx[k] + jy[j]*jy[k];
+                (*JtErr)[j] += jx[j]*ex + jy[j]*ey;
+            }
+        }
+    }
+
+    if( JtJ )
+        for( int j = 0; j < 6; j++ )
+            for( int k = 0; k < j; k++ )
+                (*JtJ)(j, k) = (*JtJ)(k, j);
+    return errNorm;
+}
+
+static void refinePoseLM( const Point3d* M, const Point2d* mn, int count, double fx, double fy,
+                          Matx33d& R, Vec3d& t )
+{
+    const int max_iter = 20;
+    Matx66d JtJ;
+    Vec6d JtErr;
+    double lambda = 1e-3;
+    double errNorm = calcPoseErrors(M, mn, count, fx, fy, R, t, &JtJ, &JtErr);
+
+    for( int iter = 0; iter < max_iter; )
+    {
+        Matx66d A = JtJ;
+        for( int k = 0; k < 6; k++ )
+            A(k, k) *= 1 + lambda;
+        Vec6d dx = A.solve(-JtErr, DECOMP_CHOLESKY);
+
+        Matx33d R1 = expRotation(Vec3d(dx[0], dx[1], dx[2]))*R;
+        Vec3d t1 = t + Vec3d(dx[3], dx[4], dx[5]);
+        double errNorm1 = calcPoseErrors(M, mn, count, fx, fy, R1, t1, 0, 0);
+
+        if( errNorm1 <= errNorm )
+        {
+            R = R1;
+            t = t1;
+            iter++;
+            lambda = std::max(lambda*0.1, DBL_EPSILON);
+            if( norm(dx) <= FLT_EPSILON*norm(t) )
+                break;
+            errNorm = calcPoseErrors(M, mn, count, fx, fy, R, t, &JtJ, &JtErr);
+        }
+        else
+        {
+            lambda *= 10;
+            if( lambda > 1e16 )
+                break;
+        }
+    }
+}
+
+class SolvePnPBatchInvoker : public ParallelLoopBody
+{
+public:
+    SolvePnPBatchInvoker( const std::vector<Mat>& _opoints, const std::vector<Mat>& _ipoints,
+                          const Matx33d& _A, const Mat& _distCoeffs,
+                          std::vector<Mat>& _rvecs, std::vector<Mat>& _tvecs,
+                          uchar* _solved, bool _useExtrinsicGuess, int _flags )
+        : opoints(&_opoints), ipoints(&_ipoints), A(_A), distCoeffs(_distCoeffs),
+          rvecs(&_rvecs), tvecs(&_tvecs), solved(_solved),
+          useExtrinsicGuess(_useExtrinsicGuess), flags(_flags)
+    {
+        hasDistortion = !distCoeffs.empty() && countNonZero(distCoeffs) > 0;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        std::vector<Point3d> M;
+        std::vector<Point2d> m, mn, Mxy;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const Mat& op = (*opoints)[opoints->size() == 1 ? 0 : i];
+            const Mat& ip = (*ipoints)[i];
+            Mat& rvec = (*rvecs)[i];
+            Mat& tvec = (*tvecs)[i];
+            int count = std::max(op.checkVector(3, CV_32F), op.checkVector(3, CV_64F));
+
+            if( flags != SOLVEPNP_ITERATIVE )
+            {
+                Mat cameraMatrix(A), r, t;
+                solved[i] = solvePnP(op, ip, cameraMatrix, distCoeffs, r, t, false, flags);
+                if( solved[i] )
+                {
+                    r.reshape(1, rvec.rows).convertTo(rvec, CV_64F);
+                    t.reshape(1, tvec.rows).convertTo(tvec, CV_64F);
+                }
+                else
+                {
+                    rvec = Scalar::all(0);
+                    tvec = Scalar::all(0);
+                }
+                continue;
+            }
+
+            if( (int)M.size() < count )
+            {
+                M.resize(count);
+                m.resize(count);
+                mn.resize(count);
+                Mxy.resize(count);
+            }
+
+            Mat _M(count, 1, CV_64FC3, &M[0]), _m(count, 1, CV_64FC2, &m[0]), _mn(count, 1, CV_64FC2, &mn[0]);
+            op.reshape(3, count).convertTo(_M, CV_64F);
+            ip.reshape(2, count).convertTo(_m, CV_64F);
+
+            // normalize image points
+            // (unapply the intrinsic matrix transformation and distortion)
+            if( hasDistortion )
+                undistortPoints(_m, _mn, A, distCoeffs);
+            else
+            {
+                double ifx = 1./A(0, 0), ify = 1./A(1, 1);
+                for( int j = 0; j < count; j++ )
+                {
+                    double y = (m[j].y - A(1, 2))*ify;
+                    mn[j] = Point2d((m[j].x - A(0, 2) - A(0, 1)*y)*ifx, y);
+                }
+            }
+
+            Matx33d R;
+            Vec3d r, t;
+            if( useExtrinsicGuess )
+            {
+                rvec.reshape(1, 3).copyTo(r);
+                tvec.reshape(1, 3).copyTo(t);
+                Rodrigues(r, R);
+            }
+            else
+                initExtrinsicParams(&M[0], &mn[0], &Mxy[0], count, R, t);
+
+            refinePoseLM(&M[0], &mn[0], count, A(0, 0), A(1, 1), R, t);
+
+            Rodrigues(R, r);
+            Mat(r).reshape(1, rvec.rows).copyTo(rvec);
+            Mat(t).reshape(1, tvec.rows).copyTo(tvec);
+            solved[i] = 1;
+        }
+    }
+
+    const std::vector<Mat>* opoints;
+    const std::vector<Mat>* ipoints;
+    Matx33d A;
+    Mat distCoeffs;
+    std::vector<Mat>* rvecs;
+    std::vector<Mat>* tvecs;
+    uchar* solved;
+    bool useExtrinsicGuess, hasDistortion;
+    int flags;
+};
+
+int solvePnPBatch( InputArrayOfArrays _objectPoints, InputArrayOfArrays _imagePoints,
+                   InputArray _cameraMatrix, InputArray _distCoeffs,
+                   OutputArrayOfArrays _rvecs, OutputArrayOfArrays _tvecs,
+                   bool useExtrinsicGuess, int flags )
+{
+    CV_INSTRUMENT_REGION()
+
+    int i, nproblems = (int)_imagePoints.total(), nobjects = (int)_objectPoints.total();
+    CV_Assert( nproblems == 0 || nobjects == 1 || nobjects == nproblems );
+    if( flags != SOLVEPNP_ITERATIVE )
+        useExtrinsicGuess = false;
+
+    std::vector<Mat> opoints(nobjects), ipoints(nproblems);
+    for( i = 0; i < nobjects; i++ )
+        opoints[i] = _objectPoints.getMat(i);
+    for( i = 0; i < nproblems; i++ )
+    {
+        ipoints[i] = _imagePoints.getMat(i);
+        const Mat& op = opoints[nobjects == 1 ? 0 : i];
+        int npoints = std::max(op.checkVector(3, CV_32F), op.checkVector(3, CV_64F));
+        CV_Assert( npoints >= 4 && npoints == std::max(ipoints[i].checkVector(2, CV_32F),
+                                                       ipoints[i].checkVector(2, CV_64F)) );
+    }
+
+    std::vector<Vec3d> rguess, tguess;
+    if( useExtrinsicGuess )
+    {
+        CV_Assert( (int)_rvecs.total() == nproblems && (int)_tvecs.total() == nproblems );
+        rguess.resize(nproblems);
+        tguess.resize(nproblems);
+        for( i = 0; i < nproblems; i++ )
+        {
+            Mat r = _rvecs.getMat(i), t = _tvecs.getMat(i);
+            CV_Assert( r.total()*r.channels() == 3 && t.total()*t.channels() == 3 );
+            r.reshape(1, 3).convertTo(rguess[i], CV_64F);
+            t.reshape(1, 3).convertTo(tguess[i], CV_64F);
+        }
+    }
+
+    Matx33d A;
+    _cameraMatrix.getMat().convertTo(A, CV_64F);
+    Mat distCoeffs = Mat_<double>(_distCoeffs.getMat());
+
+    std::vector<Mat> rvecs(nproblems), tvecs(nproblems);
+    _rvecs.create(nproblems, 1, CV_64FC3);
+    _tvecs.create(nproblems, 1, CV_64FC3);
+    for( i = 0; i < nproblems; i++ )
+    {
+        _rvecs.create(3, 1, CV_64F, i, true);
+        _tvecs.create(3, 1, CV_64F, i, true);
+        rvecs[i] = _rvecs.getMat(i);
+        tvecs[i] = _tvecs.getMat(i);
+        if( useExtrinsicGuess )
+        {
+            Mat(rguess[i]).reshape(1, rvecs[i].rows).copyTo(rvecs[i]);
+            Mat(tguess[i]).reshape(1, tvecs[i].rows).copyTo(tvecs[i]);
+        }
+    }
+
+    std::vector<uchar> solved(nproblems, (uchar)0);
+    if( nproblems > 0 )
+        parallel_for_(Range(0, nproblems),
+                      SolvePnPBatchInvoker(opoints, ipoints, A, distCoeffs, rvecs, tvecs,
+                                           &solved[0], useExtrinsicGuess, flags));
+
+    int nsolved = 0;
+    for( i = 0; i < nproblems; i++ )
+        nsolved += solved[i];
+    return nsolved;
+}
+
 class PnPRansacCallback : public PointSetRegistrator::Callback
 {
 
@@ -842,6 +842,88 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
     }
 }
 
+/*
+ MODE_HH_STRIPED: the full two-pass dynamic programming of MODE_HH computed in horizontal stripes.
+ Every stripe is extended by HH_STRIPE_OVERLAP rows (plus the half of the block) on both sides,
+ processed by computeDisparitySGBM() in MODE_HH as if it was a separate image, and only its
+ central rows are copied to the output. So the C and S cost volumes are bounded by the height
+ of the extended stripe instead of the image height, and the stripes are computed in parallel.
+
+ The vertical and the diagonal paths start at the borders of the extended stripes rather than
+ at the image borders, so the result is not bit-exact to MODE_HH; the path costs coming from
+ the overlap area are, however, dominated by the P2-bounded smoothness term after a few rows.
+ The stripe height depends only on the image size and the parameters, not on the number of
+ threads, so the result is reproducible.
+*/
+static const int HH_STRIPE_OVERLAP = 32;
+// the memory budget for C and S of a single stripe; the number of stripes is at least HH_MIN_STRIPES
+static const size_t HH_STRIPE_BUF_SIZE = (size_t)128 << 20;
+static const int HH_MIN_STRIPES = 4;
+
+struct SGBMStripedHHInvoker : public ParallelLoopBody
+{
+    SGBMStripedHHInvoker( const Mat& _img1, const Mat& _img2, Mat& _disp1,
+                          const StereoSGBMParams& _params, std::vector<Mat>& _buffers,
+                          int _stripeRows, int _overlap, int _nstripes )
+        : img1(&_img1), img2(&_img2), disp1(&_disp1), params(_params), buffers(&_buffers),
+          stripeRows(_stripeRows), overlap(_overlap), nstripes(_nstripes)
+    {
+        params.mode = StereoSGBM::MODE_HH;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        // every worker owns a buffer and processes the stripes w, w + nworkers, w + 2*nworkers ...
+        int nworkers = (int)buffers->size(), height = img1->rows;
+
+        for( int w = range.start; w < range.end; w++ )
+        {
+            Mat& buffer = (*buffers)[w];
+            for( int i = w; i < nstripes; i += nworkers )
+            {
+                int y0 = i*stripeRows, y1 = std::min(y0 + stripeRows, height);
+                int ya = std::max(y0 - overlap, 0), yb = std::min(y1 + overlap, height);
+                Mat disp(yb - ya, img1->cols, CV_16S);
+
+                computeDisparitySGBM( img1->rowRange(ya, yb), img2->rowRange(ya, yb), disp, params, buffer );
+                disp.rowRange(y0 - ya, y1 - ya).copyTo(disp1->rowRange(y0, y1));
+            }
+        }
+    }
+
+    const Mat* img1;
+    const Mat* img2;
+    Mat* disp1;
+    StereoSGBMParams params;
+    std::vector<Mat>* buffers;
+    int stripeRows, overlap, nstripes;
+};
+
+static void computeDisparitySGBM_StripedHH( const Mat& img1, const Mat& img2,
+                                            Mat& disp1, const StereoSGBMParams& params,
+                                            std::vector<Mat>& buffers )
+{
+    int height = img1.rows;
+    int minD = params.minDisparity, maxD = minD + params.numDisparities;
+    int width1 = std::max(img1.cols + std::min(minD, 0) - std::max(maxD, 0), 1);
+    int SH2 = (params.SADWindowSize > 0 ? params.SADWindowSize : 5)/2;
+    int overlap = HH_STRIPE_OVERLAP + SH2;
+
+    // C and S take 2*width1*D cost values per row
+    double rowBufSize = (double)width1*params.numDisparities*2*sizeof(CostType);
+    int stripeRows = cvFloor(HH_STRIPE_BUF_SIZE/rowBufSize) - overlap*2;
+    stripeRows = std::min(std::max(stripeRows, overlap), (height + HH_MIN_STRIPES - 1)/HH_MIN_STRIPES);
+    stripeRows = std::max(stripeRows, 1);
+
+    int nstripes = (height + stripeRows - 1)/stripeRows;
+    int nworkers = std::max(std::min(getNumThreads(), nstripes), 1);
+    buffers.resize(nworkers);
+
+    parallel_for_(Range(0, nworkers),
+                  SGBMStripedHHInvoker(img1, img2, disp1, params, buffers, stripeRows, overlap, nstripes),
+                  nworkers);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 struct CalcVerticalSums: public ParallelLoopBody
 {
@@ -2162,6 +2244,8 @@ public:
             computeDisparity3WaySGBM( left, right, disp, params, buffers, num_stripes );
         else if(params.mode==MODE_HH4)
             computeDisparitySGBM_HH4( left, right, disp, params, buffer );
+        else if(params.mode==MODE_HH_STRIPED)
+            computeDisparitySGBM_StripedHH( left, right, disp, params, stripeBuffers );
         else
             computeDisparitySGBM( left, right, disp, params, buffer );
 
@@ -2247,6 +2331,9 @@ public:
     static const int num_stripes = 4;
     Mat buffers[num_stripes];
 
+    // per-worker buffers of MODE_HH_STRIPED
+    std::vector<Mat> stripeBuffers;
+
     static const char* name_;
 };
 
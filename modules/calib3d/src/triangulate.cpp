@@ -41,6 +41,7 @@
 
 #include "precomp.hpp"
 #include "opencv2/calib3d/calib3d_c.h"
+#include "opencv2/core/hal/intrin.hpp"
 
 // cvCorrectMatches function is Copyright (C) 2009, Jostein Austvik Jacobsen.
 // cvTriangulatePoints function is derived from icvReconstructPointsFor3View, originally by Valery Mosyagin.
@@ -343,6 +344,244 @@ cvCorrectMatches(CvMat *F_, CvMat *points1_, CvMat *points2_, CvMat *new_points1
         cvConvert( points2, new_points2 );
 }
 
+namespace cv
+{
+
+// 2xN single-channel or 1xN/Nx1 2-channel point array of float or double
+struct TriangulationPoints
+{
+    bool init( const Mat& m )
+    {
+        if( m.depth() != CV_32F && m.depth() != CV_64F )
+            return false;
+        depth = m.depth();
+        if( m.channels() == 2 && (m.rows == 1 || m.cols == 1) && m.isContinuous() )
+        {
+            x = m.ptr(); y = x + m.elemSize1();
+            stride = 2;
+            count = (int)m.total();
+            return true;
+        }
+        if( m.channels() == 1 && m.rows == 2 )
+        {
+            x = m.ptr(0); y = m.ptr(1);
+            stride = 1;
+            count = m.cols;
+            return true;
+        }
+        return false;
+    }
+
+    template<typename _Tp> Point2d get( int i ) const
+    {
+        return Point2d(((const _Tp*)x)[i*stride], ((const _Tp*)y)[i*stride]);
+    }
+
+    const uchar* x;
+    const uchar* y;
+    int stride, count, depth;
+};
+
+static inline void triBroadcast( double& v, double x ) { v = x; }
+static inline double triSqrt( double x ) { return std::sqrt(x); }
+#if CV_SIMD128_64F
+static inline void triBroadcast( v_float64x2& v, double x ) { v = v_setall_f64(x); }
+static inline v_float64x2 triSqrt( const v_float64x2& x ) { return v_sqrt(x); }
+#endif
+
+/*
+ The arithmetic of the fast path, for one point (V = double) or for two points at once
+ (V = v_float64x2). The solution X is normalized, the checks are left to the caller:
+ det and tr tell whether the normal matrix is invertible, pivots whether A^T*A is positive
+ definite (as in cv::Cholesky), and n is the norm before the last normalization.
+*/
+template<typename V> static void
+triangulateLinear( const Matx34d& P1, const Matx34d& P2, const V& x1, const V& y1,
+                   const V& x2, const V& y2, V* X, V& det, V& tr, V* pivots, V& n )
+{
+    V A[4][4], N[4][4], L[4][4], idiag[4], one;
+    int i, j, k, iter;
+    triBroadcast(one, 1.);
+
+    for( k = 0; k < 4; k++ )
+    {
+        V p0, p1, p2;
+        triBroadcast(p0, P1(0, k)); triBroadcast(p1, P1(1, k)); triBroadcast(p2, P1(2, k));
+        A[0][k] = x1*p2 - p0;
+        A[1][k] = y1*p2 - p1;
+        triBroadcast(p0, P2(0, k)); triBroadcast(p1, P2(1, k)); triBroadcast(p2, P2(2, k));
+        A[2][k] = x2*p2 - p0;
+        A[3][k] = y2*p2 - p1;
+    }
+
+    // the upper triangle of A^T*A; the 3x3 block is the normal matrix of the inhomogeneous
+    // system, and -N(0:2, 3) its right-hand side
+    for( i = 0; i < 4; i++ )
+        for( j = i; j < 4; j++ )
+            N[i][j] = A[0][i]*A[0][j] + A[1][i]*A[1][j] + A[2][i]*A[2][j] + A[3][i]*A[3][j];
+
+    V c00 = N[1][1]*N[2][2] - N[1][2]*N[1][2];
+    V c01 = N[0][2]*N[1][2] - N[0][1]*N[2][2];
+    V c02 = N[0][1]*N[1][2] - N[0][2]*N[1][1];
+    V c11 = N[0][0]*N[2][2] - N[0][2]*N[0][2];
+    V c12 = N[0][1]*N[0][2] - N[0][0]*N[1][2];
+    V c22 = N[0][0]*N[1][1] - N[0][1]*N[0][1];
+    det = N[0][0]*c00 + N[0][1]*c01 + N[0][2]*c02;
+    tr = N[0][0] + N[1][1] + N[2][2];
+
+    // the right-hand side is negated through the inverted determinant
+    V idet;
+    triBroadcast(idet, -1.);
+    idet = idet/det;
+    X[0] = (c00*N[0][3] + c01*N[1][3] + c02*N[2][3])*idet;
+    X[1] = (c01*N[0][3] + c11*N[1][3] + c12*N[2][3])*idet;
+    X[2] = (c02*N[0][3] + c12*N[1][3] + c22*N[2][3])*idet;
+    X[3] = one;
+
+    V eps;
+    triBroadcast(eps, DBL_EPSILON);
+    eps = (tr + N[3][3])*eps;
+    for( k = 0; k < 4; k++ )
+        N[k][k] = N[k][k] + eps;
+
+    // L*L^T = A^T*A, with the inverted diagonal
+    for( i = 0; i < 4; i++ )
+    {
+        for( j = 0; j < i; j++ )
+        {
+            V t = N[j][i];
+            for( k = 0; k < j; k++ )
+                t = t - L[i][k]*L[j][k];
+            L[i][j] = t*idiag[j];
+        }
+        V t = N[i][i];
+        for( k = 0; k < i; k++ )
+            t = t - L[i][k]*L[i][k];
+        pivots[i] = t;
+        idiag[i] = one/triSqrt(t);
+    }
+
+    // inverse iteration
+    for( iter = 0; iter < 2; iter++ )
+    {
+        for( i = 0; i < 4; i++ )
+        {
+            V t = X[i];
+            for( k = 0; k < i; k++ )
+                t = t - L[i][k]*X[k];
+            X[i] = t*idiag[i];
+        }
+        for( i = 3; i >= 0; i-- )
+        {
+            V t = X[i];
+            for( k = i + 1; k < 4; k++ )
+                t = t - L[k][i]*X[k];
+            X[i] = t*idiag[i];
+        }
+        n = triSqrt(X[0]*X[0] + X[1]*X[1] + X[2]*X[2] + X[3]*X[3]);
+        V in = one/n;
+        for( k = 0; k < 4; k++ )
+            X[k] = X[k]*in;
+    }
+}
+
+/*
+ Two-view linear triangulation. Instead of the SVD of the 4x4 system A*X = 0, the inhomogeneous
+ least-squares problem A*(X,Y,Z,1)^T = 0 is solved in closed form (HZ, 12.2) and then refined
+ by two steps of inverse iteration on A^T*A, which gives the same null vector as the SVD.
+ Two points are processed at once with the universal intrinsics. For the points that are (nearly)
+ at infinity the normal matrix is singular, and the SVD solution is used. The result is
+ normalized as the SVD solution is, with non-negative W.
+*/
+template<typename _Tp> class TriangulatePointsInvoker : public ParallelLoopBody
+{
+public:
+    TriangulatePointsInvoker( const Matx34d& _P1, const Matx34d& _P2, const TriangulationPoints& _points1,
+                              const TriangulationPoints& _points2, Mat& _points4D )
+        : P1(_P1), P2(_P2), points1(_points1), points2(_points2), points4D(&_points4D) {}
+
+    void operator()( const Range& range ) const
+    {
+        _Tp* dst[4];
+        for( int k = 0; k < 4; k++ )
+            dst[k] = points4D->ptr<_Tp>(k);
+
+        int i = range.start;
+#if CV_SIMD128_64F
+        if( hasSIMD128() )
+        {
+            for( ; i <= range.end - 2; i += 2 )
+            {
+                Point2d p1[] = { points1.get<_Tp>(i), points1.get<_Tp>(i+1) };
+                Point2d p2[] = { points2.get<_Tp>(i), points2.get<_Tp>(i+1) };
+                v_float64x2 X[4], det, tr, pivots[4], n;
+                triangulateLinear(P1, P2, v_float64x2(p1[0].x, p1[1].x), v_float64x2(p1[0].y, p1[1].y),
+                                  v_float64x2(p2[0].x, p2[1].x), v_float64x2(p2[0].y, p2[1].y),
+                                  X, det, tr, pivots, n);
+
+                double buf[11][2];
+                for( int k = 0; k < 4; k++ )
+                {
+                    v_store(buf[k], X[k]);
+                    v_store(buf[k+4], pivots[k]);
+                }
+                v_store(buf[8], det);
+                v_store(buf[9], tr);
+                v_store(buf[10], n);
+
+                for( int j = 0; j < 2; j++ )
+                {
+                    double Xj[] = { buf[0][j], buf[1][j], buf[2][j], buf[3][j] };
+                    double pivotsj[] = { buf[4][j], buf[5][j], buf[6][j], buf[7][j] };
+                    store(i + j, p1[j], p2[j], Xj, buf[8][j], buf[9][j], pivotsj, buf[10][j], dst);
+                }
+            }
+        }
+#endif
+        for( ; i < range.end; i++ )
+        {
+            Point2d p1 = points1.get<_Tp>(i), p2 = points2.get<_Tp>(i);
+            double X[4], det, tr, pivots[4], n;
+            triangulateLinear(P1, P2, p1.x, p1.y, p2.x, p2.y, X, det, tr, pivots, n);
+            store(i, p1, p2, X, det, tr, pivots, n, dst);
+        }
+    }
+
+    // writes the solution of the point i, or the SVD solution when the fast path failed
+    void store( int i, const Point2d& p1, const Point2d& p2, const double* X, double det, double tr,
+                const double* pivots, double n, _Tp** dst ) const
+    {
+        bool ok = std::abs(det) > 1e-10*tr*tr*tr && n > 0 && n <= DBL_MAX;
+        for( int k = 0; k < 4; k++ )
+            ok = ok && pivots[k] >= DBL_EPSILON;
+
+        Matx44d A, U, Vt;
+        if( !ok )
+        {
+            for( int k = 0; k < 4; k++ )
+            {
+                A(0, k) = p1.x*P1(2, k) - P1(0, k);
+                A(1, k) = p1.y*P1(2, k) - P1(1, k);
+                A(2, k) = p2.x*P2(2, k) - P2(0, k);
+                A(3, k) = p2.y*P2(2, k) - P2(1, k);
+            }
+            Vec4d W;
+            SVD::compute(A, W, U, Vt);
+            X = &Vt(3, 0);
+        }
+
+        double scale = X[3] < 0 ? -1. : 1.;
+        for( int k = 0; k < 4; k++ )
+            dst[k][i] = saturate_cast<_Tp>(X[k]*scale);
+    }
+
+    Matx34d P1, P2;
+    TriangulationPoints points1, points2;
+    Mat* points4D;
+};
+
+}
+
 void cv::triangulatePoints( InputArray _projMatr1, InputArray _projMatr2,
                             InputArray _projPoints1, InputArray _projPoints2,
                             OutputArray _points4D )
@@ -352,6 +591,28 @@ void cv::triangulatePoints( InputArray _projMatr1, InputArray _projMatr2,
     Mat matr1 = _projMatr1.getMat(), matr2 = _projMatr2.getMat();
     Mat points1 = _projPoints1.getMat(), points2 = _projPoints2.getMat();
 
+    TriangulationPoints tpoints1, tpoints2;
+    if( matr1.size() == Size(4, 3) && matr2.size() == Size(4, 3) &&
+        matr1.channels() == 1 && matr2.channels() == 1 &&
+        tpoints1.init(points1) && tpoints2.init(points2) &&
+        tpoints1.depth == tpoints2.depth && tpoints1.count == tpoints2.count && tpoints1.count > 0 )
+    {
+        Matx34d P1, P2;
+        matr1.convertTo(P1, CV_64F);
+        matr2.convertTo(P2, CV_64F);
+
+        int npoints = tpoints1.count;
+        _points4D.create(4, npoints, tpoints1.depth);
+        Mat points4D = _points4D.getMat();
+        double nstripes = npoints/4096. + 1;
+
+        if( tpoints1.depth == CV_32F )
+            parallel_for_(Range(0, npoints), TriangulatePointsInvoker<float>(P1, P2, tpoints1, tpoints2, points4D), nstripes);
+        else
+            parallel_for_(Range(0, npoints), TriangulatePointsInvoker<double>(P1, P2, tpoints1, tpoints2, points4D), nstripes);
+        return;
+    }
+
     if((points1.rows == 1 || points1.cols == 1) && points1.channels() == 2)
         points1 = points1.reshape(1, static_cast<int>(points1.total())).t();
 
@@ -2144,3 +2144,218 @@ TEST(Calib3d_Triangulate, accuracy)
     ASSERT_LE(norm(res, res0, NORM_INF), 2);
     }
 }
+
+static void generateCalibrationViews( int nviews, RNG& rng, const Matx33d& K, const Mat& dist,
+                                      const Vec3d& baseRvec, const Vec3d& baseTvec,
+                                      vector<vector<Point3f> >& objectPoints,
+                                      vector<vector<Point2f> >& imagePoints1,
+                                      vector<vector<Point2f> >& imagePoints2 )
+{
+    const Size boardSize(9, 6);
+    const float squareSize = 0.03f;
+    vector<Point3f> board;
+    for( int y = 0; y < boardSize.height; y++ )
+        for( int x = 0; x < boardSize.width; x++ )
+            board.push_back(Point3f(x*squareSize, y*squareSize, 0));
+
+    Matx33d R_LR;
+    Rodrigues(baseRvec, R_LR);
+
+    for( int i = 0; i < nviews; i++ )
+    {
+        Vec3d rvec(rng.uniform(-0.4, 0.4), rng.uniform(-0.4, 0.4), rng.uniform(-0.2, 0.2));
+        Vec3d tvec(rng.uniform(-0.15, 0.0), rng.uniform(-0.1, 0.0), rng.uniform(0.4, 0.8));
+        vector<Point2f> pts1, pts2;
+        projectPoints(board, rvec, tvec, K, dist, pts1);
+
+        Matx33d R;
+        Rodrigues(rvec, R);
+        Vec3d rvec2, tvec2 = R_LR*tvec + baseTvec;
+        Rodrigues(R_LR*R, rvec2);
+        projectPoints(board, rvec2, tvec2, K, dist, pts2);
+
+        for( size_t j = 0; j < pts1.size(); j++ )
+        {
+            pts1[j] += Point2f((float)rng.gaussian(0.1), (float)rng.gaussian(0.1));
+            pts2[j] += Point2f((float)rng.gaussian(0.1), (float)rng.gaussian(0.1));
+        }
+        objectPoints.push_back(board);
+        imagePoints1.push_back(pts1);
+        imagePoints2.push_back(pts2);
+    }
+}
+
+TEST(Calib3d_CalibrateCamera_CPP, schur_complement)
+{
+    RNG rng(1234);
+    Matx33d K(800, 0, 320, 0, 810, 240, 0, 0, 1);
+    Mat dist = (Mat_<double>(1, 5) << 0.1, -0.2, 0.001, -0.002, 0.05);
+    vector<vector<Point3f> > objectPoints;
+    vector<vector<Point2f> > imagePoints, imagePoints2;
+    generateCalibrationViews(16, rng, K, dist, Vec3d(0, 0, 0), Vec3d(-0.1, 0, 0),
+                             objectPoints, imagePoints, imagePoints2);
+
+    const int flags[] = { 0, CALIB_FIX_ASPECT_RATIO | CALIB_ZERO_TANGENT_DIST, CALIB_FIX_PRINCIPAL_POINT | CALIB_FIX_K3 };
+    for( int f = 0; f < (int)(sizeof(flags)/sizeof(flags[0])); f++ )
+    {
+        Mat K0 = Mat(K).clone(), K1 = Mat(K).clone(), dist0, dist1;
+        vector<Mat> rvecs0, tvecs0, rvecs1, tvecs1;
+        Mat stdInt0, stdExt0, stdInt1, stdExt1, errs0, errs1;
+        TermCriteria criteria(TermCriteria::COUNT + TermCriteria::EPS, 100, DBL_EPSILON);
+
+        double rms0 = calibrateCamera(objectPoints, imagePoints, Size(640, 480), K0, dist0,
+                                      rvecs0, tvecs0, stdInt0, stdExt0, errs0, flags[f], criteria);
+        double rms1 = calibrateCamera(objectPoints, imagePoints, Size(640, 480), K1, dist1,
+                                      rvecs1, tvecs1, stdInt1, stdExt1, errs1,
+                                      flags[f] | CALIB_USE_SCHUR, criteria);
+
+        EXPECT_NEAR(rms0, rms1, 1e-8) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(K0, K1, NORM_INF), 1e-5) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(dist0, dist1, NORM_INF), 1e-6) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(stdInt0, stdInt1, NORM_RELATIVE + NORM_INF), 1e-5) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(stdExt0, stdExt1, NORM_RELATIVE + NORM_INF), 1e-5) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(errs0, errs1, NORM_INF), 1e-6) << "flags = " << flags[f];
+        for( size_t i = 0; i < rvecs0.size(); i++ )
+        {
+            EXPECT_LE(cvtest::norm(rvecs0[i], rvecs1[i], NORM_INF), 1e-6);
+            EXPECT_LE(cvtest::norm(tvecs0[i], tvecs1[i], NORM_INF), 1e-6);
+        }
+    }
+}
+
+TEST(Calib3d_StereoCalibrate_CPP, schur_complement)
+{
+    RNG rng(4321);
+    Matx33d K(800, 0, 320, 0, 810, 240, 0, 0, 1);
+    Mat dist = (Mat_<double>(1, 5) << 0.1, -0.2, 0.001, -0.002, 0.05);
+    vector<vector<Point3f> > objectPoints;
+    vector<vector<Point2f> > imagePoints1, imagePoints2;
+    generateCalibrationViews(12, rng, K, dist, Vec3d(0.01, -0.02, 0.005), Vec3d(-0.1, 0.002, 0.001),
+                             objectPoints, imagePoints1, imagePoints2);
+
+    const int flags[] = { CALIB_FIX_INTRINSIC, CALIB_USE_INTRINSIC_GUESS, CALIB_SAME_FOCAL_LENGTH | CALIB_ZERO_TANGENT_DIST };
+    for( int f = 0; f < (int)(sizeof(flags)/sizeof(flags[0])); f++ )
+    {
+        Mat K10 = Mat(K).clone(), K20 = Mat(K).clone(), d10 = dist.clone(), d20 = dist.clone();
+        Mat K11 = Mat(K).clone(), K21 = Mat(K).clone(), d11 = dist.clone(), d21 = dist.clone();
+        Mat R0, T0, R1, T1, E, F;
+        TermCriteria criteria(TermCriteria::COUNT + TermCriteria::EPS, 100, DBL_EPSILON);
+
+        double rms0 = stereoCalibrate(objectPoints, imagePoints1, imagePoints2, K10, d10, K20, d20,
+                                      Size(640, 480), R0, T0, E, F, flags[f], criteria);
+        double rms1 = stereoCalibrate(objectPoints, imagePoints1, imagePoints2, K11, d11, K21, d21,
+                                      Size(640, 480), R1, T1, E, F, flags[f] | CALIB_USE_SCHUR, criteria);
+
+        EXPECT_NEAR(rms0, rms1, 1e-8) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(R0, R1, NORM_INF), 1e-6) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(T0, T1, NORM_INF), 1e-6) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(K10, K11, NORM_INF), 1e-5) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(K20, K21, NORM_INF), 1e-5) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(d10, d11, NORM_INF), 1e-6) << "flags = " << flags[f];
+        EXPECT_LE(cvtest::norm(d20, d21, NORM_INF), 1e-6) << "flags = " << flags[f];
+    }
+}
+
+TEST(Calib3d_Triangulate, batch_vs_svd)
+{
+    RNG& rng = theRNG();
+    const int npoints = 1001;
+    Matx33d K(800, 0, 320, 0, 800, 240, 0, 0, 1);
+    Matx33d R2;
+    Rodrigues(Vec3d(0.05, -0.2, 0.02), R2);
+    Vec3d t2(-1, 0.1, 0.05);
+    Matx34d P1 = K*Matx34d(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0);
+    Matx34d P2 = K*Matx34d(R2(0, 0), R2(0, 1), R2(0, 2), t2[0],
+                           R2(1, 0), R2(1, 1), R2(1, 2), t2[1],
+                           R2(2, 0), R2(2, 1), R2(2, 2), t2[2]);
+
+    Mat X(npoints, 1, CV_64FC3);
+    rng.fill(X, RNG::UNIFORM, Scalar(-2, -2, 4), Scalar(2, 2, 10));
+    // a point at infinity in the direction of the optical axis
+    X.at<Vec3d>(0) = Vec3d(0, 0, 1e12);
+
+    vector<Point2d> x1, x2;
+    projectPoints(X, Vec3d(), Vec3d(), K, noArray(), x1);
+    Vec3d r2;
+    Rodrigues(R2, r2);
+    projectPoints(X, r2, t2, K, noArray(), x2);
+    for( int i = 0; i < npoints; i++ )
+    {
+        x1[i] += Point2d(rng.gaussian(0.3), rng.gaussian(0.3));
+        x2[i] += Point2d(rng.gaussian(0.3), rng.gaussian(0.3));
+    }
+
+    Mat points4D;
+    triangulatePoints(P1, P2, x1, x2, points4D);
+    ASSERT_EQ(CV_64F, points4D.type());
+    ASSERT_EQ(Size(npoints, 4), points4D.size());
+
+    Mat points4Df;
+    vector<Point2f> x1f, x2f;
+    Mat(x1).convertTo(x1f, CV_32F);
+    Mat(x2).convertTo(x2f, CV_32F);
+    triangulatePoints(P1, P2, x1f, x2f, points4Df);
+    ASSERT_EQ(CV_32F, points4Df.type());
+
+    for( int i = 0; i < npoints; i++ )
+    {
+        // the reference: the right singular vector of the DLT system
+        Matx44d A;
+        for( int k = 0; k < 4; k++ )
+        {
+            A(0, k) = x1[i].x*P1(2, k) - P1(0, k);
+            A(1, k) = x1[i].y*P1(2, k) - P1(1, k);
+            A(2, k) = x2[i].x*P2(2, k) - P2(0, k);
+            A(3, k) = x2[i].y*P2(2, k) - P2(1, k);
+        }
+        Matx44d U, Vt;
+        Vec4d W;
+        SVD::compute(A, W, U, Vt);
+        Vec4d ref(Vt(3, 0), Vt(3, 1), Vt(3, 2), Vt(3, 3));
+        if( ref[3] < 0 )
+            ref = -ref;
+
+        Vec4d res(points4D.at<double>(0, i), points4D.at<double>(1, i),
+                  points4D.at<double>(2, i), points4D.at<double>(3, i));
+        Vec4f resf(points4Df.at<float>(0, i), points4Df.at<float>(1, i),
+                   points4Df.at<float>(2, i), points4Df.at<float>(3, i));
+        EXPECT_NEAR(1., norm(res), 1e-9) << "point: " << i;
+        EXPECT_GE(res[3], 0.) << "point: " << i;
+        EXPECT_LE(norm(res - ref, NORM_INF), 1e-4) << "point: " << i;
+        EXPECT_LE(norm(Vec4d(resf) - res, NORM_INF), 1e-5) << "point: " << i;
+    }
+}
+
+TEST(Calib3d_ProjectPoints, no_jacobian_path)
+{
+    RNG& rng = theRNG();
+    const int npoints = 1001;
+    Matx33d K(800, 0, 320, 0, 780, 240, 0, 0, 1);
+    Vec3d rvec(0.1, -0.2, 0.3), tvec(0.5, -0.1, 5);
+    Matx33d R;
+    Rodrigues(rvec, R);
+    double k[] = { -0.3, 0.1, 0.001, -0.002, 0.01, 0.02, -0.01, 0.005 };
+    const int ndists[] = { 0, 4, 5, 8 };
+
+    Mat X(npoints, 1, CV_64FC3), Xf;
+    rng.fill(X, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+    X.convertTo(Xf, CV_32F);
+
+    for( int d = 0; d < 4; d++ )
+    {
+        Mat dist(1, ndists[d], CV_64F, k);
+        for( int depth = CV_32F; depth <= CV_64F; depth++ )
+        {
+            const Mat& src = depth == CV_32F ? Xf : X;
+            Mat fast, ref, jacobian, fastR;
+            projectPoints(src, rvec, tvec, K, dist, fast);
+            // asking for the Jacobian goes through cvProjectPoints2()
+            projectPoints(src, rvec, tvec, K, dist, ref, jacobian);
+            projectPoints(src, Mat(R), tvec, K, dist, fastR);
+
+            ASSERT_EQ(ref.type(), fast.type());
+            EXPECT_LE(cvtest::norm(fast, ref, NORM_INF), 1e-9) << "ndist: " << ndists[d] << ", depth: " << depth;
+            EXPECT_LE(cvtest::norm(fastR, ref, NORM_INF), 1e-6) << "ndist: " << ndists[d] << ", depth: " << depth;
+        }
+    }
+}
@@ -465,6 +465,62 @@ bool CV_ChessboardDetectorTest::checkByGenerator()
     return res;
 }
 
+TEST(Calib3d_ChessboardDetector, coarse_to_fine)
+{
+    Mat bg(Size(800, 600), CV_8UC3, Scalar::all(255));
+    randu(bg, Scalar::all(0), Scalar::all(255));
+    GaussianBlur(bg, bg, Size(7,7), 3.0);
+
+    Mat_<float> camMat(3, 3);
+    camMat << 300.f, 0.f, bg.cols/2.f, 0, 300.f, bg.rows/2.f, 0.f, 0.f, 1.f;
+    Mat_<float> distCoeffs(1, 5, 0.f);
+
+    ChessBoardGenerator cbg(Size(8, 6));
+    vector<Point2f> cornersGenerated;
+    Mat cb = cbg(bg, camMat, distCoeffs, cornersGenerated);
+
+    // a high-resolution view of the same board
+    const float scale = 4.f;
+    Mat img;
+    resize(cb, img, Size(), scale, scale, INTER_CUBIC);
+    for( size_t i = 0; i < cornersGenerated.size(); i++ )
+        cornersGenerated[i] = (cornersGenerated[i] + Point2f(0.5f, 0.5f))*scale - Point2f(0.5f, 0.5f);
+
+    const int flags = CALIB_CB_ADAPTIVE_THRESH + CALIB_CB_NORMALIZE_IMAGE;
+    vector<Point2f> corners, cornersPyr;
+    ASSERT_TRUE(findChessboardCorners(img, cbg.cornersSize(), corners, flags));
+    ASSERT_TRUE(findChessboardCorners(img, cbg.cornersSize(), cornersPyr, flags + CALIB_CB_COARSE_TO_FINE));
+    ASSERT_EQ(corners.size(), cornersPyr.size());
+
+    double err = calcErrorMinError(cbg.cornersSize(), corners, cornersGenerated);
+    double errPyr = calcErrorMinError(cbg.cornersSize(), cornersPyr, cornersGenerated);
+    EXPECT_LE(errPyr, std::max(err, 1.));
+
+    // the next "frame": the board has moved a bit, the previous corners are used as a prior
+    const Point2f shift(12.f, -7.f);
+    Mat moved, aff = (Mat_<double>(2, 3) << 1, 0, shift.x, 0, 1, shift.y);
+    warpAffine(img, moved, aff, img.size(), INTER_LINEAR, BORDER_REPLICATE);
+    for( size_t i = 0; i < cornersGenerated.size(); i++ )
+        cornersGenerated[i] += shift;
+
+    ASSERT_TRUE(findChessboardCorners(moved, cbg.cornersSize(), cornersPyr,
+                                      flags + CALIB_CB_COARSE_TO_FINE + CALIB_CB_USE_PREVIOUS_CORNERS));
+    ASSERT_EQ(corners.size(), cornersPyr.size());
+    EXPECT_LE(calcErrorMinError(cbg.cornersSize(), cornersPyr, cornersGenerated), std::max(err, 1.));
+
+    // a wrong prior only costs time
+    vector<Point2f> wrongPrior(cornersGenerated.size(), Point2f(10.f, 10.f));
+    for( size_t i = 0; i < wrongPrior.size(); i++ )
+        wrongPrior[i] += Point2f((float)(i % 8), (float)(i / 8));
+    ASSERT_TRUE(findChessboardCorners(moved, cbg.cornersSize(), wrongPrior, flags + CALIB_CB_USE_PREVIOUS_CORNERS));
+    EXPECT_LE(calcErrorMinError(cbg.cornersSize(), wrongPrior, cornersGenerated), std::max(err, 1.));
+
+    // no board
+    Mat bgBig;
+    resize(bg, bgBig, Size(), scale, scale, INTER_CUBIC);
+    EXPECT_FALSE(findChessboardCorners(bgBig, cbg.cornersSize(), cornersPyr, flags + CALIB_CB_COARSE_TO_FINE));
+}
+
 TEST(Calib3d_ChessboardDetector, accuracy) {  CV_ChessboardDetectorTest test( CHESSBOARD ); test.safe_run(); }
 TEST(Calib3d_CirclesPatternDetector, accuracy) { CV_ChessboardDetectorTest test( CIRCLES_GRID ); test.safe_run(); }
 TEST(Calib3d_AsymmetricCirclesPatternDetector, accuracy) { CV_ChessboardDetectorTest test( ASYMMETRIC_CIRCLES_GRID ); test.safe_run(); }
@@ -423,3 +423,113 @@ TEST(Calib3d_SolvePnP, translation)
     EXPECT_TRUE(checkRange(rvec));
     EXPECT_TRUE(checkRange(tvec));
 }
+
+static void generatePnPBatch( RNG& rng, int nproblems, int npoints, bool planar,
+                              const Mat& cameraMatrix, const Mat& distCoeffs, double noise,
+                              vector<vector<Point3f> >& objectPoints, vector<vector<Point2f> >& imagePoints,
+                              vector<Mat>& rvecs, vector<Mat>& tvecs )
+{
+    objectPoints.resize(nproblems);
+    imagePoints.resize(nproblems);
+    rvecs.resize(nproblems);
+    tvecs.resize(nproblems);
+    for( int i = 0; i < nproblems; i++ )
+    {
+        objectPoints[i].resize(npoints);
+        for( int j = 0; j < npoints; j++ )
+            objectPoints[i][j] = Point3f(rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f),
+                                         planar ? 0.f : rng.uniform(-1.f, 1.f));
+        rvecs[i] = (Mat_<double>(3, 1) << rng.uniform(-0.5, 0.5), rng.uniform(-0.5, 0.5), rng.uniform(-0.5, 0.5));
+        tvecs[i] = (Mat_<double>(3, 1) << rng.uniform(-1., 1.), rng.uniform(-1., 1.), rng.uniform(5., 10.));
+        projectPoints(objectPoints[i], rvecs[i], tvecs[i], cameraMatrix, distCoeffs, imagePoints[i]);
+        for( int j = 0; j < npoints; j++ )
+            imagePoints[i][j] += Point2f((float)rng.gaussian(noise), (float)rng.gaussian(noise));
+    }
+}
+
+TEST(Calib3d_SolvePnPBatch, accuracy)
+{
+    RNG& rng = theRNG();
+    const int nproblems = 200;
+    Mat cameraMatrix = (Mat_<double>(3, 3) << 600, 0, 320, 0, 620, 240, 0, 0, 1);
+
+    for( int planar = 0; planar < 2; planar++ )
+    {
+        vector<vector<Point3f> > objectPoints;
+        vector<vector<Point2f> > imagePoints;
+        vector<Mat> rvecsGold, tvecsGold, rvecs, tvecs;
+        generatePnPBatch(rng, nproblems, planar ? 4 : 12, planar != 0, cameraMatrix, Mat(), 0.5,
+                         objectPoints, imagePoints, rvecsGold, tvecsGold);
+
+        int nsolved = solvePnPBatch(objectPoints, imagePoints, cameraMatrix, noArray(), rvecs, tvecs);
+        ASSERT_EQ(nproblems, nsolved);
+        ASSERT_EQ(nproblems, (int)rvecs.size());
+        ASSERT_EQ(nproblems, (int)tvecs.size());
+
+        // the same objective as solvePnP. With a few planar points the objective may have two
+        // close minima, so compare the reprojection errors rather than the poses there
+        for( int i = 0; i < nproblems; i++ )
+        {
+            Mat rvec, tvec;
+            solvePnP(objectPoints[i], imagePoints[i], cameraMatrix, noArray(), rvec, tvec);
+            if( !planar )
+            {
+                EXPECT_LE(cvtest::norm(rvecs[i], rvec, NORM_INF), 1e-5) << "problem: " << i;
+                EXPECT_LE(cvtest::norm(tvecs[i], tvec, NORM_INF), 1e-5) << "problem: " << i;
+            }
+
+            vector<Point2f> projectedBatch, projected;
+            projectPoints(objectPoints[i], rvecs[i], tvecs[i], cameraMatrix, noArray(), projectedBatch);
+            projectPoints(objectPoints[i], rvec, tvec, cameraMatrix, noArray(), projected);
+            double errBatch = cvtest::norm(projectedBatch, imagePoints[i], NORM_L2);
+            double err = cvtest::norm(projected, imagePoints[i], NORM_L2);
+            EXPECT_LE(errBatch, err + 1e-3) << "planar: " << planar << ", problem: " << i;
+        }
+    }
+}
+
+TEST(Calib3d_SolvePnPBatch, distortion_and_guess)
+{
+    RNG& rng = theRNG();
+    const int nproblems = 100;
+    Mat cameraMatrix = (Mat_<double>(3, 3) << 600, 0, 320, 0, 620, 240, 0, 0, 1);
+    Mat distCoeffs = (Mat_<double>(5, 1) << -0.2, 0.05, 0.001, -0.001, 0);
+
+    vector<vector<Point3f> > objectPoints;
+    vector<vector<Point2f> > imagePoints;
+    vector<Mat> rvecsGold, tvecsGold, rvecs, tvecs;
+    generatePnPBatch(rng, nproblems, 8, false, cameraMatrix, distCoeffs, 0,
+                     objectPoints, imagePoints, rvecsGold, tvecsGold);
+
+    ASSERT_EQ(nproblems, solvePnPBatch(objectPoints, imagePoints, cameraMatrix, distCoeffs, rvecs, tvecs));
+    for( int i = 0; i < nproblems; i++ )
+    {
+        EXPECT_LE(cvtest::norm(rvecs[i], rvecsGold[i], NORM_INF), 1e-4) << "problem: " << i;
+        EXPECT_LE(cvtest::norm(tvecs[i], tvecsGold[i], NORM_INF), 1e-3) << "problem: " << i;
+    }
+
+    // start from slightly perturbed poses
+    for( int i = 0; i < nproblems; i++ )
+    {
+        rvecs[i] = rvecsGold[i] + Scalar::all(0.02);
+        tvecs[i] = tvecsGold[i] - Scalar::all(0.1);
+    }
+    ASSERT_EQ(nproblems, solvePnPBatch(objectPoints, imagePoints, cameraMatrix, distCoeffs, rvecs, tvecs, true));
+    for( int i = 0; i < nproblems; i++ )
+    {
+        EXPECT_LE(cvtest::norm(rvecs[i], rvecsGold[i], NORM_INF), 1e-4) << "problem: " << i;
+        EXPECT_LE(cvtest::norm(tvecs[i], tvecsGold[i], NORM_INF), 1e-3) << "problem: " << i;
+    }
+
+    // other methods go through solvePnP
+    vector<Mat> rvecsEPnP, tvecsEPnP;
+    ASSERT_EQ(nproblems, solvePnPBatch(objectPoints, imagePoints, cameraMatrix, distCoeffs,
+                                       rvecsEPnP, tvecsEPnP, false, SOLVEPNP_EPNP));
+    for( int i = 0; i < nproblems; i++ )
+    {
+        Mat rvec, tvec;
+        solvePnP(objectPoints[i], imagePoints[i], cameraMatrix, distCoeffs, rvec, tvec, false, SOLVEPNP_EPNP);
+        EXPECT_LE(cvtest::norm(rvecsEPnP[i], Mat_<double>(rvec), NORM_INF), 1e-6) << "problem: " << i;
+        EXPECT_LE(cvtest::norm(tvecsEPnP[i], Mat_<double>(tvec), NORM_INF), 1e-6) << "problem: " << i;
+    }
+}
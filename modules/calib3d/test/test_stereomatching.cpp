@@ -803,3 +803,34 @@ TEST(Calib3d_StereoSGBM_HH4, regression)
     absdiff(toCheck, testData,diff);
     CV_Assert( countNonZero(diff)==0);
 }
+
+TEST(Calib3d_StereoSGBM_HHStriped, accuracy_vs_HH)
+{
+    RNG& rng = theRNG();
+    Size sz(640, 480);
+    const int ndisp = 64, shift = 20;
+
+    Mat texture(sz.height/4, (sz.width + shift)/4, CV_8U);
+    rng.fill(texture, RNG::UNIFORM, 0, 256);
+    Mat scene;
+    resize(texture, scene, Size(sz.width + shift, sz.height), 0, 0, INTER_LINEAR);
+    Mat leftImg = scene.colRange(shift, shift + sz.width).clone();
+    Mat rightImg = scene.colRange(0, sz.width).clone();
+    // a nearer plane in the middle of the scene
+    Rect fg(sz.width/4, sz.height/4, sz.width/2, sz.height/2);
+    scene(fg + Point(shift + 20, 0)).copyTo(leftImg(fg));
+
+    Mat dispHH, dispStriped;
+    Ptr<StereoSGBM> sgbm = StereoSGBM::create(0, ndisp, 5, 8*25, 32*25, 1, 63, 10, 100, 32, StereoSGBM::MODE_HH);
+    sgbm->compute(leftImg, rightImg, dispHH);
+    sgbm->setMode(StereoSGBM::MODE_HH_STRIPED);
+    sgbm->compute(leftImg, rightImg, dispStriped);
+
+    ASSERT_EQ(CV_16S, dispStriped.type());
+    ASSERT_EQ(dispHH.size(), dispStriped.size());
+
+    Mat diff;
+    absdiff(dispHH, dispStriped, diff);
+    int nbad = countNonZero(diff > StereoMatcher::DISP_SCALE);
+    EXPECT_LE(nbad, (int)(0.01*sz.area())) << "pixels differing by more than one disparity: " << nbad;
+}
@@ -1387,6 +1387,30 @@ CV_EXPORTS_W void GaussianBlur( InputArray src, OutputArray dst, Size ksize,
                                 double sigmaX, double sigmaY = 0,
                                 int borderType = BORDER_DEFAULT );
 
+/** @brief Blurs an image using a recursive approximation of the Gaussian filter.
+
+The function convolves the source image with Deriche's fourth-order recursive (IIR) approximation
+of the Gaussian kernel. Unlike cv::GaussianBlur, the cost per pixel does not depend on sigma, so
+the function is meant for large sigmas (say, 5 and above) where the explicit kernels get long. The
+rows are processed in parallel and the columns are vectorized.
+
+The result is approximate: for sigma >= 1 it differs from the exact (untruncated) Gaussian
+convolution by at most about 0.2% of the input range per dimension, that is, by not more than 1
+for 8-bit images. The image borders are always extrapolated as BORDER_REPLICATE.
+
+@param src input image; the image can have any number of channels, which are processed
+independently, but the depth should be CV_8U, CV_16U, CV_16S or CV_32F.
+@param dst output image of the same size and type as src.
+@param sigmaX Gaussian kernel standard deviation in X direction; it should be at least 0.5.
+@param sigmaY Gaussian kernel standard deviation in Y direction; if sigmaY is zero, it is set to be
+equal to sigmaX.
+@param borderType pixel extrapolation method; only BORDER_REPLICATE is supported.
+
+@sa  GaussianBlur
+ */
+CV_EXPORTS_W void recursiveGaussianBlur( InputArray src, OutputArray dst, double sigmaX,
+                                         double sigmaY = 0, int borderType = BORDER_REPLICATE );
+
 /** @brief Applies the bilateral filter to an image.
 
 The function applies bilateral filtering to the input image, as described in
@@ -1419,6 +1443,30 @@ CV_EXPORTS_W void bilateralFilter( InputArray src, OutputArray dst, int d,
                                    double sigmaColor, double sigmaSpace,
                                    int borderType = BORDER_DEFAULT );
 
+/** @brief Applies a fast approximation of the bilateral filter to an image.
+
+The function approximates cv::bilateralFilter with the bilateral grid: the pixels are accumulated into
+a coarse 3D grid of the coordinates and the intensity (sampled at sigmaSpace and sigmaColor
+respectively), the grid is blurred and then interpolated back at the pixel positions. The cost per
+pixel is almost independent of sigmaSpace, while the grid size is inversely proportional to
+sigmaSpace^2*sigmaColor, so the function is meant for large spatial sigmas (say, 4 and above),
+where the exact filter is very slow. When the grid would be too large (small sigmas, or a very wide
+range of the floating-point values), the function calls bilateralFilter with BORDER_REPLICATE instead.
+
+@note Only single-channel images are supported. The color images need the color distance over all
+the channels, which the 3D grid does not represent; use bilateralFilter for them.
+
+@param src Source 8-bit or floating-point, single-channel image. Floating-point images must not
+contain NaN or infinite values.
+@param dst Destination image of the same size and type as src.
+@param sigmaColor Filter sigma in the color space.
+@param sigmaSpace Filter sigma in the coordinate space.
+
+@sa bilateralFilter
+ */
+CV_EXPORTS_W void bilateralGridFilter( InputArray src, OutputArray dst,
+                                       double sigmaColor, double sigmaSpace );
+
 /** @brief Blurs an image using the box filter.
 
 The function smooths an image using the kernel:
@@ -2959,6 +3007,72 @@ CV_EXPORTS_W float initWideAngleProjMap( InputArray cameraMatrix, InputArray dis
                                          int m1type, OutputArray map1, OutputArray map2,
                                          int projType = PROJ_SPHERICAL_EQRECT, double alpha = 0);
 
+/** @brief A compact geometric transformation map for repeated remapping.
+
+The map stores the source coordinates only at the nodes of a coarse grid, every gridStep pixels of
+the destination. apply() interpolates the grid bilinearly on the fly, in bands of rows processed in
+parallel, converts the coordinates to the fixed-point representation used by remap and remaps the
+band. With the default grid step the map takes less than 0.1% of the memory of the dense floating-
+point maps, so remapping mostly streams the source and destination images only. The error of the
+coordinates is the deviation of the map from bilinear within a grid cell. For smooth maps, such as
+the undistortion ones, it is far below the precision of the fixed-point coordinates (1/32 pixel).
+A grid step of 1 reproduces remap with the dense maps exactly.
+
+@sa createUndistortRectifyWarpMap, createWarpMap, remap
+ */
+class CV_EXPORTS WarpMap : public Algorithm
+{
+public:
+    /** @brief Remaps an image.
+
+    @param src Source image.
+    @param dst Destination image of getSize() size and the same type as src.
+    @param interpolation Interpolation method, INTER_NEAREST, INTER_LINEAR, INTER_CUBIC or INTER_LANCZOS4.
+    @param borderMode Pixel extrapolation method, see remap.
+    @param borderValue Value used in case of a constant border.
+     */
+    virtual void apply( InputArray src, OutputArray dst, int interpolation = INTER_LINEAR,
+                        int borderMode = BORDER_CONSTANT, const Scalar& borderValue = Scalar() ) const = 0;
+
+    /** @brief Computes the dense CV_32FC1 maps of x and y coordinates, as used by remap. */
+    virtual void getMaps( OutputArray map1, OutputArray map2 ) const = 0;
+
+    /** @brief Returns the size of the destination image. */
+    virtual Size getSize() const = 0;
+
+    /** @brief Returns the distance between the grid nodes, in pixels. */
+    virtual int getGridStep() const = 0;
+};
+
+/** @brief Creates a WarpMap from dense floating-point maps.
+
+@param map1 Map of x coordinates (CV_32FC1) or of (x,y) points (CV_32FC2).
+@param map2 Map of y coordinates (CV_32FC1), or empty when map1 has two channels.
+@param gridStep Distance between the grid nodes, in pixels.
+ */
+CV_EXPORTS Ptr<WarpMap> createWarpMap( InputArray map1, InputArray map2, int gridStep = 16 );
+
+/** @brief Creates a WarpMap combining undistortion, rectification and scaling.
+
+The map transforms the image like initUndistortRectifyMap followed by remap and resize with the
+given scale factor, in a single interpolation. The undistortion model is evaluated only at the grid
+nodes. The scale keeps the pixel centers, like resize, but the image is not low-pass filtered, so a
+strong downscale may alias.
+
+@param cameraMatrix Input camera matrix, see initUndistortRectifyMap.
+@param distCoeffs Input vector of distortion coefficients, see initUndistortRectifyMap.
+@param R Optional rectification transformation in the object space, see initUndistortRectifyMap.
+@param newCameraMatrix New camera matrix (3x3 or the 3x4 projection matrix), see initUndistortRectifyMap.
+@param size Undistorted image size before scaling.
+@param scale Scale factor; the destination size is size*scale, rounded.
+@param gridStep Distance between the grid nodes, in destination pixels. The error of the map grows
+with the square of the node distance in the source image, so for a strong downscale the step should be
+reduced proportionally to the scale.
+ */
+CV_EXPORTS Ptr<WarpMap> createUndistortRectifyWarpMap( InputArray cameraMatrix, InputArray distCoeffs,
+                                                       InputArray R, InputArray newCameraMatrix,
+                                                       Size size, double scale = 1, int gridStep = 16 );
+
 /** @brief Returns the default new camera matrix.
 
 The function returns the camera matrix that is either an exact copy of the input cameraMatrix (when
@@ -3599,6 +3713,65 @@ channels is derived automatically from src and code.
  */
 CV_EXPORTS_W void cvtColor( InputArray src, OutputArray dst, int code, int dstCn = 0 );
 
+/** @brief A chain of image transformations executed tile by tile.
+
+The pipeline records a sequence of operations (color conversion, resize, Gaussian blur and type
+conversion) and applies them to an image in horizontal tiles, processed in parallel. Each tile
+passes through all the operations while its intermediate rows are still in cache, so the
+intermediate images are never stored in full. The filters recompute a few rows around every tile.
+
+The result is the same as the one of the chain of the corresponding functions:
+@code
+    Ptr<ImagePipeline> pipeline = createImagePipeline();
+    pipeline->addCvtColor(COLOR_BGR2GRAY);
+    pipeline->addResize(Size(), 0.5, 0.5, INTER_AREA);
+    pipeline->addGaussianBlur(Size(5, 5), 1.5);
+    pipeline->addConvertTo(CV_32F, 1./255);
+    pipeline->apply(src, dst);
+
+    // the same as
+    cvtColor(src, gray, COLOR_BGR2GRAY);
+    resize(gray, small, Size(), 0.5, 0.5, INTER_AREA);
+    GaussianBlur(small, blurred, Size(5, 5), 1.5);
+    blurred.convertTo(dst, CV_32F, 1./255);
+@endcode
+
+@note The tiles reproduce the built-in implementations of resize and GaussianBlur. When IPP, OpenVX or
+a custom HAL would replace them for the type, size, interpolation or border of an operation, apply
+calls the function for this operation on the whole image, and tiles the operations around it. The
+result is the same in any case.
+ */
+class CV_EXPORTS ImagePipeline : public Algorithm
+{
+public:
+    /** @brief Adds a color conversion, see cvtColor. The conversions that need the neighbor pixels
+    or change the image size (Bayer demosaicing, YUV 4:2:0) are not supported. */
+    virtual void addCvtColor( int code, int dstCn = 0 ) = 0;
+
+    /** @brief Adds a resize, see resize. */
+    virtual void addResize( Size dsize, double fx = 0, double fy = 0, int interpolation = INTER_LINEAR ) = 0;
+
+    /** @brief Adds a Gaussian blur, see GaussianBlur. BORDER_ISOLATED and BORDER_WRAP are not supported. */
+    virtual void addGaussianBlur( Size ksize, double sigmaX, double sigmaY = 0, int borderType = BORDER_DEFAULT ) = 0;
+
+    /** @brief Adds a type conversion, see Mat::convertTo. */
+    virtual void addConvertTo( int rtype, double alpha = 1, double beta = 0 ) = 0;
+
+    /** @brief Applies the recorded operations to an image.
+
+    @param src Source image.
+    @param dst Destination image. An empty pipeline copies src to dst.
+     */
+    virtual void apply( InputArray src, OutputArray dst ) = 0;
+
+    /** @brief Removes all the operations. */
+    virtual void clear() = 0;
+};
+
+/** @brief Creates an empty ImagePipeline.
+ */
+CV_EXPORTS Ptr<ImagePipeline> createImagePipeline();
+
 //! @} imgproc_misc
 
 // main function for all demosaicing processes
@@ -3625,6 +3798,33 @@ type for the input array should be either np.int32 or np.float32.
  */
 CV_EXPORTS_W Moments moments( InputArray array, bool binaryImage = false );
 
+/** @brief Calculates the moments of a set of contours.
+
+The function computes moments(contours[i]) for every contour of the set, processing the contours in
+parallel. The results are the same as the ones of the separate calls.
+
+@param contours Input vector of contours, each of them is a vector of Point or Point2f.
+@param mu Output vector of moments, one per contour.
+
+@sa  moments, findContours
+ */
+CV_EXPORTS void contoursMoments( InputArrayOfArrays contours, std::vector<Moments>& mu );
+
+/** @brief Calculates the moments of every label of a label image.
+
+The function computes, in a single parallel pass over the image, the moments of all the labels
+\f$0 \le l < nlabels\f$ , that is moments(labels == l, true) for every l. The result differs from the
+separate calls only by the rounding of the accumulated sums. Pixels with labels outside of the range
+are skipped.
+
+@param labels Label image of type CV_32SC1 or CV_16UC1, e.g. the output of connectedComponents.
+@param nlabels Number of labels.
+@param mu Output vector of moments, one per label.
+
+@sa  moments, connectedComponents
+ */
+CV_EXPORTS void labelsMoments( InputArray labels, int nlabels, std::vector<Moments>& mu );
+
 /** @brief Calculates seven Hu invariants.
 
 The function calculates seven Hu invariants (introduced in @cite Hu62; see also
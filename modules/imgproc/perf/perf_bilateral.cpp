@@ -36,3 +36,38 @@ PERF_TEST_P( TestBilateralFilter, BilateralFilter,
 
     SANITY_CHECK(dst, .01, ERROR_RELATIVE);
 }
+
+CV_ENUM(BilateralMethod, 0, 1)
+
+typedef TestBaseWithParam< tr1::tuple<double, Mat_Type, BilateralMethod> > TestBilateralGrid;
+
+// the exact filter (0) against the bilateral grid (1) for growing spatial sigmas
+PERF_TEST_P( TestBilateralGrid, BilateralGrid,
+             Combine(
+                Values( 3., 6., 12. ), // sigmaSpace
+                Values( (int)CV_8UC1, (int)CV_32FC1 ),
+                BilateralMethod::all()
+             )
+)
+{
+    double sigmaSpace = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int method = get<2>(GetParam());
+    const double sigmaColor = 30.;
+
+    Mat src(szVGA, type);
+    Mat dst(szVGA, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(60);
+
+    if( method == 0 )
+    {
+        TEST_CYCLE() bilateralFilter(src, dst, 0, sigmaColor, sigmaSpace, BORDER_REPLICATE);
+    }
+    else
+    {
+        TEST_CYCLE() bilateralGridFilter(src, dst, sigmaColor, sigmaSpace);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
@@ -205,3 +205,28 @@ PERF_TEST_P(Size_MatType_BorderType, blur5x5,
 
     SANITY_CHECK(dst, 1);
 }
+
+typedef std::tr1::tuple<Size, MatType, double> Size_MatType_Sigma_t;
+typedef perf::TestBaseWithParam<Size_MatType_Sigma_t> Size_MatType_Sigma;
+
+PERF_TEST_P(Size_MatType_Sigma, recursiveGaussianBlur,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1),
+                testing::Values(5., 20., 50.)
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    double sigma = get<2>(GetParam());
+
+    Mat src(size, type);
+    Mat dst(size, type);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() recursiveGaussianBlur(src, dst, sigma);
+
+    SANITY_CHECK_NOTHING();
+}
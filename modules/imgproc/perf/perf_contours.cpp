@@ -0,0 +1,49 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using namespace testing;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(RetrMode, RETR_EXTERNAL, RETR_LIST, RETR_CCOMP)
+CV_ENUM(ApproxMode, CHAIN_APPROX_NONE, CHAIN_APPROX_SIMPLE, CHAIN_APPROX_TC89_L1)
+
+typedef std::tr1::tuple<Size, RetrMode, ApproxMode, int> TestFindContours_t;
+typedef perf::TestBaseWithParam<TestFindContours_t> TestFindContours;
+
+PERF_TEST_P(TestFindContours, findContours,
+            Combine(
+                Values(szODD, sz1080p, Size(4096, 4096)),
+                RetrMode::all(),
+                ApproxMode::all(),
+                Values(32, 128, 512) // blobs per 512x512 block
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int retrMode = get<1>(GetParam());
+    int approxMode = get<2>(GetParam());
+    int density = get<3>(GetParam());
+
+    // blobs of different sizes, some of them with holes
+    RNG rng(12345);
+    Mat img = Mat::zeros(sz, CV_8UC1);
+    int nblobs = cvRound((double)density*sz.area()/(512*512));
+    for( int i = 0; i < nblobs; i++ )
+    {
+        Point center(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+        int r = rng.uniform(2, 24);
+        circle(img, center, r, Scalar::all(255), -1);
+        if( r > 8 && (i & 1) )
+            circle(img, center, r/3, Scalar::all(0), -1);
+    }
+
+    vector<vector<Point> > contours;
+    vector<Vec4i> hierarchy;
+
+    TEST_CYCLE() findContours(img, contours, hierarchy, retrMode, approxMode);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -39,3 +39,30 @@ PERF_TEST_P(Image_MaxCorners_QualityLevel_MinDistance_BlockSize_UseHarris, goodF
 
     SANITY_CHECK(corners);
 }
+
+typedef std::tr1::tuple<Size, int> Size_Threads_t;
+typedef perf::TestBaseWithParam<Size_Threads_t> Size_Threads;
+
+PERF_TEST_P(Size_Threads, goodFeaturesToTrack_top500,
+            testing::Combine(
+                testing::Values( sz1080p, sz2160p ),
+                testing::Values( 1, 4 )
+                )
+          )
+{
+    Size sz = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat image(sz, CV_8UC1);
+    declare.in(image, WARMUP_RNG);
+    GaussianBlur(image, image, Size(0, 0), 1.5);
+
+    std::vector<Point2f> corners;
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() goodFeaturesToTrack(image, corners, 500, 0.01, 10);
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
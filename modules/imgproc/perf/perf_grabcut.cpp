@@ -0,0 +1,49 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, int> Size_Iters_t;
+typedef perf::TestBaseWithParam<Size_Iters_t> Size_Iters;
+
+PERF_TEST_P( Size_Iters, grabCut,
+             testing::Combine(
+                 testing::Values( szVGA, sz1080p ),
+                 testing::Values( 1, 5 )
+                 )
+             )
+{
+    Size sz = get<0>(GetParam());
+    int iterCount = get<1>(GetParam());
+
+    // a noisy ellipse on a noisy background
+    Mat img(sz, CV_8UC3), noise(sz, CV_8UC3);
+    img.setTo(Scalar(60, 120, 40));
+    ellipse(img, Point(sz.width/2, sz.height/2), Size(sz.width/4, sz.height/3), 0, 0, 360, Scalar(40, 80, 200), -1);
+    RNG rng(12345);
+    rng.fill(noise, RNG::NORMAL, 0, 24);
+    img += noise;
+
+    Rect rect(sz.width/8, sz.height/8, sz.width*3/4, sz.height*3/4);
+    Mat mask0, bgdModel0, fgdModel0;
+    theRNG().state = 12378213;
+    grabCut(img, mask0, rect, bgdModel0, fgdModel0, 0, GC_INIT_WITH_RECT);
+
+    Mat mask, bgdModel, fgdModel;
+    declare.time(60);
+    TEST_CYCLE()
+    {
+        mask0.copyTo(mask);
+        bgdModel0.copyTo(bgdModel);
+        fgdModel0.copyTo(fgdModel);
+        grabCut(img, mask, rect, bgdModel, fgdModel, iterCount, GC_EVAL);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
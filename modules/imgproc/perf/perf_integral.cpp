@@ -82,3 +82,31 @@ PERF_TEST_P( Size_MatType_OutMatDepth, integral_sqsum_tilted,
     SANITY_CHECK(sqsum, 1e-6);
     SANITY_CHECK(tilted, 1e-6, tilted.depth() > CV_32S ? ERROR_RELATIVE : ERROR_ABSOLUTE);
 }
+
+typedef std::tr1::tuple<MatType, int> MatType_Threads_t;
+typedef perf::TestBaseWithParam<MatType_Threads_t> MatType_Threads;
+
+PERF_TEST_P( MatType_Threads, integral_20MP,
+             testing::Combine(
+                 testing::Values( CV_8UC1, CV_32FC1 ),
+                 testing::Values( 1, 2, 4, 8 )
+                 )
+             )
+{
+    int matType = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+    Size sz(5472, 3648);
+
+    Mat src(sz, matType);
+    Mat sum, sqsum, tilted;
+    int sdepth = CV_MAT_DEPTH(matType) == CV_8U ? CV_32S : CV_32F;
+
+    declare.in(src, WARMUP_RNG).time(100);
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() integral(src, sum, sqsum, tilted, sdepth, CV_64F);
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
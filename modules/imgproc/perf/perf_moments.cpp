@@ -42,3 +42,36 @@ PERF_TEST_P(MomentsFixture_val, Moments1,
 
     SANITY_CHECK_MOMENTS(m, 2e-4, ERROR_RELATIVE);
 }
+
+typedef perf::TestBaseWithParam<Size> MomentsFixture_batch;
+
+PERF_TEST_P(MomentsFixture_batch, contoursMoments, testing::Values(sz1080p, sz2160p))
+{
+    Size srcSize = GetParam();
+    Mat img(srcSize, CV_8U);
+    declare.in(img, WARMUP_RNG);
+    threshold(img, img, 200, 255, THRESH_BINARY);
+
+    vector<vector<Point> > contours;
+    findContours(img, contours, RETR_LIST, CHAIN_APPROX_NONE);
+    vector<Moments> mu;
+
+    TEST_CYCLE() contoursMoments(contours, mu);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(MomentsFixture_batch, labelsMoments, testing::Values(sz1080p, sz2160p))
+{
+    Size srcSize = GetParam();
+    Mat img(srcSize, CV_8U), labels;
+    declare.in(img, WARMUP_RNG);
+    threshold(img, img, 200, 255, THRESH_BINARY);
+
+    int nlabels = connectedComponents(img, labels, 8, CV_32S);
+    vector<Moments> mu;
+
+    TEST_CYCLE() labelsMoments(labels, nlabels, mu);
+
+    SANITY_CHECK_NOTHING();
+}
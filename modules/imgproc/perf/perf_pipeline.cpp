@@ -0,0 +1,86 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::get;
+
+// on 4K input, chain 0: BGR -> gray -> half size -> blur -> float, with small intermediate images;
+// chain 1: BGR -> float -> blur -> Lab -> 8-bit, with 100MB float intermediate images;
+// method 0 calls the functions one by one, method 1 runs them as a pipeline
+typedef std::tr1::tuple<int, int, int> Chain_Method_Threads_t;
+typedef perf::TestBaseWithParam<Chain_Method_Threads_t> Chain_Method_Threads;
+
+static void addChain( const Ptr<ImagePipeline>& pipeline, int chain )
+{
+    if( chain == 0 )
+    {
+        pipeline->addCvtColor(COLOR_BGR2GRAY);
+        pipeline->addResize(Size(), 0.5, 0.5, INTER_AREA);
+        pipeline->addGaussianBlur(Size(5, 5), 1.5);
+        pipeline->addConvertTo(CV_32F, 1./255);
+    }
+    else
+    {
+        pipeline->addConvertTo(CV_32F, 1./255);
+        pipeline->addGaussianBlur(Size(5, 5), 1.5);
+        pipeline->addCvtColor(COLOR_BGR2Lab);
+        pipeline->addConvertTo(CV_8U, 2.55);
+    }
+}
+
+static void runChain( const Mat& src, Mat& dst, int chain )
+{
+    Mat a, b, c;
+    if( chain == 0 )
+    {
+        cvtColor(src, a, COLOR_BGR2GRAY);
+        resize(a, b, Size(), 0.5, 0.5, INTER_AREA);
+        GaussianBlur(b, c, Size(5, 5), 1.5);
+        c.convertTo(dst, CV_32F, 1./255);
+    }
+    else
+    {
+        src.convertTo(a, CV_32F, 1./255);
+        GaussianBlur(a, b, Size(5, 5), 1.5);
+        cvtColor(b, c, COLOR_BGR2Lab);
+        c.convertTo(dst, CV_8U, 2.55);
+    }
+}
+
+PERF_TEST_P( Chain_Method_Threads, ImagePipeline_4K,
+             testing::Combine(
+                 testing::Values( 0, 1 ),
+                 testing::Values( 0, 1 ),
+                 testing::Values( 1, 4 )
+                 )
+             )
+{
+    int chain = get<0>(GetParam());
+    int method = get<1>(GetParam());
+    int threads = get<2>(GetParam());
+
+    Mat src(sz2160p, CV_8UC3), dst;
+    declare.in(src, WARMUP_RNG).time(60);
+
+    Ptr<ImagePipeline> pipeline = createImagePipeline();
+    addChain(pipeline, chain);
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    if( method == 0 )
+    {
+        TEST_CYCLE() runChain(src, dst, chain);
+    }
+    else
+    {
+        TEST_CYCLE() pipeline->apply(src, dst);
+    }
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -68,3 +68,48 @@ PERF_TEST_P( TestRemap, Remap,
 
     SANITY_CHECK(dst);
 }
+
+// undistortion of 1080p to 720p; method 0 remaps with the dense float maps and resizes,
+// method 1 applies the combined WarpMap
+typedef std::tr1::tuple<int, int> Method_Threads_t;
+typedef TestBaseWithParam<Method_Threads_t> Method_Threads;
+
+PERF_TEST_P( Method_Threads, UndistortResize_1080p,
+             Combine(
+                Values( 0, 1 ),
+                Values( 1, 4 )
+             )
+)
+{
+    int method = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Size sz = sz1080p, dsz = sz720p;
+    Mat cameraMatrix = (Mat_<double>(3, 3) << 1200, 0, sz.width*0.5, 0, 1200, sz.height*0.5, 0, 0, 1);
+    Mat distCoeffs = (Mat_<double>(1, 5) << -0.25, 0.1, 0, 0, -0.02);
+    double scale = (double)dsz.width/sz.width;
+
+    Mat src(sz, CV_8UC3), dst;
+    declare.in(src, WARMUP_RNG).time(30);
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    if( method == 0 )
+    {
+        Mat mapx, mapy, undistorted;
+        initUndistortRectifyMap(cameraMatrix, distCoeffs, Mat(), cameraMatrix, sz, CV_32FC1, mapx, mapy);
+        TEST_CYCLE()
+        {
+            remap(src, undistorted, mapx, mapy, INTER_LINEAR);
+            resize(undistorted, dst, dsz, 0, 0, INTER_LINEAR);
+        }
+    }
+    else
+    {
+        Ptr<WarpMap> warpMap = createUndistortRectifyWarpMap(cameraMatrix, distCoeffs, Mat(), cameraMatrix, sz, scale);
+        TEST_CYCLE() warpMap->apply(src, dst);
+    }
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
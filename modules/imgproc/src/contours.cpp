@@ -1870,6 +1870,475 @@ cvFindContours( void*  img,  CvMemStorage*  storage,
     return cvFindContours_Impl(img, storage, firstContour, cntHeaderSize, mode, method, offset, 1);
 }
 
+/****************************************************************************************\
+*                         Parallel retrieval of contours (large images)                  *
+\****************************************************************************************/
+
+/*
+   For the retrieval modes without the full hierarchy the contours can be found without
+   the sequential scan. The Suzuki scanner meets a new outer border at the first (in the
+   raster order) pixel of every 8-connected component of 1-pixels, and a new hole border
+   right before the first pixel of every 4-connected component of 0-pixels, except for
+   the background around the image. So the image is split into horizontal bands, which are
+   labeled in parallel using the runs of 0- and 1-pixels; the labels are merged at the band
+   seams and the found borders are traced concurrently. The result (the contours, their
+   order and the hierarchy) is exactly the same as in the sequential case.
+*/
+
+namespace cv
+{
+
+static const int CONTOURS_BAND_MIN_HEIGHT = 64;
+static const int CONTOURS_PARALLEL_MIN_AREA = 1 << 20;
+
+/* runs of 0- and 1-pixels. Every row starts and ends with a 0-run (the image has zero
+   borders), the runs alternate. The root of each union-find set is its first run. */
+struct ContourRuns
+{
+    std::vector<int> xs;        /* starting x coordinates of the runs */
+    std::vector<int> parent;    /* union-find forest */
+    std::vector<int> rowOfs;    /* index of the first run of each row */
+};
+
+struct ContourStart
+{
+    int run;                    /* the first run of the component */
+    Point origin;               /* the starting point of the border */
+    int isHole;
+    int parent;                 /* index of the parent contour (CV_RETR_CCOMP) */
+};
+
+static inline int findRunRoot( int* parent, int i )
+{
+    int root = i;
+    while( parent[root] != root )
+        root = parent[root];
+    while( parent[i] != root )
+    {
+        int next = parent[i];
+        parent[i] = root;
+        i = next;
+    }
+    return root;
+}
+
+static inline int findRunRootConst( const int* parent, int i )
+{
+    while( parent[i] != i )
+        i = parent[i];
+    return i;
+}
+
+static inline void mergeRuns( int* parent, int a, int b )
+{
+    a = findRunRoot( parent, a );
+    b = findRunRoot( parent, b );
+    if( a < b )
+        parent[b] = a;
+    else if( b < a )
+        parent[a] = b;
+}
+
+/* merges the runs [c0, c1) of a row with the touching runs [p0, p1) of the previous row:
+   1-runs are 8-connected and 0-runs are 4-connected */
+static void linkRunRows( const int* xs, int* parent, int p0, int p1, int c0, int c1, int width )
+{
+    int j = p0;
+    for( int i = c0; i < c1; i++ )
+    {
+        int fg = (i - c0) & 1;
+        int lo = xs[i] - fg, hi = (i + 1 < c1 ? xs[i + 1] : width) + fg;
+
+        while( j < p1 && (j + 1 < p1 ? xs[j + 1] : width) <= lo )
+            j++;
+        for( int k = j; k < p1 && xs[k] < hi; k++ )
+            if( ((k - p0) & 1) == fg )
+                mergeRuns( parent, k, i );
+    }
+}
+
+/* returns the first x >= x0, where the pixel is zero (nz == true) or non-zero (nz == false) */
+static inline int skipRun( const uchar* row, int x, int width, bool nz, bool haveSIMD )
+{
+#if CV_SIMD128
+    if( haveSIMD )
+    {
+        v_uint8x16 v_zero = v_setzero_u8();
+        for( ; x <= width - 16; x += 16 )
+        {
+            int mask = v_signmask( v_load( row + x ) == v_zero );
+            if( !nz )
+                mask ^= 0xffff;
+            if( mask )
+                return x + trailingZeros32( mask );
+        }
+    }
+#else
+    (void)haveSIMD;
+#endif
+    for( ; x < width && (row[x] != 0) == nz; x++ )
+        ;
+    return x;
+}
+
+class ContourRunsInvoker : public ParallelLoopBody
+{
+public:
+    ContourRunsInvoker( const Mat& _img, int _bandHeight, std::vector<ContourRuns>& _bands )
+        : img(&_img), bandHeight(_bandHeight), bands(&_bands)
+    {
+#if CV_SIMD128
+        haveSIMD = hasSIMD128();
+#else
+        haveSIMD = false;
+#endif
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int width = img->cols;
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = b*bandHeight, y1 = std::min(y0 + bandHeight, img->rows);
+            ContourRuns& band = (*bands)[b];
+            std::vector<int>& xs = band.xs;
+            std::vector<int>& parent = band.parent;
+
+            band.rowOfs.resize(y1 - y0 + 1);
+            for( int y = y0; y < y1; y++ )
+            {
+                const uchar* row = img->ptr<uchar>(y);
+                int r0 = (int)xs.size();
+                band.rowOfs[y - y0] = r0;
+
+                xs.push_back(0);
+                for( int x = 0;; )
+                {
+                    x = skipRun( row, x, width, (xs.size() - r0) % 2 == 0, haveSIMD );
+                    if( x >= width )
+                        break;
+                    xs.push_back(x);
+                }
+                for( int i = r0; i < (int)xs.size(); i++ )
+                    parent.push_back(i);
+
+                if( y > y0 )
+                    linkRunRows( &xs[0], &parent[0], band.rowOfs[y - y0 - 1], r0,
+                                 r0, (int)xs.size(), width );
+            }
+            band.rowOfs[y1 - y0] = (int)xs.size();
+        }
+    }
+
+protected:
+    const Mat* img;
+    int bandHeight;
+    std::vector<ContourRuns>* bands;
+    bool haveSIMD;
+};
+
+class ContourStartsInvoker : public ParallelLoopBody
+{
+public:
+    ContourStartsInvoker( const ContourRuns& _runs, int _bandHeight, int _rows, int _mode,
+                          std::vector<std::vector<ContourStart> >& _starts )
+        : runs(&_runs), bandHeight(_bandHeight), rows(_rows), mode(_mode), starts(&_starts) {}
+
+    void operator()( const Range& range ) const
+    {
+        const int* xs = &runs->xs[0];
+        const int* parent = &runs->parent[0];
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = b*bandHeight, y1 = std::min(y0 + bandHeight, rows);
+            std::vector<ContourStart>& bandStarts = (*starts)[b];
+            for( int y = y0; y < y1; y++ )
+            {
+                int r0 = runs->rowOfs[y], r1 = runs->rowOfs[y + 1];
+                /* the first run of the row belongs to the background around the image */
+                for( int i = r0 + 1; i < r1; i++ )
+                {
+                    if( parent[i] != i )
+                        continue;
+                    ContourStart s;
+                    s.run = i;
+                    s.isHole = ((i - r0) & 1) == 0;
+                    s.origin = Point(xs[i] - s.isHole, y);
+                    s.parent = -1;
+                    if( s.isHole )
+                    {
+                        if( mode == CV_RETR_EXTERNAL )
+                            continue;
+                        if( mode == CV_RETR_CCOMP )
+                            s.parent = findRunRootConst( parent, i - 1 );
+                    }
+                    else if( mode == CV_RETR_EXTERNAL && findRunRootConst( parent, i - 1 ) != 0 )
+                        continue;
+                    bandStarts.push_back(s);
+                }
+            }
+        }
+    }
+
+protected:
+    const ContourRuns* runs;
+    int bandHeight, rows, mode;
+    std::vector<std::vector<ContourStart> >* starts;
+};
+
+/* follows the border in the same way as icvFetchContour does, but does not mark the image,
+   so that the different borders can be traced concurrently */
+static void followBorder( const uchar* ptr, int step, Point pt, int isHole, int method,
+                          std::vector<Point>& points, std::vector<schar>& codes )
+{
+    int deltas[MAX_SIZE];
+    const uchar *i0 = ptr, *i1, *i3, *i4 = 0;
+    int prev_s, s, s_end;
+
+    CV_INIT_3X3_DELTAS( deltas, step, 1 );
+    memcpy( deltas + 8, deltas, 8 * sizeof( deltas[0] ));
+
+    s_end = s = isHole ? 0 : 4;
+
+    do
+    {
+        s = (s - 1) & 7;
+        i1 = i0 + deltas[s];
+    }
+    while( *i1 == 0 && s != s_end );
+
+    if( s == s_end )            /* single pixel domain */
+    {
+        if( method != CV_CHAIN_CODE )
+            points.push_back(pt);
+        return;
+    }
+
+    i3 = i0;
+    prev_s = s ^ 4;
+
+    for( ;; )
+    {
+        while( s < MAX_SIZE - 1 )
+        {
+            i4 = i3 + deltas[++s];
+            if( *i4 != 0 )
+                break;
+        }
+        s &= 7;
+
+        if( method == CV_CHAIN_CODE )
+            codes.push_back((schar)s);
+        else if( s != prev_s || method == CV_CHAIN_APPROX_NONE )
+        {
+            points.push_back(pt);
+            prev_s = s;
+        }
+
+        pt.x += icvCodeDeltas[s].x;
+        pt.y += icvCodeDeltas[s].y;
+
+        if( i4 == i0 && i3 == i1 )
+            break;
+
+        i3 = i4;
+        s = (s + 4) & 7;
+    }
+}
+
+class ContourTraceInvoker : public ParallelLoopBody
+{
+public:
+    ContourTraceInvoker( const Mat& _img, const std::vector<ContourStart>& _starts,
+                         const std::vector<int>& _order, int _method, Point _offset,
+                         std::vector<std::vector<Point> >& _points )
+        : img(&_img), starts(&_starts), order(&_order), method(_method), offset(_offset), points(&_points) {}
+
+    void operator()( const Range& range ) const
+    {
+        bool tc89 = method == CV_CHAIN_APPROX_TC89_L1 || method == CV_CHAIN_APPROX_TC89_KCOS;
+        MemStorage storage(tc89 ? cvCreateMemStorage() : 0);
+        std::vector<schar> codes;
+        size_t step = img->step;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const ContourStart& s = (*starts)[(*order)[i]];
+            std::vector<Point>& dst = (*points)[i];
+            const uchar* ptr = img->ptr<uchar>(s.origin.y) + s.origin.x;
+
+            if( !tc89 )
+            {
+                followBorder( ptr, (int)step, s.origin + offset, s.isHole, method, dst, codes );
+                continue;
+            }
+
+            codes.clear();
+            followBorder( ptr, (int)step, s.origin + offset, s.isHole, CV_CHAIN_CODE, dst, codes );
+            CvChain* chain = (CvChain*)cvCreateSeq( CV_SEQ_CHAIN_CONTOUR, sizeof(CvChain), sizeof(char), storage );
+            chain->origin = s.origin + offset;
+            if( !codes.empty() )
+                cvSeqPushMulti( (CvSeq*)chain, &codes[0], (int)codes.size() );
+            CvSeq* contour = icvApproximateChainTC89( chain, sizeof(CvContour), storage, method );
+            dst.resize(contour->total);
+            if( contour->total > 0 )
+                cvCvtSeqToArray( contour, &dst[0] );
+            cvClearMemStorage( storage );
+        }
+    }
+
+protected:
+    const Mat* img;
+    const std::vector<ContourStart>* starts;
+    const std::vector<int>* order;
+    int method;
+    Point offset;
+    std::vector<std::vector<Point> >* points;
+};
+
+static bool findContoursParallel( const Mat& image, OutputArrayOfArrays _contours, OutputArray _hierarchy,
+                                  int mode, int method, Point offset )
+{
+    if( !(mode == CV_RETR_EXTERNAL || mode == CV_RETR_LIST || mode == CV_RETR_CCOMP) ||
+        method < CV_CHAIN_APPROX_NONE || method > CV_CHAIN_APPROX_TC89_KCOS ||
+        image.type() != CV_8UC1 || getNumThreads() <= 1 || image.total() < (size_t)CONTOURS_PARALLEL_MIN_AREA )
+        return false;
+
+    int rows = image.rows, width = image.cols;
+    int nbands = std::min(std::max(rows/CONTOURS_BAND_MIN_HEIGHT, 1), getNumThreads()*4);
+    int bandHeight = (rows + nbands - 1)/nbands;
+    nbands = (rows + bandHeight - 1)/bandHeight;
+
+    std::vector<ContourRuns> bands(nbands);
+    parallel_for_(Range(0, nbands), ContourRunsInvoker(image, bandHeight, bands));
+
+    /* gather the bands and merge the labels at the seams */
+    ContourRuns runs;
+    size_t nruns = 0;
+    for( int b = 0; b < nbands; b++ )
+        nruns += bands[b].xs.size();
+    runs.xs.reserve(nruns);
+    runs.parent.reserve(nruns);
+    runs.rowOfs.reserve(rows + 1);
+    for( int b = 0; b < nbands; b++ )
+    {
+        ContourRuns& band = bands[b];
+        int ofs = (int)runs.xs.size();
+        runs.xs.insert(runs.xs.end(), band.xs.begin(), band.xs.end());
+        for( size_t i = 0; i < band.parent.size(); i++ )
+            runs.parent.push_back(band.parent[i] + ofs);
+        for( size_t y = 0; y + 1 < band.rowOfs.size(); y++ )
+            runs.rowOfs.push_back(band.rowOfs[y] + ofs);
+        std::vector<int>().swap(band.xs);
+        std::vector<int>().swap(band.parent);
+    }
+    runs.rowOfs.push_back((int)runs.xs.size());
+
+    for( int b = 1; b < nbands; b++ )
+    {
+        int y = b*bandHeight;
+        linkRunRows( &runs.xs[0], &runs.parent[0], runs.rowOfs[y - 1], runs.rowOfs[y],
+                     runs.rowOfs[y], runs.rowOfs[y + 1], width );
+    }
+
+    std::vector<std::vector<ContourStart> > bandStarts(nbands);
+    parallel_for_(Range(0, nbands), ContourStartsInvoker(runs, bandHeight, rows, mode, bandStarts));
+
+    /* the contours in the order they are met by the sequential scanner */
+    std::vector<ContourStart> starts;
+    for( int b = 0; b < nbands; b++ )
+        starts.insert(starts.end(), bandStarts[b].begin(), bandStarts[b].end());
+    std::vector<std::vector<ContourStart> >().swap(bandStarts);
+    std::vector<int>().swap(runs.xs);
+    std::vector<int>().swap(runs.parent);
+
+    int total = (int)starts.size();
+    if( total == 0 )
+    {
+        _contours.clear();
+        return true;
+    }
+
+    /* the output order and the hierarchy, as built by cvInsertNodeIntoTree and cvTreeToNodeSeq:
+       every new contour becomes the first child of its parent */
+    std::vector<int> order(total);
+    std::vector<Vec4i> hierarchy(total, Vec4i(-1, -1, -1, -1));
+    if( mode != CV_RETR_CCOMP )
+    {
+        for( int i = 0; i < total; i++ )
+        {
+            order[i] = total - 1 - i;
+            hierarchy[i] = Vec4i(i + 1 < total ? i + 1 : -1, i - 1, -1, -1);
+        }
+    }
+    else
+    {
+        std::vector<int> outerRuns, outerIdx, firstHole, nextHole(total, -1);
+        for( int i = 0; i < total; i++ )
+            if( !starts[i].isHole )
+            {
+                outerRuns.push_back(starts[i].run);
+                outerIdx.push_back(i);
+            }
+        firstHole.resize(outerIdx.size(), -1);
+        for( int i = 0; i < total; i++ )
+            if( starts[i].isHole )
+            {
+                int k = (int)(std::lower_bound(outerRuns.begin(), outerRuns.end(), starts[i].parent) - outerRuns.begin());
+                CV_Assert( k < (int)outerRuns.size() && outerRuns[k] == starts[i].parent );
+                nextHole[i] = firstHole[k];
+                firstHole[k] = i;
+            }
+
+        int n = 0, prevOuter = -1;
+        for( int k = (int)outerIdx.size() - 1; k >= 0; k-- )
+        {
+            int outer = n++;
+            order[outer] = outerIdx[k];
+            hierarchy[outer][1] = prevOuter;
+            if( prevOuter >= 0 )
+                hierarchy[prevOuter][0] = outer;
+            prevOuter = outer;
+
+            for( int h = firstHole[k], prevHole = -1; h >= 0; h = nextHole[h] )
+            {
+                int hole = n++;
+                order[hole] = h;
+                hierarchy[hole][1] = prevHole;
+                hierarchy[hole][3] = outer;
+                if( prevHole >= 0 )
+                    hierarchy[prevHole][0] = hole;
+                else
+                    hierarchy[outer][2] = hole;
+                prevHole = hole;
+            }
+        }
+    }
+
+    std::vector<std::vector<Point> > points(total);
+    parallel_for_(Range(0, total), ContourTraceInvoker(image, starts, order, method, offset, points),
+                  getNumThreads()*4);
+
+    _contours.create(total, 1, 0, -1, true);
+    for( int i = 0; i < total; i++ )
+    {
+        _contours.create((int)points[i].size(), 1, CV_32SC2, i, true);
+        Mat ci = _contours.getMat(i);
+        CV_Assert( ci.isContinuous() );
+        if( !points[i].empty() )
+            memcpy( ci.ptr(), &points[i][0], points[i].size()*sizeof(Point) );
+    }
+
+    if( _hierarchy.needed() )
+    {
+        _hierarchy.create(1, total, CV_32SC4, -1, true);
+        Mat(hierarchy).reshape(4, 1).copyTo(_hierarchy.getMat());
+    }
+    return true;
+}
+
+}
+
 void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
                    OutputArray _hierarchy, int mode, int method, Point offset )
 {
@@ -1888,6 +2357,8 @@ void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
     CvSeq* _ccontours = 0;
     if( _hierarchy.needed() )
         _hierarchy.clear();
+    if( findContoursParallel(image, _contours, _hierarchy, mode, method, offset + Point(-1, -1)) )
+        return;
     cvFindContours_Impl(&_cimage, storage, &_ccontours, sizeof(CvContour), mode, method, offset + Point(-1, -1), 0);
     if( !_ccontours )
     {
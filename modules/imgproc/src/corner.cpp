@@ -342,46 +342,15 @@ static void calcEigenValsVecs( const Mat& _cov, Mat& _dst )
 enum { MINEIGENVAL=0, HARRIS=1, EIGENVALSVECS=2 };
 
 
-static void
-cornerEigenValsVecs( const Mat& src, Mat& eigenv, int block_size,
-                     int aperture_size, int op_type, double k=0.,
-                     int borderType=BORDER_DEFAULT )
+static void calcCovariation( const Mat& Dx, const Mat& Dy, Mat& cov )
 {
-#ifdef HAVE_TEGRA_OPTIMIZATION
-    if (tegra::useTegra() && tegra::cornerEigenValsVecs(src, eigenv, block_size, aperture_size, op_type, k, borderType))
-        return;
-#endif
 #if CV_AVX
     bool haveAvx = checkHardwareSupport(CV_CPU_AVX);
 #endif
 #if CV_SIMD128
     bool haveSimd = hasSIMD128();
 #endif
-
-    int depth = src.depth();
-    double scale = (double)(1 << ((aperture_size > 0 ? aperture_size : 3) - 1)) * block_size;
-    if( aperture_size < 0 )
-        scale *= 2.0;
-    if( depth == CV_8U )
-        scale *= 255.0;
-    scale = 1.0/scale;
-
-    CV_Assert( src.type() == CV_8UC1 || src.type() == CV_32FC1 );
-
-    Mat Dx, Dy;
-    if( aperture_size > 0 )
-    {
-        Sobel( src, Dx, CV_32F, 1, 0, aperture_size, scale, 0, borderType );
-        Sobel( src, Dy, CV_32F, 0, 1, aperture_size, scale, 0, borderType );
-    }
-    else
-    {
-        Scharr( src, Dx, CV_32F, 1, 0, scale, 0, borderType );
-        Scharr( src, Dy, CV_32F, 0, 1, scale, 0, borderType );
-    }
-
-    Size size = src.size();
-    Mat cov( size, CV_32FC3 );
+    Size size = Dx.size();
     int i, j;
 
     for( i = 0; i < size.height; i++ )
@@ -437,16 +406,104 @@ cornerEigenValsVecs( const Mat& src, Mat& eigenv, int block_size,
             cov_data[j*3+2] = dy*dy;
         }
     }
+}
 
-    boxFilter(cov, cov, cov.depth(), Size(block_size, block_size),
+// computes the rows [y0, y1) of the response. The derivatives and the covariation matrices
+// are computed for the band extended by the box filter radius, and both filters read the
+// neighbor rows through the ROI, so a band matches the whole image up to the rounding of the
+// running box filter sums.
+static void
+cornerEigenValsVecsBand( const Mat& src, Mat& eigenv, int y0, int y1, int block_size,
+                         int aperture_size, int op_type, double k, int borderType, double scale )
+{
+    int Y0 = std::max(y0 - block_size, 0), Y1 = std::min(y1 + block_size, src.rows);
+    Mat srcBand = src.rowRange(Y0, Y1), Dx, Dy;
+
+    if( aperture_size > 0 )
+    {
+        Sobel( srcBand, Dx, CV_32F, 1, 0, aperture_size, scale, 0, borderType );
+        Sobel( srcBand, Dy, CV_32F, 0, 1, aperture_size, scale, 0, borderType );
+    }
+    else
+    {
+        Scharr( srcBand, Dx, CV_32F, 1, 0, scale, 0, borderType );
+        Scharr( srcBand, Dy, CV_32F, 0, 1, scale, 0, borderType );
+    }
+
+    Mat cov( Dx.size(), CV_32FC3 ), bcov;
+    calcCovariation( Dx, Dy, cov );
+
+    boxFilter(cov.rowRange(y0 - Y0, y1 - Y0), bcov, cov.depth(), Size(block_size, block_size),
         Point(-1,-1), false, borderType );
 
+    Mat dst = eigenv.rowRange(y0, y1);
     if( op_type == MINEIGENVAL )
-        calcMinEigenVal( cov, eigenv );
+        calcMinEigenVal( bcov, dst );
     else if( op_type == HARRIS )
-        calcHarris( cov, eigenv, k );
+        calcHarris( bcov, dst, k );
     else if( op_type == EIGENVALSVECS )
-        calcEigenValsVecs( cov, eigenv );
+        calcEigenValsVecs( bcov, dst );
+}
+
+class CornerEigenValsVecsInvoker : public ParallelLoopBody
+{
+public:
+    enum { BAND = 128 };
+
+    CornerEigenValsVecsInvoker( const Mat& _src, Mat& _eigenv, int _block_size, int _aperture_size,
+                                int _op_type, double _k, int _borderType, double _scale ) :
+        src(&_src), eigenv(&_eigenv), block_size(_block_size), aperture_size(_aperture_size),
+        op_type(_op_type), k(_k), borderType(_borderType), scale(_scale) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int b = range.start; b < range.end; b++ )
+            cornerEigenValsVecsBand( *src, *eigenv, b*BAND, std::min((b + 1)*BAND, src->rows),
+                                     block_size, aperture_size, op_type, k, borderType, scale );
+    }
+
+private:
+    const Mat* src;
+    Mat* eigenv;
+    int block_size, aperture_size, op_type;
+    double k;
+    int borderType;
+    double scale;
+};
+
+static void
+cornerEigenValsVecs( const Mat& src, Mat& eigenv, int block_size,
+                     int aperture_size, int op_type, double k=0.,
+                     int borderType=BORDER_DEFAULT )
+{
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    if (tegra::useTegra() && tegra::cornerEigenValsVecs(src, eigenv, block_size, aperture_size, op_type, k, borderType))
+        return;
+#endif
+
+    int depth = src.depth();
+    double scale = (double)(1 << ((aperture_size > 0 ? aperture_size : 3) - 1)) * block_size;
+    if( aperture_size < 0 )
+        scale *= 2.0;
+    if( depth == CV_8U )
+        scale *= 255.0;
+    scale = 1.0/scale;
+
+    CV_Assert( src.type() == CV_8UC1 || src.type() == CV_32FC1 );
+
+    // the image is processed in bands of fixed height, so the result does not depend on the
+    // number of threads. With BORDER_ISOLATED the bands must still see each other's rows,
+    // so they are taken from a header that does not know about the parent image.
+    Mat img = src;
+    if( borderType & BORDER_ISOLATED )
+    {
+        img = Mat(src.size(), src.type(), (void*)src.data, src.step);
+        borderType &= ~BORDER_ISOLATED;
+    }
+
+    int nbands = (img.rows + CornerEigenValsVecsInvoker::BAND - 1)/CornerEigenValsVecsInvoker::BAND;
+    parallel_for_(Range(0, nbands), CornerEigenValsVecsInvoker(img, eigenv, block_size, aperture_size,
+                                                               op_type, k, borderType, scale));
 }
 
 #ifdef HAVE_OPENCL
@@ -60,6 +60,76 @@ struct greaterThanPtr :
     { return (*a > *b) ? true : (*a < *b) ? false : (a > b); }
 };
 
+// at most maxCorners*GFTT_SELECT_FACTOR candidates are sorted at first
+enum { GFTT_SELECT_FACTOR = 4 };
+
+// collects the non-zero local maxima of the thresholded response in bands of rows,
+// the same points that are left by the comparison with the dilated image
+class GFTTCandidatesInvoker : public ParallelLoopBody
+{
+public:
+    enum { BAND = 64 };
+
+    GFTTCandidatesInvoker( const Mat& _eig, const Mat& _mask, std::vector<std::vector<const float*> >& _bands ) :
+        eig(&_eig), mask(&_mask), bands(&_bands) {}
+
+    void operator()( const Range& range ) const
+    {
+        int width = eig->cols;
+        size_t step = eig->step/sizeof(float);
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            std::vector<const float*>& corners = (*bands)[b];
+            int y0 = 1 + b*BAND, y1 = std::min(y0 + BAND, eig->rows - 1);
+
+            for( int y = y0; y < y1; y++ )
+            {
+                const float* eig_data = eig->ptr<float>(y);
+                const uchar* mask_data = mask->data ? mask->ptr(y) : 0;
+
+                for( int x = 1; x < width - 1; x++ )
+                {
+                    const float* p = eig_data + x;
+                    float val = *p;
+                    if( val != 0 && (!mask_data || mask_data[x]) &&
+                        val >= p[-1] && val >= p[1] &&
+                        val >= p[-1-step] && val >= p[-step] && val >= p[1-step] &&
+                        val >= p[-1+step] && val >= p[step] && val >= p[1+step] )
+                        corners.push_back(p);
+                }
+            }
+        }
+    }
+
+private:
+    const Mat* eig;
+    const Mat* mask;
+    std::vector<std::vector<const float*> >* bands;
+};
+
+// moves the strongest candidates of every band to the band head
+class GFTTSelectInvoker : public ParallelLoopBody
+{
+public:
+    GFTTSelectInvoker( std::vector<std::vector<const float*> >& _bands, size_t _limit ) :
+        bands(&_bands), limit(_limit) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int b = range.start; b < range.end; b++ )
+        {
+            std::vector<const float*>& corners = (*bands)[b];
+            if( corners.size() > limit )
+                std::nth_element( corners.begin(), corners.begin() + limit, corners.end(), greaterThanPtr() );
+        }
+    }
+
+private:
+    std::vector<std::vector<const float*> >* bands;
+    size_t limit;
+};
+
 #ifdef HAVE_OPENCL
 
 struct Corner
@@ -369,7 +439,7 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
                ocl_goodFeaturesToTrack(_image, _corners, maxCorners, qualityLevel, minDistance,
                                     _mask, blockSize, useHarrisDetector, harrisK))
 
-    Mat image = _image.getMat(), eig, tmp;
+    Mat image = _image.getMat(), eig;
     if (image.empty())
     {
         _corners.release();
@@ -389,29 +459,19 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
     double maxVal = 0;
     minMaxLoc( eig, 0, &maxVal, 0, 0, _mask );
     threshold( eig, eig, maxVal*qualityLevel, 0, THRESH_TOZERO );
-    dilate( eig, tmp, Mat());
 
-    Size imgsize = image.size();
-    std::vector<const float*> tmpCorners;
-
-    // collect list of pointers to features - put them into temporary image
+    // collect the local maxima band by band
     Mat mask = _mask.getMat();
-    for( int y = 1; y < imgsize.height - 1; y++ )
-    {
-        const float* eig_data = (const float*)eig.ptr(y);
-        const float* tmp_data = (const float*)tmp.ptr(y);
-        const uchar* mask_data = mask.data ? mask.ptr(y) : 0;
-
-        for( int x = 1; x < imgsize.width - 1; x++ )
-        {
-            float val = eig_data[x];
-            if( val != 0 && val == tmp_data[x] && (!mask_data || mask_data[x]) )
-                tmpCorners.push_back(eig_data + x);
-        }
-    }
+    int nbands = (std::max(image.rows - 2, 0) + GFTTCandidatesInvoker::BAND - 1)/GFTTCandidatesInvoker::BAND;
+    std::vector<std::vector<const float*> > bands(nbands);
+    parallel_for_(Range(0, nbands), GFTTCandidatesInvoker(eig, mask, bands));
 
+    std::vector<const float*> tmpCorners;
     std::vector<Point2f> corners;
-    size_t i, j, total = tmpCorners.size(), ncorners = 0;
+    size_t i, j, b, total = 0, ncorners = 0;
+
+    for( b = 0; b < bands.size(); b++ )
+        total += bands[b].size();
 
     if (total == 0)
     {
@@ -419,23 +479,43 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
         return;
     }
 
-    std::sort( tmpCorners.begin(), tmpCorners.end(), greaterThanPtr() );
+    // Partition the image into larger grids
+    int w = image.cols;
+    int h = image.rows;
+
+    const int cell_size = minDistance >= 1 ? cvRound(minDistance) : 1;
+    const int grid_width = (w + cell_size - 1) / cell_size;
+    const int grid_height = (h + cell_size - 1) / cell_size;
 
+    std::vector<std::vector<Point2f> > grid;
     if (minDistance >= 1)
-    {
-         // Partition the image into larger grids
-        int w = image.cols;
-        int h = image.rows;
+        grid.resize(grid_width*grid_height);
 
-        const int cell_size = cvRound(minDistance);
-        const int grid_width = (w + cell_size - 1) / cell_size;
-        const int grid_height = (h + cell_size - 1) / cell_size;
+    minDistance *= minDistance;
 
-        std::vector<std::vector<Point2f> > grid(grid_width*grid_height);
+    // Only the strongest candidates are sorted. If the min distance test rejects too many of
+    // them, the selection is repeated with a larger limit; its head is the same as before,
+    // so the scan continues from where it stopped.
+    size_t limit = maxCorners > 0 ? std::min(total, (size_t)maxCorners*GFTT_SELECT_FACTOR) : total;
+    i = 0;
 
-        minDistance *= minDistance;
+    for(;;)
+    {
+        tmpCorners.clear();
+        if( limit < total )
+            parallel_for_(Range(0, nbands), GFTTSelectInvoker(bands, limit));
+        for( b = 0; b < bands.size(); b++ )
+            tmpCorners.insert(tmpCorners.end(), bands[b].begin(),
+                              bands[b].begin() + std::min(bands[b].size(), limit));
+
+        if( limit < total )
+        {
+            std::nth_element( tmpCorners.begin(), tmpCorners.begin() + limit, tmpCorners.end(), greaterThanPtr() );
+            tmpCorners.resize(limit);
+        }
+        std::sort( tmpCorners.begin(), tmpCorners.end(), greaterThanPtr() );
 
-        for( i = 0; i < total; i++ )
+        for( ; i < tmpCorners.size(); i++ )
         {
             int ofs = (int)((const uchar*)tmpCorners[i] - eig.ptr());
             int y = (int)(ofs / eig.step);
@@ -446,46 +526,50 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
             int x_cell = x / cell_size;
             int y_cell = y / cell_size;
 
-            int x1 = x_cell - 1;
-            int y1 = y_cell - 1;
-            int x2 = x_cell + 1;
-            int y2 = y_cell + 1;
-
-            // boundary check
-            x1 = std::max(0, x1);
-            y1 = std::max(0, y1);
-            x2 = std::min(grid_width-1, x2);
-            y2 = std::min(grid_height-1, y2);
-
-            for( int yy = y1; yy <= y2; yy++ )
+            if (!grid.empty())
             {
-                for( int xx = x1; xx <= x2; xx++ )
+                int x1 = x_cell - 1;
+                int y1 = y_cell - 1;
+                int x2 = x_cell + 1;
+                int y2 = y_cell + 1;
+
+                // boundary check
+                x1 = std::max(0, x1);
+                y1 = std::max(0, y1);
+                x2 = std::min(grid_width-1, x2);
+                y2 = std::min(grid_height-1, y2);
+
+                for( int yy = y1; yy <= y2; yy++ )
                 {
-                    std::vector <Point2f> &m = grid[yy*grid_width + xx];
-
-                    if( m.size() )
+                    for( int xx = x1; xx <= x2; xx++ )
                     {
-                        for(j = 0; j < m.size(); j++)
-                        {
-                            float dx = x - m[j].x;
-                            float dy = y - m[j].y;
+                        std::vector <Point2f> &m = grid[yy*grid_width + xx];
 
-                            if( dx*dx + dy*dy < minDistance )
+                        if( m.size() )
+                        {
+                            for(j = 0; j < m.size(); j++)
                             {
-                                good = false;
-                                goto break_out;
+                                float dx = x - m[j].x;
+                                float dy = y - m[j].y;
+
+                                if( dx*dx + dy*dy < minDistance )
+                                {
+                                    good = false;
+                                    goto break_out;
+                                }
                             }
                         }
                     }
                 }
-            }
 
-            break_out:
+                break_out:
+
+                if (good)
+                    grid[y_cell*grid_width + x_cell].push_back(Point2f((float)x, (float)y));
+            }
 
             if (good)
             {
-                grid[y_cell*grid_width + x_cell].push_back(Point2f((float)x, (float)y));
-
                 corners.push_back(Point2f((float)x, (float)y));
                 ++ncorners;
 
@@ -493,20 +577,10 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
                     break;
             }
         }
-    }
-    else
-    {
-        for( i = 0; i < total; i++ )
-        {
-            int ofs = (int)((const uchar*)tmpCorners[i] - eig.ptr());
-            int y = (int)(ofs / eig.step);
-            int x = (int)((ofs - y*eig.step)/sizeof(float));
 
-            corners.push_back(Point2f((float)x, (float)y));
-            ++ncorners;
-            if( maxCorners > 0 && (int)ncorners == maxCorners )
-                break;
-        }
+        if( (maxCorners > 0 && (int)ncorners == maxCorners) || limit == total )
+            break;
+        limit = std::min(total, limit*4);
     }
 
     Mat(corners).convertTo(_corners, _corners.fixedType() ? _corners.type() : CV_32F);
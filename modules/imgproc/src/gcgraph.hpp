@@ -52,7 +52,7 @@ public:
     int addVtx();
     void addEdges( int i, int j, TWeight w, TWeight revw );
     void addTermWeights( int i, TWeight sourceW, TWeight sinkW );
-    TWeight maxFlow();
+    TWeight maxFlow( bool reuseTrees = false );
     bool inSourceSegment( int i );
 private:
     class Vtx
@@ -65,6 +65,7 @@ private:
         int dist;
         TWeight weight;
         uchar t;
+        uchar changed; // the terminal weights are modified after maxFlow()
     };
     class Edge
     {
@@ -76,13 +77,18 @@ private:
 
     std::vector<Vtx> vtcs;
     std::vector<Edge> edges;
+    std::vector<int> changedVtcs;
     TWeight flow;
+    int currTs;
+    bool solved;
 };
 
 template <class TWeight>
 GCGraph<TWeight>::GCGraph()
 {
     flow = 0;
+    currTs = 0;
+    solved = false;
 }
 template <class TWeight>
 GCGraph<TWeight>::GCGraph( unsigned int vtxCount, unsigned int edgeCount )
@@ -99,6 +105,8 @@ void GCGraph<TWeight>::create( unsigned int vtxCount, unsigned int edgeCount )
     vtcs.reserve( vtxCount );
     edges.reserve( edgeCount + 2 );
     flow = 0;
+    currTs = 0;
+    solved = false;
 }
 
 template <class TWeight>
@@ -147,40 +155,111 @@ void GCGraph<TWeight>::addTermWeights( int i, TWeight sourceW, TWeight sinkW )
         sinkW -= dw;
     flow += (sourceW < sinkW) ? sourceW : sinkW;
     vtcs[i].weight = sourceW - sinkW;
+
+    // the vertex is revisited by the next maxFlow( true )
+    if( solved && !vtcs[i].changed )
+    {
+        vtcs[i].changed = 1;
+        changedVtcs.push_back(i);
+    }
 }
 
 template <class TWeight>
-TWeight GCGraph<TWeight>::maxFlow()
+TWeight GCGraph<TWeight>::maxFlow( bool reuseTrees )
 {
     const int TERMINAL = -1, ORPHAN = -2;
     Vtx stub, *nilNode = &stub, *first = nilNode, *last = nilNode;
-    int curr_ts = 0;
     stub.next = nilNode;
     Vtx *vtxPtr = &vtcs[0];
     Edge *edgePtr = &edges[0];
 
     std::vector<Vtx*> orphans;
 
-    // initialize the active queue and the graph vertices
-    for( int i = 0; i < (int)vtcs.size(); i++ )
+    if( !reuseTrees || !solved )
     {
-        Vtx* v = vtxPtr + i;
-        v->ts = 0;
-        if( v->weight != 0 )
+        // saturate the paths source -> i -> j -> sink in one pass, before the search trees are built
+        for( int i = 0; i < (int)vtcs.size(); i++ )
+        {
+            Vtx* v = vtxPtr + i;
+            for( int ei = v->first; ei != 0 && v->weight > 0; ei = edgePtr[ei].next )
+            {
+                Vtx* u = vtxPtr+edgePtr[ei].dst;
+                TWeight w = edgePtr[ei].weight;
+                if( u->weight >= 0 || w == 0 )
+                    continue;
+                w = std::min(w, std::min(v->weight, -u->weight));
+                edgePtr[ei].weight -= w;
+                edgePtr[ei^1].weight += w;
+                v->weight -= w;
+                u->weight += w;
+                flow += w;
+            }
+        }
+
+        // initialize the active queue and the graph vertices
+        currTs = 0;
+        for( int i = 0; i < (int)vtcs.size(); i++ )
         {
+            Vtx* v = vtxPtr + i;
+            v->ts = 0;
+            v->changed = 0;
+            if( v->weight != 0 )
+            {
+                last = last->next = v;
+                v->dist = 1;
+                v->parent = TERMINAL;
+                v->t = v->weight < 0;
+            }
+            else
+                v->parent = 0;
+        }
+    }
+    else
+    {
+        // keep the flow and the search trees of the previous call, and fix them
+        // around the vertices with the modified terminal weights only
+        for( size_t k = 0; k < changedVtcs.size(); k++ )
+        {
+            Vtx* v = vtxPtr + changedVtcs[k];
+            v->changed = 0;
+            if( v->weight == 0 )
+            {
+                if( v->parent )
+                {
+                    orphans.push_back(v);
+                    v->parent = ORPHAN;
+                }
+                continue;
+            }
+
+            uchar vt = v->weight < 0;
+            if( v->parent && v->t != vt )
+            {
+                // the vertex moves to the other tree, its subtree is cut off;
+                // the changed children are handled by this loop later
+                for( int ei = v->first; ei != 0; ei = edgePtr[ei].next )
+                {
+                    Vtx* u = vtxPtr+edgePtr[ei].dst;
+                    if( u->parent == (ei^1) && !u->changed )
+                    {
+                        orphans.push_back(u);
+                        u->parent = ORPHAN;
+                    }
+                }
+            }
             last = last->next = v;
+            v->ts = currTs;
             v->dist = 1;
             v->parent = TERMINAL;
-            v->t = v->weight < 0;
+            v->t = vt;
         }
-        else
-            v->parent = 0;
     }
+    changedVtcs.clear();
     first = first->next;
     last->next = nilNode;
     nilNode->next = 0;
 
-    // run the search-path -> augment-graph -> restore-trees loop
+    // run the restore-trees -> search-path -> augment-graph loop
     for(;;)
     {
         Vtx* v, *u;
@@ -188,6 +267,96 @@ TWeight GCGraph<TWeight>::maxFlow()
         TWeight minWeight, weight;
         uchar vt;
 
+        // restore the search trees by finding new parents for the orphans
+        currTs++;
+        for( size_t oi = 0; oi < orphans.size(); oi++ )
+        {
+            Vtx* v2 = orphans[oi];
+
+            int d, minDist = INT_MAX;
+            e0 = 0;
+            vt = v2->t;
+
+            for( ei = v2->first; ei != 0; ei = edgePtr[ei].next )
+            {
+                if( edgePtr[ei^(vt^1)].weight == 0 )
+                    continue;
+                u = vtxPtr+edgePtr[ei].dst;
+                if( u->t != vt || u->parent == 0 )
+                    continue;
+                // compute the distance to the tree root
+                for( d = 0;; )
+                {
+                    if( u->ts == currTs )
+                    {
+                        d += u->dist;
+                        break;
+                    }
+                    ej = u->parent;
+                    d++;
+                    if( ej < 0 )
+                    {
+                        if( ej == ORPHAN )
+                            d = INT_MAX-1;
+                        else
+                        {
+                            u->ts = currTs;
+                            u->dist = 1;
+                        }
+                        break;
+                    }
+                    u = vtxPtr+edgePtr[ej].dst;
+                }
+
+                // update the distance
+                if( ++d < INT_MAX )
+                {
+                    if( d < minDist )
+                    {
+                        minDist = d;
+                        e0 = ei;
+                    }
+                    for( u = vtxPtr+edgePtr[ei].dst; u->ts != currTs; u = vtxPtr+edgePtr[u->parent].dst )
+                    {
+                        u->ts = currTs;
+                        u->dist = --d;
+                    }
+                }
+            }
+
+            if( (v2->parent = e0) > 0 )
+            {
+                v2->ts = currTs;
+                v2->dist = minDist;
+                continue;
+            }
+
+            /* no parent is found */
+            v2->ts = 0;
+            for( ei = v2->first; ei != 0; ei = edgePtr[ei].next )
+            {
+                u = vtxPtr+edgePtr[ei].dst;
+                ej = u->parent;
+                if( !ej )
+                    continue;
+                // the neighbors of both trees that can adopt the vertex are activated:
+                // with the reused trees the passive vertices of the other tree are not
+                // revisited otherwise, and the vertex would stay free
+                if( edgePtr[ei^(u->t^1)].weight && !u->next )
+                {
+                    u->next = nilNode;
+                    last = last->next = u;
+                }
+                if( u->t == vt && ej > 0 && vtxPtr+edgePtr[ej].dst == v2 )
+                {
+                    orphans.push_back(u);
+                    u->parent = ORPHAN;
+                }
+            }
+        }
+        orphans.clear();
+        e0 = -1;
+
         // grow S & T search trees, find an edge connecting them
         while( first != nilNode )
         {
@@ -286,92 +455,8 @@ TWeight GCGraph<TWeight>::maxFlow()
             }
         }
 
-        // restore the search trees by finding new parents for the orphans
-        curr_ts++;
-        while( !orphans.empty() )
-        {
-            Vtx* v2 = orphans.back();
-            orphans.pop_back();
-
-            int d, minDist = INT_MAX;
-            e0 = 0;
-            vt = v2->t;
-
-            for( ei = v2->first; ei != 0; ei = edgePtr[ei].next )
-            {
-                if( edgePtr[ei^(vt^1)].weight == 0 )
-                    continue;
-                u = vtxPtr+edgePtr[ei].dst;
-                if( u->t != vt || u->parent == 0 )
-                    continue;
-                // compute the distance to the tree root
-                for( d = 0;; )
-                {
-                    if( u->ts == curr_ts )
-                    {
-                        d += u->dist;
-                        break;
-                    }
-                    ej = u->parent;
-                    d++;
-                    if( ej < 0 )
-                    {
-                        if( ej == ORPHAN )
-                            d = INT_MAX-1;
-                        else
-                        {
-                            u->ts = curr_ts;
-                            u->dist = 1;
-                        }
-                        break;
-                    }
-                    u = vtxPtr+edgePtr[ej].dst;
-                }
-
-                // update the distance
-                if( ++d < INT_MAX )
-                {
-                    if( d < minDist )
-                    {
-                        minDist = d;
-                        e0 = ei;
-                    }
-                    for( u = vtxPtr+edgePtr[ei].dst; u->ts != curr_ts; u = vtxPtr+edgePtr[u->parent].dst )
-                    {
-                        u->ts = curr_ts;
-                        u->dist = --d;
-                    }
-                }
-            }
-
-            if( (v2->parent = e0) > 0 )
-            {
-                v2->ts = curr_ts;
-                v2->dist = minDist;
-                continue;
-            }
-
-            /* no parent is found */
-            v2->ts = 0;
-            for( ei = v2->first; ei != 0; ei = edgePtr[ei].next )
-            {
-                u = vtxPtr+edgePtr[ei].dst;
-                ej = u->parent;
-                if( u->t != vt || !ej )
-                    continue;
-                if( edgePtr[ei^(vt^1)].weight && !u->next )
-                {
-                    u->next = nilNode;
-                    last = last->next = u;
-                }
-                if( ej > 0 && vtxPtr+edgePtr[ej].dst == v2 )
-                {
-                    orphans.push_back(u);
-                    u->parent = ORPHAN;
-                }
-            }
-        }
     }
+    solved = true;
     return flow;
 }
 
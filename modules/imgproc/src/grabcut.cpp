@@ -51,21 +51,38 @@ This is implementation of image segmentation algorithm GrabCut described in
 Carsten Rother, Vladimir Kolmogorov, Andrew Blake.
  */
 
+/*
+ Sums of the samples of GMM components
+*/
+struct GMMSampleSums
+{
+    enum { componentsCount = 5 };
+
+    void clear();
+    void addSample( int ci, const Vec3b color );
+
+    double sums[componentsCount][3];
+    double prods[componentsCount][3][3];
+    int sampleCounts[componentsCount];
+};
+
 /*
  GMM - Gaussian Mixture Model
 */
 class GMM
 {
 public:
-    static const int componentsCount = 5;
+    static const int componentsCount = GMMSampleSums::componentsCount;
 
     GMM( Mat& _model );
     double operator()( const Vec3d color ) const;
     double operator()( int ci, const Vec3d color ) const;
+    double operator()( const Vec3d color, int& k ) const;
     int whichComponent( const Vec3d color ) const;
 
     void initLearning();
     void addSample( int ci, const Vec3d color );
+    void addSamples( const GMMSampleSums& samples );
     void endLearning();
 
 private:
@@ -131,6 +148,26 @@ double GMM::operator()( int ci, const Vec3d color ) const
     return res;
 }
 
+/*
+  The same as operator()( color ) and whichComponent( color ) in one pass.
+*/
+double GMM::operator()( const Vec3d color, int& k ) const
+{
+    double res = 0, max = 0;
+    k = 0;
+    for( int ci = 0; ci < componentsCount; ci++ )
+    {
+        double p = (*this)( ci, color );
+        res += coefs[ci] * p;
+        if( p > max )
+        {
+            k = ci;
+            max = p;
+        }
+    }
+    return res;
+}
+
 int GMM::whichComponent( const Vec3d color ) const
 {
     int k = 0;
@@ -171,6 +208,21 @@ void GMM::addSample( int ci, const Vec3d color )
     totalSampleCount++;
 }
 
+void GMM::addSamples( const GMMSampleSums& samples )
+{
+    for( int ci = 0; ci < componentsCount; ci++ )
+    {
+        for( int i = 0; i < 3; i++ )
+        {
+            sums[ci][i] += samples.sums[ci][i];
+            for( int j = 0; j < 3; j++ )
+                prods[ci][i][j] += samples.prods[ci][i][j];
+        }
+        sampleCounts[ci] += samples.sampleCounts[ci];
+        totalSampleCount += samples.sampleCounts[ci];
+    }
+}
+
 void GMM::endLearning()
 {
     const double variance = 0.01;
@@ -205,6 +257,23 @@ void GMM::endLearning()
     }
 }
 
+void GMMSampleSums::clear()
+{
+    memset( sums, 0, sizeof(sums) );
+    memset( prods, 0, sizeof(prods) );
+    memset( sampleCounts, 0, sizeof(sampleCounts) );
+}
+
+void GMMSampleSums::addSample( int ci, const Vec3b color )
+{
+    double c0 = color[0], c1 = color[1], c2 = color[2];
+    sums[ci][0] += c0; sums[ci][1] += c1; sums[ci][2] += c2;
+    prods[ci][0][0] += c0*c0; prods[ci][0][1] += c0*c1; prods[ci][0][2] += c0*c2;
+    prods[ci][1][0] += c1*c0; prods[ci][1][1] += c1*c1; prods[ci][1][2] += c1*c2;
+    prods[ci][2][0] += c2*c0; prods[ci][2][1] += c2*c1; prods[ci][2][2] += c2*c2;
+    sampleCounts[ci]++;
+}
+
 void GMM::calcInverseCovAndDeterm( int ci )
 {
     if( coefs[ci] > 0 )
@@ -268,54 +337,77 @@ static double calcBeta( const Mat& img )
     return beta;
 }
 
+// the rows of the image processed by one task of the parallel loops
+enum { GRABCUT_BAND = 16 };
+
 /*
   Calculate weights of noterminal vertices of graph.
   beta and gamma - parameters of GrabCut algorithm.
  */
-static void calcNWeights( const Mat& img, Mat& leftW, Mat& upleftW, Mat& upW, Mat& uprightW, double beta, double gamma )
+class CalcNWeightsInvoker : public ParallelLoopBody
+{
+public:
+    CalcNWeightsInvoker( const Mat& _img, Mat& _leftW, Mat& _upleftW, Mat& _upW, Mat& _uprightW, double _beta, double _gamma ) :
+        img(&_img), leftW(&_leftW), upleftW(&_upleftW), upW(&_upW), uprightW(&_uprightW), beta(_beta), gamma(_gamma) {}
+
+    void operator()( const Range& range ) const;
+
+private:
+    const Mat* img;
+    Mat *leftW, *upleftW, *upW, *uprightW;
+    double beta, gamma;
+};
+
+void CalcNWeightsInvoker::operator()( const Range& range ) const
 {
     const double gammaDivSqrt2 = gamma / std::sqrt(2.0f);
-    leftW.create( img.rows, img.cols, CV_64FC1 );
-    upleftW.create( img.rows, img.cols, CV_64FC1 );
-    upW.create( img.rows, img.cols, CV_64FC1 );
-    uprightW.create( img.rows, img.cols, CV_64FC1 );
-    for( int y = 0; y < img.rows; y++ )
+    for( int y = range.start; y < range.end; y++ )
     {
-        for( int x = 0; x < img.cols; x++ )
+        for( int x = 0; x < img->cols; x++ )
         {
-            Vec3d color = img.at<Vec3b>(y,x);
+            Vec3d color = img->at<Vec3b>(y,x);
             if( x-1>=0 ) // left
             {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y,x-1);
-                leftW.at<double>(y,x) = gamma * exp(-beta*diff.dot(diff));
+                Vec3d diff = color - (Vec3d)img->at<Vec3b>(y,x-1);
+                leftW->at<double>(y,x) = gamma * exp(-beta*diff.dot(diff));
             }
             else
-                leftW.at<double>(y,x) = 0;
+                leftW->at<double>(y,x) = 0;
             if( x-1>=0 && y-1>=0 ) // upleft
             {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x-1);
-                upleftW.at<double>(y,x) = gammaDivSqrt2 * exp(-beta*diff.dot(diff));
+                Vec3d diff = color - (Vec3d)img->at<Vec3b>(y-1,x-1);
+                upleftW->at<double>(y,x) = gammaDivSqrt2 * exp(-beta*diff.dot(diff));
             }
             else
-                upleftW.at<double>(y,x) = 0;
+                upleftW->at<double>(y,x) = 0;
             if( y-1>=0 ) // up
             {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x);
-                upW.at<double>(y,x) = gamma * exp(-beta*diff.dot(diff));
+                Vec3d diff = color - (Vec3d)img->at<Vec3b>(y-1,x);
+                upW->at<double>(y,x) = gamma * exp(-beta*diff.dot(diff));
             }
             else
-                upW.at<double>(y,x) = 0;
-            if( x+1<img.cols && y-1>=0 ) // upright
+                upW->at<double>(y,x) = 0;
+            if( x+1<img->cols && y-1>=0 ) // upright
             {
-                Vec3d diff = color - (Vec3d)img.at<Vec3b>(y-1,x+1);
-                uprightW.at<double>(y,x) = gammaDivSqrt2 * exp(-beta*diff.dot(diff));
+                Vec3d diff = color - (Vec3d)img->at<Vec3b>(y-1,x+1);
+                uprightW->at<double>(y,x) = gammaDivSqrt2 * exp(-beta*diff.dot(diff));
             }
             else
-                uprightW.at<double>(y,x) = 0;
+                uprightW->at<double>(y,x) = 0;
         }
     }
 }
 
+static void calcNWeights( const Mat& img, Mat& leftW, Mat& upleftW, Mat& upW, Mat& uprightW, double beta, double gamma )
+{
+    leftW.create( img.rows, img.cols, CV_64FC1 );
+    upleftW.create( img.rows, img.cols, CV_64FC1 );
+    upW.create( img.rows, img.cols, CV_64FC1 );
+    uprightW.create( img.rows, img.cols, CV_64FC1 );
+    parallel_for_( Range(0, img.rows), CalcNWeightsInvoker(img, leftW, upleftW, upW, uprightW, beta, gamma),
+                   img.rows/(double)GRABCUT_BAND );
+}
+
 /*
   Check size, type and element values of mask matrix.
  */
@@ -395,55 +487,187 @@ static void initGMMs( const Mat& img, const Mat& mask, GMM& bgdGMM, GMM& fgdGMM
     fgdGMM.endLearning();
 }
 
+static inline bool isBgd( uchar m )
+{
+    return m == GC_BGD || m == GC_PR_BGD;
+}
+
 /*
   Assign GMMs components for each pixel.
+  compIdxs keeps the component of the background GMM in the first channel
+  and the component of the foreground GMM in the second one.
 */
-static void assignGMMsComponents( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, Mat& compIdxs )
+class AssignGMMsComponentsInvoker : public ParallelLoopBody
 {
-    Point p;
-    for( p.y = 0; p.y < img.rows; p.y++ )
+public:
+    AssignGMMsComponentsInvoker( const Mat& _img, const Mat& _mask, const GMM& _bgdGMM, const GMM& _fgdGMM, Mat& _compIdxs ) :
+        img(&_img), mask(&_mask), bgdGMM(&_bgdGMM), fgdGMM(&_fgdGMM), compIdxs(&_compIdxs) {}
+
+    void operator()( const Range& range ) const
     {
-        for( p.x = 0; p.x < img.cols; p.x++ )
+        for( int y = range.start; y < range.end; y++ )
         {
-            Vec3d color = img.at<Vec3b>(p);
-            compIdxs.at<int>(p) = mask.at<uchar>(p) == GC_BGD || mask.at<uchar>(p) == GC_PR_BGD ?
-                bgdGMM.whichComponent(color) : fgdGMM.whichComponent(color);
+            const Vec3b* I = img->ptr<Vec3b>(y);
+            const uchar* M = mask->ptr<uchar>(y);
+            Vec2b* C = compIdxs->ptr<Vec2b>(y);
+            for( int x = 0; x < img->cols; x++ )
+            {
+                Vec3d color = I[x];
+                if( isBgd(M[x]) )
+                    C[x][0] = (uchar)bgdGMM->whichComponent(color);
+                else
+                    C[x][1] = (uchar)fgdGMM->whichComponent(color);
+            }
         }
     }
+
+private:
+    const Mat* img;
+    const Mat* mask;
+    const GMM* bgdGMM;
+    const GMM* fgdGMM;
+    Mat* compIdxs;
+};
+
+static void assignGMMsComponents( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, Mat& compIdxs )
+{
+    parallel_for_( Range(0, img.rows), AssignGMMsComponentsInvoker(img, mask, bgdGMM, fgdGMM, compIdxs),
+                   img.rows/(double)GRABCUT_BAND );
 }
 
 /*
   Learn GMMs parameters.
+  The samples are summed up in bands of rows, the bands are merged in order.
 */
-static void learnGMMs( const Mat& img, const Mat& mask, const Mat& compIdxs, GMM& bgdGMM, GMM& fgdGMM )
+class LearnGMMsInvoker : public ParallelLoopBody
 {
-    bgdGMM.initLearning();
-    fgdGMM.initLearning();
-    Point p;
-    for( int ci = 0; ci < GMM::componentsCount; ci++ )
+public:
+    LearnGMMsInvoker( const Mat& _img, const Mat& _mask, const Mat& _compIdxs,
+                      std::vector<GMMSampleSums>& _bgdSums, std::vector<GMMSampleSums>& _fgdSums ) :
+        img(&_img), mask(&_mask), compIdxs(&_compIdxs), bgdSums(&_bgdSums), fgdSums(&_fgdSums) {}
+
+    void operator()( const Range& range ) const
     {
-        for( p.y = 0; p.y < img.rows; p.y++ )
+        for( int b = range.start; b < range.end; b++ )
         {
-            for( p.x = 0; p.x < img.cols; p.x++ )
+            GMMSampleSums& bgd = (*bgdSums)[b];
+            GMMSampleSums& fgd = (*fgdSums)[b];
+            bgd.clear();
+            fgd.clear();
+
+            int y1 = std::min((b + 1)*GRABCUT_BAND, img->rows);
+            for( int y = b*GRABCUT_BAND; y < y1; y++ )
             {
-                if( compIdxs.at<int>(p) == ci )
+                const Vec3b* I = img->ptr<Vec3b>(y);
+                const uchar* M = mask->ptr<uchar>(y);
+                const Vec2b* C = compIdxs->ptr<Vec2b>(y);
+                for( int x = 0; x < img->cols; x++ )
                 {
-                    if( mask.at<uchar>(p) == GC_BGD || mask.at<uchar>(p) == GC_PR_BGD )
-                        bgdGMM.addSample( ci, img.at<Vec3b>(p) );
+                    if( isBgd(M[x]) )
+                        bgd.addSample( C[x][0], I[x] );
                     else
-                        fgdGMM.addSample( ci, img.at<Vec3b>(p) );
+                        fgd.addSample( C[x][1], I[x] );
                 }
             }
         }
     }
+
+private:
+    const Mat* img;
+    const Mat* mask;
+    const Mat* compIdxs;
+    std::vector<GMMSampleSums>* bgdSums;
+    std::vector<GMMSampleSums>* fgdSums;
+};
+
+static void learnGMMs( const Mat& img, const Mat& mask, const Mat& compIdxs, GMM& bgdGMM, GMM& fgdGMM )
+{
+    int nbands = (img.rows + GRABCUT_BAND - 1)/GRABCUT_BAND;
+    std::vector<GMMSampleSums> bgdSums(nbands), fgdSums(nbands);
+    parallel_for_( Range(0, nbands), LearnGMMsInvoker(img, mask, compIdxs, bgdSums, fgdSums) );
+
+    // the sums of the color values are exact, so the order does not matter
+    bgdGMM.initLearning();
+    fgdGMM.initLearning();
+    for( int b = 0; b < nbands; b++ )
+    {
+        bgdGMM.addSamples( bgdSums[b] );
+        fgdGMM.addSamples( fgdSums[b] );
+    }
     bgdGMM.endLearning();
     fgdGMM.endLearning();
 }
 
+/*
+  Calculate weights of terminal vertices of graph (the source weight in the first channel and
+  the sink weight in the second one). The GMMs components of the next iteration are assigned
+  in the same pass, for both GMMs, since the segmentation may move the pixels between them.
+*/
+class CalcTWeightsInvoker : public ParallelLoopBody
+{
+public:
+    CalcTWeightsInvoker( const Mat& _img, const Mat& _mask, const GMM& _bgdGMM, const GMM& _fgdGMM, double _lambda,
+                         Mat& _tWeights, Mat& _compIdxs ) :
+        img(&_img), mask(&_mask), bgdGMM(&_bgdGMM), fgdGMM(&_fgdGMM), lambda(_lambda),
+        tWeights(&_tWeights), compIdxs(&_compIdxs) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const Vec3b* I = img->ptr<Vec3b>(y);
+            const uchar* M = mask->ptr<uchar>(y);
+            Vec2d* W = tWeights->ptr<Vec2d>(y);
+            Vec2b* C = compIdxs->ptr<Vec2b>(y);
+            for( int x = 0; x < img->cols; x++ )
+            {
+                Vec3d color = I[x];
+                if( M[x] == GC_PR_BGD || M[x] == GC_PR_FGD )
+                {
+                    int bk, fk;
+                    W[x][0] = -log( (*bgdGMM)(color, bk) );
+                    W[x][1] = -log( (*fgdGMM)(color, fk) );
+                    C[x][0] = (uchar)bk;
+                    C[x][1] = (uchar)fk;
+                }
+                else if( M[x] == GC_BGD )
+                {
+                    W[x][0] = 0;
+                    W[x][1] = lambda;
+                    C[x][0] = (uchar)bgdGMM->whichComponent(color);
+                }
+                else // GC_FGD
+                {
+                    W[x][0] = lambda;
+                    W[x][1] = 0;
+                    C[x][1] = (uchar)fgdGMM->whichComponent(color);
+                }
+            }
+        }
+    }
+
+private:
+    const Mat* img;
+    const Mat* mask;
+    const GMM* bgdGMM;
+    const GMM* fgdGMM;
+    double lambda;
+    Mat* tWeights;
+    Mat* compIdxs;
+};
+
+static void calcTWeights( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, double lambda,
+                          Mat& tWeights, Mat& compIdxs )
+{
+    tWeights.create( img.size(), CV_64FC2 );
+    parallel_for_( Range(0, img.rows), CalcTWeightsInvoker(img, mask, bgdGMM, fgdGMM, lambda, tWeights, compIdxs),
+                   img.rows/(double)GRABCUT_BAND );
+}
+
 /*
   Construct GCGraph
 */
-static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, double lambda,
+static void constructGCGraph( const Mat& img, const Mat& tWeights,
                        const Mat& leftW, const Mat& upleftW, const Mat& upW, const Mat& uprightW,
                        GCGraph<double>& graph )
 {
@@ -457,26 +681,10 @@ static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM
         {
             // add node
             int vtxIdx = graph.addVtx();
-            Vec3b color = img.at<Vec3b>(p);
 
             // set t-weights
-            double fromSource, toSink;
-            if( mask.at<uchar>(p) == GC_PR_BGD || mask.at<uchar>(p) == GC_PR_FGD )
-            {
-                fromSource = -log( bgdGMM(color) );
-                toSink = -log( fgdGMM(color) );
-            }
-            else if( mask.at<uchar>(p) == GC_BGD )
-            {
-                fromSource = 0;
-                toSink = lambda;
-            }
-            else // GC_FGD
-            {
-                fromSource = lambda;
-                toSink = 0;
-            }
-            graph.addTermWeights( vtxIdx, fromSource, toSink );
+            const Vec2d& tw = tWeights.at<Vec2d>(p);
+            graph.addTermWeights( vtxIdx, tw[0], tw[1] );
 
             // set n-weights
             if( p.x>0 )
@@ -503,12 +711,31 @@ static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM
     }
 }
 
+/*
+  Update the t-weights of the graph, keeping its flow.
+  Only the weights of the probable pixels depend on the GMMs.
+*/
+static void updateGCGraph( const Mat& mask, const Mat& prevTWeights, const Mat& tWeights, GCGraph<double>& graph )
+{
+    for( int y = 0; y < mask.rows; y++ )
+    {
+        const uchar* M = mask.ptr<uchar>(y);
+        const Vec2d* W0 = prevTWeights.ptr<Vec2d>(y);
+        const Vec2d* W = tWeights.ptr<Vec2d>(y);
+        for( int x = 0; x < mask.cols; x++ )
+        {
+            if( (M[x] == GC_PR_BGD || M[x] == GC_PR_FGD) && W[x] != W0[x] )
+                graph.addTermWeights( y*mask.cols + x, W[x][0] - W0[x][0], W[x][1] - W0[x][1] );
+        }
+    }
+}
+
 /*
   Estimate segmentation using MaxFlow algorithm
 */
-static void estimateSegmentation( GCGraph<double>& graph, Mat& mask )
+static void estimateSegmentation( GCGraph<double>& graph, Mat& mask, bool reuseTrees )
 {
-    graph.maxFlow();
+    graph.maxFlow( reuseTrees );
     Point p;
     for( p.y = 0; p.y < mask.rows; p.y++ )
     {
@@ -542,7 +769,7 @@ void cv::grabCut( InputArray _img, InputOutputArray _mask, Rect rect,
         CV_Error( CV_StsBadArg, "image must have CV_8UC3 type" );
 
     GMM bgdGMM( bgdModel ), fgdGMM( fgdModel );
-    Mat compIdxs( img.size(), CV_32SC1 );
+    Mat compIdxs( img.size(), CV_8UC2 );
 
     if( mode == GC_INIT_WITH_RECT || mode == GC_INIT_WITH_MASK )
     {
@@ -566,12 +793,20 @@ void cv::grabCut( InputArray _img, InputOutputArray _mask, Rect rect,
     Mat leftW, upleftW, upW, uprightW;
     calcNWeights( img, leftW, upleftW, upW, uprightW, beta, gamma );
 
+    // the graph is built once; the next iterations change the t-weights of the probable pixels
+    // and continue from the flow and the search trees of the previous one
+    GCGraph<double> graph;
+    Mat tWeights, prevTWeights;
+    assignGMMsComponents( img, mask, bgdGMM, fgdGMM, compIdxs );
     for( int i = 0; i < iterCount; i++ )
     {
-        GCGraph<double> graph;
-        assignGMMsComponents( img, mask, bgdGMM, fgdGMM, compIdxs );
         learnGMMs( img, mask, compIdxs, bgdGMM, fgdGMM );
-        constructGCGraph(img, mask, bgdGMM, fgdGMM, lambda, leftW, upleftW, upW, uprightW, graph );
-        estimateSegmentation( graph, mask );
+        calcTWeights( img, mask, bgdGMM, fgdGMM, lambda, tWeights, compIdxs );
+        if( i == 0 )
+            constructGCGraph( img, tWeights, leftW, upleftW, upW, uprightW, graph );
+        else
+            updateGCGraph( mask, prevTWeights, tWeights, graph );
+        estimateSegmentation( graph, mask, i > 0 );
+        std::swap( tWeights, prevTWeights );
     }
 }
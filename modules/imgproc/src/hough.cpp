@@ -43,6 +43,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_imgproc.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -66,6 +67,64 @@ struct hough_cmp_gt
 };
 
 
+/* computes the accumulator offsets tabOfs[n] + round(x*tabCos[n] + y*tabSin[n]) for the angles [n0, n1) */
+static inline void
+houghLineBins( int x, int y, const float* tabCos, const float* tabSin, const int* tabOfs,
+               int n0, int n1, int* bins, bool haveSIMD )
+{
+    int n = n0;
+#if CV_SIMD128
+    if( haveSIMD )
+    {
+        v_float32x4 vx = v_setall_f32((float)x), vy = v_setall_f32((float)y);
+        for( ; n <= n1 - 4; n += 4 )
+            v_store(bins + n, v_round(vx*v_load(tabCos + n) + vy*v_load(tabSin + n)) + v_load(tabOfs + n));
+    }
+#else
+    (void)haveSIMD;
+#endif
+    for( ; n < n1; n++ )
+        bins[n] = cvRound( x * tabCos[n] + y * tabSin[n] ) + tabOfs[n];
+}
+
+/* votes for the range of angles; every thread updates its own part of the accumulator */
+class HoughLinesAccumInvoker : public ParallelLoopBody
+{
+public:
+    HoughLinesAccumInvoker( const std::vector<Point>& _points, const float* _tabCos, const float* _tabSin,
+                            const int* _tabOfs, int _numangle, int* _accum )
+        : points(&_points), tabCos(_tabCos), tabSin(_tabSin), tabOfs(_tabOfs), numangle(_numangle), accum(_accum)
+    {
+#if CV_SIMD128
+        haveSIMD = hasSIMD128();
+#else
+        haveSIMD = false;
+#endif
+    }
+
+    void operator()( const Range& range ) const
+    {
+        AutoBuffer<int> _bins(numangle);
+        int* bins = _bins;
+
+        for( size_t i = 0; i < points->size(); i++ )
+        {
+            Point pt = (*points)[i];
+            houghLineBins( pt.x, pt.y, tabCos, tabSin, tabOfs, range.start, range.end, bins, haveSIMD );
+            for( int n = range.start; n < range.end; n++ )
+                accum[bins[n]]++;
+        }
+    }
+
+protected:
+    const std::vector<Point>* points;
+    const float *tabCos, *tabSin;
+    const int* tabOfs;
+    int numangle;
+    int* accum;
+    bool haveSIMD;
+};
+
 /*
 Here image is an input raster;
 step is it's step; size characterizes it's ROI;
@@ -124,9 +183,11 @@ HoughLinesStandard( const Mat& img, float rho, float theta,
 
     AutoBuffer<int> _accum((numangle+2) * (numrho+2));
     std::vector<int> _sort_buf;
+    std::vector<Point> nzloc;
     AutoBuffer<float> _tabSin(numangle);
     AutoBuffer<float> _tabCos(numangle);
-    int *accum = _accum;
+    AutoBuffer<int> _tabOfs(numangle);
+    int *accum = _accum, *tabOfs = _tabOfs;
     float *tabSin = _tabSin, *tabCos = _tabCos;
 
     memset( accum, 0, sizeof(accum[0]) * (numangle+2) * (numrho+2) );
@@ -136,6 +197,7 @@ HoughLinesStandard( const Mat& img, float rho, float theta,
     {
         tabSin[n] = (float)(sin((double)ang) * irho);
         tabCos[n] = (float)(cos((double)ang) * irho);
+        tabOfs[n] = (n+1) * (numrho+2) + (numrho - 1) / 2 + 1;
     }
 
     // stage 1. fill accumulator
@@ -143,14 +205,16 @@ HoughLinesStandard( const Mat& img, float rho, float theta,
         for( j = 0; j < width; j++ )
         {
             if( image[i * step + j] != 0 )
-                for(int n = 0; n < numangle; n++ )
-                {
-                    int r = cvRound( j * tabCos[n] + i * tabSin[n] );
-                    r += (numrho - 1) / 2;
-                    accum[(n+1) * (numrho+2) + r+1]++;
-                }
+                nzloc.push_back(Point(j, i));
         }
 
+    if( !nzloc.empty() )
+    {
+        int nstripes = std::max(std::min(getNumThreads()*2, numangle/8), 1);
+        parallel_for_(Range(0, numangle), HoughLinesAccumInvoker(nzloc, tabCos, tabSin, tabOfs, numangle, accum),
+                      nstripes);
+    }
+
     // stage 2. find local maximums
     for(int r = 0; r < numrho; r++ )
         for(int n = 0; n < numangle; n++ )
@@ -411,6 +475,42 @@ HoughLinesSDiv( const Mat& img,
 *                              Probabilistic Hough Transform                             *
 \****************************************************************************************/
 
+/* computes the accumulator bins of the points, which are not excluded yet */
+class HoughLinesBinsInvoker : public ParallelLoopBody
+{
+public:
+    HoughLinesBinsInvoker( const Point* _points, const Mat& _mask, const float* _tabCos, const float* _tabSin,
+                           const int* _tabOfs, int _numangle, int* _bins )
+        : points(_points), mask(&_mask), tabCos(_tabCos), tabSin(_tabSin), tabOfs(_tabOfs),
+          numangle(_numangle), bins(_bins)
+    {
+#if CV_SIMD128
+        haveSIMD = hasSIMD128();
+#else
+        haveSIMD = false;
+#endif
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Point pt = points[i];
+            if( mask->at<uchar>(pt) )
+                houghLineBins( pt.x, pt.y, tabCos, tabSin, tabOfs, 0, numangle, bins + i*numangle, haveSIMD );
+        }
+    }
+
+protected:
+    const Point* points;
+    const Mat* mask;
+    const float *tabCos, *tabSin;
+    const int* tabOfs;
+    int numangle;
+    int* bins;
+    bool haveSIMD;
+};
+
 static void
 HoughLinesProbabilistic( Mat& image,
                          float rho, float theta, int threshold,
@@ -460,15 +560,22 @@ HoughLinesProbabilistic( Mat& image,
 
     Mat accum = Mat::zeros( numangle, numrho, CV_32SC1 );
     Mat mask( height, width, CV_8UC1 );
-    std::vector<float> trigtab(numangle*2);
+    std::vector<float> tabCos(numangle), tabSin(numangle);
+    std::vector<int> tabOfs(numangle);
 
     for( int n = 0; n < numangle; n++ )
     {
-        trigtab[n*2] = (float)(cos((double)n*theta) * irho);
-        trigtab[n*2+1] = (float)(sin((double)n*theta) * irho);
+        tabCos[n] = (float)(cos((double)n*theta) * irho);
+        tabSin[n] = (float)(sin((double)n*theta) * irho);
+        tabOfs[n] = n * numrho + (numrho - 1) / 2;
     }
-    const float* ttab = &trigtab[0];
     uchar* mdata0 = mask.ptr();
+    int* adata = accum.ptr<int>();
+#if CV_SIMD128
+    bool haveSIMD = hasSIMD128();
+#else
+    bool haveSIMD = false;
+#endif
     std::vector<Point> nzloc;
 
     // stage 1. collect non-zero image points
@@ -490,33 +597,50 @@ HoughLinesProbabilistic( Mat& image,
 
     int count = (int)nzloc.size();
 
+    // The order, in which the points are processed, does not depend on the accumulator.
+    // So the points are drawn by blocks, and the accumulator bins of a block are computed in parallel.
+    // The result does not depend on the number of threads.
+    const int blockSize = 1024;
+    std::vector<Point> block(std::min(count, blockSize));
+    std::vector<int> blockBins(block.size()*numangle), lineBins(numangle);
+
     // stage 2. process all the points in random order
-    for( ; count > 0; count-- )
+    for( int nblock = 0, bidx = 0; count > 0; count--, bidx++ )
     {
-        // choose random point out of the remaining ones
-        int idx = rng.uniform(0, count);
+        if( bidx == nblock )
+        {
+            nblock = std::min(count, blockSize);
+            for( bidx = 0; bidx < nblock; bidx++ )
+            {
+                // choose random point out of the remaining ones
+                int idx = rng.uniform(0, count - bidx);
+                block[bidx] = nzloc[idx];
+                // "remove" it by overriding it with the last element
+                nzloc[idx] = nzloc[count - bidx - 1];
+            }
+            parallel_for_(Range(0, nblock), HoughLinesBinsInvoker(&block[0], mask, &tabCos[0], &tabSin[0],
+                                                                  &tabOfs[0], numangle, &blockBins[0]),
+                          std::max(nblock/64, 1));
+            bidx = 0;
+        }
+
         int max_val = threshold-1, max_n = 0;
-        Point point = nzloc[idx];
+        Point point = block[bidx];
         Point line_end[2];
         float a, b;
-        int* adata = accum.ptr<int>();
         int i = point.y, j = point.x, k, x0, y0, dx0, dy0, xflag;
         int good_line;
         const int shift = 16;
 
-        // "remove" it by overriding it with the last element
-        nzloc[idx] = nzloc[count-1];
-
         // check if it has been excluded already (i.e. belongs to some other line)
         if( !mdata0[i*width + j] )
             continue;
 
         // update accumulator, find the most probable line
-        for( int n = 0; n < numangle; n++, adata += numrho )
+        const int* bins = &blockBins[bidx*numangle];
+        for( int n = 0; n < numangle; n++ )
         {
-            int r = cvRound( j * ttab[n*2] + i * ttab[n*2+1] );
-            r += (numrho - 1) / 2;
-            int val = ++adata[r];
+            int val = ++adata[bins[n]];
             if( max_val < val )
             {
                 max_val = val;
@@ -530,8 +654,8 @@ HoughLinesProbabilistic( Mat& image,
 
         // from the current point walk in each direction
         // along the found line and extract the line segment
-        a = -ttab[max_n*2+1];
-        b = ttab[max_n*2];
+        a = -tabSin[max_n];
+        b = tabCos[max_n];
         x0 = j;
         y0 = i;
         if( fabs(a) > fabs(b) )
@@ -632,13 +756,9 @@ HoughLinesProbabilistic( Mat& image,
                 {
                     if( good_line )
                     {
-                        adata = accum.ptr<int>();
-                        for( int n = 0; n < numangle; n++, adata += numrho )
-                        {
-                            int r = cvRound( j1 * ttab[n*2] + i1 * ttab[n*2+1] );
-                            r += (numrho - 1) / 2;
-                            adata[r]--;
-                        }
+                        houghLineBins( j1, i1, &tabCos[0], &tabSin[0], &tabOfs[0], 0, numangle, &lineBins[0], haveSIMD );
+                        for( int n = 0; n < numangle; n++ )
+                            adata[lineBins[n]]--;
                     }
                     *mdata = 0;
                 }
@@ -1002,27 +1122,208 @@ cvHoughLines2( CvArr* src_image, void* lineStorage, int method,
 *                                     Circle Detection                                   *
 \****************************************************************************************/
 
+namespace cv
+{
+
+/* accumulates the circle evidence for the rows of the edge image and collects the edge points.
+   Every stripe of rows votes into its own accumulator, which is added to the common one then */
+class HoughCirclesAccumInvoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesAccumInvoker( const Mat& _edges, const Mat& _dx, const Mat& _dy, float _idp,
+                              int _minRadius, int _maxRadius, Mat& _accum,
+                              std::vector<std::vector<Point> >& _nz, Mutex& _mutex )
+        : edges(&_edges), dx(&_dx), dy(&_dy), idp(_idp), minRadius(_minRadius), maxRadius(_maxRadius),
+          accum(&_accum), nz(&_nz), mutex(&_mutex) {}
+
+    void operator()( const Range& range ) const
+    {
+        const int SHIFT = 10, ONE = 1 << SHIFT;
+        bool whole = range.start == 0 && range.end == edges->rows;
+        Mat localAccum;
+        if( !whole )
+            localAccum = Mat::zeros(accum->size(), CV_32SC1);
+        Mat& acc = whole ? *accum : localAccum;
+
+        int arows = acc.rows - 2, acols = acc.cols - 2;
+        int astep = (int)(acc.step/sizeof(int));
+        int* adata = acc.ptr<int>();
+        int cols = edges->cols;
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const uchar* edges_row = edges->ptr<uchar>(y);
+            const short* dx_row = dx->ptr<short>(y);
+            const short* dy_row = dy->ptr<short>(y);
+            std::vector<Point>& nz_row = (*nz)[y];
+
+            for( int x = 0; x < cols; x++ )
+            {
+                float vx, vy;
+                int sx, sy, x0, y0, x1, y1, r;
+
+                vx = dx_row[x];
+                vy = dy_row[x];
+
+                if( !edges_row[x] || (vx == 0 && vy == 0) )
+                    continue;
+
+                float mag = std::sqrt(vx*vx+vy*vy);
+                assert( mag >= 1 );
+                sx = cvRound((vx*idp)*ONE/mag);
+                sy = cvRound((vy*idp)*ONE/mag);
+
+                x0 = cvRound((x*idp)*ONE);
+                y0 = cvRound((y*idp)*ONE);
+                // Step from min_radius to max_radius in both directions of the gradient
+                for(int k1 = 0; k1 < 2; k1++ )
+                {
+                    x1 = x0 + minRadius * sx;
+                    y1 = y0 + minRadius * sy;
+
+                    for( r = minRadius; r <= maxRadius; x1 += sx, y1 += sy, r++ )
+                    {
+                        int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
+                        if( (unsigned)x2 >= (unsigned)acols ||
+                            (unsigned)y2 >= (unsigned)arows )
+                            break;
+                        adata[y2*astep + x2]++;
+                    }
+
+                    sx = -sx; sy = -sy;
+                }
+
+                nz_row.push_back(Point(x, y));
+            }
+        }
+
+        if( !whole )
+        {
+            AutoLock lock(*mutex);
+            add(*accum, localAccum, *accum);
+        }
+    }
+
+protected:
+    const Mat *edges, *dx, *dy;
+    float idp;
+    int minRadius, maxRadius;
+    Mat* accum;
+    std::vector<std::vector<Point> >* nz;
+    Mutex* mutex;
+};
+
+/* estimates the best radius and its support for the candidate centers */
+class HoughCirclesRadiusInvoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesRadiusInvoker( const std::vector<Point>& _nz, const int* _centers, int _acols, float _dp,
+                               int _minRadius, int _maxRadius, float* _radius, int* _support )
+        : nz(&_nz), centers(_centers), acols(_acols), dp(_dp), minRadius(_minRadius), maxRadius(_maxRadius),
+          radius(_radius), support(_support) {}
+
+    void operator()( const Range& range ) const
+    {
+        float min_radius2 = (float)minRadius*minRadius;
+        float max_radius2 = (float)maxRadius*maxRadius;
+        int nz_count = (int)nz->size();
+        std::vector<float> dist_buf(nz_count);
+        std::vector<int> sort_buf(nz_count);
+        float* ddata = &dist_buf[0];
+        float dr = dp;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int ofs = centers[i];
+            int y = ofs/(acols+2);
+            int x = ofs - (y)*(acols+2);
+            //Calculate circle's center in pixels
+            float cx = (float)((x + 0.5f)*dp), cy = (float)(( y + 0.5f )*dp);
+            float start_dist;
+            float r_best = 0;
+            int j, k, max_count = 0;
+
+            support[i] = -1;
+            radius[i] = 0;
+
+            for( j = k = 0; j < nz_count; j++ )
+            {
+                Point pt = (*nz)[j];
+                float _dx, _dy, _r2;
+                _dx = cx - pt.x; _dy = cy - pt.y;
+                _r2 = _dx*_dx + _dy*_dy;
+                if(min_radius2 <= _r2 && _r2 <= max_radius2 )
+                {
+                    ddata[k] = _r2;
+                    sort_buf[k] = k;
+                    k++;
+                }
+            }
+
+            int nz_count1 = k, start_idx = nz_count1 - 1;
+            if( nz_count1 == 0 )
+                continue;
+            Mat dist(1, nz_count1, CV_32FC1, ddata);
+            pow( dist, 0.5, dist );
+            // Sort non-zero pixels according to their distance from the center.
+            std::sort(sort_buf.begin(), sort_buf.begin() + nz_count1, hough_cmp_gt((int*)ddata));
+
+            start_dist = ddata[sort_buf[nz_count1-1]];
+            for( j = nz_count1 - 2; j >= 0; j-- )
+            {
+                float d = ddata[sort_buf[j]];
+
+                if( d > maxRadius )
+                    break;
+
+                if( d - start_dist > dr )
+                {
+                    float r_cur = ddata[sort_buf[(j + start_idx)/2]];
+                    if( (start_idx - j)*r_best >= max_count*r_cur ||
+                        (r_best < FLT_EPSILON && start_idx - j >= max_count) )
+                    {
+                        r_best = r_cur;
+                        max_count = start_idx - j;
+                    }
+                    start_dist = d;
+                    start_idx = j;
+                }
+            }
+
+            radius[i] = r_best;
+            support[i] = max_count;
+        }
+    }
+
+protected:
+    const std::vector<Point>* nz;
+    const int* centers;
+    int acols;
+    float dp;
+    int minRadius, maxRadius;
+    float* radius;
+    int* support;
+};
+
+}
+
 static void
 icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
                          int min_radius, int max_radius,
                          int canny_threshold, int acc_threshold,
                          CvSeq* circles, int circles_max )
 {
-    const int SHIFT = 10, ONE = 1 << SHIFT;
     cv::Ptr<CvMat> dx, dy;
-    cv::Ptr<CvMat> edges, accum, dist_buf;
+    cv::Ptr<CvMat> edges, accum;
     std::vector<int> sort_buf;
+    std::vector<cv::Point> nz;
     cv::Ptr<CvMemStorage> storage;
 
     int x, y, i, j, k, center_count, nz_count;
-    float min_radius2 = (float)min_radius*min_radius;
-    float max_radius2 = (float)max_radius*max_radius;
-    int rows, cols, arows, acols;
-    int astep, *adata;
-    float* ddata;
-    CvSeq *nz, *centers;
-    float idp, dr;
-    CvSeqReader reader;
+    int rows, arows, acols;
+    int *adata;
+    CvSeq *centers;
+    float idp;
 
     edges.reset(cvCreateMat( img->rows, img->cols, CV_8UC1 ));
 
@@ -1043,67 +1344,29 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
     cvZero(accum);
 
     storage.reset(cvCreateMemStorage());
-    /* Create sequences for the nonzero pixels in the edge image and the centers of circles
-    which could be detected.*/
-    nz = cvCreateSeq( CV_32SC2, sizeof(CvSeq), sizeof(CvPoint), storage );
+    /* Create a sequence for the centers of circles which could be detected.*/
     centers = cvCreateSeq( CV_32SC1, sizeof(CvSeq), sizeof(int), storage );
 
     rows = img->rows;
-    cols = img->cols;
     arows = accum->rows - 2;
     acols = accum->cols - 2;
     adata = accum->data.i;
-    astep = accum->step/sizeof(adata[0]);
+
     // Accumulate circle evidence for each edge pixel
-    for( y = 0; y < rows; y++ )
     {
-        const uchar* edges_row = edges->data.ptr + y*edges->step;
-        const short* dx_row = (const short*)(dx->data.ptr + y*dx->step);
-        const short* dy_row = (const short*)(dy->data.ptr + y*dy->step);
-
-        for( x = 0; x < cols; x++ )
-        {
-            float vx, vy;
-            int sx, sy, x0, y0, x1, y1, r;
-            CvPoint pt;
-
-            vx = dx_row[x];
-            vy = dy_row[x];
-
-            if( !edges_row[x] || (vx == 0 && vy == 0) )
-                continue;
-
-            float mag = std::sqrt(vx*vx+vy*vy);
-            assert( mag >= 1 );
-            sx = cvRound((vx*idp)*ONE/mag);
-            sy = cvRound((vy*idp)*ONE/mag);
-
-            x0 = cvRound((x*idp)*ONE);
-            y0 = cvRound((y*idp)*ONE);
-            // Step from min_radius to max_radius in both directions of the gradient
-            for(int k1 = 0; k1 < 2; k1++ )
-            {
-                x1 = x0 + min_radius * sx;
-                y1 = y0 + min_radius * sy;
-
-                for( r = min_radius; r <= max_radius; x1 += sx, y1 += sy, r++ )
-                {
-                    int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
-                    if( (unsigned)x2 >= (unsigned)acols ||
-                        (unsigned)y2 >= (unsigned)arows )
-                        break;
-                    adata[y2*astep + x2]++;
-                }
-
-                sx = -sx; sy = -sy;
-            }
-
-            pt.x = x; pt.y = y;
-            cvSeqPush( nz, &pt );
-        }
+        cv::Mat _edges = cv::cvarrToMat(edges), _dx = cv::cvarrToMat(dx), _dy = cv::cvarrToMat(dy);
+        cv::Mat _accum = cv::cvarrToMat(accum);
+        std::vector<std::vector<cv::Point> > nz_rows(rows);
+        cv::Mutex mutex;
+        cv::parallel_for_(cv::Range(0, rows),
+                          cv::HoughCirclesAccumInvoker(_edges, _dx, _dy, idp, min_radius, max_radius,
+                                                       _accum, nz_rows, mutex),
+                          std::min(cv::getNumThreads(), rows));
+        for( y = 0; y < rows; y++ )
+            nz.insert(nz.end(), nz_rows[y].begin(), nz_rows[y].end());
     }
 
-    nz_count = nz->total;
+    nz_count = (int)nz.size();
     if( !nz_count )
         return;
     //Find possible circle centers
@@ -1123,100 +1386,70 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
     if( !center_count )
         return;
 
-    sort_buf.resize( MAX(center_count,nz_count) );
+    sort_buf.resize( center_count );
     cvCvtSeqToArray( centers, &sort_buf[0] );
     /*Sort candidate centers in descending order of their accumulator values, so that the centers
     with the most supporting pixels appear first.*/
     std::sort(sort_buf.begin(), sort_buf.begin() + center_count, cv::hough_cmp_gt(adata));
-    cvClearSeq( centers );
-    cvSeqPushMulti( centers, &sort_buf[0], center_count );
-
-    dist_buf.reset(cvCreateMat( 1, nz_count, CV_32FC1 ));
-    ddata = dist_buf->data.fl;
 
-    dr = dp;
     min_dist = MAX( min_dist, dp );
     min_dist *= min_dist;
-    // For each found possible center
-    // Estimate radius and check support
-    for( i = 0; i < centers->total; i++ )
-    {
-        int ofs = *(int*)cvGetSeqElem( centers, i );
-        y = ofs/(acols+2);
-        x = ofs - (y)*(acols+2);
-        //Calculate circle's center in pixels
-        float cx = (float)((x + 0.5f)*dp), cy = (float)(( y + 0.5f )*dp);
-        float start_dist, dist_sum;
-        float r_best = 0;
-        int max_count = 0;
-        // Check distance with previously detected circles
-        for( j = 0; j < circles->total; j++ )
-        {
-            float* c = (float*)cvGetSeqElem( circles, j );
-            if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < min_dist )
-                break;
-        }
 
-        if( j < circles->total )
-            continue;
-        // Estimate best radius
-        cvStartReadSeq( nz, &reader );
-        for( j = k = 0; j < nz_count; j++ )
+    // The radii of the candidate centers are estimated in parallel by batches.
+    // A center is skipped if it is too close to the circles found before it,
+    // so the batch candidates are checked again after the estimation.
+    int batch_size = cv::getNumThreads() > 1 ? cv::getNumThreads()*4 : 1;
+    std::vector<int> batch(batch_size), support(batch_size);
+    std::vector<float> radius(batch_size);
+
+    for( i = 0; i < center_count; )
+    {
+        int nbatch = 0;
+        for( ; i < center_count && nbatch < batch_size; i++ )
         {
-            CvPoint pt;
-            float _dx, _dy, _r2;
-            CV_READ_SEQ_ELEM( pt, reader );
-            _dx = cx - pt.x; _dy = cy - pt.y;
-            _r2 = _dx*_dx + _dy*_dy;
-            if(min_radius2 <= _r2 && _r2 <= max_radius2 )
+            int ofs = sort_buf[i];
+            y = ofs/(acols+2);
+            x = ofs - (y)*(acols+2);
+            float cx = (float)((x + 0.5f)*dp), cy = (float)(( y + 0.5f )*dp);
+            // Check distance with previously detected circles
+            for( j = 0; j < circles->total; j++ )
             {
-                ddata[k] = _r2;
-                sort_buf[k] = k;
-                k++;
+                float* c = (float*)cvGetSeqElem( circles, j );
+                if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < min_dist )
+                    break;
             }
+            if( j == circles->total )
+                batch[nbatch++] = ofs;
         }
 
-        int nz_count1 = k, start_idx = nz_count1 - 1;
-        if( nz_count1 == 0 )
-            continue;
-        dist_buf->cols = nz_count1;
-        cvPow( dist_buf, dist_buf, 0.5 );
-        // Sort non-zero pixels according to their distance from the center.
-        std::sort(sort_buf.begin(), sort_buf.begin() + nz_count1, cv::hough_cmp_gt((int*)ddata));
+        // Estimate best radius
+        cv::parallel_for_(cv::Range(0, nbatch),
+                          cv::HoughCirclesRadiusInvoker(nz, &batch[0], acols, dp, min_radius, max_radius,
+                                                        &radius[0], &support[0]));
 
-        dist_sum = start_dist = ddata[sort_buf[nz_count1-1]];
-        for( j = nz_count1 - 2; j >= 0; j-- )
+        for( k = 0; k < nbatch; k++ )
         {
-            float d = ddata[sort_buf[j]];
-
-            if( d > max_radius )
-                break;
+            y = batch[k]/(acols+2);
+            x = batch[k] - (y)*(acols+2);
+            float cx = (float)((x + 0.5f)*dp), cy = (float)(( y + 0.5f )*dp);
+            for( j = 0; j < circles->total; j++ )
+            {
+                float* c = (float*)cvGetSeqElem( circles, j );
+                if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < min_dist )
+                    break;
+            }
 
-            if( d - start_dist > dr )
+            // Check if the circle has enough support
+            if( j == circles->total && support[k] >= 0 && support[k] > acc_threshold )
             {
-                float r_cur = ddata[sort_buf[(j + start_idx)/2]];
-                if( (start_idx - j)*r_best >= max_count*r_cur ||
-                    (r_best < FLT_EPSILON && start_idx - j >= max_count) )
-                {
-                    r_best = r_cur;
-                    max_count = start_idx - j;
-                }
-                start_dist = d;
-                start_idx = j;
-                dist_sum = 0;
+                float c[3];
+                c[0] = cx;
+                c[1] = cy;
+                c[2] = radius[k];
+                cvSeqPush( circles, c );
+                if( circles->total > circles_max )
+                    return;
             }
-            dist_sum += d;
-        }
-        // Check if the circle has enough support
-        if( max_count > acc_threshold )
-        {
-            float c[3];
-            c[0] = cx;
-            c[1] = cy;
-            c[2] = (float)r_best;
-            cvSeqPush( circles, c );
-            if( circles->total > circles_max )
-                return;
         }
     }
 }
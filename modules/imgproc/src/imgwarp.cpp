@@ -418,7 +418,7 @@ private:
 };
 
 static void
-resizeNN( const Mat& src, Mat& dst, double fx, double fy )
+resizeNN( const Mat& src, Mat& dst, double fx, double fy, const Range& range )
 {
     Size ssize = src.size(), dsize = dst.size();
     AutoBuffer<int> _x_ofs(dsize.width);
@@ -434,7 +434,6 @@ resizeNN( const Mat& src, Mat& dst, double fx, double fy )
         x_ofs[x] = std::min(sx, ssize.width-1)*pix_size;
     }
 
-    Range range(0, dsize.height);
     resizeNNInvoker invoker(src, dst, x_ofs, pix_size4, ify);
     parallel_for_(range, invoker, dst.total()/(double)(1<<16));
 }
@@ -1761,7 +1760,7 @@ template<class HResize, class VResize>
 static void resizeGeneric_( const Mat& src, Mat& dst,
                             const int* xofs, const void* _alpha,
                             const int* yofs, const void* _beta,
-                            int xmin, int xmax, int ksize )
+                            int xmin, int xmax, int ksize, const Range& range )
 {
     typedef typename HResize::alpha_type AT;
 
@@ -1774,7 +1773,6 @@ static void resizeGeneric_( const Mat& src, Mat& dst,
     xmax *= cn;
     // image resize is a separable operation. In case of not too strong
 
-    Range range(0, dsize.height);
     resizeGeneric_Invoker<HResize, VResize> invoker(src, dst, xofs, yofs, (const AT*)_alpha, beta,
         ssize, dsize, ksize, xmin, xmax);
     parallel_for_(range, invoker, dst.total()/(double)(1<<16));
@@ -2484,9 +2482,8 @@ private:
 
 template<typename T, typename WT, typename VecOp>
 static void resizeAreaFast_( const Mat& src, Mat& dst, const int* ofs, const int* xofs,
-                             int scale_x, int scale_y )
+                             int scale_x, int scale_y, const Range& range )
 {
-    Range range(0, dst.rows);
     resizeAreaFast_Invoker<T, WT, VecOp> invoker(src, dst, scale_x,
         scale_y, ofs, xofs);
     parallel_for_(range, invoker, dst.total()/(double)(1<<16));
@@ -2637,9 +2634,9 @@ template <typename T, typename WT>
 static void resizeArea_( const Mat& src, Mat& dst,
                          const DecimateAlpha* xtab, int xtab_size,
                          const DecimateAlpha* ytab, int ytab_size,
-                         const int* tabofs )
+                         const int* tabofs, const Range& range )
 {
-    parallel_for_(Range(0, dst.rows),
+    parallel_for_(range,
                  ResizeArea_Invoker<T, WT>(src, dst, xtab, xtab_size, ytab, ytab_size, tabofs),
                  dst.total()/((double)(1 << 16)));
 }
@@ -2648,16 +2645,16 @@ static void resizeArea_( const Mat& src, Mat& dst,
 typedef void (*ResizeFunc)( const Mat& src, Mat& dst,
                             const int* xofs, const void* alpha,
                             const int* yofs, const void* beta,
-                            int xmin, int xmax, int ksize );
+                            int xmin, int xmax, int ksize, const Range& range );
 
 typedef void (*ResizeAreaFastFunc)( const Mat& src, Mat& dst,
                                     const int* ofs, const int *xofs,
-                                    int scale_x, int scale_y );
+                                    int scale_x, int scale_y, const Range& range );
 
 typedef void (*ResizeAreaFunc)( const Mat& src, Mat& dst,
                                 const DecimateAlpha* xtab, int xtab_size,
                                 const DecimateAlpha* ytab, int ytab_size,
-                                const int* yofs);
+                                const int* yofs, const Range& range );
 
 
 static int computeResizeAreaTab( int ssize, int dsize, int cn, double scale, DecimateAlpha* tab )
@@ -3054,38 +3051,36 @@ private:
 };
 #endif
 
-static bool ipp_resize(const uchar * src_data, size_t src_step, int src_width, int src_height,
-            uchar * dst_data, size_t dst_step, int dst_width, int dst_height, double inv_scale_x, double inv_scale_y,
-            int depth, int channels, int interpolation)
-{
 #ifdef HAVE_IPP_IW
-    CV_INSTRUMENT_REGION_IPP()
-
+// returns the IPP interpolation of the resize, or -1 if ipp_resize does not handle it
+static IppiInterpolationType ipp_resizeInterpolation(int src_width, int src_height, int dst_width, int dst_height,
+            double inv_scale_x, double inv_scale_y, int depth, int interpolation, bool &affine)
+{
     IppDataType           ippDataType = ippiGetDataType(depth);
     IppiInterpolationType ippInter    = ippiGetInterpolation(interpolation);
     if(ippInter < 0)
-        return false;
+        return ippInter;
 
 #if IPP_DISABLE_RESIZE_NEAREST
     if(ippInter == ippNearest)
-        return false;
+        return (IppiInterpolationType)-1;
 #endif
 
 #if IPP_DISABLE_RESIZE_AREA
     if(ippInter == ippSuper)
-        return false;
+        return (IppiInterpolationType)-1;
 #endif
 
     if(ippInter != ippLinear && ippDataType == ipp64f)
-        return false;
+        return (IppiInterpolationType)-1;
 
     // Accuracy mismatch is 1 but affects detectors greatly
 #if IPP_DISABLE_RESIZE_8U
     if(ippDataType == ipp8u && ippInter == ippLinear)
-        return false;
+        return (IppiInterpolationType)-1;
 #endif
 
-    bool  affine = false;
+    affine = false;
     const double IPP_RESIZE_EPS = (depth == CV_64F)?0:1e-10;
     double ex = fabs((double)dst_width / src_width  - inv_scale_x) / inv_scale_x;
     double ey = fabs((double)dst_height / src_height - inv_scale_y) / inv_scale_y;
@@ -3096,6 +3091,24 @@ static bool ipp_resize(const uchar * src_data, size_t src_step, int src_width, i
 
     // Affine doesn't support Lanczos and Super interpolations
     if(affine && (ippInter == ippLanczos || ippInter == ippSuper))
+        return (IppiInterpolationType)-1;
+
+    return ippInter;
+}
+#endif
+
+static bool ipp_resize(const uchar * src_data, size_t src_step, int src_width, int src_height,
+            uchar * dst_data, size_t dst_step, int dst_width, int dst_height, double inv_scale_x, double inv_scale_y,
+            int depth, int channels, int interpolation)
+{
+#ifdef HAVE_IPP_IW
+    CV_INSTRUMENT_REGION_IPP()
+
+    bool                  affine;
+    IppDataType           ippDataType = ippiGetDataType(depth);
+    IppiInterpolationType ippInter    = ipp_resizeInterpolation(src_width, src_height, dst_width, dst_height,
+                                                                inv_scale_x, inv_scale_y, depth, interpolation, affine);
+    if(ippInter < 0)
         return false;
 
     try
@@ -3144,30 +3157,14 @@ static bool ipp_resize(const uchar * src_data, size_t src_step, int src_width, i
 
 //==================================================================================================
 
-namespace hal {
-
-void resize(int src_type,
-            const uchar * src_data, size_t src_step, int src_width, int src_height,
-            uchar * dst_data, size_t dst_step, int dst_width, int dst_height,
-            double inv_scale_x, double inv_scale_y, int interpolation)
+// computes the rows dstRows of dst; src and dst are the headers of the whole images
+static void resizeImpl( const Mat& src, Mat& dst, double inv_scale_x, double inv_scale_y,
+                        int interpolation, const Range& dstRows )
 {
-    CV_INSTRUMENT_REGION()
-
-    CV_Assert((dst_width * dst_height > 0) || (inv_scale_x > 0 && inv_scale_y > 0));
-    if (inv_scale_x < DBL_EPSILON || inv_scale_y < DBL_EPSILON)
-    {
-        inv_scale_x = static_cast<double>(dst_width) / src_width;
-        inv_scale_y = static_cast<double>(dst_height) / src_height;
-    }
-
-    CALL_HAL(resize, cv_hal_resize, src_type, src_data, src_step, src_width, src_height, dst_data, dst_step, dst_width, dst_height, inv_scale_x, inv_scale_y, interpolation);
-
-    int  depth = CV_MAT_DEPTH(src_type), cn = CV_MAT_CN(src_type);
-    Size dsize = Size(saturate_cast<int>(src_width*inv_scale_x),
-                        saturate_cast<int>(src_height*inv_scale_y));
-    CV_Assert( dsize.area() > 0 );
-
-    CV_IPP_RUN_FAST(ipp_resize(src_data, src_step, src_width, src_height, dst_data, dst_step, dsize.width, dsize.height, inv_scale_x, inv_scale_y, depth, cn, interpolation))
+    int src_type = src.type(), depth = CV_MAT_DEPTH(src_type), cn = CV_MAT_CN(src_type);
+    int src_width = src.cols, src_height = src.rows;
+    size_t src_step = src.step;
+    Size dsize = dst.size();
 
     static ResizeFunc linear_tab[] =
     {
@@ -3281,12 +3278,9 @@ void resize(int src_type,
     bool is_area_fast = std::abs(scale_x - iscale_x) < DBL_EPSILON &&
             std::abs(scale_y - iscale_y) < DBL_EPSILON;
 
-    Mat src(Size(src_width, src_height), src_type, const_cast<uchar*>(src_data), src_step);
-    Mat dst(dsize, src_type, dst_data, dst_step);
-
     if( interpolation == INTER_NEAREST )
     {
-        resizeNN( src, dst, inv_scale_x, inv_scale_y );
+        resizeNN( src, dst, inv_scale_x, inv_scale_y, dstRows );
         return;
     }
 
@@ -3325,7 +3319,7 @@ void resize(int src_type,
                         xofs[j + k] = sx + k;
                 }
 
-                func( src, dst, ofs, xofs, iscale_x, iscale_y );
+                func( src, dst, ofs, xofs, iscale_x, iscale_y, dstRows );
                 return;
             }
 
@@ -3350,7 +3344,7 @@ void resize(int src_type,
             }
             tabofs[dy] = ytab_size;
 
-            func( src, dst, xtab, xtab_size, ytab, ytab_size, tabofs );
+            func( src, dst, xtab, xtab_size, ytab, ytab_size, tabofs, dstRows );
             return;
         }
     }
@@ -3478,7 +3472,67 @@ void resize(int src_type,
     }
 
     func( src, dst, xofs, fixpt ? (void*)ialpha : (void*)alpha, yofs,
-          fixpt ? (void*)ibeta : (void*)beta, xmin, xmax, ksize );
+          fixpt ? (void*)ibeta : (void*)beta, xmin, xmax, ksize, dstRows );
+}
+
+void resizeRows( const Mat& src, int srcY0, Size ssize, Mat& dst, const Range& dstRows, Size dsize,
+                 double inv_scale_x, double inv_scale_y, int interpolation )
+{
+    CV_Assert( src.type() == dst.type() && src.cols == ssize.width && dst.cols == dsize.width &&
+               srcY0 >= 0 && srcY0 + src.rows <= ssize.height && dst.rows == dstRows.size() );
+
+    // the headers of the whole images; only the rows held by src and dst are accessed
+    Mat src0(ssize, src.type(), const_cast<uchar*>(src.data) - src.step*srcY0, src.step);
+    Mat dst0(dsize, dst.type(), dst.data - dst.step*dstRows.start, dst.step);
+
+    resizeImpl( src0, dst0, inv_scale_x, inv_scale_y, interpolation, dstRows );
+}
+
+bool resizeHasAcceleratedPath( int type, Size ssize, Size dsize, double inv_scale_x, double inv_scale_y, int interpolation )
+{
+    // the cases a custom HAL handles are not known
+    if( cv_hal_resize != hal_ni_resize )
+        return true;
+#ifdef HAVE_IPP_IW
+    bool affine;
+    if( ipp::useIPP() && ipp_resizeInterpolation(ssize.width, ssize.height, dsize.width, dsize.height,
+                                                 inv_scale_x, inv_scale_y, CV_MAT_DEPTH(type), interpolation, affine) >= 0 )
+        return true;
+#else
+    CV_UNUSED(type); CV_UNUSED(ssize); CV_UNUSED(dsize); CV_UNUSED(inv_scale_x); CV_UNUSED(inv_scale_y); CV_UNUSED(interpolation);
+#endif
+    return false;
+}
+
+namespace hal {
+
+void resize(int src_type,
+            const uchar * src_data, size_t src_step, int src_width, int src_height,
+            uchar * dst_data, size_t dst_step, int dst_width, int dst_height,
+            double inv_scale_x, double inv_scale_y, int interpolation)
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert((dst_width * dst_height > 0) || (inv_scale_x > 0 && inv_scale_y > 0));
+    if (inv_scale_x < DBL_EPSILON || inv_scale_y < DBL_EPSILON)
+    {
+        inv_scale_x = static_cast<double>(dst_width) / src_width;
+        inv_scale_y = static_cast<double>(dst_height) / src_height;
+    }
+
+    CALL_HAL(resize, cv_hal_resize, src_type, src_data, src_step, src_width, src_height, dst_data, dst_step, dst_width, dst_height, inv_scale_x, inv_scale_y, interpolation);
+
+    Size dsize = Size(saturate_cast<int>(src_width*inv_scale_x),
+                        saturate_cast<int>(src_height*inv_scale_y));
+    CV_Assert( dsize.area() > 0 );
+
+    CV_IPP_RUN_FAST(ipp_resize(src_data, src_step, src_width, src_height, dst_data, dst_step, dsize.width, dsize.height, inv_scale_x, inv_scale_y,
+                               CV_MAT_DEPTH(src_type), CV_MAT_CN(src_type), interpolation))
+
+    Mat src(Size(src_width, src_height), src_type, const_cast<uchar*>(src_data), src_step);
+    Mat dst(dsize, src_type, dst_data, dst_step);
+
+    resizeImpl( src, dst, inv_scale_x, inv_scale_y, interpolation, Range(0, dsize.height) );
 }
 
 } // cv::hal::
@@ -449,6 +449,113 @@ static void momentsInTile( const Mat& img, double* moments )
         moments[x] = (double)mom[x];
 }
 
+class ContoursMomentsInvoker : public ParallelLoopBody
+{
+public:
+    ContoursMomentsInvoker( const _InputArray& _contours, std::vector<Moments>& _mu ) :
+        contours(&_contours), mu(&_mu) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+            (*mu)[i] = contourMoments(contours->getMat(i));
+    }
+
+private:
+    const _InputArray* contours;
+    std::vector<Moments>* mu;
+};
+
+// integer moments of the labels met in a band of rows, relative to the band origin
+struct LabelMomentsBand
+{
+    std::vector<int> labels;
+    std::vector<double> mom;
+};
+
+// every row is split into runs of equal labels, and the power sums of x over a run
+// are taken from the prefix sums, so the cost depends on the number of runs
+class LabelMomentsInvoker : public ParallelLoopBody
+{
+public:
+    enum { BAND = 32 };
+
+    LabelMomentsInvoker( const Mat& _labels, int _nlabels, const std::vector<double>& _psum,
+                         std::vector<LabelMomentsBand>& _bands ) :
+        labels(&_labels), nlabels(_nlabels), psum(&_psum), bands(&_bands) {}
+
+    void operator()( const Range& range ) const
+    {
+        std::vector<int> slot(nlabels, -1);
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            LabelMomentsBand& band = (*bands)[b];
+            int y0 = b*BAND, y1 = std::min(y0 + BAND, labels->rows);
+
+            for( int y = y0; y < y1; y++ )
+            {
+                if( labels->depth() == CV_32S )
+                    processRow( labels->ptr<int>(y), y - y0, band, slot );
+                else
+                    processRow( labels->ptr<ushort>(y), y - y0, band, slot );
+            }
+
+            for( size_t i = 0; i < band.labels.size(); i++ )
+                slot[band.labels[i]] = -1;
+        }
+    }
+
+private:
+    template<typename T>
+    void processRow( const T* row, int y, LabelMomentsBand& band, std::vector<int>& slot ) const
+    {
+        int width = labels->cols;
+        const double* p1 = &(*psum)[0];
+        const double* p2 = p1 + width + 1;
+        const double* p3 = p2 + width + 1;
+        double y1 = y, y2 = y1*y1, y3 = y2*y1;
+
+        for( int x = 0; x < width; )
+        {
+            int l = row[x], x1 = x + 1;
+            while( x1 < width && row[x1] == row[x] )
+                x1++;
+
+            if( (unsigned)l < (unsigned)nlabels )
+            {
+                int k = slot[l];
+                if( k < 0 )
+                {
+                    k = slot[l] = (int)band.labels.size();
+                    band.labels.push_back(l);
+                    band.mom.resize(band.mom.size() + 10, 0.);
+                }
+
+                double* m = &band.mom[k*10];
+                double n = x1 - x, s1 = p1[x1] - p1[x], s2 = p2[x1] - p2[x], s3 = p3[x1] - p3[x];
+
+                m[0] += n;
+                m[1] += s1;
+                m[2] += y1*n;
+                m[3] += s2;
+                m[4] += y1*s1;
+                m[5] += y2*n;
+                m[6] += s3;
+                m[7] += y1*s2;
+                m[8] += y2*s1;
+                m[9] += y3*n;
+            }
+            x = x1;
+        }
+    }
+
+    const Mat* labels;
+    int nlabels;
+    const std::vector<double>* psum;
+    std::vector<LabelMomentsBand>* bands;
+};
+
 typedef void (*MomentsInTileFunc)(const Mat& img, double* moments);
 
 Moments::Moments()
@@ -755,6 +862,82 @@ cv::Moments cv::moments( InputArray _src, bool binary )
 }
 
 
+void cv::contoursMoments( InputArrayOfArrays _contours, std::vector<Moments>& mu )
+{
+    CV_INSTRUMENT_REGION()
+
+    int i, n = (int)_contours.total();
+    mu.resize(n);
+
+    for( i = 0; i < n; i++ )
+    {
+        Mat c = _contours.getMat(i);
+        if( c.checkVector(2) < 0 || (c.depth() != CV_32S && c.depth() != CV_32F) )
+            CV_Error( CV_StsBadArg, "Every contour must be a vector of Point or Point2f" );
+    }
+
+    parallel_for_(Range(0, n), ContoursMomentsInvoker(_contours, mu));
+}
+
+
+void cv::labelsMoments( InputArray _labels, int nlabels, std::vector<Moments>& mu )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat labels = _labels.getMat();
+    CV_Assert( (labels.type() == CV_32SC1 || labels.type() == CV_16UC1) && nlabels >= 0 );
+
+    mu.assign(nlabels, Moments());
+    if( labels.empty() || nlabels == 0 )
+        return;
+
+    // the sums of x, x^2 and x^3 for 0 <= x < i; they are accumulated in double, as the sums of
+    // x^3 overflow int64 on wide images, and they are exact while below 2^53
+    int i, j, width = labels.cols;
+    std::vector<double> psum((width + 1)*3, 0.);
+    for( i = 0; i < width; i++ )
+    {
+        double x = i;
+        psum[i + 1] = psum[i] + x;
+        psum[width + 1 + i + 1] = psum[width + 1 + i] + x*x;
+        psum[(width + 1)*2 + i + 1] = psum[(width + 1)*2 + i] + x*x*x;
+    }
+
+    int nbands = (labels.rows + LabelMomentsInvoker::BAND - 1)/LabelMomentsInvoker::BAND;
+    std::vector<LabelMomentsBand> bands(nbands);
+    parallel_for_(Range(0, nbands), LabelMomentsInvoker(labels, nlabels, psum, bands));
+
+    // the bands are merged in order, so the result does not depend on the number of threads
+    for( i = 0; i < nbands; i++ )
+    {
+        const LabelMomentsBand& band = bands[i];
+        double y = (double)i*LabelMomentsInvoker::BAND;
+
+        for( j = 0; j < (int)band.labels.size(); j++ )
+        {
+            Moments& m = mu[band.labels[j]];
+            const double* mom = &band.mom[j*10];
+
+            double ym = y * mom[0];
+
+            m.m00 += mom[0];
+            m.m10 += mom[1];
+            m.m01 += mom[2] + ym;
+            m.m20 += mom[3];
+            m.m11 += mom[4] + y * mom[1];
+            m.m02 += mom[5] + y * (mom[2] * 2 + ym);
+            m.m30 += mom[6];
+            m.m21 += mom[7] + y * mom[3];
+            m.m12 += mom[8] + y * (2 * mom[4] + y * mom[1]);
+            m.m03 += mom[9] + y * (3. * mom[5] + y * (3. * mom[2] + ym));
+        }
+    }
+
+    for( i = 0; i < nlabels; i++ )
+        completeMomentState( &mu[i] );
+}
+
+
 void cv::HuMoments( const Moments& m, double hu[7] )
 {
     CV_INSTRUMENT_REGION()
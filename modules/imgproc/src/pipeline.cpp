@@ -0,0 +1,375 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+namespace cv
+{
+
+namespace
+{
+
+enum { PIPELINE_CVT_COLOR = 0, PIPELINE_RESIZE = 1, PIPELINE_GAUSSIAN_BLUR = 2, PIPELINE_CONVERT_TO = 3 };
+
+// the intermediate rows of a tile should fit into L2 cache
+enum { PIPELINE_TILE_BUDGET = 1 << 19, PIPELINE_MIN_TILE_ROWS = 8 };
+
+
+struct PipelineNode
+{
+    int op;
+
+    // cvtColor
+    int code, dstCn;
+
+    // resize
+    Size dsize;
+    double fx, fy;
+    int interpolation;
+
+    // GaussianBlur
+    Size ksize;
+    double sigmaX, sigmaY;
+    int borderType;
+
+    // convertTo
+    int rtype;
+    double alpha, beta;
+};
+
+// a node applied to an image of a known size and type
+struct PipelineStage
+{
+    const PipelineNode* node;
+    Size ssize, dsize;
+    int stype, dtype;
+    int radius;
+    double inv_scale_x, inv_scale_y;
+    bool copy;
+};
+
+static bool isPointwiseColorConversion( int code )
+{
+    return !((code >= COLOR_BayerBG2BGR && code <= COLOR_BayerGR2BGR) ||
+             (code >= COLOR_BayerBG2BGR_VNG && code <= COLOR_BayerGR2BGR_VNG) ||
+             (code >= COLOR_BayerBG2GRAY && code <= COLOR_BayerGR2GRAY) ||
+             (code >= COLOR_BayerBG2BGR_EA && code <= COLOR_BayerGR2BGRA) ||
+             (code >= COLOR_YUV2RGB_NV12 && code <= COLOR_YUV2GRAY_420) ||
+             (code >= COLOR_RGB2YUV_I420 && code <= COLOR_BGRA2YUV_YV12));
+}
+
+static void initStage( PipelineStage& stage, const PipelineNode& node, Size ssize, int stype )
+{
+    stage.node = &node;
+    stage.ssize = stage.dsize = ssize;
+    stage.stype = stage.dtype = stype;
+    stage.radius = 0;
+    stage.inv_scale_x = stage.inv_scale_y = 1;
+    stage.copy = false;
+
+    if( node.op == PIPELINE_CVT_COLOR )
+    {
+        Mat probe(2, 2, stype, Scalar::all(0)), dst;
+        cv::cvtColor( probe, dst, node.code, node.dstCn );
+        stage.dtype = dst.type();
+    }
+    else if( node.op == PIPELINE_RESIZE )
+    {
+        // the same size computation as in cv::resize
+        Size dsize = node.dsize;
+        double inv_scale_x = node.fx, inv_scale_y = node.fy;
+        if( dsize.area() == 0 )
+        {
+            dsize = Size(saturate_cast<int>(ssize.width*inv_scale_x),
+                         saturate_cast<int>(ssize.height*inv_scale_y));
+            CV_Assert( dsize.area() > 0 );
+        }
+        else
+        {
+            inv_scale_x = (double)dsize.width/ssize.width;
+            inv_scale_y = (double)dsize.height/ssize.height;
+        }
+        stage.dsize = dsize;
+        stage.inv_scale_x = inv_scale_x;
+        stage.inv_scale_y = inv_scale_y;
+        stage.copy = dsize == ssize;
+    }
+    else if( node.op == PIPELINE_GAUSSIAN_BLUR )
+    {
+        // the same kernel size as in createGaussianKernels
+        int depth = CV_MAT_DEPTH(stype), kheight = node.ksize.height;
+        double sigmaY = node.sigmaY <= 0 ? node.sigmaX : node.sigmaY;
+        if( kheight <= 0 && sigmaY > 0 )
+            kheight = cvRound(sigmaY*(depth == CV_8U ? 3 : 4)*2 + 1)|1;
+        stage.radius = std::max(kheight, 1)/2;
+    }
+    else if( node.op == PIPELINE_CONVERT_TO )
+    {
+        int rdepth = node.rtype < 0 ? CV_MAT_DEPTH(stype) : CV_MAT_DEPTH(node.rtype);
+        stage.dtype = CV_MAKETYPE(rdepth, CV_MAT_CN(stype));
+    }
+}
+
+// the source rows of the stage needed to compute the destination rows r
+static Range sourceRows( const PipelineStage& stage, const Range& r )
+{
+    int height = stage.ssize.height;
+    if( stage.node->op == PIPELINE_GAUSSIAN_BLUR )
+        return Range(std::max(r.start - stage.radius, 0), std::min(r.end + stage.radius, height));
+    if( stage.node->op == PIPELINE_RESIZE && !stage.copy )
+    {
+        // half of the interpolation kernel around the mapped rows, plus one row
+        // for the rounding of the source coordinates
+        int interpolation = stage.node->interpolation;
+        int margin = interpolation == INTER_CUBIC ? 3 : interpolation == INTER_LANCZOS4 ? 5 : 2;
+        double scale_y = 1./stage.inv_scale_y;
+        return Range(std::max(cvFloor(r.start*scale_y) - margin, 0),
+                     std::min(cvCeil(r.end*scale_y) + margin, height));
+    }
+    return r;
+}
+
+static void runStage( const PipelineStage& stage, const Mat& src, const Range& srows, Mat& dst, const Range& drows )
+{
+    const PipelineNode& node = *stage.node;
+
+    if( node.op == PIPELINE_CVT_COLOR )
+        cv::cvtColor( src, dst, node.code, node.dstCn );
+    else if( node.op == PIPELINE_CONVERT_TO )
+        src.convertTo( dst, node.rtype, node.alpha, node.beta );
+    else if( stage.copy )
+        src.copyTo( dst );
+    else if( node.op == PIPELINE_RESIZE )
+        resizeRows( src, srows.start, stage.ssize, dst, drows, stage.dsize,
+                    stage.inv_scale_x, stage.inv_scale_y, node.interpolation );
+    else
+    {
+        // the rows around the band are read through the ROI, as in the whole image
+        Mat band = src.rowRange(drows.start - srows.start, drows.end - srows.start);
+        cv::GaussianBlur( band, dst, node.ksize, node.sigmaX, node.sigmaY, node.borderType );
+    }
+}
+
+// The tiles give the result of the built-in code of resize and GaussianBlur. IPP, OpenVX, Tegra
+// and a custom HAL may replace it in the calls for the whole images, and either skip the bands
+// or are not known to give the same result on them, so such stages run on the whole images.
+// The point-wise cvtColor and convertTo give the same pixels on the bands in any case.
+static bool isAccelerated( const PipelineStage& stage )
+{
+    const PipelineNode& node = *stage.node;
+    if( node.op == PIPELINE_RESIZE )
+        return !stage.copy && resizeHasAcceleratedPath( stage.stype, stage.ssize, stage.dsize,
+                                                        stage.inv_scale_x, stage.inv_scale_y, node.interpolation );
+    if( node.op == PIPELINE_GAUSSIAN_BLUR )
+        return gaussianBlurHasAcceleratedPath( stage.stype, stage.ssize, node.ksize,
+                                               node.sigmaX, node.sigmaY, node.borderType );
+    return false;
+}
+
+// the function call of the node on the whole image
+static void runNode( const PipelineNode& node, const Mat& src, OutputArray dst )
+{
+    if( node.op == PIPELINE_CVT_COLOR )
+        cv::cvtColor( src, dst, node.code, node.dstCn );
+    else if( node.op == PIPELINE_RESIZE )
+        cv::resize( src, dst, node.dsize, node.fx, node.fy, node.interpolation );
+    else if( node.op == PIPELINE_GAUSSIAN_BLUR )
+        cv::GaussianBlur( src, dst, node.ksize, node.sigmaX, node.sigmaY, node.borderType );
+    else
+        src.convertTo( dst, node.rtype, node.alpha, node.beta );
+}
+
+class PipelineInvoker : public ParallelLoopBody
+{
+public:
+    PipelineInvoker( const PipelineStage* _stages, int _nstages, const Mat& _src, Mat& _dst, int _tileRows ) :
+        stages(_stages), nstages(_nstages), src(&_src), dst(&_dst), tileRows(_tileRows) {}
+
+    void operator()( const Range& range ) const
+    {
+        const PipelineStage* st = stages;
+        int i, n = nstages;
+        std::vector<Range> rows(n + 1);
+        std::vector<Mat> bufs(n + 1);
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            rows[n] = Range(t*tileRows, std::min((t + 1)*tileRows, dst->rows));
+            for( i = n - 1; i >= 0; i-- )
+                rows[i] = sourceRows(st[i], rows[i + 1]);
+
+            bufs[0] = src->rowRange(rows[0]);
+            bufs[n] = dst->rowRange(rows[n]);
+
+            for( i = 0; i < n; i++ )
+            {
+                if( i + 1 < n )
+                    bufs[i + 1].create(rows[i + 1].size(), st[i].dsize.width, st[i].dtype);
+                runStage( st[i], bufs[i], rows[i], bufs[i + 1], rows[i + 1] );
+            }
+        }
+    }
+
+private:
+    const PipelineStage* stages;
+    int nstages;
+    const Mat* src;
+    Mat* dst;
+    int tileRows;
+};
+
+// runs the stages tile by tile, without storing the intermediate images in full
+static void runTiles( const PipelineStage* stages, int n, Mat src, OutputArray _dst )
+{
+    int i;
+    Size size = stages[n-1].dsize;
+    double rowBytes = 0;
+    for( i = 0; i < n - 1; i++ )
+        rowBytes += (double)stages[i].dsize.width*CV_ELEM_SIZE(stages[i].dtype)*stages[i].dsize.height;
+
+    _dst.create( size, stages[n-1].dtype );
+    Mat dst = _dst.getMat();
+    if( dst.data == src.data )
+        src = src.clone();
+
+    // the number of rows per tile, so that the intermediate rows fit into the budget,
+    // but not much less than the row overhead of the filters
+    int halo = 0;
+    for( i = 0; i < n; i++ )
+        halo = std::max(halo, stages[i].radius*size.height/std::max(stages[i].dsize.height, 1));
+    rowBytes /= size.height;
+    int tileRows = rowBytes > 0 ? cvFloor(PIPELINE_TILE_BUDGET/rowBytes) : size.height;
+    tileRows = std::min(std::max(std::max(tileRows, (int)PIPELINE_MIN_TILE_ROWS), halo*4), size.height);
+
+    int ntiles = (size.height + tileRows - 1)/tileRows;
+    parallel_for_(Range(0, ntiles), PipelineInvoker(stages, n, src, dst, tileRows));
+}
+
+class ImagePipelineImpl : public ImagePipeline
+{
+public:
+    void addCvtColor( int code, int dstCn )
+    {
+        CV_Assert( isPointwiseColorConversion(code) );
+
+        PipelineNode node = PipelineNode();
+        node.op = PIPELINE_CVT_COLOR;
+        node.code = code;
+        node.dstCn = dstCn;
+        nodes.push_back(node);
+    }
+
+    void addResize( Size dsize, double fx, double fy, int interpolation )
+    {
+        CV_Assert( dsize.area() > 0 || (fx > 0 && fy > 0) );
+        CV_Assert( interpolation == INTER_NEAREST || interpolation == INTER_LINEAR ||
+                   interpolation == INTER_CUBIC || interpolation == INTER_AREA ||
+                   interpolation == INTER_LANCZOS4 );
+
+        PipelineNode node = PipelineNode();
+        node.op = PIPELINE_RESIZE;
+        node.dsize = dsize;
+        node.fx = fx;
+        node.fy = fy;
+        node.interpolation = interpolation;
+        nodes.push_back(node);
+    }
+
+    void addGaussianBlur( Size ksize, double sigmaX, double sigmaY, int borderType )
+    {
+        CV_Assert( (borderType & BORDER_ISOLATED) == 0 && borderType != BORDER_WRAP );
+
+        PipelineNode node = PipelineNode();
+        node.op = PIPELINE_GAUSSIAN_BLUR;
+        node.ksize = ksize;
+        node.sigmaX = sigmaX;
+        node.sigmaY = sigmaY;
+        node.borderType = borderType;
+        nodes.push_back(node);
+    }
+
+    void addConvertTo( int rtype, double alpha, double beta )
+    {
+        PipelineNode node = PipelineNode();
+        node.op = PIPELINE_CONVERT_TO;
+        node.rtype = rtype;
+        node.alpha = alpha;
+        node.beta = beta;
+        nodes.push_back(node);
+    }
+
+    void apply( InputArray _src, OutputArray _dst )
+    {
+        CV_INSTRUMENT_REGION()
+
+        Mat src = _src.getMat();
+        CV_Assert( !src.empty() && src.dims <= 2 );
+
+        if( nodes.empty() )
+        {
+            src.copyTo(_dst);
+            return;
+        }
+
+        int i, j, n = (int)nodes.size();
+        std::vector<PipelineStage> stages(n);
+        Size size = src.size();
+        int type = src.type();
+
+        for( i = 0; i < n; i++ )
+        {
+            initStage( stages[i], nodes[i], size, type );
+            size = stages[i].dsize;
+            type = stages[i].dtype;
+        }
+
+        // the accelerated stages run on the whole images, the runs of the other stages by tiles;
+        // the last one writes to dst
+        Mat img = src;
+        for( i = 0; i < n; i = j )
+        {
+            Mat res;
+            if( isAccelerated(stages[i]) )
+            {
+                j = i + 1;
+                if( j < n )
+                    runNode( nodes[i], img, res );
+                else
+                    runNode( nodes[i], img, _dst );
+            }
+            else
+            {
+                for( j = i + 1; j < n && !isAccelerated(stages[j]); j++ )
+                    ;
+                if( j < n )
+                    runTiles( &stages[i], j - i, img, res );
+                else
+                    runTiles( &stages[i], j - i, img, _dst );
+            }
+            img = res;
+        }
+    }
+
+    void clear()
+    {
+        nodes.clear();
+    }
+
+    bool empty() const
+    {
+        return nodes.empty();
+    }
+
+private:
+    std::vector<PipelineNode> nodes;
+};
+
+}
+
+}
+
+cv::Ptr<cv::ImagePipeline> cv::createImagePipeline()
+{
+    return makePtr<ImagePipelineImpl>();
+}
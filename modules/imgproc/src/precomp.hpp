@@ -106,6 +106,20 @@ static inline IppiInterpolationType ippiGetInterpolation(int inter)
 }
 #endif
 
+namespace cv
+{
+// computes the rows dstRows of resize() of an ssize image into a dsize one. src holds the source
+// rows [srcY0, srcY0 + src.rows), which must include all the rows the interpolation reads.
+void resizeRows( const Mat& src, int srcY0, Size ssize, Mat& dst, const Range& dstRows, Size dsize,
+                 double inv_scale_x, double inv_scale_y, int interpolation );
+
+// true if resize() of an ssize image into a dsize one may run IPP or a custom HAL instead of resizeImpl
+bool resizeHasAcceleratedPath( int type, Size ssize, Size dsize, double inv_scale_x, double inv_scale_y, int interpolation );
+
+// true if GaussianBlur() of a size image may run IPP, OpenVX, Tegra or a custom HAL instead of sepFilter2D
+bool gaussianBlurHasAcceleratedPath( int type, Size size, Size ksize, double sigma1, double sigma2, int borderType );
+}
+
 #include "_geom.h"
 #include "filterengine.hpp"
 
@@ -2289,6 +2289,18 @@ private:
 
 #endif
 
+// the parameters ipp_GaussianBlur handles, whatever the image
+static bool ipp_GaussianBlurSupported(Size ksize, double sigma1, double sigma2, int borderType)
+{
+#if defined HAVE_IPP_IW && !(IPP_VERSION_X100 <= 201702 && ((defined _MSC_VER && defined _M_IX86) || (defined __GNUC__ && defined __i386__)))
+    return sigma1 == sigma2 && sigma1 >= FLT_EPSILON && ksize.width == ksize.height &&
+           ippiGetBorderType(borderType & ~BORDER_ISOLATED) != (IppiBorderType)-1;
+#else
+    CV_UNUSED(ksize); CV_UNUSED(sigma1); CV_UNUSED(sigma2); CV_UNUSED(borderType);
+    return false;
+#endif
+}
+
 static bool ipp_GaussianBlur(InputArray _src, OutputArray _dst, Size ksize,
                    double sigma1, double sigma2, int borderType )
 {
@@ -2299,13 +2311,7 @@ static bool ipp_GaussianBlur(InputArray _src, OutputArray _dst, Size ksize,
     CV_UNUSED(_src); CV_UNUSED(_dst); CV_UNUSED(ksize); CV_UNUSED(sigma1); CV_UNUSED(sigma2); CV_UNUSED(borderType);
     return false; // bug on ia32
 #else
-    if(sigma1 != sigma2)
-        return false;
-
-    if(sigma1 < FLT_EPSILON)
-        return false;
-
-    if(ksize.width != ksize.height)
+    if(!ipp_GaussianBlurSupported(ksize, sigma1, sigma2, borderType))
         return false;
 
     // Acquire data and begin processing
@@ -2353,6 +2359,33 @@ static bool ipp_GaussianBlur(InputArray _src, OutputArray _dst, Size ksize,
 #endif
 }
 
+bool cv::gaussianBlurHasAcceleratedPath( int type, Size size, Size ksize, double sigma1, double sigma2, int borderType )
+{
+    // the cases a custom HAL handles are not known
+    if( cv_hal_sepFilterInit != hal_ni_sepFilterInit )
+        return true;
+#ifdef HAVE_OPENVX
+    // the 3x3 kernels of openvx_gaussianBlur
+    if( useOpenVX() && type == CV_8UC1 && size.width >= 3 && size.height >= 3 &&
+        (ksize.width == 3 || (ksize.width <= 0 && cvRound(sigma1*6 + 1) == 3)) &&
+        (ksize.height == 3 || (ksize.height <= 0 && cvRound((sigma2 <= 0 ? sigma1 : sigma2)*6 + 1) == 3)) )
+        return true;
+#else
+    CV_UNUSED(type); CV_UNUSED(size);
+#endif
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    if( sigma1 == 0 && sigma2 == 0 && tegra::useTegra() )
+        return true;
+#endif
+#ifdef HAVE_IPP
+    if( ipp::useIPP() && ipp_GaussianBlurSupported(ksize, sigma1, sigma2, borderType) )
+        return true;
+#else
+    CV_UNUSED(ksize); CV_UNUSED(sigma1); CV_UNUSED(sigma2); CV_UNUSED(borderType);
+#endif
+    return false;
+}
+
 void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
                    double sigma1, double sigma2,
                    int borderType )
@@ -2402,6 +2435,340 @@ void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
     sepFilter2D(_src, _dst, CV_MAT_DEPTH(type), kx, ky, Point(-1,-1), 0, borderType );
 }
 
+/****************************************************************************************\
+                                 Recursive Gaussian Blur
+\****************************************************************************************/
+
+namespace cv
+{
+
+// Deriche's 4th-order approximation of the Gaussian,
+//   h(x) = sum_j (A_j*cos(W_j*x/sigma) + B_j*sin(W_j*x/sigma))*exp(L_j*|x|/sigma), j = 0, 1,
+// computed as the sum of two 2nd-order sections, each one having a causal and an anti-causal part:
+//   y+[n] = n0*x[n] + n1*x[n-1] - d1*y+[n-1] - d2*y+[n-2]
+//   y-[n] = m0*x[n+1] + m1*x[n+2] - d1*y-[n+1] - d2*y-[n+2]
+// The parallel form (instead of the single 4th-order recursion) keeps the poles, which get
+// very close to 1 for large sigmas, well-conditioned in single precision.
+struct RecursiveGaussianCoeffs
+{
+    RecursiveGaussianCoeffs( double sigma )
+    {
+        static const double A[] = { 1.3530, -0.3531 }, B[] = { 1.8151, 0.0902 };
+        static const double W[] = { 0.6681, 2.0787 }, L[] = { -1.3932, -1.3732 };
+        double N0[2], N1[2], M0[2], M1[2], D1[2], D2[2], sum = 0;
+        int j;
+
+        for( j = 0; j < 2; j++ )
+        {
+            double e = std::exp(L[j]/sigma), c = std::cos(W[j]/sigma), s = std::sin(W[j]/sigma);
+            N0[j] = A[j];
+            N1[j] = e*(B[j]*s - A[j]*c);
+            D1[j] = -2*e*c;
+            D2[j] = e*e;
+            M0[j] = N1[j] - A[j]*D1[j];
+            M1[j] = -A[j]*D2[j];
+            sum += (N0[j] + N1[j] + M0[j] + M1[j])/(1 + D1[j] + D2[j]);
+        }
+
+        // normalize the kernel to the unit sum
+        for( j = 0; j < 2; j++ )
+        {
+            double D = 1 + D1[j] + D2[j];
+            n[j][0] = (float)(N0[j]/sum);
+            n[j][1] = (float)(N1[j]/sum);
+            m[j][0] = (float)(M0[j]/sum);
+            m[j][1] = (float)(M1[j]/sum);
+            d[j][0] = (float)D1[j];
+            d[j][1] = (float)D2[j];
+            // the responses to a constant signal, used for the replicated borders
+            gainN[j] = (float)((N0[j] + N1[j])/(sum*D));
+            gainM[j] = (float)((M0[j] + M1[j])/(sum*D));
+        }
+    }
+
+    float n[2][2], m[2][2], d[2][2];
+    float gainN[2], gainM[2];
+};
+
+// dst[j] = a[0]*p0[j] + a[1]*p1[j] - d[0]*q1[j] - d[1]*q2[j]
+static void recursiveGaussianStep( const float* p0, const float* p1, const float* a,
+                                   const float* q1, const float* q2, const float* d,
+                                   float* dst, int len, bool haveSIMD )
+{
+    int j = 0;
+#if CV_SIMD128
+    if( haveSIMD )
+    {
+        v_float32x4 a0 = v_setall_f32(a[0]), a1 = v_setall_f32(a[1]);
+        v_float32x4 d1 = v_setall_f32(d[0]), d2 = v_setall_f32(d[1]);
+
+        for( ; j <= len - 4; j += 4 )
+        {
+            v_float32x4 s = a0*v_load(p0 + j) + a1*v_load(p1 + j);
+            v_float32x4 t = d1*v_load(q1 + j) + d2*v_load(q2 + j);
+            v_store(dst + j, s - t);
+        }
+    }
+#else
+    (void)haveSIMD;
+#endif
+    for( ; j < len; j++ )
+        dst[j] = a[0]*p0[j] + a[1]*p1[j] - d[0]*q1[j] - d[1]*q2[j];
+}
+
+// filters every row of the floating-point image in-place; with SIMD, 4 rows are filtered at once
+class RecursiveGaussianRowInvoker : public ParallelLoopBody
+{
+public:
+    RecursiveGaussianRowInvoker( Mat& _buf, double sigma ) : buf(&_buf), c(sigma)
+    {
+        haveSIMD = hasSIMD128();
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int width = buf->cols, cn = buf->channels();
+        AutoBuffer<float> _rowbuf(width*8);
+        float* xrow = _rowbuf;
+        float* yrow = xrow + width*4;
+        int i = range.start;
+
+#if CV_SIMD128
+        for( ; haveSIMD && i <= range.end - 4; i += 4 )
+        {
+            float* row[4];
+            for( int r = 0; r < 4; r++ )
+                row[r] = buf->ptr<float>(i + r);
+
+            for( int k = 0; k < cn; k++ )
+            {
+                int x;
+                for( x = 0; x < width; x++ )
+                    for( int r = 0; r < 4; r++ )
+                        xrow[x*4 + r] = row[r][x*cn + k];
+
+                v_float32x4 n00 = v_setall_f32(c.n[0][0]), n01 = v_setall_f32(c.n[0][1]);
+                v_float32x4 n10 = v_setall_f32(c.n[1][0]), n11 = v_setall_f32(c.n[1][1]);
+                v_float32x4 d00 = v_setall_f32(c.d[0][0]), d01 = v_setall_f32(c.d[0][1]);
+                v_float32x4 d10 = v_setall_f32(c.d[1][0]), d11 = v_setall_f32(c.d[1][1]);
+
+                v_float32x4 x1 = v_load(xrow);
+                v_float32x4 y01 = x1*v_setall_f32(c.gainN[0]), y02 = y01;
+                v_float32x4 y11 = x1*v_setall_f32(c.gainN[1]), y12 = y11;
+                for( x = 0; x < width; x++ )
+                {
+                    v_float32x4 x0 = v_load(xrow + x*4);
+                    v_float32x4 y00 = n00*x0 + n01*x1 - d00*y01 - d01*y02;
+                    v_float32x4 y10 = n10*x0 + n11*x1 - d10*y11 - d11*y12;
+                    x1 = x0;
+                    y02 = y01; y01 = y00;
+                    y12 = y11; y11 = y10;
+                    v_store(yrow + x*4, y00 + y10);
+                }
+
+                n00 = v_setall_f32(c.m[0][0]); n01 = v_setall_f32(c.m[0][1]);
+                n10 = v_setall_f32(c.m[1][0]); n11 = v_setall_f32(c.m[1][1]);
+
+                x1 = v_load(xrow + (width - 1)*4);
+                v_float32x4 x2 = x1;
+                y01 = y02 = x1*v_setall_f32(c.gainM[0]);
+                y11 = y12 = x1*v_setall_f32(c.gainM[1]);
+                for( x = width - 1; x >= 0; x-- )
+                {
+                    v_float32x4 y00 = n00*x1 + n01*x2 - d00*y01 - d01*y02;
+                    v_float32x4 y10 = n10*x1 + n11*x2 - d10*y11 - d11*y12;
+                    x2 = x1; x1 = v_load(xrow + x*4);
+                    y02 = y01; y01 = y00;
+                    y12 = y11; y11 = y10;
+                    v_store(yrow + x*4, v_load(yrow + x*4) + y00 + y10);
+                }
+
+                for( x = 0; x < width; x++ )
+                    for( int r = 0; r < 4; r++ )
+                        row[r][x*cn + k] = yrow[x*4 + r];
+            }
+        }
+#endif
+
+        for( ; i < range.end; i++ )
+        {
+            float* row = buf->ptr<float>(i);
+            for( int k = 0; k < cn; k++ )
+            {
+                int x;
+                for( x = 0; x < width; x++ )
+                    xrow[x] = row[x*cn + k];
+
+                const float (*n)[2] = c.n, (*m)[2] = c.m, (*d)[2] = c.d;
+                float x1 = xrow[0], x2;
+                float y01 = x1*c.gainN[0], y02 = y01, y11 = x1*c.gainN[1], y12 = y11;
+
+                for( x = 0; x < width; x++ )
+                {
+                    float x0 = xrow[x];
+                    float y00 = n[0][0]*x0 + n[0][1]*x1 - d[0][0]*y01 - d[0][1]*y02;
+                    float y10 = n[1][0]*x0 + n[1][1]*x1 - d[1][0]*y11 - d[1][1]*y12;
+                    x1 = x0;
+                    y02 = y01; y01 = y00;
+                    y12 = y11; y11 = y10;
+                    yrow[x] = y00 + y10;
+                }
+
+                x1 = x2 = xrow[width - 1];
+                y01 = y02 = x1*c.gainM[0];
+                y11 = y12 = x1*c.gainM[1];
+                for( x = width - 1; x >= 0; x-- )
+                {
+                    float y00 = m[0][0]*x1 + m[0][1]*x2 - d[0][0]*y01 - d[0][1]*y02;
+                    float y10 = m[1][0]*x1 + m[1][1]*x2 - d[1][0]*y11 - d[1][1]*y12;
+                    x2 = x1; x1 = xrow[x];
+                    y02 = y01; y01 = y00;
+                    y12 = y11; y11 = y10;
+                    row[x*cn + k] = yrow[x] + y00 + y10;
+                }
+            }
+        }
+    }
+
+private:
+    Mat* buf;
+    RecursiveGaussianCoeffs c;
+    bool haveSIMD;
+};
+
+// filters the columns of the floating-point image in-place, a strip of columns at a time
+class RecursiveGaussianColumnInvoker : public ParallelLoopBody
+{
+public:
+    enum { STRIP = 128 };
+
+    RecursiveGaussianColumnInvoker( Mat& _buf, double sigma ) : buf(&_buf), c(sigma)
+    {
+        haveSIMD = hasSIMD128();
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int height = buf->rows, len = buf->cols*buf->channels();
+        // the sum of the causal parts for the whole strip, then 3 rows of each section's
+        // output and 3 rows of the input
+        AutoBuffer<float> _strip((height + 9)*STRIP);
+        float* acc = _strip;
+        float* rows = acc + height*STRIP;
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            int x0 = s*STRIP, n = std::min(len - x0, (int)STRIP);
+            float *y[2][3], *xr[3];
+            int i, j, k;
+
+            for( k = 0; k < 3; k++ )
+            {
+                y[0][k] = rows + k*STRIP;
+                y[1][k] = rows + (k + 3)*STRIP;
+                xr[k] = rows + (k + 6)*STRIP;
+            }
+
+            const float* row0 = buf->ptr<float>(0) + x0;
+            for( j = 0; j < 2; j++ )
+                for( k = 0; k < n; k++ )
+                    y[j][1][k] = y[j][2][k] = row0[k]*c.gainN[j];
+
+            for( i = 0; i < height; i++ )
+            {
+                const float* x0row = buf->ptr<float>(i) + x0;
+                const float* x1row = buf->ptr<float>(std::max(i - 1, 0)) + x0;
+                float* a = acc + i*STRIP;
+
+                for( j = 0; j < 2; j++ )
+                {
+                    recursiveGaussianStep(x0row, x1row, c.n[j], y[j][1], y[j][2], c.d[j], y[j][0], n, haveSIMD);
+                    std::swap(y[j][2], y[j][0]);
+                    std::swap(y[j][1], y[j][2]);
+                }
+                for( k = 0; k < n; k++ )
+                    a[k] = y[0][1][k] + y[1][1][k];
+            }
+
+            const float* rowN = buf->ptr<float>(height - 1) + x0;
+            for( k = 0; k < n; k++ )
+            {
+                xr[1][k] = xr[2][k] = rowN[k];
+                for( j = 0; j < 2; j++ )
+                    y[j][1][k] = y[j][2][k] = rowN[k]*c.gainM[j];
+            }
+
+            for( i = height - 1; i >= 0; i-- )
+            {
+                float* row = buf->ptr<float>(i) + x0;
+                const float* a = acc + i*STRIP;
+
+                for( j = 0; j < 2; j++ )
+                {
+                    recursiveGaussianStep(xr[1], xr[2], c.m[j], y[j][1], y[j][2], c.d[j], y[j][0], n, haveSIMD);
+                    std::swap(y[j][2], y[j][0]);
+                    std::swap(y[j][1], y[j][2]);
+                }
+                std::swap(xr[2], xr[0]);
+                std::swap(xr[1], xr[2]);
+
+                for( k = 0; k < n; k++ )
+                {
+                    xr[1][k] = row[k];
+                    row[k] = a[k] + y[0][1][k] + y[1][1][k];
+                }
+            }
+        }
+    }
+
+private:
+    Mat* buf;
+    RecursiveGaussianCoeffs c;
+    bool haveSIMD;
+};
+
+}
+
+void cv::recursiveGaussianBlur( InputArray _src, OutputArray _dst, double sigmaX,
+                                double sigmaY, int borderType )
+{
+    CV_INSTRUMENT_REGION()
+
+    int type = _src.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_16S || depth == CV_32F );
+    CV_Assert( (borderType & ~BORDER_ISOLATED) == BORDER_REPLICATE );
+
+    if( sigmaY <= 0 )
+        sigmaY = sigmaX;
+    CV_Assert( sigmaX >= 0.5 && sigmaY >= 0.5 );
+
+    Mat src = _src.getMat();
+    _dst.create( src.size(), type );
+    Mat dst = _dst.getMat();
+    if( src.empty() )
+        return;
+
+    Mat buf;
+    if( depth == CV_32F )
+    {
+        src.copyTo(dst);
+        buf = dst;
+    }
+    else
+    {
+        // the offset keeps the filter states away from denormals in the flat dark areas
+        src.convertTo(buf, CV_32F, 1, 1);
+    }
+
+    parallel_for_(Range(0, buf.rows), RecursiveGaussianRowInvoker(buf, sigmaX));
+
+    int nstrips = (buf.cols*cn + RecursiveGaussianColumnInvoker::STRIP - 1)/RecursiveGaussianColumnInvoker::STRIP;
+    parallel_for_(Range(0, nstrips), RecursiveGaussianColumnInvoker(buf, sigmaY));
+
+    if( depth != CV_32F )
+        buf.convertTo(dst, depth, 1, -1);
+}
+
 /****************************************************************************************\
                                       Median Filter
 \****************************************************************************************/
@@ -4375,6 +4742,318 @@ void cv::bilateralFilter( InputArray _src, OutputArray _dst, int d,
         "Bilateral filtering is only implemented for 8u and 32f images" );
 }
 
+/****************************************************************************************\
+                                  Bilateral Grid Filter
+\****************************************************************************************/
+
+namespace cv
+{
+
+// The bilateral grid: the pixels of a single-channel image are splatted into a coarse
+// (x, y, intensity) grid of the homogeneous values (value*weight, weight), the grid is blurred
+// with the [1 4 6 4 1]/16 kernel, which is a Gaussian with sigma of one cell, along each of the
+// 3 dimensions and the result is sliced back at the pixel positions. The grid is sampled at
+// sigmaSpace in x and y and at sigmaColor in intensity.
+struct BilateralGrid
+{
+    // MAX_CELLS bounds the memory of the two grid buffers (256MB)
+    enum { PAD = 2, CH = 2, MAX_CELLS = 1 << 24 };
+
+    int gx, gy, gz;
+    double sspace, scolor, vmin;
+    size_t rowstep;
+};
+
+// dst[j] = (p0[j] + 4*p1[j] + 6*p2[j] + 4*p3[j] + p4[j])/16; the absent neighbors are passed as zeros
+static void bilateralGridBlurLine( const float* p0, const float* p1, const float* p2,
+                                   const float* p3, const float* p4, float* dst, int len,
+                                   bool haveSIMD )
+{
+    int j = 0;
+#if CV_SIMD128
+    if( haveSIMD )
+    {
+        v_float32x4 k1 = v_setall_f32(1.f/16), k4 = v_setall_f32(4.f/16), k6 = v_setall_f32(6.f/16);
+        for( ; j <= len - 4; j += 4 )
+        {
+            v_float32x4 s = k1*(v_load(p0 + j) + v_load(p4 + j)) +
+                            k4*(v_load(p1 + j) + v_load(p3 + j)) + k6*v_load(p2 + j);
+            v_store(dst + j, s);
+        }
+    }
+#else
+    (void)haveSIMD;
+#endif
+    for( ; j < len; j++ )
+        dst[j] = (p0[j] + p4[j])*(1.f/16) + (p1[j] + p3[j])*(4.f/16) + p2[j]*(6.f/16);
+}
+
+// accumulates the pixels into the grid rows [range); every grid row takes the image rows
+// which are interpolated from it, so the rows can be processed independently
+class BilateralGridSplatInvoker : public ParallelLoopBody
+{
+public:
+    BilateralGridSplatInvoker( const Mat& _src, const BilateralGrid& _g, float* _grid,
+                               const int* _xofs, const float* _xalpha ) :
+        src(&_src), g(_g), grid(_grid), xofs(_xofs), xalpha(_xalpha) {}
+
+    void operator()( const Range& range ) const
+    {
+        const int zstep = BilateralGrid::CH, xstep = g.gz*BilateralGrid::CH;
+        float zscale = (float)(1./g.scolor), zofs = (float)(BilateralGrid::PAD - g.vmin/g.scolor);
+
+        for( int gy = range.start; gy < range.end; gy++ )
+        {
+            float* grow = grid + g.rowstep*gy;
+            int cell = gy - BilateralGrid::PAD;
+            int y0 = std::max(cvFloor((cell - 1)*g.sspace), 0);
+            int y1 = std::min(cvCeil((cell + 1)*g.sspace) + 1, src->rows);
+
+            memset(grow, 0, g.rowstep*sizeof(float));
+            for( int y = y0; y < y1; y++ )
+            {
+                double fy = y/g.sspace;
+                int iy = cvFloor(fy);
+                float wy;
+                if( iy == cell )
+                    wy = (float)(1 - (fy - iy));
+                else if( iy + 1 == cell )
+                    wy = (float)(fy - iy);
+                else
+                    continue;
+
+                const float* srow = src->ptr<float>(y);
+                for( int x = 0; x < src->cols; x++ )
+                {
+                    float v = srow[x], fz = v*zscale + zofs;
+                    int iz = cvFloor(fz);
+                    float wz = fz - iz, wx = xalpha[x];
+                    float w00 = wy*(1 - wx)*(1 - wz), w01 = wy*(1 - wx)*wz;
+                    float w10 = wy*wx*(1 - wz), w11 = wy*wx*wz;
+                    float* c00 = grow + xofs[x] + iz*zstep;
+                    float* c10 = c00 + xstep;
+
+                    c00[0] += w00*v; c00[1] += w00;
+                    c00[zstep] += w01*v; c00[zstep + 1] += w01;
+                    c10[0] += w10*v; c10[1] += w10;
+                    c10[zstep] += w11*v; c10[zstep + 1] += w11;
+                }
+            }
+        }
+    }
+
+private:
+    const Mat* src;
+    BilateralGrid g;
+    float* grid;
+    const int* xofs;
+    const float* xalpha;
+};
+
+// blurs the grid along the intensity and x (pass == 0) or along y (pass == 1), from src to dst
+class BilateralGridBlurInvoker : public ParallelLoopBody
+{
+public:
+    BilateralGridBlurInvoker( const BilateralGrid& _g, const float* _src, float* _dst, int _pass ) :
+        g(_g), src(_src), dst(_dst), pass(_pass)
+    {
+        haveSIMD = hasSIMD128();
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int c = BilateralGrid::CH;
+        int zlen = g.gz*c, rowlen = (int)g.rowstep;
+        AutoBuffer<float> _buf(zlen + 4*c + rowlen*2);
+        float* zbuf = _buf;
+        float* zero = zbuf + zlen + 4*c;
+        float* tmp = zero + rowlen;
+
+        memset(zbuf, 0, (zlen + 4*c + rowlen)*sizeof(float));
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            float* drow = dst + g.rowstep*y;
+            if( pass == 1 )
+            {
+                const float* p[5];
+                for( int k = 0; k < 5; k++ )
+                {
+                    int yk = y + k - 2;
+                    p[k] = yk >= 0 && yk < g.gy ? src + g.rowstep*yk : zero;
+                }
+                bilateralGridBlurLine(p[0], p[1], p[2], p[3], p[4], drow, rowlen, haveSIMD);
+                continue;
+            }
+
+            const float* srow = src + g.rowstep*y;
+            for( int x = 0; x < g.gx; x++ )
+            {
+                memcpy(zbuf + 2*c, srow + x*zlen, zlen*sizeof(float));
+                bilateralGridBlurLine(zbuf, zbuf + c, zbuf + 2*c, zbuf + 3*c, zbuf + 4*c,
+                                      tmp + x*zlen, zlen, haveSIMD);
+            }
+            for( int x = 0; x < g.gx; x++ )
+            {
+                const float* p[5];
+                for( int k = 0; k < 5; k++ )
+                {
+                    int xk = x + k - 2;
+                    p[k] = xk >= 0 && xk < g.gx ? tmp + xk*zlen : zero;
+                }
+                bilateralGridBlurLine(p[0], p[1], p[2], p[3], p[4], drow + x*zlen, zlen, haveSIMD);
+            }
+        }
+    }
+
+private:
+    BilateralGrid g;
+    const float* src;
+    float* dst;
+    int pass;
+    bool haveSIMD;
+};
+
+// interpolates the blurred grid at every pixel and normalizes by the interpolated weight
+class BilateralGridSliceInvoker : public ParallelLoopBody
+{
+public:
+    BilateralGridSliceInvoker( const Mat& _src, Mat& _dst, const BilateralGrid& _g, const float* _grid,
+                               const int* _xofs, const float* _xalpha ) :
+        src(&_src), dst(&_dst), g(_g), grid(_grid), xofs(_xofs), xalpha(_xalpha) {}
+
+    void operator()( const Range& range ) const
+    {
+        const int zstep = BilateralGrid::CH, xstep = g.gz*BilateralGrid::CH;
+        int ystep = (int)g.rowstep;
+        float zscale = (float)(1./g.scolor), zofs = (float)(BilateralGrid::PAD - g.vmin/g.scolor);
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            double fy = y/g.sspace;
+            int iy = cvFloor(fy);
+            float wy = (float)(fy - iy);
+            const float* grow = grid + g.rowstep*(iy + BilateralGrid::PAD);
+            const float* srow = src->ptr<float>(y);
+            float* drow = dst->ptr<float>(y);
+
+            for( int x = 0; x < src->cols; x++ )
+            {
+                float v = srow[x], fz = v*zscale + zofs;
+                int iz = cvFloor(fz);
+                float wz = fz - iz, wx = xalpha[x];
+                const float* c0 = grow + xofs[x] + iz*zstep;
+                const float* c1 = c0 + ystep;
+
+                // interpolate along z, then x, then y, for both the value and the weight
+                float a00 = c0[0] + (c0[zstep] - c0[0])*wz;
+                float b00 = c0[1] + (c0[zstep + 1] - c0[1])*wz;
+                float a01 = c0[xstep] + (c0[xstep + zstep] - c0[xstep])*wz;
+                float b01 = c0[xstep + 1] + (c0[xstep + zstep + 1] - c0[xstep + 1])*wz;
+                float a10 = c1[0] + (c1[zstep] - c1[0])*wz;
+                float b10 = c1[1] + (c1[zstep + 1] - c1[1])*wz;
+                float a11 = c1[xstep] + (c1[xstep + zstep] - c1[xstep])*wz;
+                float b11 = c1[xstep + 1] + (c1[xstep + zstep + 1] - c1[xstep + 1])*wz;
+
+                float a0 = a00 + (a01 - a00)*wx, b0 = b00 + (b01 - b00)*wx;
+                float a1 = a10 + (a11 - a10)*wx, b1 = b10 + (b11 - b10)*wx;
+                float a = a0 + (a1 - a0)*wy, b = b0 + (b1 - b0)*wy;
+
+                drow[x] = b > FLT_EPSILON ? a/b : v;
+            }
+        }
+    }
+
+private:
+    const Mat* src;
+    Mat* dst;
+    BilateralGrid g;
+    const float* grid;
+    const int* xofs;
+    const float* xalpha;
+};
+
+// computes the grid layout for the image size and the intensity range [vmin, vmax];
+// returns false if the grid would have more than MAX_CELLS cells
+static bool initBilateralGrid( BilateralGrid& g, Size size, double vmin, double vmax,
+                               double sigmaColor, double sigmaSpace )
+{
+    const int border = 2 + BilateralGrid::PAD*2;
+    double gx = std::floor((size.width - 1)/sigmaSpace) + border;
+    double gy = std::floor((size.height - 1)/sigmaSpace) + border;
+    double gz = std::floor((vmax - vmin)/sigmaColor) + border;
+    if( gx*gy*gz > BilateralGrid::MAX_CELLS )
+        return false;
+
+    g.sspace = sigmaSpace;
+    g.scolor = sigmaColor;
+    g.vmin = vmin;
+    g.gx = (int)gx;
+    g.gy = (int)gy;
+    g.gz = (int)gz;
+    g.rowstep = (size_t)g.gx*g.gz*BilateralGrid::CH;
+    return true;
+}
+
+static void bilateralGridFilter_32f1( const Mat& src, Mat& dst, const BilateralGrid& g )
+{
+    std::vector<float> grid0(g.rowstep*g.gy), grid1(g.rowstep*g.gy);
+    std::vector<int> xofs(src.cols);
+    std::vector<float> xalpha(src.cols);
+
+    for( int x = 0; x < src.cols; x++ )
+    {
+        double fx = x/g.sspace;
+        int ix = cvFloor(fx);
+        xofs[x] = (ix + BilateralGrid::PAD)*g.gz*BilateralGrid::CH;
+        xalpha[x] = (float)(fx - ix);
+    }
+
+    parallel_for_(Range(0, g.gy), BilateralGridSplatInvoker(src, g, &grid0[0], &xofs[0], &xalpha[0]));
+    parallel_for_(Range(0, g.gy), BilateralGridBlurInvoker(g, &grid0[0], &grid1[0], 0));
+    parallel_for_(Range(0, g.gy), BilateralGridBlurInvoker(g, &grid1[0], &grid0[0], 1));
+    parallel_for_(Range(0, src.rows), BilateralGridSliceInvoker(src, dst, g, &grid0[0], &xofs[0], &xalpha[0]));
+}
+
+}
+
+void cv::bilateralGridFilter( InputArray _src, OutputArray _dst,
+                              double sigmaColor, double sigmaSpace )
+{
+    CV_INSTRUMENT_REGION()
+
+    // the grid has a single intensity axis; the color images would need a joint range of all
+    // the channels, and filtering the channels separately blurs the edges between the colors
+    // of the same channel values
+    int type = _src.type(), depth = CV_MAT_DEPTH(type);
+    CV_Assert( (depth == CV_8U || depth == CV_32F) && CV_MAT_CN(type) == 1 );
+    CV_Assert( sigmaColor > 0 && sigmaSpace > 0 );
+
+    Mat src = _src.getMat();
+    _dst.create( src.size(), type );
+    Mat dst = _dst.getMat();
+    if( src.empty() )
+        return;
+
+    if( depth == CV_32F && !checkRange(src) )
+        CV_Error( CV_StsBadArg, "The image must not contain NaN or infinite values" );
+
+    // small sigmas or a wide intensity range give a huge grid; the exact filter is used then
+    double vmin = 0, vmax = 0;
+    minMaxLoc(src, &vmin, &vmax);
+    BilateralGrid g;
+    if( !initBilateralGrid(g, src.size(), vmin, vmax, sigmaColor, sigmaSpace) )
+    {
+        bilateralFilter(src, dst, 0, sigmaColor, sigmaSpace, BORDER_REPLICATE);
+        return;
+    }
+
+    Mat fsrc, result(src.size(), CV_32F);
+    src.convertTo(fsrc, CV_32F);
+    bilateralGridFilter_32f1(fsrc, result, g);
+    result.convertTo(dst, depth);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 
 CV_IMPL void
@@ -43,6 +43,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_imgproc.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -140,6 +141,304 @@ struct Integral_SIMD<uchar, int, double>
 
 #endif
 
+// The parallel integral works in two passes. The first one computes the running
+// sums of every row independently, the second one accumulates the rows top-down
+// within the column strips. Since both passes perform the same additions in the
+// same order as the serial code, the result is bit-exact.
+
+enum { INTEGRAL_PARALLEL_MIN_AREA = 1 << 20, INTEGRAL_TILTED_BAND = 32 };
+
+template<typename ST> static inline int
+integralAccumRow_SIMD( const ST*, ST*, int )
+{
+    return 0;
+}
+
+#if CV_SIMD128
+
+template<> inline int
+integralAccumRow_SIMD<int>( const int* prev, int* dst, int n )
+{
+    int x = 0;
+    for( ; x <= n - 8; x += 8 )
+    {
+        v_store(dst + x, v_load(prev + x) + v_load(dst + x));
+        v_store(dst + x + 4, v_load(prev + x + 4) + v_load(dst + x + 4));
+    }
+    return x;
+}
+
+template<> inline int
+integralAccumRow_SIMD<float>( const float* prev, float* dst, int n )
+{
+    int x = 0;
+    for( ; x <= n - 8; x += 8 )
+    {
+        v_store(dst + x, v_load(prev + x) + v_load(dst + x));
+        v_store(dst + x + 4, v_load(prev + x + 4) + v_load(dst + x + 4));
+    }
+    return x;
+}
+
+#if CV_SIMD128_64F
+template<> inline int
+integralAccumRow_SIMD<double>( const double* prev, double* dst, int n )
+{
+    int x = 0;
+    for( ; x <= n - 4; x += 4 )
+    {
+        v_store(dst + x, v_load(prev + x) + v_load(dst + x));
+        v_store(dst + x + 2, v_load(prev + x + 2) + v_load(dst + x + 2));
+    }
+    return x;
+}
+#endif
+
+#endif
+
+// the first pass: running sums (and sums of squares) of the rows
+template<typename T, typename ST, typename QT>
+class IntegralRowsInvoker : public ParallelLoopBody
+{
+public:
+    IntegralRowsInvoker( const T* _src, size_t _srcstep, ST* _sum, size_t _sumstep,
+                         QT* _sqsum, size_t _sqsumstep, int _width, int _cn ) :
+        src(_src), srcstep(_srcstep), sum(_sum), sumstep(_sumstep),
+        sqsum(_sqsum), sqsumstep(_sqsumstep), width(_width), cn(_cn)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int len = width*cn;
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const T* srow = (const T*)((const uchar*)src + srcstep*y);
+            ST* drow = (ST*)((uchar*)sum + sumstep*(y + 1)) + cn;
+            QT* qrow = sqsum ? (QT*)((uchar*)sqsum + sqsumstep*(y + 1)) + cn : 0;
+
+            for( int k = 0; k < cn; k++ )
+            {
+                ST s = drow[k - cn] = 0;
+                if( !qrow )
+                {
+                    for( int x = k; x < len; x += cn )
+                    {
+                        s += srow[x];
+                        drow[x] = s;
+                    }
+                }
+                else
+                {
+                    QT sq = qrow[k - cn] = 0;
+                    for( int x = k; x < len; x += cn )
+                    {
+                        T it = srow[x];
+                        s += it;
+                        sq += (QT)it*it;
+                        drow[x] = s;
+                        qrow[x] = sq;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const T* src;
+    size_t srcstep;
+    ST* sum;
+    size_t sumstep;
+    QT* sqsum;
+    size_t sqsumstep;
+    int width, cn;
+};
+
+// the second pass: every row is added to the previous one within a strip of columns
+template<typename ST>
+class IntegralColsInvoker : public ParallelLoopBody
+{
+public:
+    IntegralColsInvoker( ST* _sum, size_t _sumstep, int _len, int _height, int _nstripes ) :
+        sum(_sum), sumstep(_sumstep), len(_len), height(_height), nstripes(_nstripes)
+    {
+        haveSIMD = hasSIMD128();
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int x0 = (int)((int64)len*range.start/nstripes);
+        int x1 = (int)((int64)len*range.end/nstripes);
+
+        for( int y = 2; y <= height; y++ )
+        {
+            const ST* prev = (const ST*)((const uchar*)sum + sumstep*(y - 1)) + x0;
+            ST* dst = (ST*)((uchar*)sum + sumstep*y) + x0;
+            int x = haveSIMD ? integralAccumRow_SIMD<ST>(prev, dst, x1 - x0) : 0;
+            for( ; x < x1 - x0; x++ )
+                dst[x] = prev[x] + dst[x];
+        }
+    }
+
+private:
+    ST* sum;
+    size_t sumstep;
+    int len, height, nstripes;
+    bool haveSIMD;
+};
+
+template<typename ST> static void
+integralAccumCols( ST* sum, size_t sumstep, int len, int height )
+{
+    int nstripes = std::max(std::min(getNumThreads()*2, len/64), 1);
+    parallel_for_(Range(0, nstripes), IntegralColsInvoker<ST>(sum, sumstep, len, height, nstripes), nstripes);
+}
+
+// The tilted sums depend on the previous row at x-1, x and x+1, so they are computed
+// in bands of rows: every strip of columns of the band starts from the state on top of
+// the band widened by the band height and narrows by one pixel at each side per row.
+// The overlapping parts are computed twice, which costs ~INTEGRAL_TILTED_BAND/stripWidth.
+template<typename T, typename ST>
+class IntegralTiltedInvoker : public ParallelLoopBody
+{
+public:
+    IntegralTiltedInvoker( const T* _src, size_t _srcstep, ST* _tilted, size_t _tiltedstep,
+                           const ST* _buf, ST* _nextBuf, int _width, int _cn,
+                           int _y0, int _y1, int _stripWidth ) :
+        src(_src), srcstep(_srcstep), tilted(_tilted), tiltedstep(_tiltedstep),
+        buf(_buf), nextBuf(_nextBuf), width(_width), cn(_cn),
+        y0(_y0), y1(_y1), stripWidth(_stripWidth)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int h = y1 - y0;
+        for( int strip = range.start; strip < range.end; strip++ )
+        {
+            int x0 = strip*stripWidth, x1 = std::min(x0 + stripWidth, width);
+            int xa = std::max(x0 - h, 0), xb = std::min(x1 + h, width);
+            int n = (xb - xa + 1)*cn;
+
+            // local copies of the tilted row (columns xa..xb) and the diagonal sums (pixels xa..xb-1)
+            AutoBuffer<ST> _lbuf(n*4);
+            ST* prevT = _lbuf;
+            ST* curT = prevT + n;
+            ST* prevB = curT + n;
+            ST* curB = prevB + n;
+
+            memcpy(prevT, (const ST*)((const uchar*)tilted + tiltedstep*y0) + xa*cn, n*sizeof(ST));
+            memcpy(prevB, buf + xa*cn, (xb - xa)*cn*sizeof(ST));
+            for( int k = 0; k < cn; k++ )
+                prevB[(xb - xa)*cn + k] = curB[(xb - xa)*cn + k] = 0;
+
+            for( int y = y0; y < y1; y++ )
+            {
+                int d = y1 - 1 - y;
+                int ra = std::max(x0 - d, 0), rb = std::min(x1 + d, width);
+                const T* srow = (const T*)((const uchar*)src + srcstep*y);
+
+                for( int k = 0; k < cn; k++ )
+                {
+                    // P(c), B(x) refer to the column c and the pixel x of the previous row
+                    const ST* P = prevT - xa*cn + k;
+                    const ST* B = prevB - xa*cn + k;
+                    ST* T1 = curT - xa*cn + k;
+                    ST* B1 = curB - xa*cn + k;
+                    int x = ra, xe = std::min(rb, width - 1);
+
+                    if( x == 0 )
+                    {
+                        ST t0 = srow[k];
+                        T1[0] = P[cn];
+                        T1[cn] = P[cn] + t0 + B[cn];
+                        B1[0] = width > 1 ? B[cn] + t0 : B[0];
+                        x++;
+                    }
+
+                    for( ; x < xe; x++ )
+                    {
+                        ST t0 = srow[x*cn + k];
+                        ST t1 = B[x*cn];
+                        B1[x*cn] = B[(x + 1)*cn] + t0;
+                        t1 += B[(x + 1)*cn] + t0 + P[x*cn];
+                        T1[(x + 1)*cn] = t1;
+                    }
+
+                    if( x < rb )
+                    {
+                        ST t0 = srow[x*cn + k];
+                        T1[(x + 1)*cn] = t0 + B[x*cn] + P[x*cn];
+                        B1[x*cn] = t0;
+                    }
+                }
+
+                ST* trow = (ST*)((uchar*)tilted + tiltedstep*(y + 1));
+                int c0 = x0 == 0 ? 0 : x0 + 1;
+                memcpy(trow + c0*cn, curT + (c0 - xa)*cn, (x1 + 1 - c0)*cn*sizeof(ST));
+
+                std::swap(prevT, curT);
+                std::swap(prevB, curB);
+            }
+
+            memcpy(nextBuf + x0*cn, prevB + (x0 - xa)*cn, (x1 - x0)*cn*sizeof(ST));
+        }
+    }
+
+private:
+    const T* src;
+    size_t srcstep;
+    ST* tilted;
+    size_t tiltedstep;
+    const ST* buf;
+    ST* nextBuf;
+    int width, cn, y0, y1, stripWidth;
+};
+
+template<typename T, typename ST, typename QT>
+static void integralParallel_( const T* src, size_t srcstep, ST* sum, size_t sumstep,
+                               QT* sqsum, size_t sqsumstep, ST* tilted, size_t tiltedstep,
+                               int width, int height, int cn )
+{
+    int len = (width + 1)*cn;
+
+    memset(sum, 0, len*sizeof(sum[0]));
+    if( sqsum )
+        memset(sqsum, 0, len*sizeof(sqsum[0]));
+
+    parallel_for_(Range(0, height), IntegralRowsInvoker<T, ST, QT>(src, srcstep, sum, sumstep,
+                                                                    sqsum, sqsumstep, width, cn));
+    integralAccumCols(sum, sumstep, len, height);
+    if( sqsum )
+        integralAccumCols(sqsum, sqsumstep, len, height);
+
+    if( !tilted )
+        return;
+
+    AutoBuffer<ST> _buf(width*cn*2);
+    ST* buf = _buf;
+    ST* nextBuf = buf + width*cn;
+    ST* trow = (ST*)((uchar*)tilted + tiltedstep);
+
+    memset(tilted, 0, len*sizeof(tilted[0]));
+    for( int k = 0; k < cn; k++ )
+        trow[k] = 0;
+    for( int x = 0; x < width*cn; x++ )
+        buf[x] = trow[x + cn] = src[x];
+
+    int stripWidth = std::max((width + getNumThreads() - 1)/getNumThreads(),
+                              (int)INTEGRAL_TILTED_BAND*4);
+    int nstrips = (width + stripWidth - 1)/stripWidth;
+
+    for( int y0 = 1; y0 < height; y0 += INTEGRAL_TILTED_BAND )
+    {
+        int y1 = std::min(y0 + (int)INTEGRAL_TILTED_BAND, height);
+        parallel_for_(Range(0, nstrips), IntegralTiltedInvoker<T, ST>(src, srcstep, tilted, tiltedstep,
+                                                                      buf, nextBuf, width, cn, y0, y1, stripWidth));
+        std::swap(buf, nextBuf);
+    }
+}
+
 template<typename T, typename ST, typename QT>
 void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
                 QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
@@ -147,6 +446,13 @@ void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
 {
     int x, y, k;
 
+    if( getNumThreads() > 1 && (int64)width*height >= INTEGRAL_PARALLEL_MIN_AREA )
+    {
+        integralParallel_(src, _srcstep, sum, _sumstep, sqsum, _sqsumstep,
+                          tilted, _tiltedstep, width, height, cn);
+        return;
+    }
+
     if (Integral_SIMD<T, ST, QT>()(src, _srcstep,
                                    sum, _sumstep,
                                    sqsum, _sqsumstep,
@@ -0,0 +1,273 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv
+{
+
+namespace
+{
+
+// the rows of the destination that share the temporary fixed-point maps
+enum { WARPMAP_BAND = 32 };
+
+// expands the rows [y0, y1) of the dense map from the coarse grid:
+// the grid rows are interpolated vertically, then the pixels are interpolated between the nodes
+static void expandGridRows( const Mat& grid, int step, int width, int y0, int y1, Mat& mapx, Mat& mapy )
+{
+    int gw = grid.cols, x, j;
+    float scale = 1.f/step;
+    AutoBuffer<float> _buf(gw*2);
+    float* rowx = _buf, *rowy = rowx + gw;
+
+    for( int y = y0; y < y1; y++ )
+    {
+        int i = y/step;
+        float t = (y - i*step)*scale;
+        const float* g0 = grid.ptr<float>(i);
+        const float* g1 = grid.ptr<float>(i + 1);
+        float* mx = mapx.ptr<float>(y - y0);
+        float* my = mapy.ptr<float>(y - y0);
+
+        for( j = 0; j < gw; j++ )
+        {
+            rowx[j] = g0[j*2] + (g1[j*2] - g0[j*2])*t;
+            rowy[j] = g0[j*2+1] + (g1[j*2+1] - g0[j*2+1])*t;
+        }
+
+        for( j = 0, x = 0; x < width; j++ )
+        {
+            float ax = rowx[j], dx = (rowx[j+1] - ax)*scale;
+            float ay = rowy[j], dy = (rowy[j+1] - ay)*scale;
+            int k = 0, n = std::min(step, width - x);
+
+#if CV_SIMD128
+            if( n >= 4 )
+            {
+                v_float32x4 v_ax = v_setall_f32(ax), v_dx = v_setall_f32(dx);
+                v_float32x4 v_ay = v_setall_f32(ay), v_dy = v_setall_f32(dy);
+                v_float32x4 v_k(0.f, 1.f, 2.f, 3.f), v_4 = v_setall_f32(4.f);
+                for( ; k <= n - 4; k += 4, v_k += v_4 )
+                {
+                    v_store(mx + x + k, v_ax + v_dx*v_k);
+                    v_store(my + x + k, v_ay + v_dy*v_k);
+                }
+            }
+#endif
+            for( ; k < n; k++ )
+            {
+                mx[x + k] = ax + dx*k;
+                my[x + k] = ay + dy*k;
+            }
+            x += n;
+        }
+    }
+}
+
+// the same conversion to the fixed-point maps as in convertMaps
+static void convertRowToFixed( const float* mx, const float* my, short* m1, ushort* m2, int width )
+{
+    int x = 0;
+#if CV_SIMD128
+    v_float32x4 v_scale = v_setall_f32((float)INTER_TAB_SIZE);
+    v_int32x4 v_mask = v_setall_s32(INTER_TAB_SIZE - 1);
+    for( ; x <= width - 8; x += 8 )
+    {
+        v_int32x4 ix0 = v_round(v_load(mx + x)*v_scale), ix1 = v_round(v_load(mx + x + 4)*v_scale);
+        v_int32x4 iy0 = v_round(v_load(my + x)*v_scale), iy1 = v_round(v_load(my + x + 4)*v_scale);
+
+        v_int16x8 sx = v_pack(ix0 >> INTER_BITS, ix1 >> INTER_BITS);
+        v_int16x8 sy = v_pack(iy0 >> INTER_BITS, iy1 >> INTER_BITS);
+        v_store_interleave(m1 + x*2, sx, sy);
+
+        v_int32x4 a0 = ((iy0 & v_mask) << INTER_BITS) + (ix0 & v_mask);
+        v_int32x4 a1 = ((iy1 & v_mask) << INTER_BITS) + (ix1 & v_mask);
+        v_store((short*)(m2 + x), v_pack(a0, a1));
+    }
+#endif
+    for( ; x < width; x++ )
+    {
+        int ix = saturate_cast<int>(mx[x]*INTER_TAB_SIZE);
+        int iy = saturate_cast<int>(my[x]*INTER_TAB_SIZE);
+        m1[x*2] = saturate_cast<short>(ix >> INTER_BITS);
+        m1[x*2+1] = saturate_cast<short>(iy >> INTER_BITS);
+        m2[x] = (ushort)((iy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (ix & (INTER_TAB_SIZE-1)));
+    }
+}
+
+static void convertRowToNearest( const float* mx, const float* my, short* m1, int width )
+{
+    for( int x = 0; x < width; x++ )
+    {
+        m1[x*2] = saturate_cast<short>(mx[x]);
+        m1[x*2+1] = saturate_cast<short>(my[x]);
+    }
+}
+
+class WarpMapInvoker : public ParallelLoopBody
+{
+public:
+    WarpMapInvoker( const Mat& _grid, int _step, const Mat& _src, Mat& _dst,
+                    int _interpolation, int _borderMode, const Scalar& _borderValue ) :
+        grid(&_grid), step(_step), src(&_src), dst(&_dst), interpolation(_interpolation),
+        borderMode(_borderMode), borderValue(_borderValue) {}
+
+    void operator()( const Range& range ) const
+    {
+        int width = dst->cols;
+        Mat mapx(WARPMAP_BAND, width, CV_32F), mapy(WARPMAP_BAND, width, CV_32F);
+        Mat map1(WARPMAP_BAND, width, CV_16SC2), map2(WARPMAP_BAND, width, CV_16UC1);
+        bool nearest = interpolation == INTER_NEAREST;
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = b*WARPMAP_BAND, y1 = std::min(y0 + WARPMAP_BAND, dst->rows), n = y1 - y0;
+            expandGridRows( *grid, step, width, y0, y1, mapx, mapy );
+
+            for( int i = 0; i < n; i++ )
+            {
+                if( nearest )
+                    convertRowToNearest( mapx.ptr<float>(i), mapy.ptr<float>(i), map1.ptr<short>(i), width );
+                else
+                    convertRowToFixed( mapx.ptr<float>(i), mapy.ptr<float>(i), map1.ptr<short>(i),
+                                       map2.ptr<ushort>(i), width );
+            }
+
+            Mat dstBand = dst->rowRange(y0, y1);
+            remap( *src, dstBand, map1.rowRange(0, n), nearest ? Mat() : map2.rowRange(0, n),
+                   interpolation, borderMode, borderValue );
+        }
+    }
+
+private:
+    const Mat* grid;
+    int step;
+    const Mat* src;
+    Mat* dst;
+    int interpolation, borderMode;
+    Scalar borderValue;
+};
+
+class WarpMapImpl : public WarpMap
+{
+public:
+    WarpMapImpl( const Mat& _grid, int _step, Size _size ) : grid(_grid), step(_step), size(_size) {}
+
+    void apply( InputArray _src, OutputArray _dst, int interpolation, int borderMode, const Scalar& borderValue ) const
+    {
+        CV_INSTRUMENT_REGION()
+
+        CV_Assert( interpolation == INTER_NEAREST || interpolation == INTER_LINEAR ||
+                   interpolation == INTER_CUBIC || interpolation == INTER_LANCZOS4 );
+
+        Mat src = _src.getMat();
+        CV_Assert( !src.empty() );
+        _dst.create( size, src.type() );
+        Mat dst = _dst.getMat();
+        if( dst.data == src.data )
+            src = src.clone();
+
+        int nbands = (size.height + WARPMAP_BAND - 1)/WARPMAP_BAND;
+        parallel_for_(Range(0, nbands), WarpMapInvoker(grid, step, src, dst, interpolation, borderMode, borderValue));
+    }
+
+    void getMaps( OutputArray _map1, OutputArray _map2 ) const
+    {
+        _map1.create( size, CV_32FC1 );
+        _map2.create( size, CV_32FC1 );
+        Mat map1 = _map1.getMat(), map2 = _map2.getMat();
+        expandGridRows( grid, step, size.width, 0, size.height, map1, map2 );
+    }
+
+    Size getSize() const { return size; }
+    int getGridStep() const { return step; }
+
+private:
+    Mat grid;
+    int step;
+    Size size;
+};
+
+}
+
+}
+
+cv::Ptr<cv::WarpMap> cv::createWarpMap( InputArray _map1, InputArray _map2, int gridStep )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat map1 = _map1.getMat(), map2 = _map2.getMat();
+    CV_Assert( gridStep >= 1 && !map1.empty() &&
+               ((map1.type() == CV_32FC2 && map2.empty()) ||
+                (map1.type() == CV_32FC1 && map2.type() == CV_32FC1 && map2.size() == map1.size())) );
+
+    Size size = map1.size();
+    int gw = (size.width - 1)/gridStep + 2, gh = (size.height - 1)/gridStep + 2;
+    Mat grid(gh, gw, CV_32FC2);
+
+    // the nodes out of the map are extrapolated linearly from the last two pixels
+    for( int i = 0; i < gh; i++ )
+    {
+        int y = std::min(i*gridStep, size.height - 1), y_1 = std::max(y - 1, 0);
+        float fy = (float)(i*gridStep - y);
+        for( int j = 0; j < gw; j++ )
+        {
+            int x = std::min(j*gridStep, size.width - 1), x_1 = std::max(x - 1, 0);
+            float fx = (float)(j*gridStep - x);
+            Point2f p, px, py;
+            if( map2.empty() )
+            {
+                p = map1.at<Point2f>(y, x);
+                px = map1.at<Point2f>(y, x_1);
+                py = map1.at<Point2f>(y_1, x);
+            }
+            else
+            {
+                p = Point2f(map1.at<float>(y, x), map2.at<float>(y, x));
+                px = Point2f(map1.at<float>(y, x_1), map2.at<float>(y, x_1));
+                py = Point2f(map1.at<float>(y_1, x), map2.at<float>(y_1, x));
+            }
+            grid.at<Point2f>(i, j) = p + (p - px)*fx + (p - py)*fy;
+        }
+    }
+
+    return makePtr<WarpMapImpl>(grid, gridStep, size);
+}
+
+cv::Ptr<cv::WarpMap> cv::createUndistortRectifyWarpMap( InputArray _cameraMatrix, InputArray _distCoeffs,
+                                                       InputArray _R, InputArray _newCameraMatrix,
+                                                       Size size, double scale, int gridStep )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( gridStep >= 1 && scale > 0 && size.width > 0 && size.height > 0 );
+
+    Mat newCameraMatrix = _newCameraMatrix.getMat();
+    Matx33d Ar;
+    if( newCameraMatrix.empty() )
+        Ar = getDefaultNewCameraMatrix( _cameraMatrix, size, true );
+    else
+    {
+        CV_Assert( newCameraMatrix.size() == Size(3,3) || newCameraMatrix.size() == Size(4,3) );
+        Mat(newCameraMatrix.colRange(0, 3)).convertTo(Ar, CV_64F);
+    }
+
+    // the scale keeps the pixel centers, as resize does
+    Size dsize(cvRound(size.width*scale), cvRound(size.height*scale));
+    CV_Assert( dsize.area() > 0 );
+    double d = 0.5*(scale - 1);
+    Matx33d S(scale, 0, d, 0, scale, d, 0, 0, 1);
+
+    // the pixel (j, i) of the grid map is the pixel (j*gridStep, i*gridStep) of the destination
+    double g = 1./gridStep;
+    Matx33d G(g, 0, 0, 0, g, 0, 0, 0, 1);
+
+    int gw = (dsize.width - 1)/gridStep + 2, gh = (dsize.height - 1)/gridStep + 2;
+    Mat grid;
+    initUndistortRectifyMap( _cameraMatrix, _distCoeffs, _R, Mat(G*(S*Ar)), Size(gw, gh), CV_32FC2, grid, noArray() );
+
+    return makePtr<WarpMapImpl>(grid, gridStep, dsize);
+}
@@ -290,4 +290,73 @@ namespace cvtest
         test.safe_run();
     }
 
+    TEST(Imgproc_BilateralFilter, grid)
+    {
+        RNG& rng = theRNG();
+        const int types[] = { CV_8UC1, CV_32FC1 };
+
+        for( int i = 0; i < 2; i++ )
+        {
+            int type = types[i];
+            Mat src(240, 320, CV_8UC3), noise(src.size(), CV_8UC3);
+            rng.fill(src, RNG::NORMAL, 128, 10);
+            rectangle(src, Rect(40, 50, 150, 100), Scalar(255, 200, 40), -1);
+            circle(src, Point(200, 150), 50, Scalar(20, 60, 200), -1);
+            rng.fill(noise, RNG::NORMAL, 0, 8);
+            add(src, noise, src);
+            cvtColor(src, src, COLOR_BGR2GRAY);
+            src.convertTo(src, CV_MAT_DEPTH(type));
+
+            Mat dst, ref;
+            bilateralGridFilter(src, dst, 30, 6);
+            bilateralFilter(src, ref, 0, 30, 6, BORDER_REPLICATE);
+            ASSERT_EQ(type, dst.type());
+
+            // the grid keeps the edges as the exact filter does, so the difference stays small
+            Mat diff;
+            absdiff(dst, ref, diff);
+            EXPECT_LT(mean(diff)[0], 1.5) << "type " << type;
+
+            // and the noise is removed
+            Rect roi(50, 55, 80, 40);
+            Scalar m, sdevSrc, sdevDst;
+            meanStdDev(src(roi), m, sdevSrc);
+            meanStdDev(dst(roi), m, sdevDst);
+            EXPECT_LT(sum(sdevDst)[0], sum(sdevSrc)[0]*0.5) << "type " << type;
+        }
+    }
+
+    TEST(Imgproc_BilateralFilter, grid_limits)
+    {
+        Mat src(100, 120, CV_32F), dst, ref;
+        randu(src, 0, 255);
+
+        Mat bad = src.clone();
+        bad.at<float>(50, 60) = std::numeric_limits<float>::quiet_NaN();
+        EXPECT_THROW(bilateralGridFilter(bad, dst, 30, 6), cv::Exception);
+        bad.at<float>(50, 60) = std::numeric_limits<float>::infinity();
+        EXPECT_THROW(bilateralGridFilter(bad, dst, 30, 6), cv::Exception);
+
+        // a hue-only edge, green to red of the same luma: a grid guided by the luma would blur it,
+        // so the color images are rejected
+        Mat color(100, 120, CV_8UC3, Scalar(0, 100, 0));
+        color(Rect(60, 0, 60, 100)).setTo(Scalar(0, 0, 196));
+        EXPECT_THROW(bilateralGridFilter(color, dst, 30, 6), cv::Exception);
+        color.convertTo(color, CV_32F);
+        EXPECT_THROW(bilateralGridFilter(color, dst, 30, 6), cv::Exception);
+
+        // the intensity range needs too many grid cells, the exact filter is used
+        src.at<float>(10, 10) = 1e30f;
+        bilateralGridFilter(src, dst, 30, 6);
+        bilateralFilter(src, ref, 0, 30, 6, BORDER_REPLICATE);
+        EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF));
+
+        // as do the small sigmas on a large image
+        Mat src8u(1000, 1000, CV_8U);
+        randu(src8u, 0, 256);
+        bilateralGridFilter(src8u, dst, 0.5, 1);
+        bilateralFilter(src8u, ref, 0, 0.5, 1, BORDER_REPLICATE);
+        EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF));
+    }
+
 } // end of namespace cvtest
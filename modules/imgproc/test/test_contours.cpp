@@ -485,4 +485,39 @@ TEST(Imgproc_FindContours, border)
     ASSERT_TRUE(norm(img - img_draw_contours, NORM_INF) == 0.0);
 }
 
+TEST(Imgproc_FindContours, parallel)
+{
+    // the band-parallel retrieval must reproduce the sequential scanner exactly
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+    const int modes[] = { RETR_EXTERNAL, RETR_LIST, RETR_CCOMP };
+
+    for( int iter = 0; iter < 3; iter++ )
+    {
+        Mat img(1000 + iter*97, 1100, CV_8U);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        if( iter > 0 )
+            GaussianBlur(img, img, Size(0, 0), iter*2.);
+        threshold(img, img, 128, 255, THRESH_BINARY);
+        img.row(0).setTo(Scalar::all(255));
+
+        for( int m = 0; m < 3; m++ )
+            for( int method = CHAIN_APPROX_NONE; method <= CHAIN_APPROX_TC89_KCOS; method++ )
+            {
+                vector<vector<Point> > contours0, contours;
+                vector<Vec4i> hierarchy0, hierarchy;
+
+                setNumThreads(1);
+                findContours(img, contours0, hierarchy0, modes[m], method, Point(2, -1));
+                setNumThreads(std::max(nthreads, 4));
+                findContours(img, contours, hierarchy, modes[m], method, Point(2, -1));
+                setNumThreads(nthreads);
+
+                ASSERT_EQ(contours0.size(), contours.size()) << "mode " << modes[m] << ", method " << method;
+                EXPECT_TRUE(contours0 == contours) << "mode " << modes[m] << ", method " << method;
+                EXPECT_TRUE(hierarchy0 == hierarchy) << "mode " << modes[m] << ", method " << method;
+            }
+    }
+}
+
 /* End of file. */
@@ -2016,6 +2016,74 @@ TEST(Imgproc_Morphology, iterated)
     }
 }
 
+TEST(Imgproc_GaussianBlur, recursive)
+{
+    const double sigmas[] = { 1, 2.5, 7, 20, 45 };
+    RNG& rng = theRNG();
+
+    for( int i = 0; i < (int)(sizeof(sigmas)/sizeof(sigmas[0])); i++ )
+    {
+        double sigma = sigmas[i];
+        int cn = i % 2 == 0 ? 1 : 3;
+        Mat src(rng.uniform(200, 400), rng.uniform(200, 400), CV_8UC(cn)), srcf, dst, dstf, ref;
+
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+        rectangle(src, Rect(20, 30, 100, 80), Scalar::all(255), -1);
+        rectangle(src, Rect(60, 100, 120, 90), Scalar::all(0), -1);
+        src.convertTo(srcf, CV_32F);
+
+        int radius = cvCeil(sigma*5);
+        Mat kernel = getGaussianKernel(radius*2 + 1, sigma, CV_32F);
+        sepFilter2D(srcf, ref, CV_32F, kernel, kernel, Point(-1, -1), 0, BORDER_REPLICATE);
+
+        recursiveGaussianBlur(srcf, dstf, sigma);
+        EXPECT_LE(cvtest::norm(dstf, ref, NORM_INF), 255*0.004) << "sigma " << sigma;
+
+        recursiveGaussianBlur(src, dst, sigma);
+        ref.convertTo(ref, CV_8U);
+        EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), 1) << "sigma " << sigma;
+    }
+
+    // anisotropic sigmas and the other depths
+    Mat src(64, 48, CV_16SC2), dst, ref, srcf;
+    rng.fill(src, RNG::UNIFORM, -1000, 1000);
+    src.convertTo(srcf, CV_32F);
+    recursiveGaussianBlur(src, dst, 3, 8);
+    GaussianBlur(srcf, ref, Size(31, 81), 3, 8, BORDER_REPLICATE);
+    ref.convertTo(ref, CV_16S);
+    ASSERT_EQ(src.type(), dst.type());
+    EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), 2000*0.004);
+}
+
+TEST(Imgproc_Integral, threads_invariance)
+{
+    const int depths[][3] = { { CV_8U, CV_32S, CV_64F }, { CV_8U, CV_32F, CV_32F },
+                              { CV_16U, CV_64F, CV_64F }, { CV_32F, CV_32F, CV_64F },
+                              { CV_64F, CV_64F, CV_64F } };
+    const Size sizes[] = { Size(1030, 1030), Size(1, 1 << 20), Size(3000, 359) };
+    int nthreads = getNumThreads();
+    RNG& rng = theRNG();
+
+    for( int i = 0; i < (int)(sizeof(depths)/sizeof(depths[0])); i++ )
+        for( int j = 0; j < (int)(sizeof(sizes)/sizeof(sizes[0])); j++ )
+        {
+            int cn = j == 2 ? 3 : 1;
+            Mat src(sizes[j], CV_MAKETYPE(depths[i][0], cn));
+            rng.fill(src, RNG::UNIFORM, -100, 256);
+
+            Mat sum0, sqsum0, tilted0, sum1, sqsum1, tilted1;
+            setNumThreads(1);
+            integral(src, sum0, sqsum0, tilted0, depths[i][1], depths[i][2]);
+            setNumThreads(std::max(nthreads, 4));
+            integral(src, sum1, sqsum1, tilted1, depths[i][1], depths[i][2]);
+            setNumThreads(nthreads);
+
+            ASSERT_EQ(0, cvtest::norm(sum0, sum1, NORM_INF)) << "depths " << i << ", size " << j;
+            ASSERT_EQ(0, cvtest::norm(sqsum0, sqsum1, NORM_INF)) << "depths " << i << ", size " << j;
+            ASSERT_EQ(0, cvtest::norm(tilted0, tilted1, NORM_INF)) << "depths " << i << ", size " << j;
+        }
+}
+
 TEST(Imgproc_Sobel, borderTypes)
 {
     int kernelSize = 3;
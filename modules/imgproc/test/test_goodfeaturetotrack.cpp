@@ -490,5 +490,34 @@ int CV_GoodFeatureToTTest::validate_test_results( int test_case_idx )
 
 TEST(Imgproc_GoodFeatureToT, accuracy) { CV_GoodFeatureToTTest test; test.safe_run(); }
 
+TEST(Imgproc_GoodFeatureToT, partial_selection)
+{
+    RNG& rng = theRNG();
+    Mat img(720, 1280, CV_8U);
+    rng.fill(img, RNG::UNIFORM, 0, 256);
+    GaussianBlur(img, img, Size(0, 0), 1.5);
+
+    int n = getNumThreads();
+    double minDistances[] = { 0, 5, 30 };
+    for (int i = 0; i < 3; i++)
+    {
+        std::vector<Point2f> all, best1, best;
+        goodFeaturesToTrack(img, all, 0, 0.01, minDistances[i]);
+
+        setNumThreads(1);
+        goodFeaturesToTrack(img, best1, 500, 0.01, minDistances[i]);
+        setNumThreads(std::max(n, 4));
+        goodFeaturesToTrack(img, best, 500, 0.01, minDistances[i]);
+        setNumThreads(n);
+
+        ASSERT_EQ(std::min(all.size(), (size_t)500), best.size()) << "minDistance=" << minDistances[i];
+        for (size_t j = 0; j < best.size(); j++)
+        {
+            EXPECT_EQ(all[j], best[j]) << "minDistance=" << minDistances[i] << " j=" << j;
+            EXPECT_EQ(best1[j], best[j]) << "minDistance=" << minDistances[i] << " j=" << j;
+        }
+    }
+}
+
 
 /* End of file. */
@@ -41,6 +41,7 @@
 //M*/
 
 #include "test_precomp.hpp"
+#include "../src/gcgraph.hpp"
 
 #include <string>
 #include <iostream>
@@ -170,3 +171,174 @@ TEST(Imgproc_GrabCut, repeatability)
     EXPECT_EQ(0, countNonZero(mask_1 != mask_3));
     EXPECT_EQ(0, countNonZero(mask_2 != mask_3));
 }
+
+TEST(Imgproc_GrabCut, iterations_and_threads)
+{
+    // a noisy disk on a noisy background of a different color
+    Mat img(300, 400, CV_8UC3), noise(img.size(), CV_8UC3);
+    img.setTo(Scalar(60, 120, 40));
+    circle(img, Point(200, 150), 80, Scalar(40, 80, 200), -1);
+    theRNG().state = 12345;
+    randn(noise, Scalar::all(0), Scalar::all(12));
+    img += noise;
+    GaussianBlur(img, img, Size(3, 3), 0);
+
+    Mat expected(img.size(), CV_8UC1, Scalar(0));
+    circle(expected, Point(200, 150), 80, Scalar(1), -1);
+
+    Rect rect(90, 40, 220, 220);
+    Mat masks[2];
+    int n = getNumThreads();
+    for( int k = 0; k < 2; k++ )
+    {
+        Mat bgdModel, fgdModel;
+        setNumThreads(k == 0 ? 1 : std::max(n, 4));
+        theRNG().state = 12378213;
+        grabCut(img, masks[k], rect, bgdModel, fgdModel, 0, GC_INIT_WITH_RECT);
+        grabCut(img, masks[k], rect, bgdModel, fgdModel, 5, GC_EVAL);
+    }
+    setNumThreads(n);
+
+    EXPECT_EQ(0, countNonZero(masks[0] != masks[1]));
+    EXPECT_LT(countNonZero((masks[0] & 1) != expected), countNonZero(expected)/20);
+}
+
+// builds the 8-connected grid graph of grabCut with the given t-weights and n-weights
+static void buildGrabCutGraph( GCGraph<double>& graph, const Mat& tWeights, const vector<Vec3d>& nWeights )
+{
+    graph.create( (unsigned)tWeights.total(), (unsigned)nWeights.size()*2 );
+    for( int i = 0; i < (int)tWeights.total(); i++ )
+    {
+        graph.addVtx();
+        const Vec2d& tw = tWeights.at<Vec2d>(i);
+        graph.addTermWeights( i, tw[0], tw[1] );
+    }
+    for( size_t k = 0; k < nWeights.size(); k++ )
+        graph.addEdges( (int)nWeights[k][0], (int)nWeights[k][1], nWeights[k][2], nWeights[k][2] );
+}
+
+TEST(Imgproc_GrabCut, incremental_maxflow)
+{
+    // the grabCut iterations with a single gaussian per model: the t-weights of the probable pixels
+    // change after every iteration, and the flow and the cut found by continuing from the previous
+    // solution must be the same as the ones of a new graph
+    Mat img(120, 160, CV_8UC3), noise(img.size(), CV_8UC3);
+    img.setTo(Scalar(60, 120, 40));
+    circle(img, Point(80, 60), 35, Scalar(40, 80, 200), -1);
+    rectangle(img, Point(100, 20), Point(120, 50), Scalar(50, 100, 120), -1);
+    theRNG().state = 12345;
+    randn(noise, Scalar::all(0), Scalar::all(30));
+    img += noise;
+
+    const int rows = img.rows, cols = img.cols;
+    const double gamma = 10, lambda = 9*gamma;
+    Rect rect(25, 10, 110, 100);
+
+    // the n-weights of grabCut, to the left, up-left, up and up-right neighbors
+    double beta = 0;
+    int count = 0;
+    for( int y = 0; y < rows; y++ )
+        for( int x = 1; x < cols; x++, count++ )
+        {
+            Vec3d d = Vec3d(img.at<Vec3b>(y, x)) - Vec3d(img.at<Vec3b>(y, x - 1));
+            beta += d.dot(d);
+        }
+    beta = 1./(2*beta/count);
+
+    vector<Vec3d> nWeights;
+    const int dx[] = { -1, -1, 0, 1 }, dy[] = { 0, -1, -1, -1 };
+    for( int y = 0; y < rows; y++ )
+        for( int x = 0; x < cols; x++ )
+            for( int k = 0; k < 4; k++ )
+            {
+                int x1 = x + dx[k], y1 = y + dy[k];
+                if( x1 < 0 || x1 >= cols || y1 < 0 )
+                    continue;
+                Vec3d d = Vec3d(img.at<Vec3b>(y, x)) - Vec3d(img.at<Vec3b>(y1, x1));
+                double w = gamma*std::exp(-beta*d.dot(d))/(dx[k] && dy[k] ? std::sqrt(2.) : 1.);
+                nWeights.push_back(Vec3d(y*cols + x, y1*cols + x1, w));
+            }
+
+    Mat mask(img.size(), CV_8UC1, Scalar(GC_BGD)), tWeights, prevTWeights;
+    mask(rect).setTo(Scalar(GC_PR_FGD));
+
+    RNG rng(0);
+    GCGraph<double> graph;
+    for( int iter = 0; iter < 5; iter++ )
+    {
+        // learn the models from the current segmentation
+        Vec3d sum[2], sqsum[2];
+        int n[2] = { 0, 0 };
+        for( int i = 0; i < (int)img.total(); i++ )
+        {
+            int fgd = mask.at<uchar>(i) & 1;
+            Vec3d c(img.at<Vec3b>(i));
+            sum[fgd] += c;
+            sqsum[fgd] += c.mul(c);
+            n[fgd]++;
+        }
+        ASSERT_GT(n[0], 0);
+        ASSERT_GT(n[1], 0);
+
+        tWeights.create(img.size(), CV_64FC2);
+        for( int i = 0; i < (int)img.total(); i++ )
+        {
+            Vec2d& tw = tWeights.at<Vec2d>(i);
+            if( mask.at<uchar>(i) == GC_BGD )
+            {
+                tw[0] = 0;
+                tw[1] = lambda;
+                continue;
+            }
+            // -log of the density of the background and the foreground gaussians
+            Vec3d c(img.at<Vec3b>(i));
+            for( int k = 0; k < 2; k++ )
+            {
+                double e = 0;
+                for( int j = 0; j < 3; j++ )
+                {
+                    double mean = sum[k][j]/n[k], var = sqsum[k][j]/n[k] - mean*mean + 1;
+                    e += (c[j] - mean)*(c[j] - mean)/(2*var) + 0.5*std::log(2*CV_PI*var);
+                }
+                tw[k] = e + rng.uniform(0., 40.);
+            }
+        }
+
+        double flow;
+        if( iter == 0 )
+        {
+            buildGrabCutGraph( graph, tWeights, nWeights );
+            flow = graph.maxFlow();
+        }
+        else
+        {
+            for( int i = 0; i < (int)img.total(); i++ )
+            {
+                Vec2d dw = tWeights.at<Vec2d>(i) - prevTWeights.at<Vec2d>(i);
+                if( dw != Vec2d() )
+                    graph.addTermWeights( i, dw[0], dw[1] );
+            }
+            flow = graph.maxFlow( true );
+        }
+
+        GCGraph<double> graph0;
+        buildGrabCutGraph( graph0, tWeights, nWeights );
+        double flow0 = graph0.maxFlow();
+        EXPECT_NEAR(flow0, flow, 1e-9*flow0) << "iteration " << iter;
+
+        int changed = 0, diff = 0;
+        for( int i = 0; i < (int)img.total(); i++ )
+        {
+            if( mask.at<uchar>(i) == GC_BGD )
+                continue;
+            bool fgd = graph.inSourceSegment(i);
+            diff += fgd != graph0.inSourceSegment(i);
+            changed += fgd != ((mask.at<uchar>(i) & 1) != 0);
+            mask.at<uchar>(i) = (uchar)(fgd ? GC_PR_FGD : GC_PR_BGD);
+        }
+        EXPECT_EQ(0, diff) << "iteration " << iter;
+        // the segmentation keeps moving, so every iteration modifies the trees
+        EXPECT_GT(changed, 0) << "iteration " << iter;
+        std::swap(tWeights, prevTWeights);
+    }
+}
@@ -219,3 +219,42 @@ INSTANTIATE_TEST_CASE_P( ImgProc, ProbabilisticHoughLinesTest, testing::Combine(
                                                                                 testing::Values( 0, 10 ),
                                                                                 testing::Values( 0, 4 )
                                                                                 ));
+
+TEST(Imgproc_Hough, threads_invariance)
+{
+    // the parallel voting must not change the results
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+
+    Mat img = Mat::zeros(480, 640, CV_8UC1), gray = Mat::zeros(480, 640, CV_8UC1);
+    for( int i = 0; i < 20; i++ )
+        line(img, Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)),
+             Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)), Scalar::all(255));
+    for( int i = 0; i < 2000; i++ )
+        img.at<uchar>(rng.uniform(0, img.rows), rng.uniform(0, img.cols)) = 255;
+    for( int i = 0; i < 15; i++ )
+        circle(gray, Point(rng.uniform(0, gray.cols), rng.uniform(0, gray.rows)), rng.uniform(10, 80),
+               Scalar::all(rng.uniform(100, 255)), i % 2 ? -1 : 3);
+    GaussianBlur(gray, gray, Size(5, 5), 1.5);
+
+    vector<Vec2f> lines[2];
+    vector<Vec4i> segments[2];
+    vector<Vec3f> circles[2];
+    for( int k = 0; k < 2; k++ )
+    {
+        setNumThreads(k == 0 ? 1 : std::max(nthreads, 4));
+        HoughLines(img, lines[k], 1, CV_PI/180, 80);
+        HoughLinesP(img, segments[k], 1, CV_PI/180, 50, 30, 10);
+        HoughCircles(gray, circles[k], HOUGH_GRADIENT, 1, 10, 100, 20, 5, 100);
+    }
+    setNumThreads(nthreads);
+
+    EXPECT_FALSE(lines[0].empty());
+    EXPECT_FALSE(segments[0].empty());
+    EXPECT_FALSE(circles[0].empty());
+    EXPECT_EQ(0, cvtest::norm(Mat(lines[0]), Mat(lines[1]), NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(Mat(segments[0]), Mat(segments[1]), NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(Mat(circles[0]), Mat(circles[1]), NORM_INF));
+}
+
+/* End of file. */
@@ -463,3 +463,86 @@ protected:
 };
 
 TEST(Imgproc_ContourMoment, small) { CV_SmallContourMomentTest test; test.safe_run(); }
+
+static void checkMoments( const Moments& m, const Moments& ref, double eps, const char* what, int i )
+{
+    const double* a = &m.m00;
+    const double* b = &ref.m00;
+    int n = (int)(sizeof(Moments)/sizeof(double));
+    for( int k = 0; k < n; k++ )
+        EXPECT_LE(fabs(a[k] - b[k]), eps*std::max(1., fabs(b[k]))) << what << " " << i << ", moment #" << k;
+}
+
+TEST(Imgproc_Moments, contours_batch)
+{
+    RNG& rng = theRNG();
+    Mat img = Mat::zeros(480, 640, CV_8U);
+    for( int i = 0; i < 300; i++ )
+        ellipse(img, Point(rng.uniform(0, 640), rng.uniform(0, 480)), Size(rng.uniform(1, 20), rng.uniform(1, 20)),
+                rng.uniform(0, 180), 0, 360, Scalar(255), -1);
+
+    vector<vector<Point> > contours;
+    findContours(img, contours, RETR_LIST, CHAIN_APPROX_SIMPLE);
+    ASSERT_GT(contours.size(), 10u);
+
+    vector<Moments> mu;
+    contoursMoments(contours, mu);
+    ASSERT_EQ(contours.size(), mu.size());
+    for( size_t i = 0; i < contours.size(); i++ )
+        checkMoments(mu[i], moments(contours[i]), 0, "contour", (int)i);
+}
+
+TEST(Imgproc_Moments, labels_batch)
+{
+    RNG& rng = theRNG();
+    Mat img = Mat::zeros(700, 900, CV_8U), labels;
+    for( int i = 0; i < 200; i++ )
+        ellipse(img, Point(rng.uniform(0, 900), rng.uniform(0, 700)), Size(rng.uniform(1, 60), rng.uniform(1, 60)),
+                rng.uniform(0, 180), 0, 360, Scalar(255), -1);
+
+    int nlabels = connectedComponents(img, labels, 8, CV_32S);
+    ASSERT_GT(nlabels, 10);
+
+    int n = getNumThreads();
+    vector<Moments> mu1, mu;
+    setNumThreads(1);
+    labelsMoments(labels, nlabels, mu1);
+    setNumThreads(std::max(n, 4));
+    labelsMoments(labels, nlabels, mu);
+    setNumThreads(n);
+
+    ASSERT_EQ((size_t)nlabels, mu.size());
+    for( int i = 0; i < nlabels; i++ )
+    {
+        checkMoments(mu[i], mu1[i], 0, "threads, label", i);
+        checkMoments(mu[i], moments(labels == i, true), 1e-9, "label", i);
+    }
+
+    Mat labels16;
+    labels.convertTo(labels16, CV_16U);
+    labelsMoments(labels16, nlabels, mu1);
+    for( int i = 0; i < nlabels; i++ )
+        checkMoments(mu1[i], mu[i], 0, "16U label", i);
+}
+
+TEST(Imgproc_Moments, labels_wide)
+{
+    // the sums of x^3 over a band of rows exceed int64 from the width of about 32k,
+    // and the prefix sums of x^3 from the width of about 78k
+    Mat labels(40, 80000, CV_32S, Scalar(1));
+    labels(Rect(0, 0, 30000, 40)).setTo(Scalar(0));
+    labels(Rect(50000, 5, 1, 30)).setTo(Scalar(2));
+
+    vector<Moments> mu;
+    labelsMoments(labels, 3, mu);
+    ASSERT_EQ(3u, mu.size());
+    // the central moments of the symmetric regions are the rounding errors of the huge spatial moments
+    for( int i = 0; i < 3; i++ )
+    {
+        Moments ref = moments(labels == i, true);
+        const double* a = &mu[i].m00;
+        const double* b = &ref.m00;
+        for( int k = 0; k < 10; k++ )
+            EXPECT_LE(fabs(a[k] - b[k]), 1e-9*std::max(1., fabs(b[k]))) << "label " << i << ", moment #" << k;
+    }
+}
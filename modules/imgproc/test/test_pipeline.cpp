@@ -0,0 +1,132 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+static void checkPipeline( const Ptr<ImagePipeline>& pipeline, const Mat& src, const Mat& ref, const string& name )
+{
+    int n = getNumThreads();
+    Mat dst1, dst;
+
+    setNumThreads(1);
+    pipeline->apply(src, dst1);
+    setNumThreads(std::max(n, 4));
+    pipeline->apply(src, dst);
+    setNumThreads(n);
+
+    ASSERT_EQ(ref.size(), dst.size()) << name;
+    ASSERT_EQ(ref.type(), dst.type()) << name;
+    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF)) << name;
+    EXPECT_EQ(0, cvtest::norm(ref, dst1, NORM_INF)) << name;
+}
+
+TEST(Imgproc_ImagePipeline, same_as_functions)
+{
+    RNG& rng = theRNG();
+    Mat src(1001, 1533, CV_8UC3);
+    rng.fill(src, RNG::UNIFORM, 0, 256);
+    GaussianBlur(src, src, Size(0, 0), 2);
+
+    // color, down-scale, blur, convert
+    {
+        Ptr<ImagePipeline> pipeline = createImagePipeline();
+        pipeline->addCvtColor(COLOR_BGR2GRAY);
+        pipeline->addResize(Size(), 0.5, 0.5, INTER_AREA);
+        pipeline->addGaussianBlur(Size(5, 5), 1.5);
+        pipeline->addConvertTo(CV_32F, 1./255);
+
+        Mat gray, small, blurred, ref;
+        cvtColor(src, gray, COLOR_BGR2GRAY);
+        resize(gray, small, Size(), 0.5, 0.5, INTER_AREA);
+        GaussianBlur(small, blurred, Size(5, 5), 1.5);
+        blurred.convertTo(ref, CV_32F, 1./255);
+
+        checkPipeline(pipeline, src, ref, "gray/area/blur/float");
+    }
+
+    // all the interpolations, with arbitrary scales, and large kernels between them
+    int interpolations[] = { INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_AREA, INTER_LANCZOS4 };
+    for( int k = 0; k < 5; k++ )
+    {
+        Ptr<ImagePipeline> pipeline = createImagePipeline();
+        pipeline->addConvertTo(CV_32F);
+        pipeline->addGaussianBlur(Size(0, 0), 4, 2, BORDER_REFLECT);
+        pipeline->addResize(Size(777, 333), 0, 0, interpolations[k]);
+        pipeline->addCvtColor(COLOR_BGR2Lab);
+        pipeline->addResize(Size(), 1.7, 2.3, interpolations[k]);
+        pipeline->addGaussianBlur(Size(7, 3), 0, 0, BORDER_CONSTANT);
+
+        Mat f, b, r, lab, ref;
+        src.convertTo(f, CV_32F);
+        GaussianBlur(f, b, Size(0, 0), 4, 2, BORDER_REFLECT);
+        resize(b, r, Size(777, 333), 0, 0, interpolations[k]);
+        cvtColor(r, lab, COLOR_BGR2Lab);
+        resize(lab, r, Size(), 1.7, 2.3, interpolations[k]);
+        GaussianBlur(r, ref, Size(7, 3), 0, 0, BORDER_CONSTANT);
+
+        checkPipeline(pipeline, src, ref, format("interpolation=%d", interpolations[k]));
+    }
+
+    // ROI input, 8-bit blur reading the rows around the ROI
+    {
+        Mat roi = src(Rect(100, 150, 800, 600));
+        Ptr<ImagePipeline> pipeline = createImagePipeline();
+        pipeline->addGaussianBlur(Size(9, 9), 0);
+        pipeline->addResize(Size(), 0.5, 0.5);
+
+        Mat b, ref;
+        GaussianBlur(roi, b, Size(9, 9), 0);
+        resize(b, ref, Size(), 0.5, 0.5);
+
+        checkPipeline(pipeline, roi, ref, "roi");
+    }
+}
+
+TEST(Imgproc_ImagePipeline, same_as_functions_ipp)
+{
+    // IPP replaces the 5x5 blur with equal sigmas and the cubic resize of the float images on the
+    // whole images, these stages must run on them; the others still run by tiles
+    bool useIPP = ipp::useIPP();
+    ipp::setUseIPP(true);
+
+    Mat src(1001, 1533, CV_8UC3);
+    theRNG().fill(src, RNG::UNIFORM, 0, 256);
+
+    Ptr<ImagePipeline> pipeline = createImagePipeline();
+    pipeline->addResize(Size(), 0.5, 0.5, INTER_LINEAR);
+    pipeline->addGaussianBlur(Size(5, 5), 1.5, 1.5);
+    pipeline->addCvtColor(COLOR_BGR2GRAY);
+    pipeline->addConvertTo(CV_32F);
+    pipeline->addResize(Size(900, 300), 0, 0, INTER_CUBIC);
+    pipeline->addGaussianBlur(Size(3, 3), 0, 0, BORDER_REFLECT);
+
+    Mat small, blurred, gray, f, r, ref;
+    resize(src, small, Size(), 0.5, 0.5, INTER_LINEAR);
+    GaussianBlur(small, blurred, Size(5, 5), 1.5, 1.5);
+    cvtColor(blurred, gray, COLOR_BGR2GRAY);
+    gray.convertTo(f, CV_32F);
+    resize(f, r, Size(900, 300), 0, 0, INTER_CUBIC);
+    GaussianBlur(r, ref, Size(3, 3), 0, 0, BORDER_REFLECT);
+
+    checkPipeline(pipeline, src, ref, "ipp");
+
+    // the last stage writes to dst, which is the source here
+    Mat img = src.clone();
+    pipeline->apply(img, img);
+    EXPECT_EQ(0, cvtest::norm(ref, img, NORM_INF));
+    ipp::setUseIPP(useIPP);
+}
+
+TEST(Imgproc_ImagePipeline, unsupported)
+{
+    Ptr<ImagePipeline> pipeline = createImagePipeline();
+    EXPECT_TRUE(pipeline->empty());
+    EXPECT_THROW(pipeline->addCvtColor(COLOR_BayerBG2BGR), cv::Exception);
+    EXPECT_THROW(pipeline->addCvtColor(COLOR_YUV2BGR_NV12), cv::Exception);
+    EXPECT_THROW(pipeline->addGaussianBlur(Size(3, 3), 0, 0, BORDER_WRAP), cv::Exception);
+    EXPECT_TRUE(pipeline->empty());
+}
@@ -0,0 +1,117 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+static void getCamera( Size size, Mat& cameraMatrix, Mat& distCoeffs, Mat& R, Mat& newCameraMatrix )
+{
+    cameraMatrix = (Mat_<double>(3, 3) << 800, 0, size.width*0.5 + 3.5, 0, 810, size.height*0.5 - 2.25, 0, 0, 1);
+    distCoeffs = (Mat_<double>(1, 5) << -0.21, 0.08, 0.001, -0.0015, -0.01);
+    double a = 0.02, ca = cos(a), sa = sin(a), b = -0.01, cb = cos(b), sb = sin(b);
+    R = (Mat_<double>(3, 3) << ca, 0, sa, 0, 1, 0, -sa, 0, ca)*(Mat_<double>(3, 3) << 1, 0, 0, 0, cb, -sb, 0, sb, cb);
+    newCameraMatrix = (Mat_<double>(3, 3) << 760, 0, size.width*0.5, 0, 760, size.height*0.5, 0, 0, 1);
+}
+
+TEST(Imgproc_WarpMap, step1_same_as_remap)
+{
+    Size size(641, 479);
+    Mat cameraMatrix, distCoeffs, R, newCameraMatrix;
+    getCamera(size, cameraMatrix, distCoeffs, R, newCameraMatrix);
+
+    Mat src(size, CV_8UC3);
+    theRNG().fill(src, RNG::UNIFORM, 0, 256);
+
+    Mat mapx, mapy;
+    initUndistortRectifyMap(cameraMatrix, distCoeffs, R, newCameraMatrix, size, CV_32FC1, mapx, mapy);
+    Ptr<WarpMap> warpMap = createUndistortRectifyWarpMap(cameraMatrix, distCoeffs, R, newCameraMatrix, size, 1, 1);
+    ASSERT_EQ(size, warpMap->getSize());
+    ASSERT_EQ(1, warpMap->getGridStep());
+
+    int interpolations[] = { INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4 };
+    for( int k = 0; k < 4; k++ )
+    {
+        Mat ref, dst;
+        remap(src, ref, mapx, mapy, interpolations[k], BORDER_CONSTANT, Scalar(1, 2, 3));
+        warpMap->apply(src, dst, interpolations[k], BORDER_CONSTANT, Scalar(1, 2, 3));
+        EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF)) << "interpolation " << interpolations[k];
+    }
+}
+
+TEST(Imgproc_WarpMap, coarse_grid_accuracy)
+{
+    Size size(1280, 720);
+    Mat cameraMatrix, distCoeffs, R, newCameraMatrix;
+    getCamera(size, cameraMatrix, distCoeffs, R, newCameraMatrix);
+
+    double scales[] = { 1, 0.5, 0.3 };
+    for( int k = 0; k < 3; k++ )
+    {
+        double scale = scales[k];
+        // the same grid spacing in the source image
+        int gridStep = cvRound(16*scale);
+        Ptr<WarpMap> warpMap = createUndistortRectifyWarpMap(cameraMatrix, distCoeffs, R, newCameraMatrix, size, scale, gridStep);
+        Size dsize(cvRound(size.width*scale), cvRound(size.height*scale));
+        ASSERT_EQ(dsize, warpMap->getSize());
+
+        // the maps of the scaled image are the undistortion maps at the scaled pixel centers
+        Mat S = (Mat_<double>(3, 3) << scale, 0, 0.5*(scale - 1), 0, scale, 0.5*(scale - 1), 0, 0, 1);
+        Mat refx, refy, mapx, mapy;
+        initUndistortRectifyMap(cameraMatrix, distCoeffs, R, S*newCameraMatrix, dsize, CV_32FC1, refx, refy);
+        warpMap->getMaps(mapx, mapy);
+
+        EXPECT_LE(cvtest::norm(refx, mapx, NORM_INF), 0.05) << "scale " << scale;
+        EXPECT_LE(cvtest::norm(refy, mapy, NORM_INF), 0.05) << "scale " << scale;
+    }
+}
+
+TEST(Imgproc_WarpMap, from_maps)
+{
+    Size size(517, 333);
+    Mat mapx(size, CV_32F), mapy(size, CV_32F);
+    for( int y = 0; y < size.height; y++ )
+        for( int x = 0; x < size.width; x++ )
+        {
+            mapx.at<float>(y, x) = (float)(x*0.9 + y*0.05 + 3);
+            mapy.at<float>(y, x) = (float)(y*1.1 - x*0.02 + 1);
+        }
+
+    // affine maps are reproduced by any grid, also by the extrapolated nodes
+    Mat map2c, mx, my;
+    Mat planes[] = { mapx, mapy };
+    merge(planes, 2, map2c);
+    Ptr<WarpMap> warpMap = createWarpMap(map2c, noArray(), 32);
+    warpMap->getMaps(mx, my);
+    EXPECT_LE(cvtest::norm(mapx, mx, NORM_INF), 1e-3);
+    EXPECT_LE(cvtest::norm(mapy, my, NORM_INF), 1e-3);
+
+    Mat src(size, CV_32FC1), ref, dst;
+    theRNG().fill(src, RNG::UNIFORM, 0, 1);
+    warpMap = createWarpMap(mapx, mapy, 1);
+    remap(src, ref, mapx, mapy, INTER_LINEAR, BORDER_REFLECT);
+    warpMap->apply(src, dst, INTER_LINEAR, BORDER_REFLECT);
+    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+}
+
+TEST(Imgproc_WarpMap, threads)
+{
+    Size size(800, 600);
+    Mat cameraMatrix, distCoeffs, R, newCameraMatrix;
+    getCamera(size, cameraMatrix, distCoeffs, R, newCameraMatrix);
+    Ptr<WarpMap> warpMap = createUndistortRectifyWarpMap(cameraMatrix, distCoeffs, R, newCameraMatrix, size, 0.75);
+
+    Mat src(size, CV_8UC1), dst1, dst;
+    theRNG().fill(src, RNG::UNIFORM, 0, 256);
+
+    int n = getNumThreads();
+    setNumThreads(1);
+    warpMap->apply(src, dst1);
+    setNumThreads(std::max(n, 4));
+    warpMap->apply(src, dst);
+    setNumThreads(n);
+
+    EXPECT_EQ(0, cvtest::norm(dst1, dst, NORM_INF));
+}
@@ -583,6 +583,16 @@ public:
     /** @copybrief getTermCriteria @see getTermCriteria */
     CV_WRAP virtual void setTermCriteria(const cv::TermCriteria &val) = 0;
 
+    /** Whether to use the shrinking heuristics in the optimization.
+    When it is true, the bounded variables that are not likely to change are temporarily excluded
+    from the optimization, which speeds up the training on large datasets. The result is optimal
+    within the same tolerance, but the support vectors may slightly differ from the ones found
+    without shrinking. Default value is false. */
+    /** @see setShrinking */
+    CV_WRAP bool getShrinking() const;
+    /** @copybrief getShrinking @see getShrinking */
+    CV_WRAP void setShrinking(bool val);
+
     /** Type of a %SVM kernel.
     See SVM::KernelTypes. Default value is SVM::RBF. */
     CV_WRAP virtual int getKernelType() const = 0;
@@ -595,6 +605,17 @@ public:
     See SVM::Kernel class for implementation details */
     virtual void setCustomKernel(const Ptr<Kernel> &_kernel) = 0;
 
+    /** Reduction factor of the successive halving in SVM::trainAuto.
+    When it is greater than 1, all the parameter combinations of the grid are first evaluated on a
+    few cross-validation folds, only the best 1/factor of them are evaluated on more folds, and so
+    on, until the remaining combinations are evaluated on all the folds. It saves most of the
+    training time, but the chosen parameters may differ from the ones of the exhaustive search.
+    Default value is 0, all the combinations are evaluated on all the folds. */
+    /** @see setTrainAutoHalvingFactor */
+    CV_WRAP int getTrainAutoHalvingFactor() const;
+    /** @copybrief getTrainAutoHalvingFactor @see getTrainAutoHalvingFactor */
+    CV_WRAP void setTrainAutoHalvingFactor(int val);
+
     //! %SVM type
     enum Types {
         /** C-Support Vector Classification. n-class classification (n \f$\geq\f$ 2), allows
@@ -675,7 +696,8 @@ public:
 
     The method trains the %SVM model automatically by choosing the optimal parameters C, gamma, p,
     nu, coef0, degree. Parameters are considered optimal when the cross-validation
-    estimate of the test set error is minimal.
+    estimate of the test set error is minimal. The parameter combinations and the folds are
+    evaluated in parallel, see also SVM::setTrainAutoHalvingFactor.
 
     If there is no need to optimize a parameter, the corresponding grid step should be set to any
     value less than or equal to 1. For example, to avoid optimization in gamma, set `gammaGrid.step
@@ -1464,6 +1486,22 @@ public:
     /** @copybrief getBackpropMomentumScale @see getBackpropMomentumScale */
     CV_WRAP virtual void setBackpropMomentumScale(double val) = 0;
 
+    /** BPROP: Number of samples in a mini-batch.
+    With the value 1 the weights are updated after every sample. With larger values the forward and
+    backward passes are computed for the whole batch, in parallel, and the weights are updated once per
+    batch, using the mean gradient of its samples. Default value is 1.*/
+    /** @see setBackpropBatchSize */
+    CV_WRAP int getBackpropBatchSize() const;
+    /** @copybrief getBackpropBatchSize @see getBackpropBatchSize */
+    CV_WRAP void setBackpropBatchSize(int val);
+
+    /** BPROP: Compute the mini-batch forward and backward passes in single precision.
+    The weights are stored and updated in double precision anyway. Default value is false.*/
+    /** @see setBackpropFloat32 */
+    CV_WRAP bool getBackpropFloat32() const;
+    /** @copybrief getBackpropFloat32 @see getBackpropFloat32 */
+    CV_WRAP void setBackpropFloat32(bool val);
+
     /** RPROP: Initial value \f$\Delta_0\f$ of update-values \f$\Delta_{ij}\f$.
     Default value is 0.1.*/
     /** @see setRpropDW0 */
@@ -0,0 +1,50 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace cv::ml;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<int, int, bool> HiddenSize_BatchSize_Float32_t;
+typedef perf::TestBaseWithParam<HiddenSize_BatchSize_Float32_t> HiddenSize_BatchSize_Float32;
+
+PERF_TEST_P(HiddenSize_BatchSize_Float32, ANN_MLP_trainBackprop,
+            testing::Combine(
+                testing::Values(32, 128),
+                testing::Values(1, 32, 256),
+                testing::Bool()
+                )
+            )
+{
+    int hiddenSize = get<0>(GetParam());
+    int batchSize = get<1>(GetParam());
+    bool float32 = get<2>(GetParam());
+    int samplesNum = 4000, inputSize = 16, nclasses = 4, epochs = 5;
+
+    Mat samples(samplesNum, inputSize, CV_32F), responses(samplesNum, nclasses, CV_32F, Scalar(0));
+    declare.in(samples, WARMUP_RNG);
+    for( int i = 0; i < samplesNum; i++ )
+    {
+        samples.at<float>(i, i % nclasses) += 1.f;
+        responses.at<float>(i, i % nclasses) = 1.f;
+    }
+
+    Mat layers = (Mat_<int>(1, 4) << inputSize, hiddenSize, hiddenSize, nclasses);
+    Ptr<ANN_MLP> ann = ANN_MLP::create();
+    ann->setLayerSizes(layers);
+    ann->setActivationFunction(ANN_MLP::SIGMOID_SYM, 1, 1);
+    ann->setTrainMethod(ANN_MLP::BACKPROP, 0.1, 0.1);
+    ann->setBackpropBatchSize(batchSize);
+    ann->setBackpropFloat32(float32);
+    ann->setTermCriteria(TermCriteria(TermCriteria::COUNT, epochs, 0));
+    Ptr<TrainData> data = TrainData::create(samples, ROW_SAMPLE, responses);
+
+    TEST_CYCLE() ann->train(data);
+
+    performance_metrics& m = calcMetrics();
+    RecordProperty("samples_per_sec", cvRound(samplesNum*epochs*m.frequency/m.median));
+
+    SANITY_CHECK_NOTHING();
+}
@@ -39,9 +39,77 @@
 //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv { namespace ml {
 
+// the rows of a mini-batch that are processed by one task; the partial gradients are summed
+// in the fixed order, so the training does not depend on the number of threads
+enum { ANN_MINIBATCH_CHUNK = 32 };
+
+// dst = src1*src2, src1^T*src2 (GEMM_1_T) or src1*src2^T (GEMM_2_T) in single precision;
+// cv::gemm accumulates the float products in double, so it gives no gain to the float32 path
+static void gemm32f( const Mat& src1, const Mat& src2, Mat& dst, int flags )
+{
+    int i, j, k;
+    if( flags & GEMM_2_T )
+    {
+        // the dot products of the rows
+        int l = src1.cols;
+        for( i = 0; i < dst.rows; i++ )
+        {
+            const float* a = src1.ptr<float>(i);
+            float* d = dst.ptr<float>(i);
+            for( j = 0; j < dst.cols; j++ )
+            {
+                const float* b = src2.ptr<float>(j);
+                float s = 0;
+                k = 0;
+#if CV_SIMD128
+                v_float32x4 v_s = v_setzero_f32();
+                for( ; k <= l - 4; k += 4 )
+                    v_s += v_load(a + k)*v_load(b + k);
+                s = v_reduce_sum(v_s);
+#endif
+                for( ; k < l; k++ )
+                    s += a[k]*b[k];
+                d[j] = s;
+            }
+        }
+        return;
+    }
+
+    // the rows of dst are accumulated from the rows of src2
+    bool t1 = (flags & GEMM_1_T) != 0;
+    int n = dst.cols, l = src2.rows;
+    dst = Scalar(0);
+    for( k = 0; k < l; k++ )
+    {
+        const float* b = src2.ptr<float>(k);
+        for( i = 0; i < dst.rows; i++ )
+        {
+            float a = t1 ? src1.at<float>(k, i) : src1.at<float>(i, k);
+            float* d = dst.ptr<float>(i);
+            j = 0;
+#if CV_SIMD128
+            v_float32x4 v_a = v_setall_f32(a);
+            for( ; j <= n - 4; j += 4 )
+                v_store(d + j, v_load(d + j) + v_a*v_load(b + j));
+#endif
+            for( ; j < n; j++ )
+                d[j] += a*b[j];
+        }
+    }
+}
+
+static void gemmMiniBatch( const Mat& src1, const Mat& src2, Mat& dst, int flags = 0 )
+{
+    if( src1.type() == CV_32F )
+        gemm32f( src1, src2, dst, flags );
+    else
+        gemm( src1, src2, 1, noArray(), 0, dst, flags );
+}
+
 struct AnnParams
 {
     AnnParams()
@@ -49,6 +117,8 @@ struct AnnParams
         termCrit = TermCriteria( TermCriteria::COUNT + TermCriteria::EPS, 1000, 0.01 );
         trainMethod = ANN_MLP::RPROP;
         bpDWScale = bpMomentScale = 0.1;
+        bpBatchSize = 1;
+        bpFloat32 = false;
         rpDW0 = 0.1; rpDWPlus = 1.2; rpDWMinus = 0.5;
         rpDWMin = FLT_EPSILON; rpDWMax = 50.;
     }
@@ -58,6 +128,8 @@ struct AnnParams
 
     double bpDWScale;
     double bpMomentScale;
+    int bpBatchSize;
+    bool bpFloat32;
 
     double rpDW0;
     double rpDWPlus;
@@ -133,6 +205,28 @@ public:
         return params.trainMethod;
     }
 
+    void setBackpropBatchSize_(int val)
+    {
+        if( val < 1 )
+            CV_Error( CV_StsOutOfRange, "The mini-batch size must be positive" );
+        params.bpBatchSize = val;
+    }
+
+    int getBackpropBatchSize_() const
+    {
+        return params.bpBatchSize;
+    }
+
+    void setBackpropFloat32_(bool val)
+    {
+        params.bpFloat32 = val;
+    }
+
+    bool getBackpropFloat32_() const
+    {
+        return params.bpFloat32;
+    }
+
     void setActivationFunction(int _activ_func, double _f_param1, double _f_param2 )
     {
         if( _activ_func < 0 || _activ_func > GAUSSIAN )
@@ -460,6 +554,16 @@ public:
     }
 
     void calc_activ_func_deriv( Mat& _xf, Mat& _df, const Mat& w ) const
+    {
+        if( _xf.type() == CV_32F )
+            calc_activ_func_deriv_<float>( _xf, _df, w );
+        else
+            calc_activ_func_deriv_<double>( _xf, _df, w );
+    }
+
+    // the sums are in the working type T, the biases are always double
+    template<typename T>
+    void calc_activ_func_deriv_( Mat& _xf, Mat& _df, const Mat& w ) const
     {
         const double* bias = w.ptr<double>(w.rows-1);
         int i, j, n = _xf.rows, cols = _xf.cols;
@@ -468,12 +572,12 @@ public:
         {
             for( i = 0; i < n; i++ )
             {
-                double* xf = _xf.ptr<double>(i);
-                double* df = _df.ptr<double>(i);
+                T* xf = _xf.ptr<T>(i);
+                T* df = _df.ptr<T>(i);
 
                 for( j = 0; j < cols; j++ )
                 {
-                    xf[j] += bias[j];
+                    xf[j] = (T)(xf[j] + bias[j]);
                     df[j] = 1;
                 }
             }
@@ -484,22 +588,22 @@ public:
             double scale2 = scale*f_param2;
             for( i = 0; i < n; i++ )
             {
-                double* xf = _xf.ptr<double>(i);
-                double* df = _df.ptr<double>(i);
+                T* xf = _xf.ptr<T>(i);
+                T* df = _df.ptr<T>(i);
 
                 for( j = 0; j < cols; j++ )
                 {
                     double t = xf[j] + bias[j];
-                    df[j] = t*2*scale2;
-                    xf[j] = t*t*scale;
+                    df[j] = (T)(t*2*scale2);
+                    xf[j] = (T)(t*t*scale);
                 }
             }
             exp( _xf, _xf );
 
             for( i = 0; i < n; i++ )
             {
-                double* xf = _xf.ptr<double>(i);
-                double* df = _df.ptr<double>(i);
+                T* xf = _xf.ptr<T>(i);
+                T* df = _df.ptr<T>(i);
 
                 for( j = 0; j < cols; j++ )
                     df[j] *= xf[j];
@@ -512,13 +616,13 @@ public:
 
             for( i = 0; i < n; i++ )
             {
-                double* xf = _xf.ptr<double>(i);
-                double* df = _df.ptr<double>(i);
+                T* xf = _xf.ptr<T>(i);
+                T* df = _df.ptr<T>(i);
 
                 for( j = 0; j < cols; j++ )
                 {
-                    xf[j] = (xf[j] + bias[j])*scale;
-                    df[j] = -fabs(xf[j]);
+                    xf[j] = (T)((xf[j] + bias[j])*scale);
+                    df[j] = -std::abs(xf[j]);
                 }
             }
 
@@ -530,8 +634,8 @@ public:
             scale *= 2*f_param2;
             for( i = 0; i < n; i++ )
             {
-                double* xf = _xf.ptr<double>(i);
-                double* df = _df.ptr<double>(i);
+                T* xf = _xf.ptr<T>(i);
+                T* df = _df.ptr<T>(i);
 
                 for( j = 0; j < cols; j++ )
                 {
@@ -539,8 +643,8 @@ public:
                     double t0 = 1./(1. + df[j]);
                     double t1 = scale*df[j]*t0*t0;
                     t0 *= scale2*(1. - df[j])*s0;
-                    df[j] = t1;
-                    xf[j] = t0;
+                    df[j] = (T)t1;
+                    xf[j] = (T)t0;
                 }
             }
         }
@@ -713,9 +817,9 @@ public:
         termcrit.maxCount = std::max((params.termCrit.type & CV_TERMCRIT_ITER ? params.termCrit.maxCount : MAX_ITER), 1);
         termcrit.epsilon = std::max((params.termCrit.type & CV_TERMCRIT_EPS ? params.termCrit.epsilon : DEFAULT_EPSILON), DBL_EPSILON);
 
-        int iter = params.trainMethod == ANN_MLP::BACKPROP ?
-            train_backprop( inputs, outputs, sw, termcrit ) :
-            train_rprop( inputs, outputs, sw, termcrit );
+        int iter = params.trainMethod != ANN_MLP::BACKPROP ? train_rprop( inputs, outputs, sw, termcrit ) :
+            params.bpBatchSize > 1 || params.bpFloat32 ? train_backprop_minibatch( inputs, outputs, sw, termcrit ) :
+            train_backprop( inputs, outputs, sw, termcrit );
 
         trained = iter > 0;
         return trained;
@@ -856,6 +960,225 @@ public:
         return iter;
     }
 
+    // the buffers of one chunk of a mini-batch
+    struct MiniBatchBuf
+    {
+        vector<Mat> x, df, dEdw;
+        Mat grad[2];
+        double E;
+    };
+
+    struct MiniBatchLoop : public ParallelLoopBody
+    {
+        MiniBatchLoop(const ANN_MLPImpl* _ann, const Mat& _inputs, const Mat& _outputs, const double* _sw,
+                      const int* _idx, int _count, const vector<Mat>& _w, vector<MiniBatchBuf>& _bufs)
+        {
+            ann = _ann;
+            inputs = _inputs;
+            outputs = _outputs;
+            sw = _sw;
+            idx = _idx;
+            count = _count;
+            w = &_w;
+            bufs = &_bufs;
+        }
+
+        const ANN_MLPImpl* ann;
+        Mat inputs, outputs;
+        const double* sw;
+        const int* idx;
+        int count;
+        const vector<Mat>* w;
+        vector<MiniBatchBuf>* bufs;
+
+        void operator()( const Range& range ) const
+        {
+            for( int c = range.start; c < range.end; c++ )
+            {
+                if( w->at(1).type() == CV_32F )
+                    run<float>(c);
+                else
+                    run<double>(c);
+            }
+        }
+
+        // forward and backward passes over the samples idx[c*ANN_MINIBATCH_CHUNK, ...) of the batch
+        template<typename T>
+        void run( int c ) const
+        {
+            MiniBatchBuf& buf = bufs->at(c);
+            int i0 = c*ANN_MINIBATCH_CHUNK, n = std::min((int)ANN_MINIBATCH_CHUNK, count - i0);
+            int ivcount = ann->layer_sizes.front();
+            int ovcount = ann->layer_sizes.back();
+            int itype = inputs.type(), otype = outputs.type();
+            int i, j, k, l_count = ann->layer_count();
+            double sweight0 = inputs.rows;
+            const double* scale = ann->weights[0].ptr<double>();
+
+            // grab and preprocess input data
+            Mat x1 = buf.x[0].rowRange(0, n);
+            for( i = 0; i < n; i++ )
+            {
+                const uchar* x0data_p = inputs.ptr(idx[i0 + i]);
+                const float* x0data_f = (const float*)x0data_p;
+                const double* x0data_d = (const double*)x0data_p;
+
+                T* xdata = x1.ptr<T>(i);
+                for( j = 0; j < ivcount; j++ )
+                    xdata[j] = (T)((itype == CV_32F ? (double)x0data_f[j] : x0data_d[j])*scale[j*2] + scale[j*2+1]);
+            }
+
+            // forward pass, compute y[i]=w*x[i-1], x[i]=f(y[i]), df[i]=f'(y[i])
+            for( i = 1; i < l_count; i++ )
+            {
+                Mat x2 = buf.x[i].rowRange(0, n);
+                gemmMiniBatch( x1, w->at(i).rowRange(0, x1.cols), x2 );
+                Mat _df = buf.df[i].rowRange(0, n);
+                ann->calc_activ_func_deriv( x2, _df, ann->weights[i] );
+                x1 = x2;
+            }
+
+            // calculate error
+            Mat grad1(n, ovcount, x1.type(), buf.grad[l_count & 1].ptr());
+            scale = ann->weights[l_count+1].ptr<double>();
+            buf.E = 0;
+            for( i = 0; i < n; i++ )
+            {
+                const uchar* udata_p = outputs.ptr(idx[i0 + i]);
+                const float* udata_f = (const float*)udata_p;
+                const double* udata_d = (const double*)udata_p;
+
+                const T* xdata = x1.ptr<T>(i);
+                T* gdata = grad1.ptr<T>(i);
+                double sweight = sw ? sweight0*sw[idx[i0 + i]] : 1., E1 = 0;
+
+                for( k = 0; k < ovcount; k++ )
+                {
+                    double t = (otype == CV_32F ? (double)udata_f[k] : udata_d[k])*scale[k*2] + scale[k*2+1] - xdata[k];
+                    gdata[k] = (T)(t*sweight);
+                    E1 += t*t;
+                }
+                buf.E += sweight*E1;
+            }
+
+            // backward pass, the weights are updated by the caller
+            for( i = l_count-1; i > 0; i-- )
+            {
+                int n1 = ann->layer_sizes[i-1];
+                multiply( grad1, buf.df[i].rowRange(0, n), grad1 );
+
+                Mat dEdw = buf.dEdw[i].rowRange(0, n1);
+                gemmMiniBatch( buf.x[i-1].rowRange(0, n), grad1, dEdw, GEMM_1_T );
+                Mat dEdw_bias = buf.dEdw[i].row(n1);
+                reduce( grad1, dEdw_bias, 0, REDUCE_SUM );
+
+                if( i > 1 )
+                {
+                    Mat grad2(n, n1, x1.type(), buf.grad[i & 1].ptr());
+                    gemmMiniBatch( grad1, w->at(i).rowRange(0, n1), grad2, GEMM_2_T );
+                    grad1 = grad2;
+                }
+            }
+        }
+    };
+
+    int train_backprop_minibatch( const Mat& inputs, const Mat& outputs, const Mat& _sw, TermCriteria termCrit )
+    {
+        int i, j, k, c;
+        double prev_E = DBL_MAX*0.5, E = 0;
+        int count = inputs.rows;
+        int batch_size = std::min(params.bpBatchSize, count);
+        int wtype = params.bpFloat32 ? CV_32F : CV_64F;
+
+        int iter, max_iter = termCrit.maxCount;
+        double epsilon = termCrit.epsilon*count;
+
+        int l_count = layer_count();
+        int max_chunks = (batch_size + ANN_MINIBATCH_CHUNK - 1)/ANN_MINIBATCH_CHUNK;
+        int chunk_rows = std::min(batch_size, (int)ANN_MINIBATCH_CHUNK);
+
+        // allocate buffers
+        vector<Mat> w(l_count), dw(l_count), dEdw(l_count);
+        vector<MiniBatchBuf> bufs(max_chunks);
+
+        for( i = 1; i < l_count; i++ )
+        {
+            dw[i] = Mat::zeros(weights[i].size(), CV_64F);
+            dEdw[i].create(weights[i].size(), CV_64F);
+        }
+
+        for( c = 0; c < max_chunks; c++ )
+        {
+            MiniBatchBuf& buf = bufs[c];
+            buf.x.resize(l_count);
+            buf.df.resize(l_count);
+            buf.dEdw.resize(l_count);
+            for( i = 0; i < l_count; i++ )
+            {
+                buf.x[i].create(chunk_rows, layer_sizes[i], wtype);
+                buf.df[i].create(chunk_rows, layer_sizes[i], wtype);
+                if( i > 0 )
+                    buf.dEdw[i].create(weights[i].size(), wtype);
+            }
+            buf.grad[0].create(1, chunk_rows*max_lsize, wtype);
+            buf.grad[1].create(1, chunk_rows*max_lsize, wtype);
+        }
+
+        Mat _idx_m(1, count, CV_32S);
+        int* _idx = _idx_m.ptr<int>();
+        for( i = 0; i < count; i++ )
+            _idx[i] = i;
+
+        const double* sw = _sw.empty() ? 0 : _sw.ptr<double>();
+
+        // run mini-batch back-propagation loop
+        /*
+         the same as the sequential back-propagation, with grad_i and dw_i summed over the batch:
+         dw_i(t) = momentum*dw_i(t-1) + dw_scale/batch_size*sum_over_batch(x_{i-1}*grad_i)
+        */
+        for( iter = 0; iter < max_iter; )
+        {
+            // shuffle indices
+            for( i = 0; i < count; i++ )
+            {
+                j = rng.uniform(0, count);
+                k = rng.uniform(0, count);
+                std::swap(_idx[j], _idx[k]);
+            }
+
+            E = 0;
+            for( int b = 0; b < count; b += batch_size )
+            {
+                int n = std::min(batch_size, count - b);
+                int nchunks = (n + ANN_MINIBATCH_CHUNK - 1)/ANN_MINIBATCH_CHUNK;
+
+                for( i = 1; i < l_count; i++ )
+                    weights[i].convertTo(w[i], wtype);
+
+                parallel_for_(Range(0, nchunks), MiniBatchLoop(this, inputs, outputs, sw, _idx + b, n, w, bufs));
+
+                for( i = 1; i < l_count; i++ )
+                {
+                    bufs[0].dEdw[i].convertTo(dEdw[i], CV_64F);
+                    for( c = 1; c < nchunks; c++ )
+                        add( dEdw[i], bufs[c].dEdw[i], dEdw[i], noArray(), CV_64F );
+                    addWeighted( dEdw[i], params.bpDWScale/n, dw[i], params.bpMomentScale, 0, dw[i] );
+                    add( weights[i], dw[i], weights[i] );
+                }
+
+                for( c = 0; c < nchunks; c++ )
+                    E += bufs[c].E;
+            }
+
+            iter++;
+            if( fabs(prev_E - E) < epsilon )
+                break;
+            prev_E = E;
+        }
+
+        return iter;
+    }
+
     struct RPropLoop : public ParallelLoopBody
     {
         RPropLoop(ANN_MLPImpl* _ann,
@@ -1131,6 +1454,10 @@ public:
             fs << "train_method" << "BACKPROP";
             fs << "dw_scale" << params.bpDWScale;
             fs << "moment_scale" << params.bpMomentScale;
+            if( params.bpBatchSize > 1 )
+                fs << "batch_size" << params.bpBatchSize;
+            if( params.bpFloat32 )
+                fs << "float32" << 1;
         }
         else if( params.trainMethod == ANN_MLP::RPROP )
         {
@@ -1219,6 +1546,8 @@ public:
                 params.trainMethod = ANN_MLP::BACKPROP;
                 params.bpDWScale = (double)tpn["dw_scale"];
                 params.bpMomentScale = (double)tpn["moment_scale"];
+                params.bpBatchSize = std::max((int)tpn["batch_size"], 1);
+                params.bpFloat32 = (int)tpn["float32"] != 0;
             }
             else if( tmethod_name == "RPROP" )
             {
@@ -1336,6 +1665,38 @@ Ptr<ANN_MLP> ANN_MLP::load(const String& filepath)
     return ann;
 }
 
+int ANN_MLP::getBackpropBatchSize() const
+{
+    const ANN_MLPImpl* this_ = dynamic_cast<const ANN_MLPImpl*>(this);
+    if(!this_)
+        CV_Error(Error::StsNotImplemented, "the class is not ANN_MLPImpl");
+    return this_->getBackpropBatchSize_();
+}
+
+void ANN_MLP::setBackpropBatchSize(int val)
+{
+    ANN_MLPImpl* this_ = dynamic_cast<ANN_MLPImpl*>(this);
+    if(!this_)
+        CV_Error(Error::StsNotImplemented, "the class is not ANN_MLPImpl");
+    this_->setBackpropBatchSize_(val);
+}
+
+bool ANN_MLP::getBackpropFloat32() const
+{
+    const ANN_MLPImpl* this_ = dynamic_cast<const ANN_MLPImpl*>(this);
+    if(!this_)
+        CV_Error(Error::StsNotImplemented, "the class is not ANN_MLPImpl");
+    return this_->getBackpropFloat32_();
+}
+
+void ANN_MLP::setBackpropFloat32(bool val)
+{
+    ANN_MLPImpl* this_ = dynamic_cast<ANN_MLPImpl*>(this);
+    if(!this_)
+        CV_Error(Error::StsNotImplemented, "the class is not ANN_MLPImpl");
+    this_->setBackpropFloat32_(val);
+}
+
 
     }}
 
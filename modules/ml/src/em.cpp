@@ -40,6 +40,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -48,6 +49,73 @@ namespace ml
 
 const double minEigenValue = DBL_EPSILON;
 
+// the samples are processed by fixed blocks, and the M-step statistics are accumulated into
+// a fixed number of partial sums, so the results do not depend on the number of threads
+enum { EM_BLOCK = 256, EM_MAX_PARTS = 32, EM_MAX_PARTIAL_SIZE = 1 << 24 };
+
+// sum_d w_d*(x_d - m_d)^2
+static double diagMahalanobis( const double* x, const double* m, const double* w, int dim )
+{
+    int d = 0;
+    double s = 0;
+#if CV_SIMD128_64F
+    v_float64x2 v_s0 = v_setzero_f64(), v_s1 = v_setzero_f64();
+    for( ; d <= dim - 4; d += 4 )
+    {
+        v_float64x2 t0 = v_load(x + d) - v_load(m + d);
+        v_float64x2 t1 = v_load(x + d + 2) - v_load(m + d + 2);
+        v_s0 += v_load(w + d)*t0*t0;
+        v_s1 += v_load(w + d + 2)*t1*t1;
+    }
+    double buf[2];
+    v_store(buf, v_s0 + v_s1);
+    s = buf[0] + buf[1];
+#endif
+    for( ; d < dim; d++ )
+    {
+        double t = x[d] - m[d];
+        s += w[d]*t*t;
+    }
+    return s;
+}
+
+// acc_d += p*x_d
+static void accumulateScaled( double* acc, const double* x, double p, int dim )
+{
+    int d = 0;
+#if CV_SIMD128_64F
+    v_float64x2 v_p = v_setall_f64(p);
+    for( ; d <= dim - 4; d += 4 )
+    {
+        v_store(acc + d, v_load(acc + d) + v_p*v_load(x + d));
+        v_store(acc + d + 2, v_load(acc + d + 2) + v_p*v_load(x + d + 2));
+    }
+#endif
+    for( ; d < dim; d++ )
+        acc[d] += p*x[d];
+}
+
+// acc_d += p*(x_d - m_d)^2
+static void accumulateSquaredDiff( double* acc, const double* x, const double* m, double p, int dim )
+{
+    int d = 0;
+#if CV_SIMD128_64F
+    v_float64x2 v_p = v_setall_f64(p);
+    for( ; d <= dim - 4; d += 4 )
+    {
+        v_float64x2 t0 = v_load(x + d) - v_load(m + d);
+        v_float64x2 t1 = v_load(x + d + 2) - v_load(m + d + 2);
+        v_store(acc + d, v_load(acc + d) + v_p*t0*t0);
+        v_store(acc + d + 2, v_load(acc + d + 2) + v_p*t1*t1);
+    }
+#endif
+    for( ; d < dim; d++ )
+    {
+        double t = x[d] - m[d];
+        acc[d] += p*t*t;
+    }
+}
+
 class CV_EXPORTS EMImpl : public EM
 {
 public:
@@ -571,7 +639,7 @@ public:
         int dim = sample.cols;
 
         Mat L(1, nclusters, CV_64FC1), centeredSample(1, dim, CV_64F);
-        int i, label = 0;
+        int i;
         for(int clusterIndex = 0; clusterIndex < nclusters; clusterIndex++)
         {
             const double* mptr = means.ptr<double>(clusterIndex);
@@ -601,22 +669,37 @@ public:
             }
             CV_DbgAssert(!logWeightDivDet.empty());
             L.at<double>(clusterIndex) = logWeightDivDet.at<double>(clusterIndex) - 0.5 * Lval;
+        }
+
+        Vec2d res = normalizeProbabilities(L.ptr<double>(), nclusters, dim);
+        if(probs)
+            L.convertTo(*probs, ptype);
+
+        return res;
+    }
 
-            if(L.at<double>(clusterIndex) > L.at<double>(label))
-                label = clusterIndex;
+    // replaces L_ik by probs_ik, returns the log-likelihood and the label of the sample
+    static Vec2d normalizeProbabilities(double* L, int nclusters, int dim)
+    {
+        int i, label = 0;
+        for( i = 1; i < nclusters; i++ )
+        {
+            if( L[i] > L[label] )
+                label = i;
         }
 
-        double maxLVal = L.at<double>(label);
+        double maxLVal = L[label];
         double expDiffSum = 0;
-        for( i = 0; i < L.cols; i++ )
+        for( i = 0; i < nclusters; i++ )
         {
-            double v = std::exp(L.at<double>(i) - maxLVal);
-            L.at<double>(i) = v;
+            double v = std::exp(L[i] - maxLVal);
+            L[i] = v;
             expDiffSum += v; // sum_j(exp(L_ij - L_iq))
         }
 
-        if(probs)
-            L.convertTo(*probs, ptype, 1./expDiffSum);
+        double scale = 1./expDiffSum;
+        for( i = 0; i < nclusters; i++ )
+            L[i] *= scale;
 
         Vec2d res;
         res[0] = std::log(expDiffSum)  + maxLVal - 0.5 * dim * CV_LOG2PI;
@@ -625,6 +708,127 @@ public:
         return res;
     }
 
+    struct EStepBody : public ParallelLoopBody
+    {
+        EStepBody(const EMImpl* _em, const Mat& _invCovsDiag, Mat& _probs, Mat& _logLikelihoods, Mat& _labels) :
+            em(_em), invCovsDiag(&_invCovsDiag), probs(&_probs), logLikelihoods(&_logLikelihoods), labels(&_labels) {}
+
+        void operator()(const Range& range) const
+        {
+            const Mat& samples = em->trainSamples;
+            int nclusters = em->nclusters, dim = samples.cols;
+            int i0 = range.start*EM_BLOCK, i1 = std::min(range.end*EM_BLOCK, samples.rows);
+            const double* logWeightDivDet = em->logWeightDivDet.ptr<double>();
+
+            for( int i = i0; i < i1; i++ )
+            {
+                Mat sampleProbs = probs->row(i);
+                if( em->covMatType != COV_MAT_GENERIC )
+                {
+                    const double* x = samples.ptr<double>(i);
+                    double* L = sampleProbs.ptr<double>();
+                    for( int k = 0; k < nclusters; k++ )
+                        L[k] = logWeightDivDet[k] - 0.5 * diagMahalanobis(x, em->means.ptr<double>(k),
+                                                                          invCovsDiag->ptr<double>(k), dim);
+                }
+                Vec2d res = em->covMatType != COV_MAT_GENERIC ?
+                    normalizeProbabilities(sampleProbs.ptr<double>(), nclusters, dim) :
+                    em->computeProbabilities(samples.row(i), &sampleProbs, CV_64F);
+                logLikelihoods->at<double>(i) = res[0];
+                labels->at<int>(i) = static_cast<int>(res[1]);
+            }
+        }
+
+        const EMImpl* em;
+        const Mat* invCovsDiag;
+        Mat* probs;
+        Mat* logLikelihoods;
+        Mat* labels;
+    };
+
+    // accumulates the M-step statistics of the parts of the training set: the sums of the probabilities
+    // and of the weighted samples, or the weighted scatter of the samples around the updated means
+    struct MStepBody : public ParallelLoopBody
+    {
+        MStepBody(const EMImpl* _em, bool _scatter, double _minPosWeight, std::vector<Mat>& _sums) :
+            em(_em), scatter(_scatter), minPosWeight(_minPosWeight), sums(&_sums) {}
+
+        void operator()(const Range& range) const
+        {
+            const Mat& samples = em->trainSamples;
+            int nclusters = em->nclusters, dim = samples.cols;
+            int nsamples = samples.rows, nparts = (int)sums->size();
+            const double* weights = em->weights.ptr<double>();
+            AutoBuffer<double> _c(dim);
+            double* c = _c;
+
+            for( int part = range.start; part < range.end; part++ )
+            {
+                int i0 = (int)((int64)nsamples*part/nparts), i1 = (int)((int64)nsamples*(part + 1)/nparts);
+                Mat& acc = (*sums)[part];
+                acc = Scalar(0);
+
+                for( int i = i0; i < i1; i++ )
+                {
+                    const double* x = samples.ptr<double>(i);
+                    const double* p = em->trainProbs.ptr<double>(i);
+                    for( int k = 0; k < nclusters; k++ )
+                    {
+                        double pk = p[k];
+                        if( pk == 0 )
+                            continue;
+                        if( !scatter )
+                        {
+                            // the row k keeps the weighted sum of the samples and the sum of the probabilities
+                            double* a = acc.ptr<double>(k);
+                            accumulateScaled(a, x, pk, dim);
+                            a[dim] += pk;
+                        }
+                        else if( weights[k] > minPosWeight )
+                        {
+                            const double* m = em->means.ptr<double>(k);
+                            if( em->covMatType != COV_MAT_GENERIC )
+                                accumulateSquaredDiff(acc.ptr<double>(k), x, m, pk, dim);
+                            else
+                            {
+                                // the upper triangle of the cluster scatter matrix
+                                double* a = acc.ptr<double>(k*dim);
+                                for( int d = 0; d < dim; d++ )
+                                    c[d] = x[d] - m[d];
+                                for( int d = 0; d < dim; d++, a += dim )
+                                    accumulateScaled(a + d, c + d, pk*c[d], dim - d);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        const EMImpl* em;
+        bool scatter;
+        double minPosWeight;
+        std::vector<Mat>* sums;
+    };
+
+    // sums the M-step statistics over the samples, the partial sums are reduced in the fixed order
+    void accumulateMStep(bool scatter, double minPosWeight, Mat& total)
+    {
+        int nsamples = trainSamples.rows, dim = trainSamples.cols;
+        int rows = scatter && covMatType == COV_MAT_GENERIC ? nclusters*dim : nclusters;
+        int cols = scatter ? dim : dim + 1;
+        int nparts = std::min((nsamples + EM_BLOCK - 1)/EM_BLOCK, (int)EM_MAX_PARTS);
+        nparts = std::max(std::min(nparts, (int)(EM_MAX_PARTIAL_SIZE/((int64)rows*cols))), 1);
+
+        std::vector<Mat> sums(nparts);
+        for( int part = 0; part < nparts; part++ )
+            sums[part].create(rows, cols, CV_64FC1);
+        parallel_for_(Range(0, nparts), MStepBody(this, scatter, minPosWeight, sums));
+
+        total = sums[0];
+        for( int part = 1; part < nparts; part++ )
+            total += sums[part];
+    }
+
     void eStep()
     {
         // Compute probs_ik from means_k, covs_k and weights_k.
@@ -637,13 +841,22 @@ public:
         CV_DbgAssert(trainSamples.type() == CV_64FC1);
         CV_DbgAssert(means.type() == CV_64FC1);
 
-        for(int sampleIndex = 0; sampleIndex < trainSamples.rows; sampleIndex++)
+        // the inverse eigenvalues of the diagonal and spherical covariances, one per dimension
+        Mat invCovsDiag;
+        if(covMatType != COV_MAT_GENERIC)
         {
-            Mat sampleProbs = trainProbs.row(sampleIndex);
-            Vec2d res = computeProbabilities(trainSamples.row(sampleIndex), &sampleProbs, CV_64F);
-            trainLogLikelihoods.at<double>(sampleIndex) = res[0];
-            trainLabels.at<int>(sampleIndex) = static_cast<int>(res[1]);
+            int dim = trainSamples.cols;
+            invCovsDiag.create(nclusters, dim, CV_64FC1);
+            for(int clusterIndex = 0; clusterIndex < nclusters; clusterIndex++)
+            {
+                if(covMatType == COV_MAT_SPHERICAL)
+                    invCovsDiag.row(clusterIndex) = Scalar(invCovsEigenValues[clusterIndex].at<double>(0));
+                else
+                    invCovsEigenValues[clusterIndex].reshape(1, 1).copyTo(invCovsDiag.row(clusterIndex));
+            }
         }
+
+        parallel_for_(Range(0, (trainSamples.rows + EM_BLOCK - 1)/EM_BLOCK), EStepBody(this, invCovsDiag, trainProbs, trainLogLikelihoods, trainLabels));
     }
 
     void mStep()
@@ -651,15 +864,16 @@ public:
         // Update means_k, covs_k and weights_k from probs_ik
         int dim = trainSamples.cols;
 
-        // Update weights
-        // not normalized first
-        reduce(trainProbs, weights, 0, CV_REDUCE_SUM);
+        // Update weights and means
+        // the weights are not normalized first
+        const double minPosWeight = trainSamples.rows * DBL_EPSILON;
+        Mat sums;
+        accumulateMStep(false, minPosWeight, sums);
+        transpose(sums.col(dim), weights);
 
-        // Update means
         means.create(nclusters, dim, CV_64FC1);
         means = Scalar(0);
 
-        const double minPosWeight = trainSamples.rows * DBL_EPSILON;
         double minWeight = DBL_MAX;
         int minWeightClusterIndex = -1;
         for(int clusterIndex = 0; clusterIndex < nclusters; clusterIndex++)
@@ -674,12 +888,12 @@ public:
             }
 
             Mat clusterMean = means.row(clusterIndex);
-            for(int sampleIndex = 0; sampleIndex < trainSamples.rows; sampleIndex++)
-                clusterMean += trainProbs.at<double>(sampleIndex, clusterIndex) * trainSamples.row(sampleIndex);
+            sums.row(clusterIndex).colRange(0, dim).copyTo(clusterMean);
             clusterMean /= weights.at<double>(clusterIndex);
         }
 
         // Update covsEigenValues and invCovsEigenValues
+        accumulateMStep(true, minPosWeight, sums);
         covs.resize(nclusters);
         covsEigenValues.resize(nclusters);
         if(covMatType == COV_MAT_GENERIC)
@@ -690,39 +904,16 @@ public:
             if(weights.at<double>(clusterIndex) <= minPosWeight)
                 continue;
 
-            if(covMatType != COV_MAT_SPHERICAL)
-                covsEigenValues[clusterIndex].create(1, dim, CV_64FC1);
-            else
-                covsEigenValues[clusterIndex].create(1, 1, CV_64FC1);
-
+            Mat clusterCov;
             if(covMatType == COV_MAT_GENERIC)
-                covs[clusterIndex].create(dim, dim, CV_64FC1);
-
-            Mat clusterCov = covMatType != COV_MAT_GENERIC ?
-                covsEigenValues[clusterIndex] : covs[clusterIndex];
-
-            clusterCov = Scalar(0);
-
-            Mat centeredSample;
-            for(int sampleIndex = 0; sampleIndex < trainSamples.rows; sampleIndex++)
             {
-                centeredSample = trainSamples.row(sampleIndex) - means.row(clusterIndex);
-
-                if(covMatType == COV_MAT_GENERIC)
-                    clusterCov += trainProbs.at<double>(sampleIndex, clusterIndex) * centeredSample.t() * centeredSample;
-                else
-                {
-                    double p = trainProbs.at<double>(sampleIndex, clusterIndex);
-                    for(int di = 0; di < dim; di++ )
-                    {
-                        double val = centeredSample.at<double>(di);
-                        clusterCov.at<double>(covMatType != COV_MAT_SPHERICAL ? di : 0) += p*val*val;
-                    }
-                }
+                clusterCov = covs[clusterIndex] = sums.rowRange(clusterIndex*dim, (clusterIndex + 1)*dim).clone();
+                completeSymm(clusterCov);
             }
-
-            if(covMatType == COV_MAT_SPHERICAL)
-                clusterCov /= dim;
+            else if(covMatType == COV_MAT_DIAGONAL)
+                clusterCov = covsEigenValues[clusterIndex] = sums.row(clusterIndex).clone();
+            else
+                clusterCov = covsEigenValues[clusterIndex] = Mat(1, 1, CV_64FC1, Scalar(sum(sums.row(clusterIndex))[0]/dim));
 
             clusterCov /= weights.at<double>(clusterIndex);
 
@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <stdarg.h>
 #include <ctype.h>
@@ -115,6 +116,7 @@ struct SvmParams
     double      p;
     Mat         classWeights;
     TermCriteria termCrit;
+    bool        shrinking;
 
     SvmParams()
     {
@@ -127,6 +129,7 @@ struct SvmParams
         nu = 0;
         p = 0;
         termCrit = TermCriteria( CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, FLT_EPSILON );
+        shrinking = false;
     }
 
     SvmParams( int _svmType, int _kernelType,
@@ -144,6 +147,7 @@ struct SvmParams
         p = _p;
         classWeights = _classWeights;
         termCrit = _termCrit;
+        shrinking = false;
     }
 
 };
@@ -166,8 +170,41 @@ public:
                             const float* another, Qfloat* results,
                             double alpha, double beta )
     {
-        int j, k;
-        for( j = 0; j < vcount; j++ )
+        int j = 0, k;
+#if CV_SIMD128_64F
+        // 4 samples at once, one per lane; the float and the double operations
+        // are the same as in the scalar loop below, and so are the results
+        for( ; j <= vcount - 4; j += 4 )
+        {
+            const float* s0 = &vecs[j*var_count];
+            const float* s1 = s0 + var_count;
+            const float* s2 = s1 + var_count;
+            const float* s3 = s2 + var_count;
+            v_float64x2 v_s0 = v_setzero_f64(), v_s1 = v_setzero_f64();
+            for( k = 0; k <= var_count - 4; k += 4 )
+            {
+                v_float32x4 c0, c1, c2, c3;
+                v_transpose4x4(v_load(s0 + k), v_load(s1 + k), v_load(s2 + k), v_load(s3 + k), c0, c1, c2, c3);
+                v_float32x4 t = c0*v_setall_f32(another[k]) + c1*v_setall_f32(another[k+1]) +
+                    c2*v_setall_f32(another[k+2]) + c3*v_setall_f32(another[k+3]);
+                v_s0 += v_cvt_f64(t);
+                v_s1 += v_cvt_f64_high(t);
+            }
+            for( ; k < var_count; k++ )
+            {
+                v_float32x4 t = v_float32x4(s0[k], s1[k], s2[k], s3[k])*v_setall_f32(another[k]);
+                v_s0 += v_cvt_f64(t);
+                v_s1 += v_cvt_f64_high(t);
+            }
+            double s[4];
+            v_float64x2 v_alpha = v_setall_f64(alpha), v_beta = v_setall_f64(beta);
+            v_store(s, v_s0*v_alpha + v_beta);
+            v_store(s + 2, v_s1*v_alpha + v_beta);
+            for( k = 0; k < 4; k++ )
+                results[j + k] = (Qfloat)s[k];
+        }
+#endif
+        for( ; j < vcount; j++ )
         {
             const float* sample = &vecs[j*var_count];
             double s = 0;
@@ -218,9 +255,51 @@ public:
                    const float* another, Qfloat* results )
     {
         double gamma = -params.gamma;
-        int j, k;
+        int j = 0, k;
 
-        for( j = 0; j < vcount; j++ )
+#if CV_SIMD128_64F
+        for( ; j <= vcount - 4; j += 4 )
+        {
+            const float* s0 = &vecs[j*var_count];
+            const float* s1 = s0 + var_count;
+            const float* s2 = s1 + var_count;
+            const float* s3 = s2 + var_count;
+            v_float64x2 v_s0 = v_setzero_f64(), v_s1 = v_setzero_f64();
+            for( k = 0; k <= var_count - 4; k += 4 )
+            {
+                v_float32x4 c0, c1, c2, c3;
+                v_transpose4x4(v_load(s0 + k), v_load(s1 + k), v_load(s2 + k), v_load(s3 + k), c0, c1, c2, c3);
+                c0 -= v_setall_f32(another[k]);
+                c1 -= v_setall_f32(another[k+1]);
+                c2 -= v_setall_f32(another[k+2]);
+                c3 -= v_setall_f32(another[k+3]);
+
+                v_float64x2 t0 = v_cvt_f64(c0), t1 = v_cvt_f64(c1);
+                v_s0 += t0*t0 + t1*t1;
+                t0 = v_cvt_f64_high(c0); t1 = v_cvt_f64_high(c1);
+                v_s1 += t0*t0 + t1*t1;
+
+                t0 = v_cvt_f64(c2); t1 = v_cvt_f64(c3);
+                v_s0 += t0*t0 + t1*t1;
+                t0 = v_cvt_f64_high(c2); t1 = v_cvt_f64_high(c3);
+                v_s1 += t0*t0 + t1*t1;
+            }
+            for( ; k < var_count; k++ )
+            {
+                v_float32x4 c = v_float32x4(s0[k], s1[k], s2[k], s3[k]) - v_setall_f32(another[k]);
+                v_float64x2 t0 = v_cvt_f64(c), t1 = v_cvt_f64_high(c);
+                v_s0 += t0*t0;
+                v_s1 += t1*t1;
+            }
+            double s[4];
+            v_float64x2 v_gamma = v_setall_f64(gamma);
+            v_store(s, v_s0*v_gamma);
+            v_store(s + 2, v_s1*v_gamma);
+            for( k = 0; k < 4; k++ )
+                results[j + k] = (Qfloat)s[k];
+        }
+#endif
+        for( ; j < vcount; j++ )
         {
             const float* sample = &vecs[j*var_count];
             double s = 0;
@@ -448,6 +527,13 @@ public:
     public:
         enum { MIN_CACHE_SIZE = (40 << 20) /* 40Mb */, MAX_CACHE_SIZE = (500 << 20) /* 500Mb */ };
 
+        // the kernel rows are computed by fixed blocks of samples; the block size is a multiple of
+        // the vector width of cv::exp and cv::pow, so the values do not depend on the partitioning
+        enum { KERNEL_ROW_BLOCK = 1024 };
+
+        // the number of iterations between the shrinking steps
+        enum { SHRINKING_PERIOD = 1000 };
+
         typedef bool (Solver::*SelectWorkingSet)( int& i, int& j );
         typedef Qfloat* (Solver::*GetRow)( int i, Qfloat* row, Qfloat* dst, bool existed );
         typedef void (Solver::*CalcRho)( double& rho, double& r );
@@ -471,6 +557,27 @@ public:
             double r;   // for Solver_NU
         };
 
+        class KernelRowBody : public ParallelLoopBody
+        {
+        public:
+            KernelRowBody( SVM::Kernel* _kernel, const Mat& _samples, int _i, Qfloat* _dst ) :
+                kernel(_kernel), samples(&_samples), i(_i), dst(_dst) {}
+
+            void operator()( const Range& range ) const
+            {
+                int j0 = range.start*KERNEL_ROW_BLOCK;
+                int j1 = std::min(range.end*KERNEL_ROW_BLOCK, samples->rows);
+                kernel->calc( j1 - j0, samples->cols, samples->ptr<float>(j0),
+                              samples->ptr<float>(i), dst + j0 );
+            }
+
+        private:
+            SVM::Kernel* kernel;
+            const Mat* samples;
+            int i;
+            Qfloat* dst;
+        };
+
         void clear()
         {
             alpha_vec = 0;
@@ -485,7 +592,7 @@ public:
                 double _Cp, double _Cn,
                 const Ptr<SVM::Kernel>& _kernel, GetRow _get_row,
                 SelectWorkingSet _select_working_set, CalcRho _calc_rho,
-                TermCriteria _termCrit )
+                TermCriteria _termCrit, bool _shrinking, size_t _cache_budget )
         {
             clear();
 
@@ -503,9 +610,14 @@ public:
             C[1] = _Cp;
             eps = _termCrit.epsilon;
             max_iter = _termCrit.maxCount;
+            shrinking = _shrinking;
 
             G_vec.resize(alpha_count);
+            G_bar_vec.resize(alpha_count);
             alpha_status_vec.resize(alpha_count);
+            setRangeVector(active_vec, alpha_count);
+            active_size = alpha_count;
+            unshrink = false;
             buf[0].resize(sample_count*2);
             buf[1].resize(sample_count*2);
 
@@ -522,8 +634,11 @@ public:
             int64 csize = (int64)sample_count*sample_count/4;
             csize = std::max(csize, (int64)(MIN_CACHE_SIZE/sizeof(Qfloat)) );
             csize = std::min(csize, (int64)(MAX_CACHE_SIZE/sizeof(Qfloat)) );
+            // the concurrent solvers of trainAuto share the budget
+            csize = std::min(csize, (int64)(_cache_budget/sizeof(Qfloat)) );
             max_cache_size = (int)((csize + sample_count-1)/sample_count);
-            max_cache_size = std::min(std::max(max_cache_size, 1), sample_count);
+            // the rows i and j of the working set must be in the cache at the same time
+            max_cache_size = std::min(std::max(max_cache_size, 2), sample_count);
             cache_size = 0;
 
             lru_cache.clear();
@@ -532,6 +647,17 @@ public:
             lru_cache_data.create(max_cache_size, sample_count, QFLOAT_TYPE);
         }
 
+        void calc_kernel_row( int i, Qfloat* dst )
+        {
+            // the custom kernels are not required to be thread-safe
+            if( sample_count > KERNEL_ROW_BLOCK && kernel->getType() != SVM::CUSTOM )
+                parallel_for_(Range(0, (sample_count + KERNEL_ROW_BLOCK - 1)/KERNEL_ROW_BLOCK),
+                              KernelRowBody(kernel, samples, i, dst));
+            else
+                kernel->calc( sample_count, var_count, samples.ptr<float>(),
+                              samples.ptr<float>(i), dst );
+        }
+
         Qfloat* get_row_base( int i, bool* _existed )
         {
             int i1 = i < sample_count ? i : i - sample_count;
@@ -557,8 +683,7 @@ public:
                     last.prev = 0;
                     last.next = 0;
                 }
-                kernel->calc( sample_count, var_count, samples.ptr<float>(),
-                              samples.ptr<float>(i1), lru_cache_data.ptr<Qfloat>(kr.idx) );
+                calc_kernel_row( i1, lru_cache_data.ptr<Qfloat>(kr.idx) );
             }
             else
             {
@@ -647,7 +772,131 @@ public:
             alpha_status[i] = (schar)(alpha[i] >= get_C(i) ? 1 : alpha[i] <= 0 ? -1 : 0)
 
         #undef reconstruct_gradient
-        #define reconstruct_gradient() /* empty for now */
+
+        // restores G of the shrunk variables
+        void reconstruct_gradient()
+        {
+            if( active_size == alpha_count )
+                return;
+
+            const double* alpha = &alpha_vec->at(0);
+            const schar* alpha_status = &alpha_status_vec[0];
+            const int* active = &active_vec[0];
+            const double* G_bar = &G_bar_vec[0];
+            const double* b = &b_vec[0];
+            double* G = &G_vec[0];
+            int a, a1;
+
+            for( a = active_size; a < alpha_count; a++ )
+            {
+                int j = active[a];
+                G[j] = G_bar[j] + b[j];
+            }
+
+            // the free variables are never shrunk
+            for( a = 0; a < active_size; a++ )
+            {
+                int i = active[a];
+                if( is_free(i) )
+                {
+                    const Qfloat* Q_i = get_row( i, &buf[0][0] );
+                    double alpha_i = alpha[i];
+                    for( a1 = active_size; a1 < alpha_count; a1++ )
+                    {
+                        int j = active[a1];
+                        G[j] += alpha_i*Q_i[j];
+                    }
+                }
+            }
+        }
+
+        void unshrink_all()
+        {
+            reconstruct_gradient();
+            setRangeVector(active_vec, alpha_count);
+            active_size = alpha_count;
+        }
+
+        bool be_shrunk( int i, double Gmax1, double Gmax2 ) const
+        {
+            const schar* y = &y_vec[0];
+            const schar* alpha_status = &alpha_status_vec[0];
+            const double* G = &G_vec[0];
+
+            if( is_upper_bound(i) )
+                return y[i] > 0 ? -G[i] > Gmax1 : -G[i] > Gmax2;
+            if( is_lower_bound(i) )
+                return y[i] > 0 ? G[i] > Gmax2 : G[i] > Gmax1;
+            return false;
+        }
+
+        bool be_shrunk_nu_svm( int i, double Gmax1, double Gmax2, double Gmax3, double Gmax4 ) const
+        {
+            const schar* y = &y_vec[0];
+            const schar* alpha_status = &alpha_status_vec[0];
+            const double* G = &G_vec[0];
+
+            if( is_upper_bound(i) )
+                return y[i] > 0 ? -G[i] > Gmax1 : -G[i] > Gmax4;
+            if( is_lower_bound(i) )
+                return y[i] > 0 ? G[i] > Gmax2 : G[i] > Gmax3;
+            return false;
+        }
+
+        // removes the bounded variables that are not likely to move from the active set;
+        // the order of the active variables is kept, so the working set selection is not affected
+        void do_shrinking()
+        {
+            const schar* y = &y_vec[0];
+            const schar* alpha_status = &alpha_status_vec[0];
+            const double* G = &G_vec[0];
+            bool nu_svm = select_working_set_func == &Solver::select_working_set_nu_svm;
+            double Gmax1 = -DBL_MAX, Gmax2 = -DBL_MAX, Gmax3 = -DBL_MAX, Gmax4 = -DBL_MAX;
+            int a, n;
+
+            for( a = 0; a < active_size; a++ )
+            {
+                int i = active_vec[a];
+                if( !is_upper_bound(i) )
+                {
+                    if( y[i] > 0 )
+                        Gmax1 = std::max(Gmax1, -G[i]);
+                    else if( nu_svm )
+                        Gmax4 = std::max(Gmax4, -G[i]);
+                    else
+                        Gmax2 = std::max(Gmax2, -G[i]);
+                }
+                if( !is_lower_bound(i) )
+                {
+                    if( y[i] > 0 )
+                        Gmax2 = std::max(Gmax2, G[i]);
+                    else if( nu_svm )
+                        Gmax3 = std::max(Gmax3, G[i]);
+                    else
+                        Gmax1 = std::max(Gmax1, G[i]);
+                }
+            }
+
+            // close to the solution all the variables are checked once more
+            double gap = nu_svm ? std::max(Gmax1 + Gmax2, Gmax3 + Gmax4) : Gmax1 + Gmax2;
+            if( !unshrink && gap <= eps*10 )
+            {
+                unshrink = true;
+                unshrink_all();
+            }
+
+            vector<int> shrunk;
+            for( a = n = 0; a < active_size; a++ )
+            {
+                int i = active_vec[a];
+                if( nu_svm ? be_shrunk_nu_svm(i, Gmax1, Gmax2, Gmax3, Gmax4) : be_shrunk(i, Gmax1, Gmax2) )
+                    shrunk.push_back(i);
+                else
+                    active_vec[n++] = i;
+            }
+            std::copy(shrunk.begin(), shrunk.end(), active_vec.begin() + n);
+            active_size = n;
+        }
 
         bool solve_generic( SolutionInfo& si )
         {
@@ -655,16 +904,19 @@ public:
             double* alpha = &alpha_vec->at(0);
             schar* alpha_status = &alpha_status_vec[0];
             double* G = &G_vec[0];
+            double* G_bar = &G_bar_vec[0];
             double* b = &b_vec[0];
+            const int* active = &active_vec[0];
 
-            int iter = 0;
-            int i, j, k;
+            int iter = 0, counter = std::min(alpha_count, (int)SHRINKING_PERIOD) + 1;
+            int i, j, k, a;
 
             // 1. initialize gradient and alpha status
             for( i = 0; i < alpha_count; i++ )
             {
                 update_alpha_status(i);
                 G[i] = b[i];
+                G_bar[i] = 0;
                 if( fabs(G[i]) > 1e200 )
                     return false;
             }
@@ -678,6 +930,13 @@ public:
 
                     for( j = 0; j < alpha_count; j++ )
                         G[j] += alpha_i*Q_i[j];
+
+                    if( shrinking && is_upper_bound(i) )
+                    {
+                        double C_i = get_C(i);
+                        for( j = 0; j < alpha_count; j++ )
+                            G_bar[j] += C_i*Q_i[j];
+                    }
                 }
             }
 
@@ -700,7 +959,25 @@ public:
                 }
         #endif
 
-                if( (this->*select_working_set_func)( i, j ) != 0 || iter++ >= max_iter )
+                // without shrinking all the variables stay active, as in the plain SMO
+                if( shrinking && --counter == 0 )
+                {
+                    counter = std::min(alpha_count, (int)SHRINKING_PERIOD);
+                    do_shrinking();
+                }
+
+                if( (this->*select_working_set_func)( i, j ) != 0 )
+                {
+                    // the solution is optimal on the active set, check it on all the variables
+                    if( active_size == alpha_count )
+                        break;
+                    unshrink_all();
+                    counter = 1;
+                    if( (this->*select_working_set_func)( i, j ) != 0 )
+                        break;
+                }
+
+                if( iter++ >= max_iter )
                     break;
 
                 Q_i = get_row( i, &buf[0][0] );
@@ -774,6 +1051,7 @@ public:
                 }
 
                 // update alpha
+                bool upper_i = is_upper_bound(i), upper_j = is_upper_bound(j);
                 alpha[i] = alpha_i;
                 alpha[j] = alpha_j;
                 update_alpha_status(i);
@@ -783,10 +1061,38 @@ public:
                 delta_alpha_i = alpha_i - old_alpha_i;
                 delta_alpha_j = alpha_j - old_alpha_j;
 
-                for( k = 0; k < alpha_count; k++ )
-                    G[k] += Q_i[k]*delta_alpha_i + Q_j[k]*delta_alpha_j;
+                if( active_size == alpha_count )
+                {
+                    for( k = 0; k < alpha_count; k++ )
+                        G[k] += Q_i[k]*delta_alpha_i + Q_j[k]*delta_alpha_j;
+                }
+                else
+                {
+                    for( a = 0; a < active_size; a++ )
+                    {
+                        k = active[a];
+                        G[k] += Q_i[k]*delta_alpha_i + Q_j[k]*delta_alpha_j;
+                    }
+                }
+
+                // update G_bar
+                if( shrinking && upper_i != is_upper_bound(i) )
+                {
+                    double c = upper_i ? -C_i : C_i;
+                    for( k = 0; k < alpha_count; k++ )
+                        G_bar[k] += c*Q_i[k];
+                }
+                if( shrinking && upper_j != is_upper_bound(j) )
+                {
+                    double c = upper_j ? -C_j : C_j;
+                    for( k = 0; k < alpha_count; k++ )
+                        G_bar[k] += c*Q_j[k];
+                }
             }
 
+            // the iterations limit might be reached with some variables shrunk
+            unshrink_all();
+
             // calculate rho
             (this->*calc_rho_func)( si.rho, si.r );
 
@@ -817,9 +1123,11 @@ public:
             const schar* y = &y_vec[0];
             const schar* alpha_status = &alpha_status_vec[0];
             const double* G = &G_vec[0];
+            const int* active = &active_vec[0];
 
-            for( int i = 0; i < alpha_count; i++ )
+            for( int a = 0; a < active_size; a++ )
             {
+                int i = active[a];
                 double t;
 
                 if( y[i] > 0 )    // y = +1
@@ -913,9 +1221,11 @@ public:
             const schar* y = &y_vec[0];
             const schar* alpha_status = &alpha_status_vec[0];
             const double* G = &G_vec[0];
+            const int* active = &active_vec[0];
 
-            for( int i = 0; i < alpha_count; i++ )
+            for( int a = 0; a < active_size; a++ )
             {
+                int i = active[a];
                 double t;
 
                 if( y[i] > 0 )    // y == +1
@@ -1014,7 +1324,8 @@ public:
         */
         static bool solve_c_svc( const Mat& _samples, const vector<schar>& _y,
                                  double _Cp, double _Cn, const Ptr<SVM::Kernel>& _kernel,
-                                 vector<double>& _alpha, SolutionInfo& _si, TermCriteria termCrit )
+                                 vector<double>& _alpha, SolutionInfo& _si, TermCriteria termCrit,
+                                 bool shrinking, size_t cache_budget )
         {
             int sample_count = _samples.rows;
 
@@ -1025,7 +1336,7 @@ public:
                            &Solver::get_row_svc,
                            &Solver::select_working_set,
                            &Solver::calc_rho,
-                           termCrit );
+                           termCrit, shrinking, cache_budget );
 
             if( !solver.solve_generic( _si ))
                 return false;
@@ -1040,7 +1351,8 @@ public:
         static bool solve_nu_svc( const Mat& _samples, const vector<schar>& _y,
                                   double nu, const Ptr<SVM::Kernel>& _kernel,
                                   vector<double>& _alpha, SolutionInfo& _si,
-                                  TermCriteria termCrit )
+                                  TermCriteria termCrit, bool shrinking,
+                                  size_t cache_budget )
         {
             int sample_count = _samples.rows;
 
@@ -1070,7 +1382,7 @@ public:
                            &Solver::get_row_svc,
                            &Solver::select_working_set_nu_svm,
                            &Solver::calc_rho_nu_svm,
-                           termCrit );
+                           termCrit, shrinking, cache_budget );
 
             if( !solver.solve_generic( _si ))
                 return false;
@@ -1091,7 +1403,8 @@ public:
         static bool solve_one_class( const Mat& _samples, double nu,
                                      const Ptr<SVM::Kernel>& _kernel,
                                      vector<double>& _alpha, SolutionInfo& _si,
-                                     TermCriteria termCrit )
+                                     TermCriteria termCrit, bool shrinking,
+                                     size_t cache_budget )
         {
             int sample_count = _samples.rows;
             vector<schar> _y(sample_count, 1);
@@ -1112,7 +1425,7 @@ public:
                            &Solver::get_row_one_class,
                            &Solver::select_working_set,
                            &Solver::calc_rho,
-                           termCrit );
+                           termCrit, shrinking, cache_budget );
 
             return solver.solve_generic(_si);
         }
@@ -1120,7 +1433,8 @@ public:
         static bool solve_eps_svr( const Mat& _samples, const vector<float>& _yf,
                                    double p, double C, const Ptr<SVM::Kernel>& _kernel,
                                    vector<double>& _alpha, SolutionInfo& _si,
-                                   TermCriteria termCrit )
+                                   TermCriteria termCrit, bool shrinking,
+                                   size_t cache_budget )
         {
             int sample_count = _samples.rows;
             int alpha_count = sample_count*2;
@@ -1144,7 +1458,7 @@ public:
                            &Solver::get_row_svr,
                            &Solver::select_working_set,
                            &Solver::calc_rho,
-                           termCrit );
+                           termCrit, shrinking, cache_budget );
 
             if( !solver.solve_generic( _si ))
                 return false;
@@ -1159,7 +1473,8 @@ public:
         static bool solve_nu_svr( const Mat& _samples, const vector<float>& _yf,
                                   double nu, double C, const Ptr<SVM::Kernel>& _kernel,
                                   vector<double>& _alpha, SolutionInfo& _si,
-                                  TermCriteria termCrit )
+                                  TermCriteria termCrit, bool shrinking,
+                                  size_t cache_budget )
         {
             int sample_count = _samples.rows;
             int alpha_count = sample_count*2;
@@ -1187,7 +1502,7 @@ public:
                            &Solver::get_row_svr,
                            &Solver::select_working_set_nu_svm,
                            &Solver::calc_rho_nu_svm,
-                           termCrit );
+                           termCrit, shrinking, cache_budget );
 
             if( !solver.solve_generic( _si ))
                 return false;
@@ -1212,6 +1527,12 @@ public:
         int alpha_count;
 
         vector<double> G_vec;
+        // the gradient part from the variables at the upper bound, to reconstruct G after shrinking
+        vector<double> G_bar_vec;
+        // the variables [0, active_size) are optimized, the rest are shrunk
+        vector<int> active_vec;
+        int active_size;
+        bool shrinking, unshrink;
         vector<double>* alpha_vec;
         vector<schar> y_vec;
         // -1 - lower bound, 0 - free, 1 - upper bound
@@ -1232,6 +1553,8 @@ public:
     //////////////////////////////////////////////////////////////////////////////////////////
     SVMImpl()
     {
+        trainAutoHalvingFactor = 0;
+        cache_budget = Solver::MAX_CACHE_SIZE;
         clear();
         checkParams();
     }
@@ -1260,6 +1583,26 @@ public:
         return sv;
     }
 
+    bool getShrinking_() const
+    {
+        return params.shrinking;
+    }
+
+    void setShrinking_( bool val )
+    {
+        params.shrinking = val;
+    }
+
+    int getTrainAutoHalvingFactor_() const
+    {
+        return trainAutoHalvingFactor;
+    }
+
+    void setTrainAutoHalvingFactor_( int val )
+    {
+        trainAutoHalvingFactor = val;
+    }
+
     CV_IMPL_PROPERTY(int, Type, params.svmType)
     CV_IMPL_PROPERTY(double, Gamma, params.gamma)
     CV_IMPL_PROPERTY(double, Coef0, params.coef0)
@@ -1386,9 +1729,9 @@ public:
                 _responses.convertTo(_yf, CV_32F);
 
             bool ok =
-            svmType == ONE_CLASS ? Solver::solve_one_class( _samples, params.nu, kernel, _alpha, sinfo, params.termCrit ) :
-            svmType == EPS_SVR ? Solver::solve_eps_svr( _samples, _yf, params.p, params.C, kernel, _alpha, sinfo, params.termCrit ) :
-            svmType == NU_SVR ? Solver::solve_nu_svr( _samples, _yf, params.nu, params.C, kernel, _alpha, sinfo, params.termCrit ) : false;
+            svmType == ONE_CLASS ? Solver::solve_one_class( _samples, params.nu, kernel, _alpha, sinfo, params.termCrit, params.shrinking, cache_budget ) :
+            svmType == EPS_SVR ? Solver::solve_eps_svr( _samples, _yf, params.p, params.C, kernel, _alpha, sinfo, params.termCrit, params.shrinking, cache_budget ) :
+            svmType == NU_SVR ? Solver::solve_nu_svr( _samples, _yf, params.nu, params.C, kernel, _alpha, sinfo, params.termCrit, params.shrinking, cache_budget ) : false;
 
             if( !ok )
                 return false;
@@ -1499,10 +1842,12 @@ public:
                     DecisionFunc df;
                     bool ok = params.svmType == C_SVC ?
                                 Solver::solve_c_svc( temp_samples, temp_y, Cp, Cn,
-                                                     kernel, _alpha, sinfo, params.termCrit ) :
+                                                     kernel, _alpha, sinfo, params.termCrit,
+                                                     params.shrinking, cache_budget ) :
                               params.svmType == NU_SVC ?
                                 Solver::solve_nu_svc( temp_samples, temp_y, params.nu,
-                                                      kernel, _alpha, sinfo, params.termCrit ) :
+                                                      kernel, _alpha, sinfo, params.termCrit,
+                                                      params.shrinking, cache_budget ) :
                               false;
                     if( !ok )
                         return false;
@@ -1713,12 +2058,11 @@ public:
 
         int sample_count = samples.rows;
         var_count = samples.cols;
-        size_t sample_size = var_count*samples.elemSize();
 
         vector<int> sidx;
         setRangeVector(sidx, sample_count);
 
-        int i, j, k;
+        int i, k;
 
         // randomly permute training samples
         for( i = 0; i < sample_count; i++ )
@@ -1764,23 +2108,13 @@ public:
             }
         }
 
-        int test_sample_count = (sample_count + k_fold/2)/k_fold;
-        int train_sample_count = sample_count - test_sample_count;
-
-        SvmParams best_params = params;
-        double min_error = FLT_MAX;
-
-        int rtype = responses.type();
-
-        Mat temp_train_samples(train_sample_count, var_count, CV_32F);
-        Mat temp_test_samples(test_sample_count, var_count, CV_32F);
-        Mat temp_train_responses(train_sample_count, 1, rtype);
-        Mat temp_test_responses;
-
         // If grid.minVal == grid.maxVal, this will allow one and only one pass through the loop with params.var = grid.minVal.
         #define FOR_IN_GRID(var, grid) \
             for( params.var = grid.minVal; params.var == grid.minVal || params.var < grid.maxVal; params.var = (grid.minVal == grid.maxVal) ? grid.maxVal + 1 : params.var * grid.logStep )
 
+        // the parameters are checked and adjusted in the loop, so the sequence of the grid cells
+        // is collected the same way as it is enumerated
+        vector<SvmParams> cells;
         FOR_IN_GRID(C, C_grid)
         FOR_IN_GRID(gamma, gamma_grid)
         FOR_IN_GRID(p, p_grid)
@@ -1790,56 +2124,175 @@ public:
         {
             // make sure we updated the kernel and other parameters
             setParams(params);
+            cells.push_back(params);
+        }
+
+        int ncells = (int)cells.size();
+        vector<double> errors(ncells*k_fold, 0.);
+        vector<int> alive;
+        setRangeVector(alive, ncells);
+
+        // successive halving: the cells are evaluated on the growing number of folds,
+        // only the best 1/factor of the cells go to the next rung
+        int factor = trainAutoHalvingFactor, nrungs = 1;
+        if( factor > 1 )
+            for( int n = ncells; n > 1; n = (n + factor - 1)/factor )
+                nrungs++;
+
+        int nfolds = 0;
+        vector<std::pair<double, int> > ranks;
+        for( int rung = 0; rung < nrungs; rung++ )
+        {
+            int nfolds1 = rung == nrungs - 1 ? k_fold :
+                std::min(std::max(cvRound(k_fold*std::pow((double)factor, rung - nrungs + 1)), nfolds + 1), k_fold);
+
+            vector<Vec2i> tasks;
+            for( i = 0; i < (int)alive.size(); i++ )
+                for( k = nfolds; k < nfolds1; k++ )
+                    tasks.push_back(Vec2i(alive[i], k));
+
+            // the custom kernels are not required to be thread-safe; otherwise the tasks run
+            // concurrently and share the kernel cache budget of a single solver
+            bool serial = params.kernelType == CUSTOM;
+            size_t budget = serial ? cache_budget : cache_budget/std::max(getNumThreads(), 1);
+            TrainAutoBody body( this, cells, tasks, samples, responses, sidx, k_fold, is_classification,
+                                budget, errors );
+            if( serial )
+                body(Range(0, (int)tasks.size()));
+            else
+                parallel_for_(Range(0, (int)tasks.size()), body);
+            nfolds = nfolds1;
 
+            if( rung == nrungs - 1 || nfolds == k_fold )
+                break;
+
+            ranks.clear();
+            for( i = 0; i < (int)alive.size(); i++ )
+            {
+                double error = 0;
+                for( k = 0; k < nfolds; k++ )
+                    error += errors[alive[i]*k_fold + k];
+                ranks.push_back(std::make_pair(error, alive[i]));
+            }
+            std::sort(ranks.begin(), ranks.end());
+            alive.resize((alive.size() + factor - 1)/factor);
+            for( i = 0; i < (int)alive.size(); i++ )
+                alive[i] = ranks[i].second;
+            std::sort(alive.begin(), alive.end());
+        }
+
+        SvmParams best_params = params;
+        double min_error = FLT_MAX;
+        for( i = 0; i < (int)alive.size(); i++ )
+        {
             double error = 0;
             for( k = 0; k < k_fold; k++ )
+                error += errors[alive[i]*k_fold + k];
+            if( min_error > error )
+            {
+                min_error   = error;
+                best_params = cells[alive[i]];
+            }
+        }
+
+        class_labels = class_labels0;
+        setParams(best_params);
+        return do_train( samples, responses );
+    }
+
+    // trains and tests the independent models on the (grid cell, fold) pairs of SVMImpl::trainAuto
+    struct TrainAutoBody : ParallelLoopBody
+    {
+        TrainAutoBody( const SVMImpl* _svm, const vector<SvmParams>& _cells, const vector<Vec2i>& _tasks,
+                       const Mat& _samples, const Mat& _responses, const vector<int>& _sidx,
+                       int _k_fold, bool _is_classification, size_t _cache_budget,
+                       vector<double>& _errors )
+        {
+            svm = _svm;
+            cells = &_cells;
+            tasks = &_tasks;
+            samples = &_samples;
+            responses = &_responses;
+            sidx = &_sidx;
+            k_fold = _k_fold;
+            is_classification = _is_classification;
+            cache_budget = _cache_budget;
+            errors = &_errors;
+        }
+
+        void operator()( const Range& range ) const
+        {
+            int sample_count = samples->rows, var_count = samples->cols;
+            int test_sample_count = (sample_count + k_fold/2)/k_fold;
+            int train_sample_count = sample_count - test_sample_count;
+            size_t sample_size = var_count*samples->elemSize();
+            int rtype = responses->type();
+            const vector<int>& idx = *sidx;
+
+            Mat temp_train_samples(train_sample_count, var_count, CV_32F);
+            Mat temp_test_samples(test_sample_count, var_count, CV_32F);
+            Mat temp_train_responses(train_sample_count, 1, rtype);
+            Mat temp_test_responses;
+
+            for( int t = range.start; t < range.end; t++ )
             {
+                int c = (*tasks)[t][0], k = (*tasks)[t][1], i, j;
+                Ptr<SVMImpl> model = makePtr<SVMImpl>();
+                model->kernel = svm->kernel;
+                model->setParams((*cells)[c]);
+                model->class_labels = svm->class_labels;
+                model->cache_budget = cache_budget;
+
                 int start = (k*sample_count + k_fold/2)/k_fold;
                 for( i = 0; i < train_sample_count; i++ )
                 {
-                    j = sidx[(i+start)%sample_count];
-                    memcpy(temp_train_samples.ptr(i), samples.ptr(j), sample_size);
+                    j = idx[(i+start)%sample_count];
+                    memcpy(temp_train_samples.ptr(i), samples->ptr(j), sample_size);
                     if( is_classification )
-                        temp_train_responses.at<int>(i) = responses.at<int>(j);
-                    else if( !responses.empty() )
-                        temp_train_responses.at<float>(i) = responses.at<float>(j);
+                        temp_train_responses.at<int>(i) = responses->at<int>(j);
+                    else if( !responses->empty() )
+                        temp_train_responses.at<float>(i) = responses->at<float>(j);
                 }
 
-                // Train SVM on <train_size> samples
-                if( !do_train( temp_train_samples, temp_train_responses ))
-                    continue;
-
-                for( i = 0; i < test_sample_count; i++ )
+                // Train SVM on <train_size> samples; the failed folds do not add to the error
+                double error = 0;
+                if( model->do_train( temp_train_samples, temp_train_responses ))
                 {
-                    j = sidx[(i+start+train_sample_count) % sample_count];
-                    memcpy(temp_test_samples.ptr(i), samples.ptr(j), sample_size);
-                }
+                    for( i = 0; i < test_sample_count; i++ )
+                    {
+                        j = idx[(i+start+train_sample_count) % sample_count];
+                        memcpy(temp_test_samples.ptr(i), samples->ptr(j), sample_size);
+                    }
 
-                predict(temp_test_samples, temp_test_responses, 0);
-                for( i = 0; i < test_sample_count; i++ )
-                {
-                    float val = temp_test_responses.at<float>(i);
-                    j = sidx[(i+start+train_sample_count) % sample_count];
-                    if( is_classification )
-                        error += (float)(val != responses.at<int>(j));
-                    else
+                    model->predict(temp_test_samples, temp_test_responses, 0);
+                    for( i = 0; i < test_sample_count; i++ )
                     {
-                        val -= responses.at<float>(j);
-                        error += val*val;
+                        float val = temp_test_responses.at<float>(i);
+                        j = idx[(i+start+train_sample_count) % sample_count];
+                        if( is_classification )
+                            error += (float)(val != responses->at<int>(j));
+                        else
+                        {
+                            val -= responses->at<float>(j);
+                            error += val*val;
+                        }
                     }
                 }
-            }
-            if( min_error > error )
-            {
-                min_error   = error;
-                best_params = params;
+                (*errors)[c*k_fold + k] = error;
             }
         }
 
-        class_labels = class_labels0;
-        setParams(best_params);
-        return do_train( samples, responses );
-    }
+        const SVMImpl* svm;
+        const vector<SvmParams>* cells;
+        const vector<Vec2i>* tasks;
+        const Mat* samples;
+        const Mat* responses;
+        const vector<int>* sidx;
+        int k_fold;
+        bool is_classification;
+        size_t cache_budget;
+        vector<double>* errors;
+    };
 
     struct PredictBody : ParallelLoopBody
     {
@@ -2032,6 +2485,9 @@ public:
         if( params.termCrit.type & TermCriteria::COUNT )
             fs << "iterations" << params.termCrit.maxCount;
         fs << "}";
+
+        if( params.shrinking )
+            fs << "shrinking" << 1;
     }
 
     bool isTrained() const
@@ -2184,6 +2640,8 @@ public:
         else
             _params.termCrit = TermCriteria( TermCriteria::EPS + TermCriteria::COUNT, 1000, FLT_EPSILON );
 
+        _params.shrinking = (int)fn["shrinking"] != 0;
+
         setParams( _params );
     }
 
@@ -2278,6 +2736,9 @@ public:
     vector<int> df_index;
 
     Ptr<Kernel> kernel;
+    int trainAutoHalvingFactor;
+    // the maximum size of the kernel row cache of the solver, in bytes
+    size_t cache_budget;
 };
 
 
@@ -2305,6 +2766,38 @@ Mat SVM::getUncompressedSupportVectors() const
     return this_->getUncompressedSupportVectors_();
 }
 
+bool SVM::getShrinking() const
+{
+    const SVMImpl* this_ = dynamic_cast<const SVMImpl*>(this);
+    if(!this_)
+        CV_Error(Error::StsNotImplemented, "the class is not SVMImpl");
+    return this_->getShrinking_();
+}
+
+void SVM::setShrinking(bool val)
+{
+    SVMImpl* this_ = dynamic_cast<SVMImpl*>(this);
+    if(!this_)
+        CV_Error(Error::StsNotImplemented, "the class is not SVMImpl");
+    this_->setShrinking_(val);
+}
+
+int SVM::getTrainAutoHalvingFactor() const
+{
+    const SVMImpl* this_ = dynamic_cast<const SVMImpl*>(this);
+    if(!this_)
+        CV_Error(Error::StsNotImplemented, "the class is not SVMImpl");
+    return this_->getTrainAutoHalvingFactor_();
+}
+
+void SVM::setTrainAutoHalvingFactor(int val)
+{
+    SVMImpl* this_ = dynamic_cast<SVMImpl*>(this);
+    if(!this_)
+        CV_Error(Error::StsNotImplemented, "the class is not SVMImpl");
+    this_->setTrainAutoHalvingFactor_(val);
+}
+
 bool SVM::trainAuto(InputArray samples, int layout,
             InputArray responses, int kfold, Ptr<ParamGrid> Cgrid,
             Ptr<ParamGrid> gammaGrid, Ptr<ParamGrid> pGrid, Ptr<ParamGrid> nuGrid,
@@ -703,3 +703,44 @@ TEST(ML_KNearest, accuracy) { CV_KNearestTest test; test.safe_run(); }
 TEST(ML_EM, accuracy) { CV_EMTest test; test.safe_run(); }
 TEST(ML_EM, save_load) { CV_EMTest_SaveLoad test; test.safe_run(); }
 TEST(ML_EM, classification) { CV_EMTest_Classification test; test.safe_run(); }
+
+TEST(ML_EM, threads)
+{
+    // several sample blocks and partial sums, the model must not depend on the number of threads
+    Mat means, samples, labels;
+    vector<Mat> covs;
+    defaultDistribs( means, covs );
+    vector<int> sizes( 3, 1000 );
+    samples.create( 3000, 2, CV_32FC1 );
+    generateData( samples, labels, sizes, means, covs, CV_32FC1, CV_32SC1 );
+
+    int nthreads = getNumThreads();
+    for( int covMatType = EM::COV_MAT_SPHERICAL; covMatType <= EM::COV_MAT_GENERIC; covMatType++ )
+    {
+        Ptr<EM> em1 = EM::create(), emN = EM::create();
+        Mat logLikelihoods1, logLikelihoodsN;
+        em1->setClustersNumber( 3 );
+        emN->setClustersNumber( 3 );
+        em1->setCovarianceMatrixType( covMatType );
+        emN->setCovarianceMatrixType( covMatType );
+
+        setNumThreads(1);
+        theRNG().state = 1;
+        em1->trainEM( samples, logLikelihoods1, noArray(), noArray() );
+        setNumThreads(std::max(nthreads, 4));
+        theRNG().state = 1;
+        emN->trainEM( samples, logLikelihoodsN, noArray(), noArray() );
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(0, cvtest::norm(logLikelihoods1, logLikelihoodsN, NORM_INF)) << "covMatType=" << covMatType;
+        EXPECT_EQ(0, cvtest::norm(em1->getMeans(), emN->getMeans(), NORM_INF)) << "covMatType=" << covMatType;
+        EXPECT_EQ(0, cvtest::norm(em1->getWeights(), emN->getWeights(), NORM_INF)) << "covMatType=" << covMatType;
+
+        vector<Mat> covs1, covsN;
+        em1->getCovs( covs1 );
+        emN->getCovs( covsN );
+        ASSERT_EQ(covs1.size(), covsN.size());
+        for( size_t k = 0; k < covs1.size(); k++ )
+            EXPECT_EQ(0, cvtest::norm(covs1[k], covsN[k], NORM_INF)) << "covMatType=" << covMatType;
+    }
+}
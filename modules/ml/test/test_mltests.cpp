@@ -217,4 +217,60 @@ TEST(ML_RTrees, getVotes)
     EXPECT_EQ(result.at<float>(0, predicted_class), rt->predict(test));
 }
 
+TEST(ML_ANN, minibatch)
+{
+    // three separable blobs with one-hot responses
+    int i, n = 600, nclasses = 3;
+    Mat samples(n, 4, CV_32F), responses(n, nclasses, CV_32F, Scalar(0));
+    RNG rng(0);
+    rng.fill(samples, RNG::NORMAL, 0, 0.3);
+    for( i = 0; i < n; i++ )
+    {
+        samples.at<float>(i, i % nclasses) += 2.f;
+        responses.at<float>(i, i % nclasses) = 1.f;
+    }
+    Mat layers = (Mat_<int>(1, 3) << 4, 16, nclasses);
+
+    // the batches are split into chunks with the partial gradients summed in order,
+    // so the weights must not depend on the number of threads
+    int nthreads = getNumThreads();
+    for( int float32 = 0; float32 <= 1; float32++ )
+    {
+        Ptr<ml::ANN_MLP> ann[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            ann[k] = ml::ANN_MLP::create();
+            ann[k]->setLayerSizes(layers);
+            ann[k]->setActivationFunction(ml::ANN_MLP::SIGMOID_SYM, 1, 1);
+            ann[k]->setTrainMethod(ml::ANN_MLP::BACKPROP, 0.1, 0.1);
+            ann[k]->setBackpropBatchSize(80);
+            ann[k]->setBackpropFloat32(float32 != 0);
+            ann[k]->setTermCriteria(TermCriteria(TermCriteria::COUNT, 50, 0));
+            setNumThreads(k == 0 ? 1 : std::max(nthreads, 4));
+            ann[k]->train(samples, ml::ROW_SAMPLE, responses);
+        }
+        setNumThreads(nthreads);
+
+        for( i = 0; i < layers.cols; i++ )
+            EXPECT_EQ(0, cvtest::norm(ann[0]->getWeights(i), ann[1]->getWeights(i), NORM_INF))
+                << "float32=" << float32 << " layer=" << i;
+
+        Mat predicted;
+        ann[0]->predict(samples, predicted);
+        int errors = 0;
+        for( i = 0; i < n; i++ )
+        {
+            Point maxLoc;
+            minMaxLoc(predicted.row(i), 0, 0, 0, &maxLoc);
+            errors += maxLoc.x != i % nclasses;
+        }
+        EXPECT_LE(errors, n/20) << "float32=" << float32;
+    }
+
+    Ptr<ml::ANN_MLP> ann = ml::ANN_MLP::create();
+    EXPECT_EQ(1, ann->getBackpropBatchSize());
+    EXPECT_FALSE(ann->getBackpropFloat32());
+    EXPECT_THROW(ann->setBackpropBatchSize(0), cv::Exception);
+}
+
 /* End of file. */
@@ -119,6 +119,216 @@ TEST(ML_SVM, trainAuto_regression_5369)
     EXPECT_EQ(1., result1);
 }
 
+static void makeTrainAutoData( int datasize, Mat& samples, Mat& responses )
+{
+    samples.create( datasize, 2, CV_32FC1 );
+    responses.create( datasize, 1, CV_32S );
+
+    RNG rng(0);
+    for (int i = 0; i < datasize; ++i)
+    {
+        int response = rng.uniform(0, 3);
+        samples.at<float>( i, 0 ) = rng.uniform(0.f, 0.6f) + response * 0.4f;
+        samples.at<float>( i, 1 ) = rng.uniform(0.f, 0.6f) + (response % 2) * 0.4f;
+        responses.at<int>( i, 0 ) = response;
+    }
+}
+
+TEST(ML_SVM, trainAuto_threads)
+{
+    Mat samples, responses;
+    makeTrainAutoData( 150, samples, responses );
+    cv::Ptr<TrainData> data = TrainData::create( samples, cv::ml::ROW_SAMPLE, responses );
+
+    // the grid cells and the folds are evaluated in parallel, the choice must not depend on it
+    int nthreads = getNumThreads();
+    for( int factor = 0; factor <= 3; factor += 3 )
+    {
+        cv::Ptr<SVM> svm1 = SVM::create(), svmN = SVM::create();
+        svm1->setTrainAutoHalvingFactor( factor );
+        svmN->setTrainAutoHalvingFactor( factor );
+
+        setNumThreads(1);
+        svm1->trainAuto( data, 5 );
+        setNumThreads(std::max(nthreads, 4));
+        svmN->trainAuto( data, 5 );
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(svm1->getC(), svmN->getC()) << "factor=" << factor;
+        EXPECT_EQ(svm1->getGamma(), svmN->getGamma()) << "factor=" << factor;
+    }
+}
+
+TEST(ML_SVM, trainAuto_halving)
+{
+    Mat samples, responses;
+    makeTrainAutoData( 150, samples, responses );
+    cv::Ptr<TrainData> data = TrainData::create( samples, cv::ml::ROW_SAMPLE, responses );
+
+    cv::Ptr<SVM> svm = SVM::create();
+    EXPECT_EQ(0, svm->getTrainAutoHalvingFactor());
+    svm->setTrainAutoHalvingFactor( 2 );
+    svm->trainAuto( data, 10 );
+
+    Mat predicted;
+    svm->predict( samples, predicted );
+    int errors = 0;
+    for (int i = 0; i < samples.rows; ++i)
+        errors += cvRound(predicted.at<float>(i)) != responses.at<int>(i);
+    EXPECT_LE(errors, samples.rows/10);
+}
+
+TEST(ML_SVM, solver_threads)
+{
+    // enough samples for the kernel rows to be split into blocks and for the shrinking to start
+    Mat samples, responses, fresponses;
+    makeTrainAutoData( 3000, samples, responses );
+    responses.convertTo( fresponses, CV_32F );
+
+    int nthreads = getNumThreads();
+    for( int type = SVM::C_SVC; type <= SVM::EPS_SVR; type += SVM::EPS_SVR - SVM::C_SVC )
+    {
+        cv::Ptr<SVM> svm1 = SVM::create(), svmN = SVM::create();
+        svm1->setType( type );
+        svmN->setType( type );
+        svm1->setP( 0.1 );
+        svmN->setP( 0.1 );
+        svm1->setShrinking( true );
+        svmN->setShrinking( true );
+        Mat r = type == SVM::C_SVC ? responses : fresponses;
+
+        setNumThreads(1);
+        svm1->train( samples, cv::ml::ROW_SAMPLE, r );
+        setNumThreads(std::max(nthreads, 4));
+        svmN->train( samples, cv::ml::ROW_SAMPLE, r );
+        setNumThreads(nthreads);
+
+        Mat sv1 = svm1->getSupportVectors(), svN = svmN->getSupportVectors();
+        ASSERT_EQ(sv1.size(), svN.size()) << "type=" << type;
+        EXPECT_EQ(0, cvtest::norm(sv1, svN, NORM_INF)) << "type=" << type;
+
+        Mat predicted1, predictedN;
+        svm1->predict( samples, predicted1 );
+        svmN->predict( samples, predictedN );
+        EXPECT_EQ(0, cvtest::norm(predicted1, predictedN, NORM_INF)) << "type=" << type;
+
+        int errors = 0;
+        for (int i = 0; i < samples.rows; ++i)
+            errors += cvRound(predicted1.at<float>(i)) != responses.at<int>(i);
+        EXPECT_LE(errors, samples.rows/10) << "type=" << type;
+    }
+}
+
+static void makeSolverData( int datasize, Mat& samples, Mat& labels, Mat& values )
+{
+    samples.create( datasize, 5, CV_32FC1 );
+    labels.create( datasize, 1, CV_32S );
+    values.create( datasize, 1, CV_32F );
+
+    // non-negative features, as required by CHI2 and INTER
+    RNG rng(0);
+    rng.fill( samples, RNG::UNIFORM, 0, 1 );
+    for (int i = 0; i < datasize; ++i)
+    {
+        const float* x = samples.ptr<float>(i);
+        float v = x[0] + 0.5f*x[1] - x[2]*x[3] + rng.uniform(-0.1f, 0.1f);
+        values.at<float>( i, 0 ) = v;
+        labels.at<int>( i, 0 ) = v > 0.5f;
+    }
+}
+
+TEST(ML_SVM, solver_no_shrinking)
+{
+    // the models trained by the SMO solver before the shrinking was added
+    static const struct
+    {
+        int sv_count;
+        double rho;
+        float df[3];
+    }
+    ref[5][6] =
+    {
+        {
+            // C_SVC: LINEAR, POLY, RBF, SIGMOID, CHI2, INTER
+            {  88, -1.072311083, { 1.117986f, 0.079879798f, -2.4021435f } },
+            {  75, -0.9547674107, { 1.2733471f, 0.56587785f, -1.7292171f } },
+            {  99, 0.1624921045, { 1.0932597f, 0.14159435f, -1.7821422f } },
+            { 180, 1.812060222, { -2.0946875f, -1.2016321f, 0.13588615f } },
+            {  99, 0.1493332975, { 0.9639461f, 0.19420813f, -2.0513268f } },
+            {  86, -1.081378405, { 1.0182328f, 0.27039814f, -2.6174362f } }
+        },
+        {
+            // NU_SVC: LINEAR, POLY, RBF, SIGMOID, CHI2, INTER
+            {  63, -1.283730057, { 1.8354241f, 0.51284063f, -3.9686489f } },
+            {  64, -0.9757253397, { 1.6000793f, 0.62648237f, -2.1402335f } },
+            {  65, -0.04217857163, { 1.8637996f, 0.60564649f, -3.0504799f } },
+            {  60, -0.5500014309, { 0.9417786f, -0.088616237f, -0.70089781f } },
+            {  66, -0.07846419953, { 1.4418656f, 0.62439764f, -3.3563459f } },
+            {  76, -0.9340905679, { 1.2620683f, 0.49700901f, -3.361304f } }
+        },
+        {
+            // ONE_CLASS: LINEAR, POLY, RBF, SIGMOID, CHI2, INTER
+            {  62, 52.27884033, { 1.3821399f, 11.574725f, -14.517571f } },
+            {  61, 51.37977297, { 1.4909782f, 17.175303f, -17.2931f } },
+            {  64, 35.55614249, { 4.6066155f, 4.0851979f, -0.89438421f } },
+            {  60, -35.56786135, { 1.2586311f, -0.015485555f, 3.2121699f } },
+            {  62, 33.59116613, { 4.897315f, 3.5204735f, -0.97219235f } },
+            {  61, 76.23502412, { 6.4059691f, 15.737f, -17.196091f } }
+        },
+        {
+            // EPS_SVR: LINEAR, POLY, RBF, SIGMOID, CHI2, INTER
+            { 112, -0.1923085485, { 0.26875383f, 0.38072035f, 1.0197322f } },
+            {  78, -0.2217915079, { 0.31931308f, 0.40140423f, 0.8754651f } },
+            {  92, -0.5052577747, { 0.2777198f, 0.41070503f, 0.87579769f } },
+            { 196, -1.179874879, { 1.6466559f, 0.38737375f, -0.78831786f } },
+            { 100, -0.5302548252, { 0.2923083f, 0.40281221f, 0.84181046f } },
+            { 130, -0.3039338844, { 0.33378324f, 0.3921302f, 1.0138888f } }
+        },
+        {
+            // NU_SVR: LINEAR, POLY, RBF, SIGMOID, CHI2, INTER
+            {  64, -0.2742265202, { 0.27017409f, 0.37758085f, 1.0352803f } },
+            {  89, -0.1682835286, { 0.30670884f, 0.39513469f, 0.84549236f } },
+            {  75, -0.5291851763, { 0.27360928f, 0.40008408f, 0.87680638f } },
+            {  60, -0.7868192717, { 1.138617f, 0.7345776f, -0.31005326f } },
+            {  80, -0.5303112415, { 0.28209805f, 0.40080243f, 0.8515889f } },
+            { 103, -0.3040210244, { 0.35893822f, 0.36445573f, 1.004047f } }
+        }
+    };
+
+    Mat samples, labels, values;
+    makeSolverData( 200, samples, labels, values );
+
+    for( int type = SVM::C_SVC; type <= SVM::NU_SVR; type++ )
+        for( int kernel = SVM::LINEAR; kernel <= SVM::INTER; kernel++ )
+        {
+            cv::Ptr<SVM> svm = SVM::create();
+            EXPECT_FALSE(svm->getShrinking());
+            svm->setType( type );
+            svm->setKernel( kernel );
+            svm->setGamma( kernel == SVM::SIGMOID ? 0.1 : 0.5 );
+            svm->setCoef0( 0.5 );
+            svm->setDegree( 3 );
+            svm->setC( 1 );
+            svm->setNu( 0.3 );
+            svm->setP( 0.05 );
+            svm->train( samples, cv::ml::ROW_SAMPLE,
+                        type == SVM::EPS_SVR || type == SVM::NU_SVR ? values : labels );
+
+            Mat sv = kernel == SVM::LINEAR ? svm->getUncompressedSupportVectors() : svm->getSupportVectors();
+            Mat alpha, svidx, df;
+            double rho = svm->getDecisionFunction( 0, alpha, svidx );
+            svm->predict( samples.rowRange(0, 3), df, cv::ml::StatModel::RAW_OUTPUT );
+
+            const int idx = type - SVM::C_SVC, kidx = kernel - SVM::LINEAR;
+            EXPECT_EQ(ref[idx][kidx].sv_count, sv.rows) << "type=" << type << " kernel=" << kernel;
+            EXPECT_NEAR(ref[idx][kidx].rho, rho, 1e-6*std::max(1., fabs(rho)))
+                << "type=" << type << " kernel=" << kernel;
+            for( int i = 0; i < 3; i++ )
+                EXPECT_NEAR(ref[idx][kidx].df[i], df.at<float>(i), 1e-5*std::max(1.f, fabs(df.at<float>(i))))
+                    << "type=" << type << " kernel=" << kernel << " i=" << i;
+        }
+}
+
 class CV_SVMGetSupportVectorsTest : public cvtest::BaseTest {
 public:
     CV_SVMGetSupportVectorsTest() {}
@@ -320,6 +320,29 @@ public:
                                   Size maxSize = Size(),
                                   bool outputRejectLevels = false );
 
+    /** @overload
+    Detects objects in a batch of images. The image pyramids are built and all the (image, stripe of
+    windows) pairs are scanned in one parallel loop, which keeps the threads busy on small images. The
+    buffers of the image pyramids are kept for the next batch of images of the same sizes.
+
+    @param images Vector of the images of the type CV_8U where objects are detected.
+    @param objects Vector of the vectors of rectangles that contain the objects detected in the
+    corresponding images, as detectMultiScale() returns them for each image alone.
+    @param scaleFactor Parameter specifying how much the image size is reduced at each image scale.
+    @param minNeighbors Parameter specifying how many neighbors each candidate rectangle should have
+    to retain it.
+    @param flags Parameter with the same meaning for an old cascade as in the function
+    cvHaarDetectObjects. It is not used for a new cascade.
+    @param minSize Minimum possible object size. Objects smaller than that are ignored.
+    @param maxSize Maximum possible object size. Objects larger than that are ignored.
+    */
+    void detectMultiScale( InputArrayOfArrays images,
+                           CV_OUT std::vector<std::vector<Rect> >& objects,
+                           double scaleFactor = 1.1,
+                           int minNeighbors = 3, int flags = 0,
+                           Size minSize = Size(),
+                           Size maxSize = Size() );
+
     CV_WRAP bool isOldFormatCascade() const;
     CV_WRAP Size getOriginalWindowSize() const;
     CV_WRAP int getFeatureType() const;
@@ -425,6 +448,12 @@ public:
                                   double hitThreshold = 0, Size winStride = Size(),
                                   Size padding = Size(), double scale = 1.05,
                                   double finalThreshold = 2.0, bool useMeanshiftGrouping = false) const;
+    //! for a batch of images, all the (image, pyramid level) pairs of which are processed in one parallel loop;
+    //! the results for each image are the same as those of detectMultiScale() for the image alone
+    void detectMultiScale(InputArrayOfArrays imgs, CV_OUT std::vector<std::vector<Rect> >& foundLocations,
+                          CV_OUT std::vector<std::vector<double> >& foundWeights, double hitThreshold = 0,
+                          Size winStride = Size(), Size padding = Size(), double scale = 1.05,
+                          double finalThreshold = 2.0, bool useMeanshiftGrouping = false) const;
 
     CV_WRAP virtual void computeGradient(const Mat& img, CV_OUT Mat& grad, CV_OUT Mat& angleOfs,
                                  Size paddingTL = Size(), Size paddingBR = Size()) const;
@@ -0,0 +1,88 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+#include <opencv2/imgproc.hpp>
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::get;
+
+typedef std::tr1::tuple<std::string, int> Cascade_Threads_t;
+typedef perf::TestBaseWithParam<Cascade_Threads_t> Cascade_Threads;
+
+PERF_TEST_P( Cascade_Threads, CascadeClassifier,
+             testing::Combine(
+                 testing::Values( string("cv/cascadeandhog/cascades/haarcascade_frontalface_alt.xml"),
+                                  string("cv/cascadeandhog/cascades/lbpcascade_frontalface.xml") ),
+                 testing::Values( 1, 2, 4, 8 )
+                 )
+             )
+{
+    const string cascadePath = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    CascadeClassifier cc( getDataPath(cascadePath) );
+    if (cc.empty())
+        FAIL() << "Can't load cascade file: " << getDataPath(cascadePath);
+
+    Mat img = imread(getDataPath("cv/shared/lena.png"), IMREAD_GRAYSCALE);
+    if (img.empty())
+        FAIL() << "Can't load source image";
+
+    equalizeHist(img, img);
+    declare.in(img);
+
+    vector<Rect> faces;
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() cc.detectMultiScale(img, faces, 1.1, 3, 0, Size(30, 30));
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef std::tr1::tuple<bool, int> Batch_Threads_t;
+typedef perf::TestBaseWithParam<Batch_Threads_t> Batch_Threads;
+
+PERF_TEST_P( Batch_Threads, CascadeClassifier_16xQVGA,
+             testing::Combine(
+                 testing::Bool(),
+                 testing::Values( 1, 2, 4, 8 )
+                 )
+             )
+{
+    bool batch = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    const string cascadePath = "cv/cascadeandhog/cascades/haarcascade_frontalface_alt.xml";
+    CascadeClassifier cc( getDataPath(cascadePath) );
+    if (cc.empty())
+        FAIL() << "Can't load cascade file: " << getDataPath(cascadePath);
+
+    Mat img = imread(getDataPath("cv/shared/lena.png"), IMREAD_GRAYSCALE);
+    if (img.empty())
+        FAIL() << "Can't load source image";
+
+    // the frames of 16 cameras
+    vector<Mat> imgs(16);
+    for( size_t i = 0; i < imgs.size(); i++ )
+        resize(img(Rect((int)i*8, (int)i*4, 320, 240)), imgs[i], szQVGA);
+
+    vector<vector<Rect> > faces(imgs.size());
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE()
+    {
+        if( batch )
+            cc.detectMultiScale(imgs, faces, 1.1, 3, 0, Size(30, 30));
+        else
+            for( size_t i = 0; i < imgs.size(); i++ )
+                cc.detectMultiScale(imgs[i], faces[i], 1.1, 3, 0, Size(30, 30));
+    }
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
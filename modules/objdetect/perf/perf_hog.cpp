@@ -0,0 +1,79 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, int> Size_Threads_t;
+typedef perf::TestBaseWithParam<Size_Threads_t> Size_Threads;
+
+PERF_TEST_P( Size_Threads, HOGDetectMultiScale,
+             testing::Combine(
+                 testing::Values( szVGA, sz1080p ),
+                 testing::Values( 1, 2, 4, 8 )
+                 )
+             )
+{
+    Size sz = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat img(sz, CV_8UC1);
+    declare.in(img, WARMUP_RNG);
+
+    HOGDescriptor hog;
+    hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+    vector<Rect> found;
+    vector<double> weights;
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() hog.detectMultiScale(img, found, weights, 0, Size(8, 8), Size(32, 32), 1.05, 2);
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef std::tr1::tuple<bool, int> Batch_Threads_t;
+typedef perf::TestBaseWithParam<Batch_Threads_t> Batch_Threads;
+
+PERF_TEST_P( Batch_Threads, HOGDetectMultiScale_16xQVGA,
+             testing::Combine(
+                 testing::Bool(),
+                 testing::Values( 1, 2, 4, 8 )
+                 )
+             )
+{
+    bool batch = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    vector<Mat> imgs(16);
+    for( size_t i = 0; i < imgs.size(); i++ )
+    {
+        imgs[i].create(szQVGA, CV_8UC1);
+        declare.in(imgs[i], WARMUP_RNG);
+    }
+
+    HOGDescriptor hog;
+    hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+    vector<vector<Rect> > found(imgs.size());
+    vector<vector<double> > weights(imgs.size());
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE()
+    {
+        if( batch )
+            hog.detectMultiScale(imgs, found, weights, 0, Size(8, 8), Size(32, 32), 1.05, 2);
+        else
+            for( size_t i = 0; i < imgs.size(); i++ )
+                hog.detectMultiScale(imgs[i], found[i], weights[i], 0, Size(8, 8), Size(32, 32), 1.05, 2);
+    }
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
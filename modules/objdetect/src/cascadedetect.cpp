@@ -405,6 +405,21 @@ bool FeatureEvaluator::read(const FileNode&, Size _origWinSize)
 }
 
 Ptr<FeatureEvaluator> FeatureEvaluator::clone() const { return Ptr<FeatureEvaluator>(); }
+Ptr<FeatureEvaluator> FeatureEvaluator::cloneForImage() const { return Ptr<FeatureEvaluator>(); }
+
+// forgets the image, so that a copy of the evaluator can be set to another image
+void FeatureEvaluator::resetImage()
+{
+    scaleData = makePtr<std::vector<ScaleData> >();
+    sbufSize = Size();
+    sbufFlag = 0;
+    sbuf.release();
+    rbuf.release();
+    urbuf.release();
+    usbuf.release();
+    ufbuf.release();
+    uscaleData.release();
+}
 int FeatureEvaluator::getFeatureType() const {return -1;}
 bool FeatureEvaluator::setWindow(Point, int) { return true; }
 void FeatureEvaluator::getUMats(std::vector<UMat>& bufs)
@@ -627,6 +642,17 @@ Ptr<FeatureEvaluator> HaarEvaluator::clone() const
     return ret;
 }
 
+Ptr<FeatureEvaluator> HaarEvaluator::cloneForImage() const
+{
+    Ptr<HaarEvaluator> ret = makePtr<HaarEvaluator>();
+    *ret = *this;
+    ret->resetImage();
+    ret->optfeatures = makePtr<std::vector<OptFeature> >();
+    ret->optfeatures_lbuf = makePtr<std::vector<OptFeature> >();
+    ret->optfeaturesPtr = 0;
+    return ret;
+}
+
 
 void HaarEvaluator::computeChannels(int scaleIdx, InputArray img)
 {
@@ -706,8 +732,18 @@ bool HaarEvaluator::setWindow( Point pt, int scaleIdx )
         return false;
 
     pwin = &sbuf.at<int>(pt) + s.layer_ofs;
-    const int* pq = (const int*)(pwin + sqofs);
-    int valsum = CALC_SUM_OFS(nofs, pwin);
+    return calcNormFactor(pwin, varianceNormFactor);
+}
+
+const int* HaarEvaluator::setRow( int y, int scaleIdx ) const
+{
+    return &sbuf.at<int>(y, 0) + getScaleData(scaleIdx).layer_ofs;
+}
+
+bool HaarEvaluator::calcNormFactor( const int* p, float& _nf ) const
+{
+    const int* pq = (const int*)(p + sqofs);
+    int valsum = CALC_SUM_OFS(nofs, p);
     unsigned valsqsum = (unsigned)(CALC_SUM_OFS(nofs, pq));
 
     double area = normrect.area();
@@ -715,12 +751,12 @@ bool HaarEvaluator::setWindow( Point pt, int scaleIdx )
     if( nf > 0. )
     {
         nf = std::sqrt(nf);
-        varianceNormFactor = (float)(1./nf);
-        return area*varianceNormFactor < 1e-1;
+        _nf = (float)(1./nf);
+        return area*_nf < 1e-1;
     }
     else
     {
-        varianceNormFactor = 1.f;
+        _nf = 1.f;
         return false;
     }
 }
@@ -811,6 +847,17 @@ Ptr<FeatureEvaluator> LBPEvaluator::clone() const
     return ret;
 }
 
+Ptr<FeatureEvaluator> LBPEvaluator::cloneForImage() const
+{
+    Ptr<LBPEvaluator> ret = makePtr<LBPEvaluator>();
+    *ret = *this;
+    ret->resetImage();
+    ret->optfeatures = makePtr<std::vector<OptFeature> >();
+    ret->optfeatures_lbuf = makePtr<std::vector<OptFeature> >();
+    ret->optfeaturesPtr = 0;
+    return ret;
+}
+
 void LBPEvaluator::computeChannels(int scaleIdx, InputArray _img)
 {
     const ScaleData& s = scaleData->at(scaleIdx);
@@ -873,6 +920,11 @@ bool LBPEvaluator::setWindow( Point pt, int scaleIdx )
     return true;
 }
 
+const int* LBPEvaluator::setRow( int y, int scaleIdx ) const
+{
+    return &sbuf.at<int>(y, 0) + getScaleData(scaleIdx).layer_ofs;
+}
+
 
 Ptr<FeatureEvaluator> FeatureEvaluator::create( int featureType )
 {
@@ -951,6 +1003,167 @@ int CascadeClassifierImpl::runAt( Ptr<FeatureEvaluator>& evaluator, Point pt, in
     }
 }
 
+bool CascadeClassifierImpl::canRunRows() const
+{
+    return !oldCascade && data.maxNodesPerTree == 1 &&
+        (data.featureType == FeatureEvaluator::HAAR || data.featureType == FeatureEvaluator::LBP);
+}
+
+// Runs the stump cascade on the windows (x, y), x = 0, xstep, ..., (nwindows - 1)*xstep of the layer
+// and stores what runAt() returns for each of them, except for the windows next to the ones
+// rejected by the first stage: CascadeClassifierInvoker skips them, so they get 0 without being evaluated.
+// The windows are passed through the cascade stage by stage, 4 at a time, and only the windows
+// accepted by a stage are kept for the next one, so the neighbour windows are loaded together
+// while most of them are left.
+void CascadeClassifierImpl::runRow( Ptr<FeatureEvaluator>& evaluator, int y, int scaleIdx, int xstep, int nwindows,
+                                    int* results, double* weights )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( canRunRows() && !data.stumps.empty() );
+
+    bool haar = data.featureType == FeatureEvaluator::HAAR;
+    const HaarEvaluator& haarEvaluator = (const HaarEvaluator&)*evaluator;
+    const LBPEvaluator& lbpEvaluator = (const LBPEvaluator&)*evaluator;
+    const int* p = haar ? haarEvaluator.setRow(y, scaleIdx) : lbpEvaluator.setRow(y, scaleIdx);
+
+    // the windows that are left: their indices, x and variance normalization factors,
+    // with the room for the lanes after the last window
+    AutoBuffer<int> _ibuf((nwindows + 4)*2);
+    AutoBuffer<float> _nf(nwindows + 4);
+    AutoBuffer<double> _sums(nwindows + 4);
+    int* idx = _ibuf;
+    int* wofs = idx + nwindows + 4;
+    float* nf = _nf;
+    double* sums = _sums;
+    int i, j, k, n = 0, xlast = (nwindows - 1)*xstep;
+
+    for( k = 0; k < nwindows; k++ )
+    {
+        results[k] = -1;
+        weights[k] = 0;
+        nf[n] = 1.f;
+        if( haar && !haarEvaluator.calcNormFactor(p + k*xstep, nf[n]) )
+            continue;
+        idx[n] = k;
+        wofs[n++] = k*xstep;
+    }
+
+    int nstages = (int)data.stages.size();
+    size_t subsetSize = (data.ncategories + 31)/32;
+    const CascadeClassifierImpl::Data::Stump* cascadeStumps = &data.stumps[0];
+    const int* cascadeSubsets = haar ? 0 : &data.subsets[0];
+
+    for( int si = 0; si < nstages && n > 0; si++ )
+    {
+        const CascadeClassifierImpl::Data::Stage& stage = data.stages[si];
+        int ntrees = stage.ntrees;
+
+        for( i = 0; i < n; i++ )
+            sums[i] = 0;
+
+        i = 0;
+#if CV_SIMD128
+        for( j = n; j < n + 3; j++ )
+        {
+            wofs[j] = wofs[n - 1];
+            nf[j] = nf[n - 1];
+        }
+
+        for( ; i < n; i += 4 )
+        {
+            int d = wofs[i + 3] - wofs[i];
+            int mode = i + 4 > n ? CASCADE_LOAD_GATHER : d == 3 ? CASCADE_LOAD_DENSE :
+                d == 6 && xstep == 2 && wofs[i + 3] < xlast ? CASCADE_LOAD_DENSE2 : CASCADE_LOAD_GATHER;
+            v_float32x4 vnf = v_load(nf + i);
+            float leaves[4];
+            int c[4];
+
+            for( int wi = 0; wi < ntrees; wi++ )
+            {
+                const CascadeClassifierImpl::Data::Stump& stump = cascadeStumps[wi];
+                if( haar )
+                {
+                    v_float32x4 value =
+                        mode == CASCADE_LOAD_DENSE ? haarEvaluator.calcOrd4<CASCADE_LOAD_DENSE>(stump.featureIdx, p, wofs + i, vnf) :
+                        mode == CASCADE_LOAD_DENSE2 ? haarEvaluator.calcOrd4<CASCADE_LOAD_DENSE2>(stump.featureIdx, p, wofs + i, vnf) :
+                        haarEvaluator.calcOrd4<CASCADE_LOAD_GATHER>(stump.featureIdx, p, wofs + i, vnf);
+                    v_store(leaves, v_select(value < v_setall_f32(stump.threshold),
+                                             v_setall_f32(stump.left), v_setall_f32(stump.right)));
+                }
+                else
+                {
+                    const int* subset = &cascadeSubsets[wi*subsetSize];
+                    v_store(c, mode == CASCADE_LOAD_DENSE ? lbpEvaluator.calcCat4<CASCADE_LOAD_DENSE>(stump.featureIdx, p, wofs + i) :
+                               mode == CASCADE_LOAD_DENSE2 ? lbpEvaluator.calcCat4<CASCADE_LOAD_DENSE2>(stump.featureIdx, p, wofs + i) :
+                               lbpEvaluator.calcCat4<CASCADE_LOAD_GATHER>(stump.featureIdx, p, wofs + i));
+                    for( j = 0; j < 4; j++ )
+                        leaves[j] = (subset[c[j]>>5] & (1 << (c[j] & 31))) ? stump.left : stump.right;
+                }
+                sums[i] += leaves[0];
+                sums[i + 1] += leaves[1];
+                sums[i + 2] += leaves[2];
+                sums[i + 3] += leaves[3];
+            }
+        }
+#endif
+        for( ; i < n; i++ )
+        {
+            const int* pwin = p + wofs[i];
+            for( int wi = 0; wi < ntrees; wi++ )
+            {
+                const CascadeClassifierImpl::Data::Stump& stump = cascadeStumps[wi];
+                if( haar )
+                {
+                    double value = haarEvaluator.calcOrd(stump.featureIdx, pwin, nf[i]);
+                    sums[i] += value < stump.threshold ? stump.left : stump.right;
+                }
+                else
+                {
+                    int c = lbpEvaluator.calcCat(stump.featureIdx, pwin);
+                    const int* subset = &cascadeSubsets[wi*subsetSize];
+                    sums[i] += (subset[c>>5] & (1 << (c & 31))) ? stump.left : stump.right;
+                }
+            }
+        }
+
+        // the windows rejected by the stage are removed;
+        // after the first stage, also the windows that follow the rejected ones
+        int skip = -1, m = 0;
+        for( i = 0; i < n; i++ )
+        {
+            k = idx[i];
+            if( k == skip )
+            {
+                results[k] = 0;
+                continue;
+            }
+            weights[k] = sums[i];
+            if( sums[i] < stage.threshold )
+            {
+                results[k] = -si;
+                if( si == 0 && k + 1 < nwindows )
+                {
+                    skip = k + 1;
+                    results[skip] = 0;
+                }
+                continue;
+            }
+            idx[m] = k;
+            wofs[m] = wofs[i];
+            nf[m++] = nf[i];
+        }
+        n = m;
+
+        cascadeStumps += ntrees;
+        if( !haar )
+            cascadeSubsets += ntrees*subsetSize;
+    }
+
+    for( i = 0; i < n; i++ )
+        results[idx[i]] = 1;
+}
+
 void CascadeClassifierImpl::setMaskGenerator(const Ptr<MaskGenerator>& _maskGenerator)
 {
     maskGenerator=_maskGenerator;
@@ -972,13 +1185,15 @@ Ptr<BaseCascadeClassifier::MaskGenerator> createFaceDetectionMaskGenerator()
 class CascadeClassifierInvoker : public ParallelLoopBody
 {
 public:
-    CascadeClassifierInvoker( CascadeClassifierImpl& _cc, int _nscales, int _nstripes,
+    CascadeClassifierInvoker( CascadeClassifierImpl& _cc, const Ptr<FeatureEvaluator>& _featureEvaluator,
+                              int _nscales, int _nstripes,
                               const FeatureEvaluator::ScaleData* _scaleData,
                               const int* _stripeSizes, std::vector<Rect>& _vec,
                               std::vector<int>& _levels, std::vector<double>& _weights,
                               bool outputLevels, const Mat& _mask, Mutex* _mtx)
     {
         classifier = &_cc;
+        featureEvaluator = _featureEvaluator;
         nscales = _nscales;
         nstripes = _nstripes;
         scaleData = _scaleData;
@@ -994,9 +1209,12 @@ public:
     {
         CV_INSTRUMENT_REGION()
 
-        Ptr<FeatureEvaluator> evaluator = classifier->featureEvaluator->clone();
+        Ptr<FeatureEvaluator> evaluator = featureEvaluator->clone();
         double gypWeight = 0.;
         Size origWinSize = classifier->data.origWinSize;
+        bool runRows = classifier->canRunRows();
+        std::vector<int> rowResults;
+        std::vector<double> rowWeights;
 
         for( int scaleIdx = 0; scaleIdx < nscales; scaleIdx++ )
         {
@@ -1010,11 +1228,28 @@ public:
             Size winSize(cvRound(origWinSize.width * scalingFactor),
                          cvRound(origWinSize.height * scalingFactor));
 
+            int nx = (szw.width + yStep - 1)/yStep;
+            if( runRows && nx > 0 )
+            {
+                rowResults.resize(nx);
+                rowWeights.resize(nx);
+            }
+
             for( int y = y0; y < y1; y += yStep )
             {
+                if( runRows && nx > 0 )
+                    classifier->runRow(evaluator, y, scaleIdx, yStep, nx, &rowResults[0], &rowWeights[0]);
+
                 for( int x = 0; x < szw.width; x += yStep )
                 {
-                    int result = classifier->runAt(evaluator, Point(x, y), scaleIdx, gypWeight);
+                    int result;
+                    if( runRows )
+                    {
+                        result = rowResults[x/yStep];
+                        gypWeight = rowWeights[x/yStep];
+                    }
+                    else
+                        result = classifier->runAt(evaluator, Point(x, y), scaleIdx, gypWeight);
                     if( rejectLevels )
                     {
                         if( result == 1 )
@@ -1038,7 +1273,7 @@ public:
                                                    winSize.width, winSize.height));
                         mtx->unlock();
                     }
-                    if( result == 0 )
+                    if( result == 0 && !runRows )
                         x += yStep;
                 }
             }
@@ -1046,6 +1281,7 @@ public:
     }
 
     CascadeClassifierImpl* classifier;
+    Ptr<FeatureEvaluator> featureEvaluator;
     std::vector<Rect>* rectangles;
     int nscales, nstripes;
     const FeatureEvaluator::ScaleData* scaleData;
@@ -1232,25 +1468,12 @@ static void detectMultiScaleOldFormat( const Mat& image, Ptr<CvHaarClassifierCas
     std::transform(vecAvgComp.begin(), vecAvgComp.end(), objects.begin(), getRect());
 }
 
-void CascadeClassifierImpl::detectMultiScaleNoGrouping( InputArray _image, std::vector<Rect>& candidates,
-                                                    std::vector<int>& rejectLevels, std::vector<double>& levelWeights,
-                                                    double scaleFactor, Size minObjectSize, Size maxObjectSize,
-                                                    bool outputRejectLevels )
+static void getScales( Size imgsz, Size originalWindowSize, double scaleFactor,
+                       Size minObjectSize, Size maxObjectSize, std::vector<float>& scales )
 {
-    CV_INSTRUMENT_REGION()
-
-    Size imgsz = _image.size();
-    Size originalWindowSize = getOriginalWindowSize();
-
-    if( maxObjectSize.height == 0 || maxObjectSize.width == 0 )
-        maxObjectSize = imgsz;
-
-    // If a too small image patch is entering the function, break early before any processing
-    if( (imgsz.height < originalWindowSize.height) || (imgsz.width < originalWindowSize.width) )
-        return;
-
-    std::vector<float> all_scales, scales;
+    std::vector<float> all_scales;
     all_scales.reserve(1024);
+    scales.clear();
     scales.reserve(1024);
 
     // First calculate all possible scales for the given image and model, then remove undesired scales
@@ -1293,6 +1516,40 @@ void CascadeClassifierImpl::detectMultiScaleNoGrouping( InputArray _image, std::
         }
         scales.push_back(all_scales[iMin]);
     }
+}
+
+// splits the rows of the windows of each scale into the same number of stripes, returns the number
+static int getStripes( const FeatureEvaluator::ScaleData* s, size_t nscales, Size origWinSize, int* stripeSizes )
+{
+    Size szw = s->getWorkingSize(origWinSize);
+    int nstripes = cvCeil(szw.width/32.);
+    for( size_t i = 0; i < nscales; i++ )
+    {
+        szw = s[i].getWorkingSize(origWinSize);
+        stripeSizes[i] = std::max((szw.height/s[i].ystep + nstripes-1)/nstripes, 1)*s[i].ystep;
+    }
+    return nstripes;
+}
+
+void CascadeClassifierImpl::detectMultiScaleNoGrouping( InputArray _image, std::vector<Rect>& candidates,
+                                                    std::vector<int>& rejectLevels, std::vector<double>& levelWeights,
+                                                    double scaleFactor, Size minObjectSize, Size maxObjectSize,
+                                                    bool outputRejectLevels )
+{
+    CV_INSTRUMENT_REGION()
+
+    Size imgsz = _image.size();
+    Size originalWindowSize = getOriginalWindowSize();
+
+    if( maxObjectSize.height == 0 || maxObjectSize.width == 0 )
+        maxObjectSize = imgsz;
+
+    // If a too small image patch is entering the function, break early before any processing
+    if( (imgsz.height < originalWindowSize.height) || (imgsz.width < originalWindowSize.width) )
+        return;
+
+    std::vector<float> scales;
+    getScales(imgsz, originalWindowSize, scaleFactor, minObjectSize, maxObjectSize, scales);
 
     candidates.clear();
     rejectLevels.clear();
@@ -1337,25 +1594,145 @@ void CascadeClassifierImpl::detectMultiScaleNoGrouping( InputArray _image, std::
         if (maskGenerator)
             currentMask = maskGenerator->generateMask(gray.getMat());
 
-        size_t i, nscales = scales.size();
+        size_t nscales = scales.size();
         cv::AutoBuffer<int> stripeSizeBuf(nscales);
         int* stripeSizes = stripeSizeBuf;
         const FeatureEvaluator::ScaleData* s = &featureEvaluator->getScaleData(0);
-        Size szw = s->getWorkingSize(data.origWinSize);
-        int nstripes = cvCeil(szw.width/32.);
-        for( i = 0; i < nscales; i++ )
-        {
-            szw = s[i].getWorkingSize(data.origWinSize);
-            stripeSizes[i] = std::max((szw.height/s[i].ystep + nstripes-1)/nstripes, 1)*s[i].ystep;
-        }
+        int nstripes = getStripes(s, nscales, data.origWinSize, stripeSizes);
 
-        CascadeClassifierInvoker invoker(*this, (int)nscales, nstripes, s, stripeSizes,
+        CascadeClassifierInvoker invoker(*this, featureEvaluator, (int)nscales, nstripes, s, stripeSizes,
                                          candidates, rejectLevels, levelWeights,
                                          outputRejectLevels, currentMask, &mtx);
         parallel_for_(Range(0, nstripes), invoker);
     }
 }
 
+// builds the image pyramids of a batch, each in its own evaluator
+class CascadePyramidInvoker : public ParallelLoopBody
+{
+public:
+    CascadePyramidInvoker( const std::vector<Mat>& _images, const std::vector<std::vector<float> >& _scales,
+                           std::vector<Ptr<FeatureEvaluator> >& _evaluators, std::vector<Mat>& _grays,
+                           std::vector<uchar>& _ok ) :
+        images(&_images), scales(&_scales), evaluators(&_evaluators), grays(&_grays), ok(&_ok)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        CV_INSTRUMENT_REGION()
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const Mat& image = (*images)[i];
+            Mat& gray = (*grays)[i];
+            if( image.channels() > 1 )
+                cvtColor(image, gray, COLOR_BGR2GRAY);
+            else
+                gray = image;
+
+            Ptr<FeatureEvaluator>& evaluator = (*evaluators)[i];
+            (*ok)[i] = !(*scales)[i].empty() && evaluator->setImage(gray, (*scales)[i]);
+            if( (*ok)[i] )
+                evaluator->getMats();
+        }
+    }
+
+private:
+    const std::vector<Mat>* images;
+    const std::vector<std::vector<float> >* scales;
+    std::vector<Ptr<FeatureEvaluator> >* evaluators;
+    std::vector<Mat>* grays;
+    std::vector<uchar>* ok;
+};
+
+// scans the (image, stripe) pairs of a batch with the invokers of the images
+class CascadeClassifierBatchInvoker : public ParallelLoopBody
+{
+public:
+    CascadeClassifierBatchInvoker( const std::vector<CascadeClassifierInvoker>& _invokers,
+                                   const std::vector<int>& _itemInvokers, const std::vector<int>& _itemStripes ) :
+        invokers(&_invokers), itemInvokers(&_itemInvokers), itemStripes(&_itemStripes)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        // the consecutive stripes of an image are scanned together, with the same copy of its evaluator
+        for( int i = range.start, j; i < range.end; i = j )
+        {
+            int k = (*itemInvokers)[i];
+            for( j = i + 1; j < range.end && (*itemInvokers)[j] == k; j++ )
+                ;
+            (*invokers)[k](Range((*itemStripes)[i], (*itemStripes)[j - 1] + 1));
+        }
+    }
+
+private:
+    const std::vector<CascadeClassifierInvoker>* invokers;
+    const std::vector<int>* itemInvokers;
+    const std::vector<int>* itemStripes;
+};
+
+void CascadeClassifierImpl::detectMultiScaleNoGrouping( const std::vector<Mat>& images,
+                                                        std::vector<std::vector<Rect> >& candidates,
+                                                        double scaleFactor, Size minObjectSize, Size maxObjectSize )
+{
+    CV_INSTRUMENT_REGION()
+
+    size_t i, nimages = images.size();
+    Size originalWindowSize = getOriginalWindowSize();
+
+    std::vector<std::vector<float> > scales(nimages);
+    for( i = 0; i < nimages; i++ )
+    {
+        Size imgsz = images[i].size();
+        CV_Assert( images[i].depth() == CV_8U );
+        if( imgsz.height >= originalWindowSize.height && imgsz.width >= originalWindowSize.width )
+            getScales(imgsz, originalWindowSize, scaleFactor, minObjectSize,
+                      maxObjectSize.area() > 0 ? maxObjectSize : imgsz, scales[i]);
+    }
+
+    // the evaluators of the previous batch keep their buffers and feature offsets for the images of the same size
+    while( imageEvaluators.size() < nimages )
+        imageEvaluators.push_back(featureEvaluator->cloneForImage());
+
+    std::vector<Mat> grays(nimages);
+    std::vector<uchar> ok(nimages);
+    parallel_for_(Range(0, (int)nimages), CascadePyramidInvoker(images, scales, imageEvaluators, grays, ok));
+
+    std::vector<CascadeClassifierInvoker> invokers;
+    std::vector<std::vector<int> > stripeSizes(nimages);
+    std::vector<int> itemInvokers, itemStripes, fakeLevels;
+    std::vector<double> fakeWeights;
+    for( i = 0; i < nimages; i++ )
+    {
+        if( !ok[i] )
+            continue;
+
+        Mat currentMask;
+        if (maskGenerator)
+            currentMask = maskGenerator->generateMask(grays[i]);
+
+        size_t nscales = scales[i].size();
+        stripeSizes[i].resize(nscales);
+        const FeatureEvaluator::ScaleData* s = &imageEvaluators[i]->getScaleData(0);
+        int nstripes = getStripes(s, nscales, data.origWinSize, &stripeSizes[i][0]);
+
+        for( int j = 0; j < nstripes; j++ )
+        {
+            itemInvokers.push_back((int)invokers.size());
+            itemStripes.push_back(j);
+        }
+        invokers.push_back(CascadeClassifierInvoker(*this, imageEvaluators[i], (int)nscales, nstripes, s,
+                                                    &stripeSizes[i][0], candidates[i], fakeLevels, fakeWeights,
+                                                    false, currentMask, &mtx));
+    }
+
+    parallel_for_(Range(0, (int)itemInvokers.size()),
+                  CascadeClassifierBatchInvoker(invokers, itemInvokers, itemStripes));
+}
+
 
 void CascadeClassifierImpl::detectMultiScale( InputArray _image, std::vector<Rect>& objects,
                                           std::vector<int>& rejectLevels,
@@ -1437,6 +1814,35 @@ void CascadeClassifierImpl::detectMultiScale( InputArray _image, std::vector<Rec
     }
 }
 
+void CascadeClassifierImpl::detectMultiScale( InputArrayOfArrays _images, std::vector<std::vector<Rect> >& objects,
+                                          double scaleFactor, int minNeighbors,
+                                          int flags, Size minObjectSize, Size maxObjectSize )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( scaleFactor > 1 );
+
+    std::vector<Mat> images;
+    _images.getMatVector(images);
+    size_t i, nimages = images.size();
+    objects.assign(nimages, std::vector<Rect>());
+
+    if( empty() )
+        return;
+
+    if( isOldFormatCascade() )
+    {
+        for( i = 0; i < nimages; i++ )
+            detectMultiScale( images[i], objects[i], scaleFactor, minNeighbors, flags, minObjectSize, maxObjectSize );
+        return;
+    }
+
+    detectMultiScaleNoGrouping( images, objects, scaleFactor, minObjectSize, maxObjectSize );
+    const double GROUP_EPS = 0.2;
+    for( i = 0; i < nimages; i++ )
+        groupRectangles( objects[i], minNeighbors, GROUP_EPS );
+}
+
 
 CascadeClassifierImpl::Data::Data()
 {
@@ -1588,6 +1994,7 @@ bool CascadeClassifierImpl::read_(const FileNode& root)
     ustages.release();
     unodes.release();
     uleaves.release();
+    imageEvaluators.clear();
     if( !data.read(root) )
         return false;
 
@@ -1726,6 +2133,32 @@ void CascadeClassifier::detectMultiScale( InputArray image,
     clipObjects(image.size(), objects, &rejectLevels, &levelWeights);
 }
 
+void CascadeClassifier::detectMultiScale( InputArrayOfArrays images,
+                      CV_OUT std::vector<std::vector<Rect> >& objects,
+                      double scaleFactor,
+                      int minNeighbors, int flags,
+                      Size minSize, Size maxSize )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert(!empty());
+    // the batch is not a part of the BaseCascadeClassifier interface; the other implementations
+    // process the images one by one
+    Ptr<CascadeClassifierImpl> impl = cc.dynamicCast<CascadeClassifierImpl>();
+    if( impl )
+        impl->detectMultiScale(images, objects, scaleFactor, minNeighbors, flags, minSize, maxSize);
+    else
+    {
+        std::vector<Mat> imgs;
+        images.getMatVector(imgs);
+        objects.resize(imgs.size());
+        for( size_t i = 0; i < imgs.size(); i++ )
+            cc->detectMultiScale(imgs[i], objects[i], scaleFactor, minNeighbors, flags, minSize, maxSize);
+    }
+    for( size_t i = 0; i < objects.size(); i++ )
+        clipObjects(images.size((int)i), objects[i], 0, 0);
+}
+
 bool CascadeClassifier::isOldFormatCascade() const
 {
     CV_Assert(!empty());
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "opencv2/core/ocl.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -36,6 +37,7 @@ public:
 
     virtual bool read(const FileNode& node, Size origWinSize);
     virtual Ptr<FeatureEvaluator> clone() const;
+    virtual Ptr<FeatureEvaluator> cloneForImage() const;
     virtual int getFeatureType() const;
     int getNumChannels() const { return nchannels; }
 
@@ -62,6 +64,7 @@ protected:
     int sbufFlag;
 
     bool updateScaleData( Size imgsz, const std::vector<float>& _scales );
+    void resetImage();
     virtual void computeChannels( int, InputArray ) {}
     virtual void computeOptFeatures() {}
 
@@ -109,6 +112,12 @@ public:
                           Size maxSize = Size(),
                           bool outputRejectLevels = false );
 
+    void detectMultiScale( InputArrayOfArrays images,
+                          CV_OUT std::vector<std::vector<Rect> >& objects,
+                          double scaleFactor = 1.1,
+                          int minNeighbors = 3, int flags = 0,
+                          Size minSize = Size(),
+                          Size maxSize = Size() );
 
     bool isOldFormatCascade() const;
     Size getOriginalWindowSize() const;
@@ -133,6 +142,8 @@ protected:
                                     std::vector<int>& rejectLevels, std::vector<double>& levelWeights,
                                     double scaleFactor, Size minObjectSize, Size maxObjectSize,
                                     bool outputRejectLevels = false );
+    void detectMultiScaleNoGrouping( const std::vector<Mat>& images, std::vector<std::vector<Rect> >& candidates,
+                                    double scaleFactor, Size minObjectSize, Size maxObjectSize );
 
     enum { MAX_FACES = 10000 };
     enum { BOOST = 0 };
@@ -158,6 +169,9 @@ protected:
     friend int predictCategoricalStump( CascadeClassifierImpl& cascade, Ptr<FeatureEvaluator> &featureEvaluator, double& weight);
 
     int runAt( Ptr<FeatureEvaluator>& feval, Point pt, int scaleIdx, double& weight );
+    bool canRunRows() const;
+    void runRow( Ptr<FeatureEvaluator>& feval, int y, int scaleIdx, int xstep, int nwindows,
+                 int* results, double* weights );
 
     class Data
     {
@@ -214,6 +228,8 @@ protected:
 
     Data data;
     Ptr<FeatureEvaluator> featureEvaluator;
+    // the evaluators of the images of a batch, kept for the next batch
+    std::vector<Ptr<FeatureEvaluator> > imageEvaluators;
     Ptr<CvHaarClassifierCascade> oldCascade;
 
     Ptr<MaskGenerator> maskGenerator;
@@ -315,6 +331,31 @@ protected:
 
 #define CALC_SUM_OFS(rect, ptr) CALC_SUM_OFS_((rect)[0], (rect)[1], (rect)[2], (rect)[3], ptr)
 
+#if CV_SIMD128
+// the ways of loading the values at the same offset of 4 windows of a row
+enum { CASCADE_LOAD_GATHER = 0, CASCADE_LOAD_DENSE = 1, CASCADE_LOAD_DENSE2 = 2 };
+
+// the values at the offset ofs of the 4 windows that are wofs[0..3] elements away from p:
+// the neighbour windows and the windows 2 pixels apart are loaded without gathering
+template<int mode> inline v_int32x4 cascadeLoad4( const int* p, int ofs, const int* wofs )
+{
+    p += ofs;
+    if( mode == CASCADE_LOAD_DENSE )
+        return v_load(p + wofs[0]);
+    if( mode == CASCADE_LOAD_DENSE2 )
+    {
+        v_float32x4 a, b;
+        v_load_deinterleave((const float*)(p + wofs[0]), a, b);
+        return v_reinterpret_as_s32(a);
+    }
+    return v_int32x4(p[wofs[0]], p[wofs[1]], p[wofs[2]], p[wofs[3]]);
+}
+
+#define CALC_SUM4_OFS(rect, p, wofs) \
+(cascadeLoad4<mode>(p, (rect)[0], wofs) - cascadeLoad4<mode>(p, (rect)[1], wofs) - \
+ cascadeLoad4<mode>(p, (rect)[2], wofs) + cascadeLoad4<mode>(p, (rect)[3], wofs))
+#endif
+
 //----------------------------------------------  HaarEvaluator ---------------------------------------
 class HaarEvaluator : public FeatureEvaluator
 {
@@ -340,6 +381,9 @@ public:
 
         enum { RECT_NUM = Feature::RECT_NUM };
         float calc( const int* pwin ) const;
+#if CV_SIMD128
+        template<int mode> v_float32x4 calc4( const int* p, const int* wofs ) const;
+#endif
         void setOffsets( const Feature& _f, int step, int tofs );
 
         int ofs[RECT_NUM][4];
@@ -351,6 +395,7 @@ public:
 
     virtual bool read( const FileNode& node, Size origWinSize);
     virtual Ptr<FeatureEvaluator> clone() const;
+    virtual Ptr<FeatureEvaluator> cloneForImage() const;
     virtual int getFeatureType() const { return FeatureEvaluator::HAAR; }
 
     virtual bool setWindow(Point p, int scaleIdx);
@@ -362,6 +407,16 @@ public:
     virtual float calcOrd(int featureIdx) const
     { return (*this)(featureIdx); }
 
+    // the evaluation of the windows of a row, see CascadeClassifierImpl::runRow()
+    const int* setRow(int y, int scaleIdx) const;
+    bool calcNormFactor(const int* p, float& nf) const;
+    float calcOrd(int featureIdx, const int* p, float nf) const
+    { return optfeaturesPtr[featureIdx].calc(p) * nf; }
+#if CV_SIMD128
+    template<int mode> v_float32x4 calcOrd4(int featureIdx, const int* p, const int* wofs, const v_float32x4& nf) const
+    { return optfeaturesPtr[featureIdx].calc4<mode>(p, wofs) * nf; }
+#endif
+
 protected:
     virtual void computeChannels( int i, InputArray img );
     virtual void computeOptFeatures();
@@ -406,6 +461,19 @@ inline float HaarEvaluator::OptFeature :: calc( const int* ptr ) const
     return ret;
 }
 
+#if CV_SIMD128
+template<int mode> inline v_float32x4 HaarEvaluator::OptFeature :: calc4( const int* p, const int* wofs ) const
+{
+    v_float32x4 ret = v_cvt_f32(CALC_SUM4_OFS(ofs[0], p, wofs)) * v_setall_f32(weight[0]) +
+                      v_cvt_f32(CALC_SUM4_OFS(ofs[1], p, wofs)) * v_setall_f32(weight[1]);
+
+    if( weight[2] != 0.0f )
+        ret += v_cvt_f32(CALC_SUM4_OFS(ofs[2], p, wofs)) * v_setall_f32(weight[2]);
+
+    return ret;
+}
+#endif
+
 //----------------------------------------------  LBPEvaluator -------------------------------------
 
 class LBPEvaluator : public FeatureEvaluator
@@ -427,6 +495,9 @@ public:
         OptFeature();
 
         int calc( const int* pwin ) const;
+#if CV_SIMD128
+        template<int mode> v_int32x4 calc4( const int* p, const int* wofs ) const;
+#endif
         void setOffsets( const Feature& _f, int step );
         int ofs[16];
     };
@@ -436,6 +507,7 @@ public:
 
     virtual bool read( const FileNode& node, Size origWinSize );
     virtual Ptr<FeatureEvaluator> clone() const;
+    virtual Ptr<FeatureEvaluator> cloneForImage() const;
     virtual int getFeatureType() const { return FeatureEvaluator::LBP; }
 
     virtual bool setWindow(Point p, int scaleIdx);
@@ -444,6 +516,15 @@ public:
     { return optfeaturesPtr[featureIdx].calc(pwin); }
     virtual int calcCat(int featureIdx) const
     { return (*this)(featureIdx); }
+
+    // the evaluation of the windows of a row, see CascadeClassifierImpl::runRow()
+    const int* setRow(int y, int scaleIdx) const;
+    int calcCat(int featureIdx, const int* p) const
+    { return optfeaturesPtr[featureIdx].calc(p); }
+#if CV_SIMD128
+    template<int mode> v_int32x4 calcCat4(int featureIdx, const int* p, const int* wofs) const
+    { return optfeaturesPtr[featureIdx].calc4<mode>(p, wofs); }
+#endif
 protected:
     virtual void computeChannels( int i, InputArray img );
     virtual void computeOptFeatures();
@@ -482,6 +563,26 @@ inline int LBPEvaluator::OptFeature :: calc( const int* p ) const
            (CALC_SUM_OFS_( ofs[4], ofs[5], ofs[8], ofs[9], p ) >= cval ? 1 : 0);
 }
 
+#if CV_SIMD128
+template<int mode> inline v_int32x4 LBPEvaluator::OptFeature :: calc4( const int* p, const int* wofs ) const
+{
+    v_int32x4 v[16];
+    for( int i = 0; i < 16; i++ )
+        v[i] = cascadeLoad4<mode>( p, ofs[i], wofs );
+
+    v_int32x4 cval = v[5] - v[6] - v[9] + v[10];
+
+    return ((v[0] - v[1] - v[4] + v[5] >= cval) & v_setall_s32(128)) |
+           ((v[1] - v[2] - v[5] + v[6] >= cval) & v_setall_s32(64)) |
+           ((v[2] - v[3] - v[6] + v[7] >= cval) & v_setall_s32(32)) |
+           ((v[6] - v[7] - v[10] + v[11] >= cval) & v_setall_s32(16)) |
+           ((v[10] - v[11] - v[14] + v[15] >= cval) & v_setall_s32(8)) |
+           ((v[9] - v[10] - v[13] + v[14] >= cval) & v_setall_s32(4)) |
+           ((v[8] - v[9] - v[12] + v[13] >= cval) & v_setall_s32(2)) |
+           ((v[4] - v[5] - v[8] + v[9] >= cval) & v_setall_s32(1));
+}
+#endif
+
 
 //----------------------------------------------  predictor functions -------------------------------------
 
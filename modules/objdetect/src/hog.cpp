@@ -603,6 +603,42 @@ struct HOGCache
     const HOGDescriptor* descriptor;
 };
 
+// computes the gradient of the padded image in bands of rows; computeGradient takes
+// the rows around the ROI from the parent image, so the bands are seamless
+class HOGGradientInvoker :
+    public ParallelLoopBody
+{
+public:
+    enum { BAND = 32 };
+
+    HOGGradientInvoker( const HOGDescriptor* _descriptor, const Mat& _img, Mat& _grad, Mat& _qangle,
+                        const Size& _paddingTL, const Size& _paddingBR ) :
+        descriptor(_descriptor), img(&_img), grad(&_grad), qangle(&_qangle),
+        paddingTL(_paddingTL), paddingBR(_paddingBR)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        // the first and the last band take the top and the bottom padding
+        int r0 = range.start*BAND, r1 = std::min(range.end*BAND, img->rows);
+        int padTop = r0 == 0 ? paddingTL.height : 0;
+        int padBottom = r1 == img->rows ? paddingBR.height : 0;
+        int y0 = r0 + paddingTL.height - padTop, y1 = r1 + paddingTL.height + padBottom;
+
+        Mat gradBand = grad->rowRange(y0, y1), qangleBand = qangle->rowRange(y0, y1);
+        descriptor->computeGradient(img->rowRange(r0, r1), gradBand, qangleBand,
+                                    Size(paddingTL.width, padTop), Size(paddingBR.width, padBottom));
+    }
+
+private:
+    const HOGDescriptor* descriptor;
+    const Mat* img;
+    Mat* grad;
+    Mat* qangle;
+    Size paddingTL, paddingBR;
+};
+
 HOGCache::HOGCache() :
     blockHistogramSize(), count1(), count2(), count4()
 {
@@ -625,7 +661,12 @@ void HOGCache::init(const HOGDescriptor* _descriptor,
     cacheStride = _cacheStride;
     useCache = _useCache;
 
-    descriptor->computeGradient(_img, grad, qangle, _paddingTL, _paddingBR);
+    Size gradSize(_img.cols + _paddingTL.width + _paddingBR.width,
+                  _img.rows + _paddingTL.height + _paddingBR.height);
+    grad.create(gradSize, CV_32FC2);
+    qangle.create(gradSize, CV_8UC2);
+    parallel_for_(Range(0, (_img.rows + HOGGradientInvoker::BAND - 1)/HOGGradientInvoker::BAND),
+                  HOGGradientInvoker(descriptor, _img, grad, qangle, _paddingTL, _paddingBR));
     imgoffset = _paddingTL;
 
     winSize = descriptor->winSize;
@@ -1653,6 +1694,139 @@ void HOGDescriptor::compute(InputArray _img, std::vector<float>& descriptors,
     }
 }
 
+// adds the dot product of a block histogram and the corresponding part of the SVM detector to s
+static inline double addBlockScore(double s, const float* vec, const float* svmVec, int blockHistogramSize)
+{
+    int k;
+#if CV_SSE2
+    float partSum[4];
+    __m128 _vec = _mm_loadu_ps(vec);
+    __m128 _svmVec = _mm_loadu_ps(svmVec);
+    __m128 sum = _mm_mul_ps(_svmVec, _vec);
+
+    for( k = 4; k <= blockHistogramSize - 4; k += 4 )
+    {
+        _vec = _mm_loadu_ps(vec + k);
+        _svmVec = _mm_loadu_ps(svmVec + k);
+
+        sum = _mm_add_ps(sum, _mm_mul_ps(_vec, _svmVec));
+    }
+
+    _mm_storeu_ps(partSum, sum);
+    double t0 = partSum[0] + partSum[1];
+    double t1 = partSum[2] + partSum[3];
+    s += t0 + t1;
+#elif CV_NEON
+    float partSum[4];
+    float32x4_t _vec = vld1q_f32(vec);
+    float32x4_t _svmVec = vld1q_f32(svmVec);
+    float32x4_t sum = vmulq_f32(_svmVec, _vec);
+
+    for( k = 4; k <= blockHistogramSize - 4; k += 4 )
+    {
+        _vec = vld1q_f32(vec + k);
+        _svmVec = vld1q_f32(svmVec + k);
+
+        sum = vaddq_f32(sum, vmulq_f32(_vec, _svmVec));
+    }
+
+    vst1q_f32(partSum, sum);
+    double t0 = partSum[0] + partSum[1];
+    double t1 = partSum[2] + partSum[3];
+    s += t0 + t1;
+#else
+    for( k = 0; k <= blockHistogramSize - 4; k += 4 )
+        s += vec[k]*svmVec[k] + vec[k+1]*svmVec[k+1] +
+            vec[k+2]*svmVec[k+2] + vec[k+3]*svmVec[k+3];
+#endif
+    for( ; k < blockHistogramSize; k++ )
+        s += vec[k]*svmVec[k];
+    return s;
+}
+
+// computes the normalized block histograms at all the block positions
+// of the detection windows of the image, a row of the positions at a time
+class HOGBlockMapInvoker :
+    public ParallelLoopBody
+{
+public:
+    HOGBlockMapInvoker( HOGCache* _cache, Mat& _blockMap, const Size& _cacheStride, const Size& _padding ) :
+        cache(_cache), blockMap(&_blockMap), cacheStride(_cacheStride), padding(_padding)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int ncols = blockMap->cols/cache->blockHistogramSize;
+        for( int y = range.start; y < range.end; y++ )
+        {
+            float* dst = blockMap->ptr<float>(y);
+            for( int x = 0; x < ncols; x++, dst += cache->blockHistogramSize )
+                cache->getBlock(Point(x*cacheStride.width - padding.width, y*cacheStride.height - padding.height), dst);
+        }
+    }
+
+private:
+    HOGCache* cache;
+    Mat* blockMap;
+    Size cacheStride, padding;
+};
+
+// scores the detection windows by the correlation of the block map with the SVM detector,
+// a row of the windows at a time
+class HOGScoreInvoker :
+    public ParallelLoopBody
+{
+public:
+    HOGScoreInvoker( const Mat& _blockMap, const std::vector<Point>& _blockOfs, const float* _svmVec, double _rho,
+                     double _hitThreshold, int _blockHistogramSize, const Size& _nwindows, const Size& _winStride,
+                     const Size& _cacheStride, const Size& _padding,
+                     std::vector<std::vector<Point> >& _hits, std::vector<std::vector<double> >& _weights ) :
+        blockMap(&_blockMap), blockOfs(&_blockOfs), svmVec(_svmVec), rho(_rho), hitThreshold(_hitThreshold),
+        blockHistogramSize(_blockHistogramSize), nwindows(_nwindows), winStride(_winStride),
+        cacheStride(_cacheStride), padding(_padding), hits(&_hits), weights(&_weights)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int nblocks = (int)blockOfs->size();
+        const Point* ofs = &(*blockOfs)[0];
+        int mapStep = (int)(blockMap->step/sizeof(float));
+        int dx = winStride.width/cacheStride.width, dy = winStride.height/cacheStride.height;
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            std::vector<Point>& rowHits = (*hits)[y];
+            std::vector<double>& rowWeights = (*weights)[y];
+            for( int x = 0; x < nwindows.width; x++ )
+            {
+                const float* map0 = blockMap->ptr<float>(y*dy) + x*dx*blockHistogramSize;
+                const float* svm = svmVec;
+                double s = rho;
+                for( int j = 0; j < nblocks; j++, svm += blockHistogramSize )
+                    s = addBlockScore(s, map0 + ofs[j].y*mapStep + ofs[j].x*blockHistogramSize, svm, blockHistogramSize);
+
+                if( s >= hitThreshold )
+                {
+                    rowHits.push_back(Point(x*winStride.width - padding.width, y*winStride.height - padding.height));
+                    rowWeights.push_back(s);
+                }
+            }
+        }
+    }
+
+private:
+    const Mat* blockMap;
+    const std::vector<Point>* blockOfs;
+    const float* svmVec;
+    double rho, hitThreshold;
+    int blockHistogramSize;
+    Size nwindows, winStride, cacheStride, padding;
+    std::vector<std::vector<Point> >* hits;
+    std::vector<std::vector<double> >* weights;
+};
+
 void HOGDescriptor::detect(const Mat& img,
     std::vector<Point>& hits, std::vector<double>& weights, double hitThreshold,
     Size winStride, Size padding, const std::vector<Point>& locations) const
@@ -1674,11 +1848,7 @@ void HOGDescriptor::detect(const Mat& img,
     padding.height = (int)alignSize(std::max(padding.height, 0), cacheStride.height);
     Size paddedImgSize(img.cols + padding.width*2, img.rows + padding.height*2);
 
-    HOGCache cache(this, img, padding, padding, nwindows == 0, cacheStride);
-
-    if( !nwindows )
-        nwindows = cache.windowsInImage(paddedImgSize, winStride).area();
-
+    HOGCache cache(this, img, padding, padding, false, cacheStride);
     const HOGCache::BlockData* blockData = &cache.blockData[0];
 
     int nblocks = cache.nblocks.area();
@@ -1686,78 +1856,59 @@ void HOGDescriptor::detect(const Mat& img,
     size_t dsize = getDescriptorSize();
 
     double rho = svmDetector.size() > dsize ? svmDetector[dsize] : 0;
-    std::vector<float> blockHist(blockHistogramSize);
-
-#if CV_SSE2 || CV_NEON
-    float partSum[4];
-#endif
 
-    for( size_t i = 0; i < nwindows; i++ )
+    if( !nwindows )
     {
-        Point pt0;
-        if( !locations.empty() )
-        {
-            pt0 = locations[i];
-            if( pt0.x < -padding.width || pt0.x > img.cols + padding.width - winSize.width ||
-                    pt0.y < -padding.height || pt0.y > img.rows + padding.height - winSize.height )
-                continue;
-        }
-        else
+        // all the windows of the image: the normalized histograms of the blocks they share are
+        // computed once, as a map on the grid of cacheStride, and the windows are scored by
+        // the correlation of the map with the detector
+        Size nwin = cache.windowsInImage(paddedImgSize, winStride);
+        if( nwin.width <= 0 || nwin.height <= 0 )
+            return;
+
+        Size mapSize(((nwin.width - 1)*winStride.width + winSize.width - blockSize.width)/cacheStride.width + 1,
+                     ((nwin.height - 1)*winStride.height + winSize.height - blockSize.height)/cacheStride.height + 1);
+        Mat blockMap(mapSize.height, mapSize.width*blockHistogramSize, CV_32F);
+        parallel_for_(Range(0, mapSize.height), HOGBlockMapInvoker(&cache, blockMap, cacheStride, padding));
+
+        std::vector<Point> blockOfs(nblocks);
+        for( int j = 0; j < nblocks; j++ )
+            blockOfs[j] = Point(blockData[j].imgOffset.x/cacheStride.width,
+                                blockData[j].imgOffset.y/cacheStride.height);
+
+        std::vector<std::vector<Point> > rowHits(nwin.height);
+        std::vector<std::vector<double> > rowWeights(nwin.height);
+        parallel_for_(Range(0, nwin.height),
+                      HOGScoreInvoker(blockMap, blockOfs, &svmDetector[0], rho, hitThreshold, blockHistogramSize,
+                                      nwin, winStride, cacheStride, padding, rowHits, rowWeights));
+
+        for( int y = 0; y < nwin.height; y++ )
         {
-            pt0 = cache.getWindow(paddedImgSize, winStride, (int)i).tl() - Point(padding);
-            CV_Assert(pt0.x % cacheStride.width == 0 && pt0.y % cacheStride.height == 0);
+            hits.insert(hits.end(), rowHits[y].begin(), rowHits[y].end());
+            weights.insert(weights.end(), rowWeights[y].begin(), rowWeights[y].end());
         }
+        return;
+    }
+
+    std::vector<float> blockHist(blockHistogramSize);
+
+    for( size_t i = 0; i < nwindows; i++ )
+    {
+        Point pt0 = locations[i];
+        if( pt0.x < -padding.width || pt0.x > img.cols + padding.width - winSize.width ||
+                pt0.y < -padding.height || pt0.y > img.rows + padding.height - winSize.height )
+            continue;
+
         double s = rho;
         const float* svmVec = &svmDetector[0];
 
-        int j, k;
-        for( j = 0; j < nblocks; j++, svmVec += blockHistogramSize )
+        for( int j = 0; j < nblocks; j++, svmVec += blockHistogramSize )
         {
             const HOGCache::BlockData& bj = blockData[j];
             Point pt = pt0 + bj.imgOffset;
 
             const float* vec = cache.getBlock(pt, &blockHist[0]);
-#if CV_SSE2
-            __m128 _vec = _mm_loadu_ps(vec);
-            __m128 _svmVec = _mm_loadu_ps(svmVec);
-            __m128 sum = _mm_mul_ps(_svmVec, _vec);
-
-            for( k = 4; k <= blockHistogramSize - 4; k += 4 )
-            {
-                _vec = _mm_loadu_ps(vec + k);
-                _svmVec = _mm_loadu_ps(svmVec + k);
-
-                sum = _mm_add_ps(sum, _mm_mul_ps(_vec, _svmVec));
-            }
-
-            _mm_storeu_ps(partSum, sum);
-            double t0 = partSum[0] + partSum[1];
-            double t1 = partSum[2] + partSum[3];
-            s += t0 + t1;
-#elif CV_NEON
-            float32x4_t _vec = vld1q_f32(vec);
-            float32x4_t _svmVec = vld1q_f32(svmVec);
-            float32x4_t sum = vmulq_f32(_svmVec, _vec);
-
-            for( k = 4; k <= blockHistogramSize - 4; k += 4 )
-            {
-                _vec = vld1q_f32(vec + k);
-                _svmVec = vld1q_f32(svmVec + k);
-
-                sum = vaddq_f32(sum, vmulq_f32(_vec, _svmVec));
-            }
-
-            vst1q_f32(partSum, sum);
-            double t0 = partSum[0] + partSum[1];
-            double t1 = partSum[2] + partSum[3];
-            s += t0 + t1;
-#else
-            for( k = 0; k <= blockHistogramSize - 4; k += 4 )
-                s += vec[k]*svmVec[k] + vec[k+1]*svmVec[k+1] +
-                    vec[k+2]*svmVec[k+2] + vec[k+3]*svmVec[k+3];
-#endif
-            for( ; k < blockHistogramSize; k++ )
-                s += vec[k]*svmVec[k];
+            s = addBlockScore(s, vec, svmVec, blockHistogramSize);
         }
         if( s >= hitThreshold )
         {
@@ -2049,18 +2200,12 @@ static bool ocl_detectMultiScale(InputArray _img, std::vector<Rect> &found_locat
 }
 #endif //HAVE_OPENCL
 
-void HOGDescriptor::detectMultiScale(
-    InputArray _img, std::vector<Rect>& foundLocations, std::vector<double>& foundWeights,
-    double hitThreshold, Size winStride, Size padding,
-    double scale0, double finalThreshold, bool useMeanshiftGrouping) const
+static void getLevelScales(Size imgSize, Size winSize, int nlevels, double scale0, std::vector<double>& levelScale)
 {
-    CV_INSTRUMENT_REGION()
-
     double scale = 1.;
     int levels = 0;
 
-    Size imgSize = _img.size();
-    std::vector<double> levelScale;
+    levelScale.clear();
     for( levels = 0; levels < nlevels; levels++ )
     {
         levelScale.push_back(scale);
@@ -2072,6 +2217,18 @@ void HOGDescriptor::detectMultiScale(
     }
     levels = std::max(levels, 1);
     levelScale.resize(levels);
+}
+
+void HOGDescriptor::detectMultiScale(
+    InputArray _img, std::vector<Rect>& foundLocations, std::vector<double>& foundWeights,
+    double hitThreshold, Size winStride, Size padding,
+    double scale0, double finalThreshold, bool useMeanshiftGrouping) const
+{
+    CV_INSTRUMENT_REGION()
+
+    Size imgSize = _img.size();
+    std::vector<double> levelScale;
+    getLevelScales(imgSize, winSize, nlevels, scale0, levelScale);
 
     if(winStride == Size())
         winStride = blockStride;
@@ -2090,7 +2247,9 @@ void HOGDescriptor::detectMultiScale(
     Mat img = _img.getMat();
     Range range(0, (int)levelScale.size());
     HOGInvoker invoker(this, img, hitThreshold, winStride, padding, &levelScale[0], &allCandidates, &mtx, &tempWeights, &tempScales);
-    parallel_for_(range, invoker);
+    // the levels are processed one by one, each of them in parallel by detect(),
+    // so that the largest levels do not take the whole time of a single thread
+    invoker(range);
 
     std::copy(tempScales.begin(), tempScales.end(), back_inserter(foundScales));
     foundLocations.clear();
@@ -2116,6 +2275,98 @@ void HOGDescriptor::detectMultiScale(InputArray img, std::vector<Rect>& foundLoc
                 padding, scale0, finalThreshold, useMeanshiftGrouping);
 }
 
+// runs the detection of the (image, level) pairs of a batch, each of them with its own invoker
+class HOGBatchInvoker :
+    public ParallelLoopBody
+{
+public:
+    HOGBatchInvoker( const std::vector<HOGInvoker>& _invokers, const std::vector<int>& _levels ) :
+        invokers(&_invokers), levels(&_levels)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int level = (*levels)[i];
+            (*invokers)[i](Range(level, level + 1));
+        }
+    }
+
+private:
+    const std::vector<HOGInvoker>* invokers;
+    const std::vector<int>* levels;
+};
+
+void HOGDescriptor::detectMultiScale(
+    InputArrayOfArrays _imgs, std::vector<std::vector<Rect> >& foundLocations,
+    std::vector<std::vector<double> >& foundWeights, double hitThreshold, Size winStride, Size padding,
+    double scale0, double finalThreshold, bool useMeanshiftGrouping) const
+{
+    CV_INSTRUMENT_REGION()
+
+    std::vector<Mat> imgs;
+    _imgs.getMatVector(imgs);
+    int i, k, nimgs = (int)imgs.size();
+
+    if(winStride == Size())
+        winStride = blockStride;
+
+    std::vector<std::vector<double> > levelScales(nimgs);
+    int maxLevels = 0;
+    for( i = 0; i < nimgs; i++ )
+    {
+        getLevelScales(imgs[i].size(), winSize, nlevels, scale0, levelScales[i]);
+        maxLevels = std::max(maxLevels, (int)levelScales[i].size());
+    }
+
+    // the (image, level) pairs go from the largest levels to the smallest ones, for the load balance;
+    // each pair gets its own output, so that the candidates of an image are in the same order as in
+    // detectMultiScale() for the image alone
+    std::vector<HOGInvoker> invokers;
+    std::vector<int> itemImgs, itemLevels;
+    for( k = 0; k < maxLevels; k++ )
+        for( i = 0; i < nimgs; i++ )
+            if( k < (int)levelScales[i].size() )
+            {
+                itemImgs.push_back(i);
+                itemLevels.push_back(k);
+            }
+
+    int nitems = (int)itemImgs.size();
+    std::vector<std::vector<Rect> > itemCandidates(nitems);
+    std::vector<std::vector<double> > itemWeights(nitems), itemScales(nitems);
+    Mutex mtx;
+    for( k = 0; k < nitems; k++ )
+    {
+        i = itemImgs[k];
+        invokers.push_back(HOGInvoker(this, imgs[i], hitThreshold, winStride, padding, &levelScales[i][0],
+                                      &itemCandidates[k], &mtx, &itemWeights[k], &itemScales[k]));
+    }
+    parallel_for_(Range(0, nitems), HOGBatchInvoker(invokers, itemLevels));
+
+    foundLocations.assign(nimgs, std::vector<Rect>());
+    foundWeights.assign(nimgs, std::vector<double>());
+    std::vector<std::vector<double> > foundScales(nimgs);
+    for( k = 0; k < nitems; k++ )
+    {
+        i = itemImgs[k];
+        foundLocations[i].insert(foundLocations[i].end(), itemCandidates[k].begin(), itemCandidates[k].end());
+        foundWeights[i].insert(foundWeights[i].end(), itemWeights[k].begin(), itemWeights[k].end());
+        foundScales[i].insert(foundScales[i].end(), itemScales[k].begin(), itemScales[k].end());
+    }
+
+    for( i = 0; i < nimgs; i++ )
+    {
+        if ( useMeanshiftGrouping )
+            groupRectangles_meanshift(foundLocations[i], foundWeights[i], foundScales[i], finalThreshold, winSize);
+        else
+            groupRectangles(foundLocations[i], foundWeights[i], (int)finalThreshold, 0.2);
+        clipObjects(imgs[i].size(), foundLocations[i], 0, &foundWeights[i]);
+    }
+}
+
 template<typename _ClsName> struct RTTIImpl
 {
 public:
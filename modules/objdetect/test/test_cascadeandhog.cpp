@@ -1386,3 +1386,206 @@ TEST(Objdetect_CascadeDetector, small_img)
         }
     }
 }
+
+TEST(Objdetect_HOGDetector, dense_same_as_locations)
+{
+    Mat img(240, 180, CV_8U);
+    RNG rng(12345);
+    rng.fill(img, RNG::UNIFORM, 0, 256);
+    GaussianBlur(img, img, Size(5, 5), 1.5);
+
+    HOGDescriptor hog;
+    hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+
+    Size winStride(8, 8), padding(16, 16);
+    vector<Point> hits, hits0;
+    vector<double> weights, weights0;
+    hog.detect(img, hits, weights, -DBL_MAX, winStride, padding);
+
+    vector<Point> locations;
+    for( int y = -padding.height; y <= img.rows + padding.height - hog.winSize.height; y += winStride.height )
+        for( int x = -padding.width; x <= img.cols + padding.width - hog.winSize.width; x += winStride.width )
+            locations.push_back(Point(x, y));
+    hog.detect(img, hits0, weights0, -DBL_MAX, winStride, padding, locations);
+
+    ASSERT_EQ(locations.size(), hits.size());
+    ASSERT_EQ(hits0.size(), hits.size());
+    ASSERT_EQ(weights0.size(), weights.size());
+    for( size_t i = 0; i < hits.size(); i++ )
+    {
+        EXPECT_EQ(hits0[i], hits[i]);
+        EXPECT_EQ(weights0[i], weights[i]);
+    }
+}
+
+TEST(Objdetect_HOGDetector, detectMultiScale_threads)
+{
+    Mat img(360, 280, CV_8U);
+    RNG rng(12345);
+    rng.fill(img, RNG::UNIFORM, 0, 256);
+    GaussianBlur(img, img, Size(7, 7), 2);
+
+    HOGDescriptor hog;
+    hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+
+    int n = getNumThreads();
+    vector<Rect> found0, found;
+    vector<double> weights0, weights;
+
+    setNumThreads(1);
+    hog.detectMultiScale(img, found0, weights0, -2, Size(8, 8), Size(16, 16), 1.05, 0);
+    setNumThreads(std::max(n, 4));
+    hog.detectMultiScale(img, found, weights, -2, Size(8, 8), Size(16, 16), 1.05, 0);
+    setNumThreads(n);
+
+    EXPECT_FALSE(found0.empty());
+    ASSERT_EQ(found0.size(), found.size());
+    ASSERT_EQ(weights0.size(), weights.size());
+    for( size_t i = 0; i < found.size(); i++ )
+    {
+        EXPECT_EQ(found0[i], found[i]);
+        EXPECT_EQ(weights0[i], weights[i]);
+    }
+}
+
+static bool rectLess( const Rect& a, const Rect& b )
+{
+    if( a.x != b.x ) return a.x < b.x;
+    if( a.y != b.y ) return a.y < b.y;
+    if( a.width != b.width ) return a.width < b.width;
+    return a.height < b.height;
+}
+
+static bool pairRectLess( const pair<Rect, double>& a, const pair<Rect, double>& b )
+{
+    if( a.first != b.first ) return rectLess(a.first, b.first);
+    return a.second < b.second;
+}
+
+TEST(Objdetect_CascadeDetector, threads)
+{
+    String root = cvtest::TS::ptr()->get_data_path() + "cascadeandhog/cascades/";
+    String cascades[] =
+    {
+        root + "haarcascade_frontalface_alt.xml",
+        root + "lbpcascade_frontalface.xml",
+        String()
+    };
+
+    Mat img = imread(cvtest::TS::ptr()->get_data_path() + "shared/lena.png", IMREAD_GRAYSCALE);
+    ASSERT_FALSE(img.empty());
+
+    int n = getNumThreads();
+    for( int i = 0; !cascades[i].empty(); i++ )
+    {
+        CascadeClassifier cascade(cascades[i]);
+        ASSERT_FALSE(cascade.empty());
+
+        vector<Rect> objects0, objects;
+        vector<int> levels0, levels;
+        vector<double> weights0, weights;
+
+        setNumThreads(1);
+        cascade.detectMultiScale(img, objects0, levels0, weights0, 1.1, 0, 0, Size(), Size(), true);
+        setNumThreads(std::max(n, 4));
+        cascade.detectMultiScale(img, objects, levels, weights, 1.1, 0, 0, Size(), Size(), true);
+        setNumThreads(n);
+
+        // the candidates come from the stripes in any order
+        vector<pair<Rect, double> > found0, found;
+        for( size_t j = 0; j < objects0.size(); j++ )
+            found0.push_back(std::make_pair(objects0[j], weights0[j]));
+        for( size_t j = 0; j < objects.size(); j++ )
+            found.push_back(std::make_pair(objects[j], weights[j]));
+        std::sort(found0.begin(), found0.end(), pairRectLess);
+        std::sort(found.begin(), found.end(), pairRectLess);
+
+        EXPECT_FALSE(found0.empty());
+        ASSERT_EQ(found0.size(), found.size());
+        for( size_t j = 0; j < found.size(); j++ )
+        {
+            EXPECT_EQ(found0[j].first, found[j].first);
+            EXPECT_EQ(found0[j].second, found[j].second);
+        }
+    }
+}
+
+TEST(Objdetect_CascadeDetector, batch)
+{
+    String root = cvtest::TS::ptr()->get_data_path() + "cascadeandhog/cascades/";
+    String cascades[] =
+    {
+        root + "haarcascade_frontalface_alt.xml",
+        root + "lbpcascade_frontalface.xml",
+        String()
+    };
+
+    Mat img = imread(cvtest::TS::ptr()->get_data_path() + "shared/lena.png");
+    ASSERT_FALSE(img.empty());
+
+    vector<Mat> images;
+    Mat gray, small;
+    cvtColor(img, gray, COLOR_BGR2GRAY);
+    resize(img, small, Size(), 0.6, 0.6);
+    images.push_back(img);
+    images.push_back(gray);
+    images.push_back(small);
+    images.push_back(img(Rect(10, 20, 300, 280)));
+
+    for( int i = 0; !cascades[i].empty(); i++ )
+    {
+        CascadeClassifier cascade(cascades[i]);
+        ASSERT_FALSE(cascade.empty());
+
+        // the second batch reuses the pyramids of the first one, the third one is smaller
+        for( int iter = 0; iter < 3; iter++ )
+        {
+            vector<Mat> batch(images.begin(), images.end() - (iter == 2 ? 2 : 0));
+            vector<vector<Rect> > objects;
+            cascade.detectMultiScale(batch, objects, 1.1, 3, 0, Size(30, 30));
+            ASSERT_EQ(batch.size(), objects.size());
+
+            for( size_t j = 0; j < batch.size(); j++ )
+            {
+                vector<Rect> objects0;
+                cascade.detectMultiScale(batch[j], objects0, 1.1, 3, 0, Size(30, 30));
+                std::sort(objects0.begin(), objects0.end(), rectLess);
+                std::sort(objects[j].begin(), objects[j].end(), rectLess);
+                EXPECT_EQ(objects0, objects[j]);
+            }
+        }
+    }
+}
+
+TEST(Objdetect_HOGDetector, detectMultiScale_batch)
+{
+    RNG rng(12345);
+    vector<Mat> imgs;
+    Size sizes[] = { Size(280, 360), Size(320, 240), Size(200, 200), Size(280, 360) };
+    for( int i = 0; i < 4; i++ )
+    {
+        Mat img(sizes[i], i == 1 ? CV_8UC3 : CV_8UC1);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        GaussianBlur(img, img, Size(7, 7), 2);
+        imgs.push_back(img);
+    }
+
+    HOGDescriptor hog;
+    hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+
+    vector<vector<Rect> > found;
+    vector<vector<double> > weights;
+    hog.detectMultiScale(imgs, found, weights, -2, Size(8, 8), Size(16, 16), 1.05, 0);
+    ASSERT_EQ(imgs.size(), found.size());
+    ASSERT_EQ(imgs.size(), weights.size());
+
+    for( size_t i = 0; i < imgs.size(); i++ )
+    {
+        vector<Rect> found0;
+        vector<double> weights0;
+        hog.detectMultiScale(imgs[i], found0, weights0, -2, Size(8, 8), Size(16, 16), 1.05, 0);
+        EXPECT_FALSE(found0.empty());
+        EXPECT_EQ(found0, found[i]);
+        EXPECT_EQ(weights0, weights[i]);
+    }
+}
@@ -381,6 +381,71 @@ public:
     Mat temp5;
 };
 
+/** @brief Batch of Kalman filters sharing the same model.
+
+The class runs many independent Kalman filters of the same dimensions, e.g. the tracks of a
+multi-object tracker, that share the transition, control, measurement and noise matrices. The
+computations are the same as in KalmanFilter, but all the filters, or a subset of them selected
+by a mask, are processed in one call.
+
+The states of the filters are stored in the structure-of-arrays layout: column i of every
+per-filter matrix belongs to filter i, so that several filters are processed at once with SIMD
+instructions. Element (r, c) of the covariance matrices of filter i is stored at
+errorCovPost.at<float>(r*dynamParams + c, i), element (r, c) of the gain at
+gain.at<float>(r*measureParams + c, i). All the matrices are CV_32F.
+
+The common small dimensions (constant velocity and constant acceleration models of 1D and 2D
+points and of the bounding boxes) have specialized implementations.
+ */
+class CV_EXPORTS_W BatchKalmanFilter
+{
+public:
+    /** @brief The constructors. */
+    CV_WRAP BatchKalmanFilter();
+    /** @overload
+    @param count Number of the filters.
+    @param dynamParams Dimensionality of the state.
+    @param measureParams Dimensionality of the measurement.
+    @param controlParams Dimensionality of the control vector.
+    */
+    CV_WRAP BatchKalmanFilter( int count, int dynamParams, int measureParams, int controlParams = 0 );
+
+    /** @brief Re-initializes the filters. The previous content is destroyed.
+
+    @param count Number of the filters.
+    @param dynamParams Dimensionality of the state.
+    @param measureParams Dimensionality of the measurement.
+    @param controlParams Dimensionality of the control vector.
+     */
+    void init( int count, int dynamParams, int measureParams, int controlParams = 0 );
+
+    /** @brief Computes the predicted states.
+
+    @param control The optional controls of the filters, controlParams x count matrix.
+    @param mask The optional 8-bit mask of count elements selecting the filters to update.
+     */
+    CV_WRAP void predict( InputArray control = noArray(), InputArray mask = noArray() );
+
+    /** @brief Updates the predicted states from the measurements.
+
+    @param measurements The measurements of the filters, measureParams x count matrix.
+    @param mask The optional 8-bit mask of count elements selecting the filters to update.
+     */
+    CV_WRAP void correct( InputArray measurements, InputArray mask = noArray() );
+
+    CV_PROP_RW Mat transitionMatrix;   //!< state transition matrix (A), shared
+    CV_PROP_RW Mat controlMatrix;      //!< control matrix (B), shared (not used if there is no control)
+    CV_PROP_RW Mat measurementMatrix;  //!< measurement matrix (H), shared
+    CV_PROP_RW Mat processNoiseCov;    //!< process noise covariance matrix (Q), shared
+    CV_PROP_RW Mat measurementNoiseCov;//!< measurement noise covariance matrix (R), shared
+
+    CV_PROP_RW Mat statePre;           //!< predicted states, dynamParams x count
+    CV_PROP_RW Mat statePost;          //!< corrected states, dynamParams x count
+    CV_PROP_RW Mat errorCovPre;        //!< priori error estimate covariance matrices, dynamParams^2 x count
+    CV_PROP_RW Mat gain;               //!< Kalman gain matrices, dynamParams*measureParams x count
+    CV_PROP_RW Mat errorCovPost;       //!< posteriori error estimate covariance matrices, dynamParams^2 x count
+};
+
 
 class CV_EXPORTS_W DenseOpticalFlow : public Algorithm
 {
@@ -585,6 +650,124 @@ public:
 };
 
 
+/** @brief DIS optical flow algorithm.
+
+The class implements the Dense Inverse Search (DIS) optical flow algorithm described in
+@cite Kroeger2016 . The flow is computed coarse-to-fine on the image pyramids built by
+buildOpticalFlowPyramid. On every scale:
+
+-   the flow of the overlapping square patches of the first image is found by the inverse
+    compositional gradient descent, starting from the flow of the coarser scale or of the
+    neighbouring patches, whichever matches better;
+-   the dense flow is computed as a weighted average of the flows of the patches covering
+    each pixel, the weights are inversely proportional to the matching error;
+-   optionally, the dense flow is refined by a few iterations of a variational method with
+    the brightness and gradient constancy data terms and a smoothness term.
+
+The computations stop at the finest scale, the result is upscaled to the original resolution.
+The patches are processed in parallel by stripes.
+
+The presets give reasonable trade-offs between the speed and the quality: PRESET_ULTRAFAST
+runs at more than 100 frames per second for VGA frames on a single modern CPU core.
+
+The input images should be 8-bit single-channel images.
+*/
+class CV_EXPORTS_W DISOpticalFlow : public DenseOpticalFlow
+{
+public:
+    enum
+    {
+        PRESET_ULTRAFAST = 0,
+        PRESET_FAST = 1,
+        PRESET_MEDIUM = 2
+    };
+
+    /** @brief Finest level of the Gaussian pyramid on which the flow is computed (zero level
+        corresponds to the original image resolution). The final flow is obtained by bilinear upscaling.
+        @see setFinestScale */
+    CV_WRAP virtual int getFinestScale() const = 0;
+    /** @copybrief getFinestScale @see getFinestScale */
+    CV_WRAP virtual void setFinestScale(int val) = 0;
+
+    /** @brief Size of an image patch for matching (in pixels). Normally, default 8x8 patches work well
+        enough in most cases.
+        @see setPatchSize */
+    CV_WRAP virtual int getPatchSize() const = 0;
+    /** @copybrief getPatchSize @see getPatchSize */
+    CV_WRAP virtual void setPatchSize(int val) = 0;
+
+    /** @brief Stride between neighbor patches. Must be less than patch size. Lower values correspond
+        to higher flow quality.
+        @see setPatchStride */
+    CV_WRAP virtual int getPatchStride() const = 0;
+    /** @copybrief getPatchStride @see getPatchStride */
+    CV_WRAP virtual void setPatchStride(int val) = 0;
+
+    /** @brief Maximum number of gradient descent iterations in the patch inverse search stage. Higher values
+        may improve quality in some cases.
+        @see setGradientDescentIterations */
+    CV_WRAP virtual int getGradientDescentIterations() const = 0;
+    /** @copybrief getGradientDescentIterations @see getGradientDescentIterations */
+    CV_WRAP virtual void setGradientDescentIterations(int val) = 0;
+
+    /** @brief Number of fixed point iterations of the variational refinement per scale. Set to zero to
+        disable the variational refinement completely. Higher values will typically result in more smooth and
+        high-quality flow.
+        @see setVariationalRefinementIterations */
+    CV_WRAP virtual int getVariationalRefinementIterations() const = 0;
+    /** @copybrief getVariationalRefinementIterations @see getVariationalRefinementIterations */
+    CV_WRAP virtual void setVariationalRefinementIterations(int val) = 0;
+
+    /** @brief Weight of the smoothness term of the variational refinement
+        @see setVariationalRefinementAlpha */
+    CV_WRAP virtual float getVariationalRefinementAlpha() const = 0;
+    /** @copybrief getVariationalRefinementAlpha @see getVariationalRefinementAlpha */
+    CV_WRAP virtual void setVariationalRefinementAlpha(float val) = 0;
+
+    /** @brief Weight of the color constancy term of the variational refinement
+        @see setVariationalRefinementDelta */
+    CV_WRAP virtual float getVariationalRefinementDelta() const = 0;
+    /** @copybrief getVariationalRefinementDelta @see getVariationalRefinementDelta */
+    CV_WRAP virtual void setVariationalRefinementDelta(float val) = 0;
+
+    /** @brief Weight of the gradient constancy term of the variational refinement
+        @see setVariationalRefinementGamma */
+    CV_WRAP virtual float getVariationalRefinementGamma() const = 0;
+    /** @copybrief getVariationalRefinementGamma @see getVariationalRefinementGamma */
+    CV_WRAP virtual void setVariationalRefinementGamma(float val) = 0;
+
+    /** @brief Whether to use mean-normalization of patches when computing patch distance. It is turned on
+        by default as it typically provides a noticeable quality boost because of increased robustness to
+        illumination variations. Turn it off if you are certain that your sequence doesn't contain any changes
+        in illumination.
+        @see setUseMeanNormalization */
+    CV_WRAP virtual bool getUseMeanNormalization() const = 0;
+    /** @copybrief getUseMeanNormalization @see getUseMeanNormalization */
+    CV_WRAP virtual void setUseMeanNormalization(bool val) = 0;
+
+    /** @brief Whether to use spatial propagation of good optical flow vectors. This option is turned on by
+        default, as it tends to work better on average and can sometimes help recover from major errors
+        introduced by the coarse-to-fine scheme employed by the DIS optical flow algorithm. Turning this
+        option off can make the output flow field a bit smoother, however.
+        @see setUseSpatialPropagation */
+    CV_WRAP virtual bool getUseSpatialPropagation() const = 0;
+    /** @copybrief getUseSpatialPropagation @see getUseSpatialPropagation */
+    CV_WRAP virtual void setUseSpatialPropagation(bool val) = 0;
+
+    //! @brief Use the flow passed to calc as the initial approximation
+    /** @see setUseInitialFlow */
+    CV_WRAP virtual bool getUseInitialFlow() const = 0;
+    /** @copybrief getUseInitialFlow @see getUseInitialFlow */
+    CV_WRAP virtual void setUseInitialFlow(bool val) = 0;
+
+    /** @brief Creates an instance of DISOpticalFlow
+
+    @param preset one of PRESET_ULTRAFAST, PRESET_FAST and PRESET_MEDIUM
+    */
+    CV_WRAP static Ptr<DISOpticalFlow> create(int preset = DISOpticalFlow::PRESET_FAST);
+};
+
+
 /** @brief Class used for calculating a sparse optical flow.
 
 The class can calculate an optical flow for a sparse feature set using the
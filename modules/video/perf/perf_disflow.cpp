@@ -0,0 +1,44 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(DISPreset, DISOpticalFlow::PRESET_ULTRAFAST, DISOpticalFlow::PRESET_FAST, DISOpticalFlow::PRESET_MEDIUM)
+
+typedef std::tr1::tuple<Size, DISPreset, int> Size_Preset_Threads_t;
+typedef perf::TestBaseWithParam<Size_Preset_Threads_t> Size_Preset_Threads;
+
+PERF_TEST_P(Size_Preset_Threads, DISOpticalFlow_calc,
+            testing::Combine(
+                testing::Values(szVGA, sz720p),
+                DISPreset::all(),
+                testing::Values(1, 2, 4, 8)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int preset = get<1>(GetParam());
+    int threads = get<2>(GetParam());
+
+    Mat frame0(sz, CV_8UC1), frame1, flow(sz, CV_32FC2);
+    declare.in(frame0, WARMUP_RNG);
+    GaussianBlur(frame0, frame0, Size(0, 0), 2.0);
+    Mat M = (Mat_<double>(2, 3) << 1, 0, 5.5, 0, 1, -3.25);
+    warpAffine(frame0, frame1, M, sz, INTER_LINEAR, BORDER_REFLECT);
+
+    Ptr<DISOpticalFlow> dis = DISOpticalFlow::create(preset);
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() dis->calc(frame0, frame1, flow);
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -0,0 +1,78 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// the constant velocity models of the points and of the bounding boxes
+typedef std::tr1::tuple<int, int, bool> Count_Dims_Batch_t;
+typedef perf::TestBaseWithParam<Count_Dims_Batch_t> Count_Dims_Batch;
+
+PERF_TEST_P(Count_Dims_Batch, KalmanFilter_predict_correct,
+            testing::Combine(
+                testing::Values(1000, 5000),
+                testing::Values(2, 4),
+                testing::Bool()
+                )
+            )
+{
+    int count = get<0>(GetParam());
+    int MP = get<1>(GetParam()), DP = MP*2;
+    bool batch = get<2>(GetParam());
+
+    Mat A = Mat::eye(DP, DP, CV_32F), H = Mat::zeros(MP, DP, CV_32F);
+    for( int i = 0; i < MP; i++ )
+    {
+        A.at<float>(i, i + MP) = 1.f;
+        H.at<float>(i, i) = 1.f;
+    }
+    Mat Q = Mat::eye(DP, DP, CV_32F)*1e-2, R = Mat::eye(MP, MP, CV_32F)*1e-1;
+    Mat z(MP, count, CV_32F);
+    declare.in(z, WARMUP_RNG);
+
+    if( batch )
+    {
+        BatchKalmanFilter kf(count, DP, MP);
+        A.copyTo(kf.transitionMatrix);
+        H.copyTo(kf.measurementMatrix);
+        Q.copyTo(kf.processNoiseCov);
+        R.copyTo(kf.measurementNoiseCov);
+
+        TEST_CYCLE()
+        {
+            kf.predict();
+            kf.correct(z);
+        }
+    }
+    else
+    {
+        vector<KalmanFilter> kfs(count);
+        vector<Mat> zs(count);
+        for( int i = 0; i < count; i++ )
+        {
+            kfs[i].init(DP, MP);
+            A.copyTo(kfs[i].transitionMatrix);
+            H.copyTo(kfs[i].measurementMatrix);
+            Q.copyTo(kfs[i].processNoiseCov);
+            R.copyTo(kfs[i].measurementNoiseCov);
+            zs[i] = z.col(i).clone();
+        }
+
+        TEST_CYCLE()
+        {
+            for( int i = 0; i < count; i++ )
+            {
+                kfs[i].predict();
+                kfs[i].correct(zs[i]);
+            }
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
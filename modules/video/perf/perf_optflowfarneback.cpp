@@ -0,0 +1,40 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, bool, int> Size_Gaussian_Threads_t;
+typedef perf::TestBaseWithParam<Size_Gaussian_Threads_t> Size_Gaussian_Threads;
+
+PERF_TEST_P(Size_Gaussian_Threads, calcOpticalFlowFarneback,
+            testing::Combine(
+                testing::Values(szVGA, sz720p),
+                testing::Bool(),
+                testing::Values(1, 2, 4, 8)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int flags = get<1>(GetParam()) ? OPTFLOW_FARNEBACK_GAUSSIAN : 0;
+    int threads = get<2>(GetParam());
+
+    Mat frame0(sz, CV_8UC1), frame1, flow(sz, CV_32FC2);
+    declare.in(frame0, WARMUP_RNG);
+    GaussianBlur(frame0, frame0, Size(0, 0), 2.0);
+    Mat M = (Mat_<double>(2, 3) << 1, 0, 1.5, 0, 1, -0.75);
+    warpAffine(frame0, frame1, M, sz, INTER_LINEAR, BORDER_REFLECT);
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() calcOpticalFlowFarneback(frame0, frame1, flow, 0.5, 5, 13, 10, 5, 1.1, flags);
+    setNumThreads(nthreads);
+
+    SANITY_CHECK_NOTHING();
+}
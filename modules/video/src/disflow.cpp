@@ -0,0 +1,757 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "opencv2/imgproc.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+//
+// Dense optical flow algorithm from the following paper:
+// Till Kroeger, Radu Timofte, Dengxin Dai and Luc Van Gool. "Fast Optical Flow using Dense Inverse Search".
+// Proceedings of the European Conference on Computer Vision (ECCV), 2016
+//
+
+namespace cv
+{
+namespace
+{
+
+// the patch rows searched sequentially, so that the good flow vectors can be propagated to the
+// neighbouring patches; the stripes do not depend on the number of threads, so that the result
+// does not depend on it either
+enum { DIS_STRIPE = 8 };
+
+// the pixel rows of the densification and of the variational refinement processed by one task
+enum { DIS_BAND = 16 };
+
+// the parameters of the robust penalizers of the variational refinement
+static const float DIS_EPS_SQUARED = 1e-6f;
+static const float DIS_ZETA_SQUARED = 1e-2f;
+static const float DIS_SOR_OMEGA = 1.6f;
+static const int DIS_SOR_ITERATIONS = 5;
+
+// the image data of a pyramid level
+struct DISLevel
+{
+    Mat I0, I0x, I0y;      // the first image and its gradients, CV_32F
+    Mat I1pad;             // the second image with the border of pad pixels, CV_32F
+    const float* I1;       // the origin of the second image
+    size_t step;           // the step of I1pad in floats
+    int pad;
+    Size size;
+};
+
+// the patches start at xs[j] and ys[i]; the last patches are aligned with the image borders
+static void getPatchGrid( int len, int ps, int stride, std::vector<int>& ofs )
+{
+    int n = (len - ps + stride - 1)/stride + 1;
+    ofs.resize(n);
+    for( int i = 0; i < n; i++ )
+        ofs[i] = std::min(i*stride, len - ps);
+}
+
+// Bilinearly warps the patch of the second image displaced by (u, v) and compares it with
+// the template. Returns the (mean-normalized) SSD and the steepest descent vector (bx, by).
+static float computePatchDiff( const DISLevel& lv, int ps, int x, int y, float u, float v,
+                               const float* T, const float* gx, const float* gy, bool meanNorm,
+                               float& bx, float& by )
+{
+    float px = std::min(std::max(x + u, (float)-lv.pad), (float)(lv.size.width + lv.pad - ps - 1));
+    float py = std::min(std::max(y + v, (float)-lv.pad), (float)(lv.size.height + lv.pad - ps - 1));
+    int ix = cvFloor(px), iy = cvFloor(py);
+    float fx = px - ix, fy = py - iy;
+    float w00 = (1.f - fx)*(1.f - fy), w01 = fx*(1.f - fy), w10 = (1.f - fx)*fy, w11 = fx*fy;
+    const float* src = lv.I1 + iy*lv.step + ix;
+    float sd = 0.f, sd2 = 0.f, sbx = 0.f, sby = 0.f;
+
+#if CV_SIMD128
+    v_float32x4 v_sd = v_setzero_f32(), v_sd2 = v_setzero_f32(), v_bx = v_setzero_f32(), v_by = v_setzero_f32();
+    v_float32x4 v_w00 = v_setall_f32(w00), v_w01 = v_setall_f32(w01);
+    v_float32x4 v_w10 = v_setall_f32(w10), v_w11 = v_setall_f32(w11);
+#endif
+    for( int r = 0; r < ps; r++ )
+    {
+        const float *a = src + r*lv.step, *b = a + lv.step;
+        const float *t = T + r*ps, *gxr = gx + r*ps, *gyr = gy + r*ps;
+        int c = 0;
+#if CV_SIMD128
+        for( ; c <= ps - 4; c += 4 )
+        {
+            v_float32x4 d = v_w00*v_load(a + c) + v_w01*v_load(a + c + 1) +
+                            v_w10*v_load(b + c) + v_w11*v_load(b + c + 1) - v_load(t + c);
+            v_sd += d;
+            v_sd2 += d*d;
+            v_bx += v_load(gxr + c)*d;
+            v_by += v_load(gyr + c)*d;
+        }
+#endif
+        for( ; c < ps; c++ )
+        {
+            float d = w00*a[c] + w01*a[c+1] + w10*b[c] + w11*b[c+1] - t[c];
+            sd += d;
+            sd2 += d*d;
+            sbx += gxr[c]*d;
+            sby += gyr[c]*d;
+        }
+    }
+#if CV_SIMD128
+    sd += v_reduce_sum(v_sd);
+    sd2 += v_reduce_sum(v_sd2);
+    sbx += v_reduce_sum(v_bx);
+    sby += v_reduce_sum(v_by);
+#endif
+
+    // the gradients are centered when the mean normalization is on, so the mean of the difference
+    // does not affect the descent vector
+    bx = sbx;
+    by = sby;
+    return meanNorm ? sd2 - sd*sd/(ps*ps) : sd2;
+}
+
+class PatchInverseSearchInvoker : public ParallelLoopBody
+{
+public:
+    PatchInverseSearchInvoker( const DISLevel& _lv, const Mat& _Ux, const Mat& _Uy, const std::vector<int>& _xs,
+                               const std::vector<int>& _ys, int _ps, int _niters, bool _meanNorm,
+                               bool _propagation, Mat& _Sx, Mat& _Sy ) :
+        lv(&_lv), Ux(&_Ux), Uy(&_Uy), xs(&_xs), ys(&_ys), ps(_ps), niters(_niters), meanNorm(_meanNorm),
+        propagation(_propagation), Sx(&_Sx), Sy(&_Sy) {}
+
+    void operator()( const Range& range ) const
+    {
+        int hs = (int)ys->size(), ws = (int)xs->size();
+        AutoBuffer<float> _buf(ps*ps*3);
+        float *T = _buf, *gx = T + ps*ps, *gy = gx + ps*ps;
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            int i0 = s*DIS_STRIPE, i1 = std::min(i0 + DIS_STRIPE, hs);
+
+            // with the spatial propagation, the patches are searched twice: in the raster order,
+            // trying the flow of the left and the top neighbours, and then in the reverse order,
+            // trying the flow of the right and the bottom neighbours
+            for( int i = i0; i < i1; i++ )
+                for( int j = 0; j < ws; j++ )
+                    processPatch( i, j, i0, i1, 0, T, gx, gy );
+
+            if( propagation )
+            {
+                for( int i = i1 - 1; i >= i0; i-- )
+                    for( int j = ws - 1; j >= 0; j-- )
+                        processPatch( i, j, i0, i1, 1, T, gx, gy );
+            }
+        }
+    }
+
+private:
+    void processPatch( int i, int j, int i0, int i1, int pass, float* T, float* gx, float* gy ) const
+    {
+        int ws = (int)xs->size(), x = (*xs)[j], y = (*ys)[i], n = ps*ps, r, c;
+        const DISLevel& l = *lv;
+
+        // the template and its gradients
+        float mgx = 0.f, mgy = 0.f;
+        for( r = 0; r < ps; r++ )
+        {
+            const float* t = l.I0.ptr<float>(y + r) + x;
+            const float* dx = l.I0x.ptr<float>(y + r) + x;
+            const float* dy = l.I0y.ptr<float>(y + r) + x;
+            for( c = 0; c < ps; c++ )
+            {
+                T[r*ps + c] = t[c];
+                gx[r*ps + c] = dx[c];
+                gy[r*ps + c] = dy[c];
+                mgx += dx[c];
+                mgy += dy[c];
+            }
+        }
+
+        mgx = meanNorm ? mgx/n : 0.f;
+        mgy = meanNorm ? mgy/n : 0.f;
+        float sxx = 0.f, sxy = 0.f, syy = 0.f;
+        for( c = 0; c < n; c++ )
+        {
+            float dx = gx[c] - mgx, dy = gy[c] - mgy;
+            gx[c] = dx;
+            gy[c] = dy;
+            sxx += dx*dx;
+            sxy += dx*dy;
+            syy += dy*dy;
+        }
+
+        // the initial flow comes from the coarser scale
+        int cx = x + ps/2, cy = y + ps/2;
+        float u0 = Ux->at<float>(cy, cx), v0 = Uy->at<float>(cy, cx);
+        float* sx = Sx->ptr<float>(i);
+        float* sy = Sy->ptr<float>(i);
+        float u = pass == 0 ? u0 : sx[j], v = pass == 0 ? v0 : sy[j];
+        float bx, by, cbx, cby;
+        float cost = computePatchDiff( l, ps, x, y, u, v, T, gx, gy, meanNorm, bx, by );
+
+        if( propagation )
+        {
+            int nbi[2], nbj[2];
+            if( pass == 0 )
+            {
+                nbi[0] = i; nbj[0] = j > 0 ? j - 1 : -1;
+                nbi[1] = i > i0 ? i - 1 : -1; nbj[1] = j;
+            }
+            else
+            {
+                nbi[0] = i; nbj[0] = j + 1 < ws ? j + 1 : -1;
+                nbi[1] = i + 1 < i1 ? i + 1 : -1; nbj[1] = j;
+            }
+
+            for( int k = 0; k < 2; k++ )
+            {
+                if( nbi[k] < 0 || nbj[k] < 0 )
+                    continue;
+                float cu = Sx->at<float>(nbi[k], nbj[k]), cv = Sy->at<float>(nbi[k], nbj[k]);
+                float ccost = computePatchDiff( l, ps, x, y, cu, cv, T, gx, gy, meanNorm, cbx, cby );
+                if( ccost < cost )
+                {
+                    u = cu; v = cv;
+                    cost = ccost; bx = cbx; by = cby;
+                }
+            }
+        }
+
+        // the inverse compositional gradient descent; the Hessian does not depend on the flow
+        float det = sxx*syy - sxy*sxy;
+        int iters = !propagation ? niters : pass == 0 ? niters/2 : niters - niters/2;
+        if( det > FLT_EPSILON*(sxx + syy)*(sxx + syy) )
+        {
+            float idet = 1.f/det;
+            for( int it = 0; it < iters; it++ )
+            {
+                float du = (syy*bx - sxy*by)*idet, dv = (sxx*by - sxy*bx)*idet;
+                u -= du;
+                v -= dv;
+                if( du*du + dv*dv < 1e-6f || it == iters - 1 )
+                    break;
+                computePatchDiff( l, ps, x, y, u, v, T, gx, gy, meanNorm, bx, by );
+            }
+        }
+
+        // the patches that went too far are most likely wrong
+        if( (u - u0)*(u - u0) + (v - v0)*(v - v0) > (float)n )
+        {
+            u = u0;
+            v = v0;
+        }
+
+        sx[j] = u;
+        sy[j] = v;
+    }
+
+    const DISLevel* lv;
+    const Mat *Ux, *Uy;
+    const std::vector<int> *xs, *ys;
+    int ps, niters;
+    bool meanNorm, propagation;
+    Mat *Sx, *Sy;
+};
+
+// Computes the dense flow as the average of the flows of all the patches covering each pixel,
+// weighted by the inverse of the warping error
+class DensificationInvoker : public ParallelLoopBody
+{
+public:
+    DensificationInvoker( const DISLevel& _lv, const std::vector<int>& _xs, const std::vector<int>& _ys,
+                          int _ps, int _stride, const Mat& _Sx, const Mat& _Sy, Mat& _Ux, Mat& _Uy ) :
+        lv(&_lv), xs(&_xs), ys(&_ys), ps(_ps), stride(_stride), Sx(&_Sx), Sy(&_Sy), Ux(&_Ux), Uy(&_Uy) {}
+
+    void operator()( const Range& range ) const
+    {
+        const DISLevel& l = *lv;
+        int w = l.size.width, h = l.size.height, hs = (int)ys->size(), ws = (int)xs->size();
+        int y0 = range.start*DIS_BAND, y1 = std::min(range.end*DIS_BAND, h);
+        AutoBuffer<float> _buf(w*3);
+        float *su = _buf, *sv = su + w, *sw = sv + w;
+
+        for( int y = y0; y < y1; y++ )
+        {
+            const float* I0row = l.I0.ptr<float>(y);
+            int x, i0 = std::max((y - ps)/stride - 1, 0), i1 = std::min(y/stride + 2, hs);
+
+            for( x = 0; x < w; x++ )
+                su[x] = sv[x] = sw[x] = 0.f;
+
+            for( int i = i0; i < i1; i++ )
+            {
+                if( y < (*ys)[i] || y >= (*ys)[i] + ps )
+                    continue;
+
+                const float* sx = Sx->ptr<float>(i);
+                const float* sy = Sy->ptr<float>(i);
+                for( int j = 0; j < ws; j++ )
+                {
+                    float u = sx[j], v = sy[j];
+                    int xj = (*xs)[j];
+                    float py = std::min(std::max(y + v, (float)-l.pad), (float)(h + l.pad - 2));
+                    int iy = cvFloor(py);
+                    float fy = py - iy;
+                    const float *a = l.I1 + iy*l.step, *b = a + l.step;
+
+                    int ix = cvFloor(xj + u);
+                    if( ix >= -l.pad && ix + ps < w + l.pad )
+                    {
+                        // the same interpolation weights for the whole row of the patch
+                        float fx = xj + u - ix;
+                        float w00 = (1.f - fx)*(1.f - fy), w01 = fx*(1.f - fy), w10 = (1.f - fx)*fy, w11 = fx*fy;
+                        a += ix - xj; b += ix - xj;
+                        x = xj;
+#if CV_SIMD128
+                        v_float32x4 v_w00 = v_setall_f32(w00), v_w01 = v_setall_f32(w01);
+                        v_float32x4 v_w10 = v_setall_f32(w10), v_w11 = v_setall_f32(w11);
+                        v_float32x4 v_u = v_setall_f32(u), v_v = v_setall_f32(v), v_one = v_setall_f32(1.f);
+                        for( ; x <= xj + ps - 4; x += 4 )
+                        {
+                            v_float32x4 d = v_w00*v_load(a + x) + v_w01*v_load(a + x + 1) +
+                                            v_w10*v_load(b + x) + v_w11*v_load(b + x + 1) - v_load(I0row + x);
+                            v_float32x4 wt = v_one/v_max(v_abs(d), v_one);
+                            v_store(su + x, v_load(su + x) + wt*v_u);
+                            v_store(sv + x, v_load(sv + x) + wt*v_v);
+                            v_store(sw + x, v_load(sw + x) + wt);
+                        }
+#endif
+                        for( ; x < xj + ps; x++ )
+                        {
+                            float d = w00*a[x] + w01*a[x+1] + w10*b[x] + w11*b[x+1] - I0row[x];
+                            float wt = 1.f/std::max(std::abs(d), 1.f);
+                            su[x] += wt*u;
+                            sv[x] += wt*v;
+                            sw[x] += wt;
+                        }
+                    }
+                    else
+                    {
+                        for( x = xj; x < xj + ps; x++ )
+                        {
+                            float px = std::min(std::max(x + u, (float)-l.pad), (float)(w + l.pad - 2));
+                            int jx = cvFloor(px);
+                            float fx = px - jx;
+                            float d = (1.f - fx)*(1.f - fy)*a[jx] + fx*(1.f - fy)*a[jx+1] +
+                                      (1.f - fx)*fy*b[jx] + fx*fy*b[jx+1] - I0row[x];
+                            float wt = 1.f/std::max(std::abs(d), 1.f);
+                            su[x] += wt*u;
+                            sv[x] += wt*v;
+                            sw[x] += wt;
+                        }
+                    }
+                }
+            }
+
+            float* ux = Ux->ptr<float>(y);
+            float* uy = Uy->ptr<float>(y);
+            for( x = 0; x < w; x++ )
+            {
+                float iw = 1.f/sw[x];
+                ux[x] = su[x]*iw;
+                uy[x] = sv[x]*iw;
+            }
+        }
+    }
+
+private:
+    const DISLevel* lv;
+    const std::vector<int> *xs, *ys;
+    int ps, stride;
+    const Mat *Sx, *Sy;
+    Mat *Ux, *Uy;
+};
+
+// the linearized data terms and the smoothness weights of the variational refinement
+struct VariationalData
+{
+    Mat Ix, Iy, Iz, Ixx, Ixy, Iyy, Ixz, Iyz;
+    Mat dUx, dUy;
+    Mat A11, A12, A22, b1, b2, Ws;
+};
+
+class VariationalCoeffsInvoker : public ParallelLoopBody
+{
+public:
+    VariationalCoeffsInvoker( VariationalData& _d, const Mat& _Ux, const Mat& _Uy,
+                              float _alpha, float _delta, float _gamma ) :
+        d(&_d), Ux(&_Ux), Uy(&_Uy), alpha(_alpha), delta(_delta), gamma(_gamma) {}
+
+    void operator()( const Range& range ) const
+    {
+        int w = Ux->cols, h = Ux->rows;
+        int y0 = range.start*DIS_BAND, y1 = std::min(range.end*DIS_BAND, h);
+
+        for( int y = y0; y < y1; y++ )
+        {
+            const float *Ix = d->Ix.ptr<float>(y), *Iy = d->Iy.ptr<float>(y), *Iz = d->Iz.ptr<float>(y);
+            const float *Ixx = d->Ixx.ptr<float>(y), *Ixy = d->Ixy.ptr<float>(y), *Iyy = d->Iyy.ptr<float>(y);
+            const float *Ixz = d->Ixz.ptr<float>(y), *Iyz = d->Iyz.ptr<float>(y);
+            const float *du = d->dUx.ptr<float>(y), *dv = d->dUy.ptr<float>(y);
+            const float *u = Ux->ptr<float>(y), *v = Uy->ptr<float>(y);
+            int yn = std::min(y + 1, h - 1);
+            const float *dun = d->dUx.ptr<float>(yn), *dvn = d->dUy.ptr<float>(yn);
+            const float *un = Ux->ptr<float>(yn), *vn = Uy->ptr<float>(yn);
+            float *A11 = d->A11.ptr<float>(y), *A12 = d->A12.ptr<float>(y), *A22 = d->A22.ptr<float>(y);
+            float *b1 = d->b1.ptr<float>(y), *b2 = d->b2.ptr<float>(y), *Ws = d->Ws.ptr<float>(y);
+
+            for( int x = 0; x < w; x++ )
+            {
+                // brightness constancy
+                float nd = 1.f/(Ix[x]*Ix[x] + Iy[x]*Iy[x] + DIS_ZETA_SQUARED);
+                float ed = Iz[x] + Ix[x]*du[x] + Iy[x]*dv[x];
+                float wd = delta*nd*0.5f/std::sqrt(ed*ed*nd + DIS_EPS_SQUARED);
+
+                // gradient constancy
+                float nx = 1.f/(Ixx[x]*Ixx[x] + Ixy[x]*Ixy[x] + DIS_ZETA_SQUARED);
+                float ny = 1.f/(Ixy[x]*Ixy[x] + Iyy[x]*Iyy[x] + DIS_ZETA_SQUARED);
+                float egx = Ixz[x] + Ixx[x]*du[x] + Ixy[x]*dv[x];
+                float egy = Iyz[x] + Ixy[x]*du[x] + Iyy[x]*dv[x];
+                float wg = gamma*0.5f/std::sqrt(egx*egx*nx + egy*egy*ny + DIS_EPS_SQUARED);
+                float wgx = wg*nx, wgy = wg*ny;
+
+                A11[x] = wd*Ix[x]*Ix[x] + wgx*Ixx[x]*Ixx[x] + wgy*Ixy[x]*Ixy[x];
+                A12[x] = wd*Ix[x]*Iy[x] + wgx*Ixx[x]*Ixy[x] + wgy*Ixy[x]*Iyy[x];
+                A22[x] = wd*Iy[x]*Iy[x] + wgx*Ixy[x]*Ixy[x] + wgy*Iyy[x]*Iyy[x];
+                b1[x] = -(wd*Ix[x]*Iz[x] + wgx*Ixx[x]*Ixz[x] + wgy*Ixy[x]*Iyz[x]);
+                b2[x] = -(wd*Iy[x]*Iz[x] + wgx*Ixy[x]*Ixz[x] + wgy*Iyy[x]*Iyz[x]);
+
+                // smoothness of the refined flow, forward differences
+                int xn = std::min(x + 1, w - 1);
+                float ux = u[xn] + du[xn] - u[x] - du[x], uy = un[x] + dun[x] - u[x] - du[x];
+                float vx = v[xn] + dv[xn] - v[x] - dv[x], vy = vn[x] + dvn[x] - v[x] - dv[x];
+                Ws[x] = alpha*0.5f/std::sqrt(ux*ux + uy*uy + vx*vx + vy*vy + DIS_EPS_SQUARED);
+            }
+        }
+    }
+
+private:
+    VariationalData* d;
+    const Mat *Ux, *Uy;
+    float alpha, delta, gamma;
+};
+
+// one red or black half-iteration of SOR for the increments of the flow
+class VariationalSORInvoker : public ParallelLoopBody
+{
+public:
+    VariationalSORInvoker( VariationalData& _d, const Mat& _Ux, const Mat& _Uy, int _color ) :
+        d(&_d), Ux(&_Ux), Uy(&_Uy), color(_color) {}
+
+    void operator()( const Range& range ) const
+    {
+        int w = Ux->cols, h = Ux->rows;
+        int y0 = range.start*DIS_BAND, y1 = std::min(range.end*DIS_BAND, h);
+
+        for( int y = y0; y < y1; y++ )
+        {
+            const float *A11 = d->A11.ptr<float>(y), *A12 = d->A12.ptr<float>(y), *A22 = d->A22.ptr<float>(y);
+            const float *b1 = d->b1.ptr<float>(y), *b2 = d->b2.ptr<float>(y), *Ws = d->Ws.ptr<float>(y);
+            const float *Wsp = d->Ws.ptr<float>(std::max(y - 1, 0));
+            const float *u = Ux->ptr<float>(y), *v = Uy->ptr<float>(y);
+            const float *up = Ux->ptr<float>(std::max(y - 1, 0)), *vp = Uy->ptr<float>(std::max(y - 1, 0));
+            const float *un = Ux->ptr<float>(std::min(y + 1, h - 1)), *vn = Uy->ptr<float>(std::min(y + 1, h - 1));
+            float *du = d->dUx.ptr<float>(y), *dv = d->dUy.ptr<float>(y);
+            const float *dup = d->dUx.ptr<float>(std::max(y - 1, 0)), *dvp = d->dUy.ptr<float>(std::max(y - 1, 0));
+            const float *dun = d->dUx.ptr<float>(std::min(y + 1, h - 1)), *dvn = d->dUy.ptr<float>(std::min(y + 1, h - 1));
+
+            for( int x = (y + color) & 1; x < w; x += 2 )
+            {
+                // the weights of the left, right, top and bottom neighbours
+                float wl = x > 0 ? Ws[x-1] : 0.f, wr = x < w - 1 ? Ws[x] : 0.f;
+                float wt = y > 0 ? Wsp[x] : 0.f, wb = y < h - 1 ? Ws[x] : 0.f;
+                float sw = wl + wr + wt + wb;
+                float U = u[x] + du[x], V = v[x] + dv[x];
+                float su = 0.f, sv = 0.f;
+
+                if( x > 0 ) { su += wl*(u[x-1] + du[x-1] - U); sv += wl*(v[x-1] + dv[x-1] - V); }
+                if( x < w - 1 ) { su += wr*(u[x+1] + du[x+1] - U); sv += wr*(v[x+1] + dv[x+1] - V); }
+                if( y > 0 ) { su += wt*(up[x] + dup[x] - U); sv += wt*(vp[x] + dvp[x] - V); }
+                if( y < h - 1 ) { su += wb*(un[x] + dun[x] - U); sv += wb*(vn[x] + dvn[x] - V); }
+
+                // su and sv are relative to the current increments
+                float dun_ = (b1[x] + su + sw*du[x] - A12[x]*dv[x])/(A11[x] + sw);
+                du[x] += DIS_SOR_OMEGA*(dun_ - du[x]);
+                float dvn_ = (b2[x] + sv + sw*dv[x] - A12[x]*du[x])/(A22[x] + sw);
+                dv[x] += DIS_SOR_OMEGA*(dvn_ - dv[x]);
+            }
+        }
+    }
+
+private:
+    VariationalData* d;
+    const Mat *Ux, *Uy;
+    int color;
+};
+
+class DISOpticalFlowImpl : public DISOpticalFlow
+{
+public:
+    DISOpticalFlowImpl();
+
+    void calc( InputArray I0, InputArray I1, InputOutputArray flow );
+    void collectGarbage();
+
+    int getFinestScale() const { return finest_scale; }
+    void setFinestScale( int val ) { finest_scale = val; }
+    int getPatchSize() const { return patch_size; }
+    void setPatchSize( int val ) { patch_size = val; }
+    int getPatchStride() const { return patch_stride; }
+    void setPatchStride( int val ) { patch_stride = val; }
+    int getGradientDescentIterations() const { return grad_descent_iter; }
+    void setGradientDescentIterations( int val ) { grad_descent_iter = val; }
+    int getVariationalRefinementIterations() const { return variational_refinement_iter; }
+    void setVariationalRefinementIterations( int val ) { variational_refinement_iter = val; }
+    float getVariationalRefinementAlpha() const { return alpha; }
+    void setVariationalRefinementAlpha( float val ) { alpha = val; }
+    float getVariationalRefinementDelta() const { return delta; }
+    void setVariationalRefinementDelta( float val ) { delta = val; }
+    float getVariationalRefinementGamma() const { return gamma; }
+    void setVariationalRefinementGamma( float val ) { gamma = val; }
+    bool getUseMeanNormalization() const { return use_mean_normalization; }
+    void setUseMeanNormalization( bool val ) { use_mean_normalization = val; }
+    bool getUseSpatialPropagation() const { return use_spatial_propagation; }
+    void setUseSpatialPropagation( bool val ) { use_spatial_propagation = val; }
+    bool getUseInitialFlow() const { return use_initial_flow; }
+    void setUseInitialFlow( bool val ) { use_initial_flow = val; }
+
+    int finest_scale;
+    int patch_size;
+    int patch_stride;
+    int grad_descent_iter;
+    int variational_refinement_iter;
+    float alpha, delta, gamma;
+    bool use_mean_normalization;
+    bool use_spatial_propagation;
+    bool use_initial_flow;
+
+private:
+    void prepareLevel( int level );
+    void variationalRefinement();
+
+    // the pyramids are kept between the calls, so the buffers are reused for the video frames
+    std::vector<Mat> I0s, I1s;
+    DISLevel lv;
+    Mat Ux, Uy, Sx, Sy, I1x, I1y;
+    std::vector<int> xs, ys;
+    VariationalData vd;
+};
+
+DISOpticalFlowImpl::DISOpticalFlowImpl()
+{
+    finest_scale = 2;
+    patch_size = 8;
+    patch_stride = 4;
+    grad_descent_iter = 16;
+    variational_refinement_iter = 5;
+    alpha = 20.f;
+    delta = 5.f;
+    gamma = 10.f;
+    use_mean_normalization = true;
+    use_spatial_propagation = true;
+    use_initial_flow = false;
+}
+
+void DISOpticalFlowImpl::prepareLevel( int level )
+{
+    Mat I0l = I0s[level], I1l = I1s[level];
+    lv.size = I0l.size();
+    lv.pad = patch_size;
+
+    I0l.convertTo(lv.I0, CV_32F);
+    // the pyramid border is used by Sobel as the real neighbours
+    Sobel(I0l, lv.I0x, CV_32F, 1, 0, 3, 1./8);
+    Sobel(I0l, lv.I0y, CV_32F, 0, 1, 3, 1./8);
+
+    Mat I1whole = I1l;
+    I1whole.adjustROI(lv.pad, lv.pad, lv.pad, lv.pad);
+    I1whole.convertTo(lv.I1pad, CV_32F);
+    lv.step = lv.I1pad.step/sizeof(float);
+    lv.I1 = lv.I1pad.ptr<float>(lv.pad) + lv.pad;
+
+    if( variational_refinement_iter > 0 )
+    {
+        Sobel(I1l, I1x, CV_32F, 1, 0, 3, 1./8);
+        Sobel(I1l, I1y, CV_32F, 0, 1, 3, 1./8);
+    }
+}
+
+void DISOpticalFlowImpl::variationalRefinement()
+{
+    Size size = lv.size;
+    Mat mapx(size, CV_32F), mapy(size, CV_32F), I1w, I1xw, I1yw;
+
+    for( int y = 0; y < size.height; y++ )
+    {
+        const float *ux = Ux.ptr<float>(y), *uy = Uy.ptr<float>(y);
+        float *mx = mapx.ptr<float>(y), *my = mapy.ptr<float>(y);
+        for( int x = 0; x < size.width; x++ )
+        {
+            mx[x] = x + ux[x];
+            my[x] = y + uy[x];
+        }
+    }
+
+    Mat I1 = lv.I1pad(Rect(lv.pad, lv.pad, size.width, size.height));
+    remap(I1, I1w, mapx, mapy, INTER_LINEAR, BORDER_REPLICATE);
+    remap(I1x, I1xw, mapx, mapy, INTER_LINEAR, BORDER_REPLICATE);
+    remap(I1y, I1yw, mapx, mapy, INTER_LINEAR, BORDER_REPLICATE);
+
+    // the derivatives are averaged between the images
+    addWeighted(I1xw, 0.5, lv.I0x, 0.5, 0, vd.Ix);
+    addWeighted(I1yw, 0.5, lv.I0y, 0.5, 0, vd.Iy);
+    subtract(I1w, lv.I0, vd.Iz);
+    subtract(I1xw, lv.I0x, vd.Ixz);
+    subtract(I1yw, lv.I0y, vd.Iyz);
+    Sobel(vd.Ix, vd.Ixx, CV_32F, 1, 0, 3, 1./8, 0, BORDER_REPLICATE);
+    Sobel(vd.Ix, vd.Ixy, CV_32F, 0, 1, 3, 1./8, 0, BORDER_REPLICATE);
+    Sobel(vd.Iy, vd.Iyy, CV_32F, 0, 1, 3, 1./8, 0, BORDER_REPLICATE);
+
+    vd.dUx = Mat::zeros(size, CV_32F);
+    vd.dUy = Mat::zeros(size, CV_32F);
+    vd.A11.create(size, CV_32F); vd.A12.create(size, CV_32F); vd.A22.create(size, CV_32F);
+    vd.b1.create(size, CV_32F); vd.b2.create(size, CV_32F); vd.Ws.create(size, CV_32F);
+
+    Range bands(0, (size.height + DIS_BAND - 1)/DIS_BAND);
+    for( int it = 0; it < variational_refinement_iter; it++ )
+    {
+        parallel_for_(bands, VariationalCoeffsInvoker(vd, Ux, Uy, alpha, delta, gamma));
+        for( int k = 0; k < DIS_SOR_ITERATIONS; k++ )
+        {
+            parallel_for_(bands, VariationalSORInvoker(vd, Ux, Uy, 0));
+            parallel_for_(bands, VariationalSORInvoker(vd, Ux, Uy, 1));
+        }
+    }
+
+    Ux += vd.dUx;
+    Uy += vd.dUy;
+}
+
+void DISOpticalFlowImpl::calc( InputArray _I0, InputArray _I1, InputOutputArray _flow )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat I0 = _I0.getMat(), I1 = _I1.getMat();
+    CV_Assert( !I0.empty() && I0.type() == CV_8UC1 && I1.type() == CV_8UC1 && I0.size() == I1.size() );
+    CV_Assert( patch_size > 2 && patch_stride > 0 && patch_stride <= patch_size && finest_scale >= 0 &&
+               grad_descent_iter >= 0 && variational_refinement_iter >= 0 );
+    CV_Assert( I0.cols > patch_size && I0.rows > patch_size );
+
+    Mat initFlow;
+    if( use_initial_flow )
+    {
+        initFlow = _flow.getMat();
+        CV_Assert( initFlow.size() == I0.size() && initFlow.type() == CV_32FC2 );
+    }
+
+    int w = I0.cols, h = I0.rows, ps = patch_size;
+    int coarsest = std::min(cvRound(std::log(std::max(w, h)/(4.*ps))/std::log(2.)),
+                            cvFloor(std::log(std::min(w, h)/(double)ps)/std::log(2.)));
+    coarsest = std::max(coarsest, 0);
+    Size winSize(ps, ps);
+    coarsest = std::min(buildOpticalFlowPyramid(I0, I0s, winSize, coarsest, false), coarsest);
+    coarsest = std::min(buildOpticalFlowPyramid(I1, I1s, winSize, coarsest, false), coarsest);
+    int finest = std::min(finest_scale, coarsest);
+
+    for( int level = coarsest; level >= finest; level-- )
+    {
+        prepareLevel(level);
+        Size size = lv.size;
+
+        if( level == coarsest )
+        {
+            if( !initFlow.empty() )
+            {
+                Mat planes[2];
+                split(initFlow, planes);
+                resize(planes[0], Ux, size, 0, 0, INTER_AREA);
+                resize(planes[1], Uy, size, 0, 0, INTER_AREA);
+                Ux *= (double)size.width/w;
+                Uy *= (double)size.height/h;
+            }
+            else
+            {
+                Ux = Mat::zeros(size, CV_32F);
+                Uy = Mat::zeros(size, CV_32F);
+            }
+        }
+        else
+        {
+            Mat Uxc = Ux, Uyc = Uy;
+            resize(Uxc, Ux, size, 0, 0, INTER_LINEAR);
+            resize(Uyc, Uy, size, 0, 0, INTER_LINEAR);
+            Ux *= 2;
+            Uy *= 2;
+        }
+
+        getPatchGrid(size.width, ps, patch_stride, xs);
+        getPatchGrid(size.height, ps, patch_stride, ys);
+        int hs = (int)ys.size(), ws = (int)xs.size();
+        Sx.create(hs, ws, CV_32F);
+        Sy.create(hs, ws, CV_32F);
+
+        parallel_for_(Range(0, (hs + DIS_STRIPE - 1)/DIS_STRIPE),
+                      PatchInverseSearchInvoker(lv, Ux, Uy, xs, ys, ps, grad_descent_iter, use_mean_normalization,
+                                                use_spatial_propagation, Sx, Sy));
+        parallel_for_(Range(0, (size.height + DIS_BAND - 1)/DIS_BAND),
+                      DensificationInvoker(lv, xs, ys, ps, patch_stride, Sx, Sy, Ux, Uy));
+
+        if( variational_refinement_iter > 0 )
+            variationalRefinement();
+    }
+
+    // the flow is upscaled from the finest processed scale
+    Mat planes[2];
+    resize(Ux, planes[0], I0.size(), 0, 0, INTER_LINEAR);
+    resize(Uy, planes[1], I0.size(), 0, 0, INTER_LINEAR);
+    planes[0] *= (double)w/lv.size.width;
+    planes[1] *= (double)h/lv.size.height;
+    merge(planes, 2, _flow);
+}
+
+void DISOpticalFlowImpl::collectGarbage()
+{
+    I0s.clear();
+    I1s.clear();
+    lv = DISLevel();
+    Ux.release(); Uy.release();
+    Sx.release(); Sy.release();
+    I1x.release(); I1y.release();
+    vd = VariationalData();
+}
+
+}
+
+Ptr<DISOpticalFlow> DISOpticalFlow::create( int preset )
+{
+    Ptr<DISOpticalFlowImpl> dis = makePtr<DISOpticalFlowImpl>();
+    dis->patch_size = 8;
+    if( preset == DISOpticalFlow::PRESET_ULTRAFAST )
+    {
+        dis->finest_scale = 2;
+        dis->patch_stride = 4;
+        dis->grad_descent_iter = 12;
+        dis->variational_refinement_iter = 0;
+    }
+    else if( preset == DISOpticalFlow::PRESET_FAST )
+    {
+        dis->finest_scale = 2;
+        dis->patch_stride = 4;
+        dis->grad_descent_iter = 16;
+        dis->variational_refinement_iter = 5;
+    }
+    else if( preset == DISOpticalFlow::PRESET_MEDIUM )
+    {
+        dis->finest_scale = 1;
+        dis->patch_size = 12;
+        dis->patch_stride = 4;
+        dis->grad_descent_iter = 25;
+        dis->variational_refinement_iter = 5;
+    }
+    else
+        CV_Error( Error::StsBadArg, "Unknown preset" );
+
+    return dis;
+}
+
+}
@@ -39,6 +39,7 @@
 //
 //M*/
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -131,4 +132,400 @@ const Mat& KalmanFilter::correct(const Mat& measurement)
     return statePost;
 }
 
+
+namespace
+{
+
+// the filters updated by one task
+enum { KALMAN_BATCH_CHUNK = 256 };
+
+// the operations on one filter at a time
+struct KalmanLanes1
+{
+    typedef float vt;
+    enum { nlanes = 1 };
+    static inline vt load( const float* p ) { return *p; }
+    static inline void store( float* p, vt v ) { *p = v; }
+    static inline vt setall( float v ) { return v; }
+    static inline vt sqrt( vt v ) { return std::sqrt(v); }
+    static inline vt max( vt a, vt b ) { return std::max(a, b); }
+};
+
+#if CV_SIMD128
+// the operations on 4 filters at a time, the filters are the SIMD lanes
+struct KalmanLanes4
+{
+    typedef v_float32x4 vt;
+    enum { nlanes = 4 };
+    static inline vt load( const float* p ) { return v_load(p); }
+    static inline void store( float* p, const vt& v ) { v_store(p, v); }
+    static inline vt setall( float v ) { return v_setall_f32(v); }
+    static inline vt sqrt( const vt& v ) { return v_sqrt(v); }
+    static inline vt max( const vt& a, const vt& b ) { return v_max(a, b); }
+};
+#endif
+
+struct KalmanBatchData
+{
+    int count, DP, MP, CP;
+    // the shared model, continuous matrices
+    const float *A, *B, *H, *Q, *R;
+    // the per-filter matrices; element (r, i) is at ptr[r*step + i]
+    float *xPre, *xPost, *PPre, *PPost, *K;
+    size_t step;
+    const float *u, *z;
+    size_t ustep, zstep;
+    const uchar* mask;
+};
+
+// the number of the temporary vectors used by the kernels
+static inline int kalmanBufSize( int DP, int MP )
+{
+    return std::max(DP*(DP + 1), MP*(2*DP + MP + 2));
+}
+
+// The kernels process the filters i, ..., i + L::nlanes - 1. DP_ and MP_ are the dimensions
+// known at compile time, or 0. The zero elements of the shared matrices are skipped, the branches
+// are the same for all the filters.
+template<typename L, int DP_> static void
+kalmanPredict( const KalmanBatchData& d, int i, typename L::vt* ext )
+{
+    typedef typename L::vt vt;
+    const int DP = DP_ > 0 ? DP_ : d.DP, CP = d.CP;
+    const size_t step = d.step;
+    vt local[DP_ > 0 ? DP_*(DP_ + 1) : 1];
+    vt* x = DP_ > 0 ? local : ext;
+    vt* T = x + DP;
+    const float *A = d.A, *B = d.B, *Q = d.Q;
+    int r, c, k;
+
+    // x'(k) = A*x(k) + B*u(k)
+    for( r = 0; r < DP; r++ )
+    {
+        vt s = L::setall(0.f);
+        for( k = 0; k < DP; k++ )
+            if( A[r*DP + k] != 0.f )
+                s = s + L::setall(A[r*DP + k])*L::load(d.xPost + k*step + i);
+        if( d.u )
+            for( k = 0; k < CP; k++ )
+                if( B[r*CP + k] != 0.f )
+                    s = s + L::setall(B[r*CP + k])*L::load(d.u + k*d.ustep + i);
+        x[r] = s;
+    }
+
+    // T = A*P(k)
+    for( r = 0; r < DP; r++ )
+        for( c = 0; c < DP; c++ )
+        {
+            vt s = L::setall(0.f);
+            for( k = 0; k < DP; k++ )
+                if( A[r*DP + k] != 0.f )
+                    s = s + L::setall(A[r*DP + k])*L::load(d.PPost + (k*DP + c)*step + i);
+            T[r*DP + c] = s;
+        }
+
+    // as in KalmanFilter, the results are also the posteriori ones until the next correction
+    for( r = 0; r < DP; r++ )
+    {
+        L::store(d.xPre + r*step + i, x[r]);
+        L::store(d.xPost + r*step + i, x[r]);
+    }
+
+    // P'(k) = T*At + Q
+    for( r = 0; r < DP; r++ )
+        for( c = 0; c < DP; c++ )
+        {
+            vt s = L::setall(Q[r*DP + c]);
+            for( k = 0; k < DP; k++ )
+                if( A[c*DP + k] != 0.f )
+                    s = s + T[r*DP + k]*L::setall(A[c*DP + k]);
+            L::store(d.PPre + (r*DP + c)*step + i, s);
+            L::store(d.PPost + (r*DP + c)*step + i, s);
+        }
+}
+
+template<typename L, int DP_, int MP_> static void
+kalmanCorrect( const KalmanBatchData& d, int i, typename L::vt* ext )
+{
+    typedef typename L::vt vt;
+    const int DP = DP_ > 0 ? DP_ : d.DP, MP = MP_ > 0 ? MP_ : d.MP;
+    const size_t step = d.step;
+    vt local[DP_ > 0 && MP_ > 0 ? MP_*(2*DP_ + MP_ + 2) : 1];
+    vt* T = DP_ > 0 && MP_ > 0 ? local : ext;
+    vt* Kt = T + MP*DP;
+    vt* S = Kt + MP*DP;
+    vt* invd = S + MP*MP;
+    vt* y = invd + MP;
+    const float *H = d.H, *R = d.R;
+    vt one = L::setall(1.f);
+    int r, c, k;
+
+    // T = H*P'(k)
+    for( r = 0; r < MP; r++ )
+        for( c = 0; c < DP; c++ )
+        {
+            vt s = L::setall(0.f);
+            for( k = 0; k < DP; k++ )
+                if( H[r*DP + k] != 0.f )
+                    s = s + L::setall(H[r*DP + k])*L::load(d.PPre + (k*DP + c)*step + i);
+            T[r*DP + c] = s;
+        }
+
+    // S = T*Ht + R, the lower triangle
+    for( r = 0; r < MP; r++ )
+        for( c = 0; c <= r; c++ )
+        {
+            vt s = L::setall(R[r*MP + c]);
+            for( k = 0; k < DP; k++ )
+                if( H[c*DP + k] != 0.f )
+                    s = s + T[r*DP + k]*L::setall(H[c*DP + k]);
+            S[r*MP + c] = s;
+        }
+
+    // S = L*Lt, in place
+    for( c = 0; c < MP; c++ )
+    {
+        vt s = S[c*MP + c];
+        for( k = 0; k < c; k++ )
+            s = s - S[c*MP + k]*S[c*MP + k];
+        invd[c] = one/L::sqrt(L::max(s, L::setall(FLT_MIN)));
+        for( r = c + 1; r < MP; r++ )
+        {
+            s = S[r*MP + c];
+            for( k = 0; k < c; k++ )
+                s = s - S[r*MP + k]*S[c*MP + k];
+            S[r*MP + c] = s*invd[c];
+        }
+    }
+
+    // Kt(k) = inv(S)*T, by the forward and the backward substitutions
+    for( c = 0; c < DP; c++ )
+    {
+        for( r = 0; r < MP; r++ )
+        {
+            vt s = T[r*DP + c];
+            for( k = 0; k < r; k++ )
+                s = s - S[r*MP + k]*Kt[k*DP + c];
+            Kt[r*DP + c] = s*invd[r];
+        }
+        for( r = MP - 1; r >= 0; r-- )
+        {
+            vt s = Kt[r*DP + c];
+            for( k = r + 1; k < MP; k++ )
+                s = s - S[k*MP + r]*Kt[k*DP + c];
+            Kt[r*DP + c] = s*invd[r];
+        }
+    }
+
+    // y = z(k) - H*x'(k)
+    for( r = 0; r < MP; r++ )
+    {
+        vt s = L::load(d.z + r*d.zstep + i);
+        for( k = 0; k < DP; k++ )
+            if( H[r*DP + k] != 0.f )
+                s = s - L::setall(H[r*DP + k])*L::load(d.xPre + k*step + i);
+        y[r] = s;
+    }
+
+    // x(k) = x'(k) + K(k)*y, P(k) = P'(k) - K(k)*T
+    for( r = 0; r < DP; r++ )
+    {
+        vt s = L::load(d.xPre + r*step + i);
+        for( k = 0; k < MP; k++ )
+        {
+            s = s + Kt[k*DP + r]*y[k];
+            L::store(d.K + (r*MP + k)*step + i, Kt[k*DP + r]);
+        }
+        L::store(d.xPost + r*step + i, s);
+
+        for( c = 0; c < DP; c++ )
+        {
+            s = L::load(d.PPre + (r*DP + c)*step + i);
+            for( k = 0; k < MP; k++ )
+                s = s - Kt[k*DP + r]*T[k*DP + c];
+            L::store(d.PPost + (r*DP + c)*step + i, s);
+        }
+    }
+}
+
+template<int DP_, int MP_> class KalmanBatchInvoker : public ParallelLoopBody
+{
+public:
+    KalmanBatchInvoker( const KalmanBatchData& _d, bool _correct ) : d(&_d), correct(_correct) {}
+
+    void operator()( const Range& range ) const
+    {
+        const uchar* mask = d->mask;
+        int i = range.start*KALMAN_BATCH_CHUNK, i1 = std::min(range.end*KALMAN_BATCH_CHUNK, d->count);
+        AutoBuffer<float> _buf(kalmanBufSize(d->DP, d->MP)*4 + 4);
+        float* buf = alignPtr((float*)_buf, 16);
+
+#if CV_SIMD128
+        for( ; i <= i1 - 4; i += 4 )
+        {
+            int n = !mask ? 4 : (mask[i] != 0) + (mask[i+1] != 0) + (mask[i+2] != 0) + (mask[i+3] != 0);
+            if( n == 4 )
+                run<KalmanLanes4>( i, (v_float32x4*)buf );
+            else
+                for( int k = 0; n > 0 && k < 4; k++ )
+                    if( mask[i + k] )
+                        run<KalmanLanes1>( i + k, buf );
+        }
+#endif
+        for( ; i < i1; i++ )
+            if( !mask || mask[i] )
+                run<KalmanLanes1>( i, buf );
+    }
+
+private:
+    template<typename L> void run( int i, typename L::vt* buf ) const
+    {
+        if( correct )
+            kalmanCorrect<L, DP_, MP_>( *d, i, buf );
+        else
+            kalmanPredict<L, DP_>( *d, i, buf );
+    }
+
+    const KalmanBatchData* d;
+    bool correct;
+};
+
+static void runKalmanBatch( const KalmanBatchData& d, bool correct )
+{
+    Range range(0, (d.count + KALMAN_BATCH_CHUNK - 1)/KALMAN_BATCH_CHUNK);
+
+    // the constant velocity and the constant acceleration models of the points and the boxes
+    if( d.DP == 2 && d.MP == 1 )
+        parallel_for_(range, KalmanBatchInvoker<2, 1>(d, correct));
+    else if( d.DP == 4 && d.MP == 2 )
+        parallel_for_(range, KalmanBatchInvoker<4, 2>(d, correct));
+    else if( d.DP == 6 && d.MP == 2 )
+        parallel_for_(range, KalmanBatchInvoker<6, 2>(d, correct));
+    else if( d.DP == 8 && d.MP == 4 )
+        parallel_for_(range, KalmanBatchInvoker<8, 4>(d, correct));
+    else
+        parallel_for_(range, KalmanBatchInvoker<0, 0>(d, correct));
+}
+
+}
+
+BatchKalmanFilter::BatchKalmanFilter() {}
+BatchKalmanFilter::BatchKalmanFilter(int count, int dynamParams, int measureParams, int controlParams)
+{
+    init(count, dynamParams, measureParams, controlParams);
+}
+
+void BatchKalmanFilter::init(int count, int DP, int MP, int CP)
+{
+    CV_Assert( count > 0 && DP > 0 && MP > 0 );
+    CP = std::max(CP, 0);
+
+    transitionMatrix = Mat::eye(DP, DP, CV_32F);
+    processNoiseCov = Mat::eye(DP, DP, CV_32F);
+    measurementMatrix = Mat::zeros(MP, DP, CV_32F);
+    measurementNoiseCov = Mat::eye(MP, MP, CV_32F);
+
+    if( CP > 0 )
+        controlMatrix = Mat::zeros(DP, CP, CV_32F);
+    else
+        controlMatrix.release();
+
+    statePre = Mat::zeros(DP, count, CV_32F);
+    statePost = Mat::zeros(DP, count, CV_32F);
+    errorCovPre = Mat::zeros(DP*DP, count, CV_32F);
+    errorCovPost = Mat::zeros(DP*DP, count, CV_32F);
+    gain = Mat::zeros(DP*MP, count, CV_32F);
+}
+
+static void initKalmanBatchData( BatchKalmanFilter& kf, KalmanBatchData& d, InputArray _mask )
+{
+    int DP = kf.transitionMatrix.rows, MP = kf.measurementMatrix.rows, count = kf.statePost.cols;
+    CV_Assert( DP > 0 && MP > 0 && count > 0 );
+    CV_Assert( kf.transitionMatrix.type() == CV_32F && kf.transitionMatrix.size() == Size(DP, DP) &&
+               kf.processNoiseCov.type() == CV_32F && kf.processNoiseCov.size() == Size(DP, DP) &&
+               kf.measurementMatrix.type() == CV_32F && kf.measurementMatrix.size() == Size(DP, MP) &&
+               kf.measurementNoiseCov.type() == CV_32F && kf.measurementNoiseCov.size() == Size(MP, MP) );
+
+    Mat* states[] = { &kf.statePre, &kf.statePost, &kf.errorCovPre, &kf.errorCovPost, &kf.gain };
+    int rows[] = { DP, DP, DP*DP, DP*DP, DP*MP };
+    for( int k = 0; k < 5; k++ )
+    {
+        // a single step for all the per-filter matrices
+        CV_Assert( states[k]->type() == CV_32F && states[k]->size() == Size(count, rows[k]) );
+        if( !states[k]->isContinuous() )
+            *states[k] = states[k]->clone();
+    }
+
+    Mat A = kf.transitionMatrix, H = kf.measurementMatrix, Q = kf.processNoiseCov, R = kf.measurementNoiseCov;
+    // the shared matrices are small, the continuous copies are cheap
+    if( !A.isContinuous() ) kf.transitionMatrix = A = A.clone();
+    if( !H.isContinuous() ) kf.measurementMatrix = H = H.clone();
+    if( !Q.isContinuous() ) kf.processNoiseCov = Q = Q.clone();
+    if( !R.isContinuous() ) kf.measurementNoiseCov = R = R.clone();
+
+    d.count = count;
+    d.DP = DP;
+    d.MP = MP;
+    d.CP = 0;
+    d.A = A.ptr<float>();
+    d.H = H.ptr<float>();
+    d.Q = Q.ptr<float>();
+    d.R = R.ptr<float>();
+    d.B = 0;
+    d.xPre = kf.statePre.ptr<float>();
+    d.xPost = kf.statePost.ptr<float>();
+    d.PPre = kf.errorCovPre.ptr<float>();
+    d.PPost = kf.errorCovPost.ptr<float>();
+    d.K = kf.gain.ptr<float>();
+    d.step = count;
+    d.u = d.z = 0;
+    d.ustep = d.zstep = 0;
+    d.mask = 0;
+
+    Mat mask = _mask.getMat();
+    if( !mask.empty() )
+    {
+        CV_Assert( mask.type() == CV_8U && mask.total() == (size_t)count && mask.isContinuous() );
+        d.mask = mask.ptr<uchar>();
+    }
+}
+
+void BatchKalmanFilter::predict(InputArray _control, InputArray _mask)
+{
+    CV_INSTRUMENT_REGION()
+
+    KalmanBatchData d;
+    initKalmanBatchData( *this, d, _mask );
+
+    Mat control = _control.getMat();
+    if( !control.empty() )
+    {
+        CV_Assert( controlMatrix.type() == CV_32F && controlMatrix.rows == d.DP &&
+                   control.type() == CV_32F && control.size() == Size(d.count, controlMatrix.cols) );
+        if( !controlMatrix.isContinuous() )
+            controlMatrix = controlMatrix.clone();
+        d.CP = controlMatrix.cols;
+        d.B = controlMatrix.ptr<float>();
+        d.u = control.ptr<float>();
+        d.ustep = control.step/sizeof(float);
+    }
+
+    runKalmanBatch( d, false );
+}
+
+void BatchKalmanFilter::correct(InputArray _measurements, InputArray _mask)
+{
+    CV_INSTRUMENT_REGION()
+
+    KalmanBatchData d;
+    initKalmanBatchData( *this, d, _mask );
+
+    Mat measurements = _measurements.getMat();
+    CV_Assert( measurements.type() == CV_32F && measurements.size() == Size(d.count, d.MP) );
+    d.z = measurements.ptr<float>();
+    d.zstep = measurements.step/sizeof(float);
+
+    runKalmanBatch( d, true );
+}
+
 }
@@ -42,6 +42,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_video.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #if defined __APPLE__ || defined ANDROID
 #define SMALL_LOCALSIZE
@@ -112,93 +113,203 @@ FarnebackPrepareGaussian(int n, double sigma, float *g, float *xg, float *xxg,
     ig55 = invG(5,5);
 }
 
-static void
-FarnebackPolyExp( const Mat& src, Mat& dst, int n, double sigma )
-{
-    int k, x, y;
+// the rows processed by one parallel task; the bands do not depend on the number of threads,
+// so that the result does not depend on it either
+enum { FARNEBACK_BAND = 32 };
 
-    CV_Assert( src.type() == CV_32FC1 );
-    int width = src.cols;
-    int height = src.rows;
-    AutoBuffer<float> kbuf(n*6 + 3), _row((width + n*2)*3);
-    float* g = kbuf + n;
-    float* xg = g + n*2 + 1;
-    float* xxg = xg + n*2 + 1;
-    float *row = (float*)_row + n*3;
-    double ig11, ig03, ig33, ig55;
-
-    FarnebackPrepareGaussian(n, sigma, g, xg, xxg, ig11, ig03, ig33, ig55);
+static inline int
+FarnebackNumBands( int y0, int y1 )
+{
+    return (y1 - y0 + FARNEBACK_BAND - 1)/FARNEBACK_BAND;
+}
 
-    dst.create( height, width, CV_32FC(5));
+class FarnebackPolyExpInvoker : public ParallelLoopBody
+{
+public:
+    FarnebackPolyExpInvoker( const Mat& _src, Mat& _dst, int _n, const float* _g, const float* _xg,
+                             const float* _xxg, double _ig11, double _ig03, double _ig33, double _ig55 ) :
+        src(&_src), dst(&_dst), n(_n), g(_g), xg(_xg), xxg(_xxg),
+        ig11(_ig11), ig03(_ig03), ig33(_ig33), ig55(_ig55) {}
 
-    for( y = 0; y < height; y++ )
+    void operator()( const Range& range ) const
     {
-        float g0 = g[0], g1, g2;
-        const float *srow0 = src.ptr<float>(y), *srow1 = 0;
-        float *drow = dst.ptr<float>(y);
+        int k, x, y, width = src->cols, height = src->rows;
+        int y0 = range.start*FARNEBACK_BAND, y1 = std::min(range.end*FARNEBACK_BAND, height);
 
-        // vertical part of convolution
-        for( x = 0; x < width; x++ )
-        {
-            row[x*3] = srow0[x]*g0;
-            row[x*3+1] = row[x*3+2] = 0.f;
-        }
+        // the vertically filtered rows, one plane per polynomial coefficient
+        AutoBuffer<float> _row((width + n*2)*3);
+        float *row0 = (float*)_row + n, *row1 = row0 + width + n*2, *row2 = row1 + width + n*2;
 
-        for( k = 1; k <= n; k++ )
+        for( y = y0; y < y1; y++ )
         {
-            g0 = g[k]; g1 = xg[k]; g2 = xxg[k];
-            srow0 = src.ptr<float>(std::max(y-k,0));
-            srow1 = src.ptr<float>(std::min(y+k,height-1));
+            float g0 = g[0], g1, g2;
+            const float *srow0 = src->ptr<float>(y), *srow1 = 0;
+            float *drow = dst->ptr<float>(y);
 
-            for( x = 0; x < width; x++ )
+            // vertical part of convolution
+            x = 0;
+#if CV_SIMD128
+            {
+                v_float32x4 v_g0 = v_setall_f32(g0), v_z = v_setzero_f32();
+                for( ; x <= width - 4; x += 4 )
+                {
+                    v_store(row0 + x, v_load(srow0 + x)*v_g0);
+                    v_store(row1 + x, v_z);
+                    v_store(row2 + x, v_z);
+                }
+            }
+#endif
+            for( ; x < width; x++ )
             {
-                float p = srow0[x] + srow1[x];
-                float t0 = row[x*3] + g0*p;
-                float t1 = row[x*3+1] + g1*(srow1[x] - srow0[x]);
-                float t2 = row[x*3+2] + g2*p;
-
-                row[x*3] = t0;
-                row[x*3+1] = t1;
-                row[x*3+2] = t2;
+                row0[x] = srow0[x]*g0;
+                row1[x] = row2[x] = 0.f;
             }
-        }
 
-        // horizontal part of convolution
-        for( x = 0; x < n*3; x++ )
-        {
-            row[-1-x] = row[2-x];
-            row[width*3+x] = row[width*3+x-3];
-        }
+            for( k = 1; k <= n; k++ )
+            {
+                g0 = g[k]; g1 = xg[k]; g2 = xxg[k];
+                srow0 = src->ptr<float>(std::max(y-k,0));
+                srow1 = src->ptr<float>(std::min(y+k,height-1));
+
+                x = 0;
+#if CV_SIMD128
+                v_float32x4 v_g0 = v_setall_f32(g0), v_g1 = v_setall_f32(g1), v_g2 = v_setall_f32(g2);
+                for( ; x <= width - 4; x += 4 )
+                {
+                    v_float32x4 s0 = v_load(srow0 + x), s1 = v_load(srow1 + x);
+                    v_float32x4 p = s0 + s1;
+                    v_store(row0 + x, v_load(row0 + x) + v_g0*p);
+                    v_store(row1 + x, v_load(row1 + x) + v_g1*(s1 - s0));
+                    v_store(row2 + x, v_load(row2 + x) + v_g2*p);
+                }
+#endif
+                for( ; x < width; x++ )
+                {
+                    float p = srow0[x] + srow1[x];
+                    row0[x] += g0*p;
+                    row1[x] += g1*(srow1[x] - srow0[x]);
+                    row2[x] += g2*p;
+                }
+            }
 
-        for( x = 0; x < width; x++ )
-        {
-            g0 = g[0];
-            // r1 ~ 1, r2 ~ x, r3 ~ y, r4 ~ x^2, r5 ~ y^2, r6 ~ xy
-            double b1 = row[x*3]*g0, b2 = 0, b3 = row[x*3+1]*g0,
-                b4 = 0, b5 = row[x*3+2]*g0, b6 = 0;
+            // horizontal part of convolution
+            for( x = 1; x <= n; x++ )
+            {
+                row0[-x] = row0[0]; row0[width-1+x] = row0[width-1];
+                row1[-x] = row1[0]; row1[width-1+x] = row1[width-1];
+                row2[-x] = row2[0]; row2[width-1+x] = row2[width-1];
+            }
 
-            for( k = 1; k <= n; k++ )
+            x = 0;
+#if CV_SIMD128_64F
+            // 4 pixels at once; the products and the sums are rounded the same way as below
+            for( ; x <= width - 4; x += 4 )
             {
-                double tg = row[(x+k)*3] + row[(x-k)*3];
-                g0 = g[k];
-                b1 += tg*g0;
-                b4 += tg*xxg[k];
-                b2 += (row[(x+k)*3] - row[(x-k)*3])*xg[k];
-                b3 += (row[(x+k)*3+1] + row[(x-k)*3+1])*g0;
-                b6 += (row[(x+k)*3+1] - row[(x-k)*3+1])*xg[k];
-                b5 += (row[(x+k)*3+2] + row[(x-k)*3+2])*g0;
+                v_float32x4 v_g0 = v_setall_f32(g[0]);
+                v_float32x4 t0 = v_load(row0 + x)*v_g0;
+                v_float32x4 t1 = v_load(row1 + x)*v_g0;
+                v_float32x4 t2 = v_load(row2 + x)*v_g0;
+                v_float64x2 z = v_setzero_f64();
+                v_float64x2 b1l = v_cvt_f64(t0), b1h = v_cvt_f64_high(t0), b2l = z, b2h = z;
+                v_float64x2 b3l = v_cvt_f64(t1), b3h = v_cvt_f64_high(t1), b4l = z, b4h = z;
+                v_float64x2 b5l = v_cvt_f64(t2), b5h = v_cvt_f64_high(t2), b6l = z, b6h = z;
+
+                for( k = 1; k <= n; k++ )
+                {
+                    v_float32x4 v_gk = v_setall_f32(g[k]), v_xgk = v_setall_f32(xg[k]);
+                    v_float64x2 v_dgk = v_setall_f64(g[k]), v_dxxgk = v_setall_f64(xxg[k]);
+
+                    v_float32x4 a = v_load(row0 + x + k), b = v_load(row0 + x - k);
+                    v_float32x4 tg = a + b;
+                    v_float64x2 tgl = v_cvt_f64(tg), tgh = v_cvt_f64_high(tg);
+                    b1l += tgl*v_dgk; b1h += tgh*v_dgk;
+                    b4l += tgl*v_dxxgk; b4h += tgh*v_dxxgk;
+                    t0 = (a - b)*v_xgk;
+                    b2l += v_cvt_f64(t0); b2h += v_cvt_f64_high(t0);
+
+                    a = v_load(row1 + x + k); b = v_load(row1 + x - k);
+                    t0 = (a + b)*v_gk;
+                    b3l += v_cvt_f64(t0); b3h += v_cvt_f64_high(t0);
+                    t0 = (a - b)*v_xgk;
+                    b6l += v_cvt_f64(t0); b6h += v_cvt_f64_high(t0);
+
+                    a = v_load(row2 + x + k); b = v_load(row2 + x - k);
+                    t0 = (a + b)*v_gk;
+                    b5l += v_cvt_f64(t0); b5h += v_cvt_f64_high(t0);
+                }
+
+                v_float64x2 v_ig11 = v_setall_f64(ig11), v_ig03 = v_setall_f64(ig03);
+                v_float64x2 v_ig33 = v_setall_f64(ig33), v_ig55 = v_setall_f64(ig55);
+                float CV_DECL_ALIGNED(16) buf[5][4];
+                v_store_low(buf[0], v_cvt_f32(b3l*v_ig11)); v_store_low(buf[0] + 2, v_cvt_f32(b3h*v_ig11));
+                v_store_low(buf[1], v_cvt_f32(b2l*v_ig11)); v_store_low(buf[1] + 2, v_cvt_f32(b2h*v_ig11));
+                v_store_low(buf[2], v_cvt_f32(b1l*v_ig03 + b5l*v_ig33));
+                v_store_low(buf[2] + 2, v_cvt_f32(b1h*v_ig03 + b5h*v_ig33));
+                v_store_low(buf[3], v_cvt_f32(b1l*v_ig03 + b4l*v_ig33));
+                v_store_low(buf[3] + 2, v_cvt_f32(b1h*v_ig03 + b4h*v_ig33));
+                v_store_low(buf[4], v_cvt_f32(b6l*v_ig55)); v_store_low(buf[4] + 2, v_cvt_f32(b6h*v_ig55));
+
+                for( k = 0; k < 4; k++ )
+                {
+                    float* d = drow + (x + k)*5;
+                    d[0] = buf[0][k]; d[1] = buf[1][k]; d[2] = buf[2][k];
+                    d[3] = buf[3][k]; d[4] = buf[4][k];
+                }
             }
+#endif
+            for( ; x < width; x++ )
+            {
+                g0 = g[0];
+                // r1 ~ 1, r2 ~ x, r3 ~ y, r4 ~ x^2, r5 ~ y^2, r6 ~ xy
+                double b1 = row0[x]*g0, b2 = 0, b3 = row1[x]*g0,
+                    b4 = 0, b5 = row2[x]*g0, b6 = 0;
 
-            // do not store r1
-            drow[x*5+1] = (float)(b2*ig11);
-            drow[x*5] = (float)(b3*ig11);
-            drow[x*5+3] = (float)(b1*ig03 + b4*ig33);
-            drow[x*5+2] = (float)(b1*ig03 + b5*ig33);
-            drow[x*5+4] = (float)(b6*ig55);
+                for( k = 1; k <= n; k++ )
+                {
+                    double tg = row0[x+k] + row0[x-k];
+                    g0 = g[k];
+                    b1 += tg*g0;
+                    b4 += tg*xxg[k];
+                    b2 += (row0[x+k] - row0[x-k])*xg[k];
+                    b3 += (row1[x+k] + row1[x-k])*g0;
+                    b6 += (row1[x+k] - row1[x-k])*xg[k];
+                    b5 += (row2[x+k] + row2[x-k])*g0;
+                }
+
+                // do not store r1
+                drow[x*5+1] = (float)(b2*ig11);
+                drow[x*5] = (float)(b3*ig11);
+                drow[x*5+3] = (float)(b1*ig03 + b4*ig33);
+                drow[x*5+2] = (float)(b1*ig03 + b5*ig33);
+                drow[x*5+4] = (float)(b6*ig55);
+            }
         }
     }
 
-    row -= n*3;
+private:
+    const Mat* src;
+    Mat* dst;
+    int n;
+    const float *g, *xg, *xxg;
+    double ig11, ig03, ig33, ig55;
+};
+
+static void
+FarnebackPolyExp( const Mat& src, Mat& dst, int n, double sigma )
+{
+    CV_Assert( src.type() == CV_32FC1 );
+    AutoBuffer<float> kbuf(n*6 + 3);
+    float* g = kbuf + n;
+    float* xg = g + n*2 + 1;
+    float* xxg = xg + n*2 + 1;
+    double ig11, ig03, ig33, ig55;
+
+    FarnebackPrepareGaussian(n, sigma, g, xg, xxg, ig11, ig03, ig33, ig55);
+
+    dst.create( src.rows, src.cols, CV_32FC(5));
+
+    parallel_for_(Range(0, FarnebackNumBands(0, src.rows)),
+                  FarnebackPolyExpInvoker(src, dst, n, g, xg, xxg, ig11, ig03, ig33, ig55));
 }
 
 
@@ -213,372 +324,496 @@ FarnebackPolyExpPyr( const Mat& src0, Vector<Mat>& pyr, int maxlevel, int n, dou
 }*/
 
 
-static void
-FarnebackUpdateMatrices( const Mat& _R0, const Mat& _R1, const Mat& _flow, Mat& matM, int _y0, int _y1 )
+enum { FARNEBACK_BORDER = 5 };
+
+static inline void
+FarnebackUpdateMatrixPixel( const float* R0, const float* R1, size_t step1, const float* flow,
+                            float* M, int x, int y, int width, int height )
 {
-    const int BORDER = 5;
+    const int BORDER = FARNEBACK_BORDER;
     static const float border[BORDER] = {0.14f, 0.14f, 0.4472f, 0.4472f, 0.4472f};
 
+    float dx = flow[x*2], dy = flow[x*2+1];
+    float fx = x + dx, fy = y + dy;
+
+#if 1
+    int x1 = cvFloor(fx), y1 = cvFloor(fy);
+    const float* ptr = R1 + y1*step1 + x1*5;
+    float r2, r3, r4, r5, r6;
+
+    fx -= x1; fy -= y1;
+
+    if( (unsigned)x1 < (unsigned)(width-1) &&
+        (unsigned)y1 < (unsigned)(height-1) )
+    {
+        float a00 = (1.f-fx)*(1.f-fy), a01 = fx*(1.f-fy),
+              a10 = (1.f-fx)*fy, a11 = fx*fy;
+
+        r2 = a00*ptr[0] + a01*ptr[5] + a10*ptr[step1] + a11*ptr[step1+5];
+        r3 = a00*ptr[1] + a01*ptr[6] + a10*ptr[step1+1] + a11*ptr[step1+6];
+        r4 = a00*ptr[2] + a01*ptr[7] + a10*ptr[step1+2] + a11*ptr[step1+7];
+        r5 = a00*ptr[3] + a01*ptr[8] + a10*ptr[step1+3] + a11*ptr[step1+8];
+        r6 = a00*ptr[4] + a01*ptr[9] + a10*ptr[step1+4] + a11*ptr[step1+9];
+
+        r4 = (R0[x*5+2] + r4)*0.5f;
+        r5 = (R0[x*5+3] + r5)*0.5f;
+        r6 = (R0[x*5+4] + r6)*0.25f;
+    }
+#else
+    int x1 = cvRound(fx), y1 = cvRound(fy);
+    const float* ptr = R1 + y1*step1 + x1*5;
+    float r2, r3, r4, r5, r6;
+
+    if( (unsigned)x1 < (unsigned)width &&
+        (unsigned)y1 < (unsigned)height )
+    {
+        r2 = ptr[0];
+        r3 = ptr[1];
+        r4 = (R0[x*5+2] + ptr[2])*0.5f;
+        r5 = (R0[x*5+3] + ptr[3])*0.5f;
+        r6 = (R0[x*5+4] + ptr[4])*0.25f;
+    }
+#endif
+    else
+    {
+        r2 = r3 = 0.f;
+        r4 = R0[x*5+2];
+        r5 = R0[x*5+3];
+        r6 = R0[x*5+4]*0.5f;
+    }
+
+    r2 = (R0[x*5] - r2)*0.5f;
+    r3 = (R0[x*5+1] - r3)*0.5f;
+
+    r2 += r4*dy + r6*dx;
+    r3 += r6*dy + r5*dx;
+
+    if( (unsigned)(x - BORDER) >= (unsigned)(width - BORDER*2) ||
+        (unsigned)(y - BORDER) >= (unsigned)(height - BORDER*2))
+    {
+        float scale = (x < BORDER ? border[x] : 1.f)*
+            (x >= width - BORDER ? border[width - x - 1] : 1.f)*
+            (y < BORDER ? border[y] : 1.f)*
+            (y >= height - BORDER ? border[height - y - 1] : 1.f);
+
+        r2 *= scale; r3 *= scale; r4 *= scale;
+        r5 *= scale; r6 *= scale;
+    }
+
+    M[x*5]   = r4*r4 + r6*r6; // G(1,1)
+    M[x*5+1] = (r4 + r5)*r6;  // G(1,2)=G(2,1)
+    M[x*5+2] = r5*r5 + r6*r6; // G(2,2)
+    M[x*5+3] = r4*r2 + r6*r3; // h(1)
+    M[x*5+4] = r6*r2 + r5*r3; // h(2)
+}
+
+static void
+FarnebackUpdateMatricesRows( const Mat& _R0, const Mat& _R1, const Mat& _flow, Mat& matM, int _y0, int _y1 )
+{
+    const int BORDER = FARNEBACK_BORDER;
     int x, y, width = _flow.cols, height = _flow.rows;
     const float* R1 = _R1.ptr<float>();
     size_t step1 = _R1.step/sizeof(R1[0]);
 
-    matM.create(height, width, CV_32FC(5));
-
     for( y = _y0; y < _y1; y++ )
     {
         const float* flow = _flow.ptr<float>(y);
         const float* R0 = _R0.ptr<float>(y);
         float* M = matM.ptr<float>(y);
 
-        for( x = 0; x < width; x++ )
+        x = 0;
+#if CV_SIMD128
+        // 4 pixels at once out of the border, where all the 4 bilinear neighbours are inside;
+        // the operations are the same as in FarnebackUpdateMatrixPixel
+        if( (unsigned)(y - BORDER) < (unsigned)(height - BORDER*2) )
         {
-            float dx = flow[x*2], dy = flow[x*2+1];
-            float fx = x + dx, fy = y + dy;
-
-#if 1
-            int x1 = cvFloor(fx), y1 = cvFloor(fy);
-            const float* ptr = R1 + y1*step1 + x1*5;
-            float r2, r3, r4, r5, r6;
+            for( ; x < BORDER; x++ )
+                FarnebackUpdateMatrixPixel( R0, R1, step1, flow, M, x, y, width, height );
 
-            fx -= x1; fy -= y1;
+            v_float32x4 v_one = v_setall_f32(1.f), v_half = v_setall_f32(0.5f), v_quarter = v_setall_f32(0.25f);
+            v_float32x4 v_y = v_setall_f32((float)y), v_x0(0.f, 1.f, 2.f, 3.f);
+            v_int32x4 v_zero = v_setzero_s32(), v_maxx = v_setall_s32(width - 1), v_maxy = v_setall_s32(height - 1);
 
-            if( (unsigned)x1 < (unsigned)(width-1) &&
-                (unsigned)y1 < (unsigned)(height-1) )
+            for( ; x <= width - BORDER - 4; x += 4 )
             {
-                float a00 = (1.f-fx)*(1.f-fy), a01 = fx*(1.f-fy),
-                      a10 = (1.f-fx)*fy, a11 = fx*fy;
-
-                r2 = a00*ptr[0] + a01*ptr[5] + a10*ptr[step1] + a11*ptr[step1+5];
-                r3 = a00*ptr[1] + a01*ptr[6] + a10*ptr[step1+1] + a11*ptr[step1+6];
-                r4 = a00*ptr[2] + a01*ptr[7] + a10*ptr[step1+2] + a11*ptr[step1+7];
-                r5 = a00*ptr[3] + a01*ptr[8] + a10*ptr[step1+3] + a11*ptr[step1+8];
-                r6 = a00*ptr[4] + a01*ptr[9] + a10*ptr[step1+4] + a11*ptr[step1+9];
-
-                r4 = (R0[x*5+2] + r4)*0.5f;
-                r5 = (R0[x*5+3] + r5)*0.5f;
-                r6 = (R0[x*5+4] + r6)*0.25f;
-            }
-#else
-            int x1 = cvRound(fx), y1 = cvRound(fy);
-            const float* ptr = R1 + y1*step1 + x1*5;
-            float r2, r3, r4, r5, r6;
+                v_float32x4 dx, dy;
+                v_load_deinterleave(flow + x*2, dx, dy);
+                v_float32x4 fx = v_setall_f32((float)x) + v_x0 + dx, fy = v_y + dy;
+                v_int32x4 x1 = v_floor(fx), y1 = v_floor(fy);
+                if( !v_check_all((x1 >= v_zero) & (x1 < v_maxx) & (y1 >= v_zero) & (y1 < v_maxy)) )
+                {
+                    for( int k = 0; k < 4; k++ )
+                        FarnebackUpdateMatrixPixel( R0, R1, step1, flow, M, x + k, y, width, height );
+                    continue;
+                }
 
-            if( (unsigned)x1 < (unsigned)width &&
-                (unsigned)y1 < (unsigned)height )
-            {
-                r2 = ptr[0];
-                r3 = ptr[1];
-                r4 = (R0[x*5+2] + ptr[2])*0.5f;
-                r5 = (R0[x*5+3] + ptr[3])*0.5f;
-                r6 = (R0[x*5+4] + ptr[4])*0.25f;
-            }
-#endif
-            else
-            {
-                r2 = r3 = 0.f;
-                r4 = R0[x*5+2];
-                r5 = R0[x*5+3];
-                r6 = R0[x*5+4]*0.5f;
-            }
+                fx -= v_cvt_f32(x1); fy -= v_cvt_f32(y1);
+                int CV_DECL_ALIGNED(16) ofs[4];
+                float CV_DECL_ALIGNED(16) a[4][4], r6buf[4], m4buf[4];
+                v_store_aligned(ofs, y1*v_setall_s32((int)step1) + x1*v_setall_s32(5));
+                v_store_aligned(a[0], (v_one - fx)*(v_one - fy));
+                v_store_aligned(a[1], fx*(v_one - fy));
+                v_store_aligned(a[2], (v_one - fx)*fy);
+                v_store_aligned(a[3], fx*fy);
+
+                v_float32x4 r[4];
+                for( int k = 0; k < 4; k++ )
+                {
+                    const float* ptr = R1 + ofs[k];
+                    float a00 = a[0][k], a01 = a[1][k], a10 = a[2][k], a11 = a[3][k];
+                    r[k] = v_setall_f32(a00)*v_load(ptr) + v_setall_f32(a01)*v_load(ptr + 5) +
+                           v_setall_f32(a10)*v_load(ptr + step1) + v_setall_f32(a11)*v_load(ptr + step1 + 5);
+                    r6buf[k] = a00*ptr[4] + a01*ptr[9] + a10*ptr[step1+4] + a11*ptr[step1+9];
+                }
 
-            r2 = (R0[x*5] - r2)*0.5f;
-            r3 = (R0[x*5+1] - r3)*0.5f;
+                v_float32x4 r2, r3, r4, r5, r6 = v_load_aligned(r6buf);
+                v_float32x4 c0, c1, c2, c3, c4(R0[x*5+4], R0[x*5+9], R0[x*5+14], R0[x*5+19]);
+                v_transpose4x4(r[0], r[1], r[2], r[3], r2, r3, r4, r5);
+                v_transpose4x4(v_load(R0 + x*5), v_load(R0 + x*5 + 5), v_load(R0 + x*5 + 10),
+                               v_load(R0 + x*5 + 15), c0, c1, c2, c3);
 
-            r2 += r4*dy + r6*dx;
-            r3 += r6*dy + r5*dx;
+                r4 = (c2 + r4)*v_half;
+                r5 = (c3 + r5)*v_half;
+                r6 = (c4 + r6)*v_quarter;
 
-            if( (unsigned)(x - BORDER) >= (unsigned)(width - BORDER*2) ||
-                (unsigned)(y - BORDER) >= (unsigned)(height - BORDER*2))
-            {
-                float scale = (x < BORDER ? border[x] : 1.f)*
-                    (x >= width - BORDER ? border[width - x - 1] : 1.f)*
-                    (y < BORDER ? border[y] : 1.f)*
-                    (y >= height - BORDER ? border[height - y - 1] : 1.f);
+                r2 = (c0 - r2)*v_half;
+                r3 = (c1 - r3)*v_half;
 
-                r2 *= scale; r3 *= scale; r4 *= scale;
-                r5 *= scale; r6 *= scale;
-            }
+                r2 += r4*dy + r6*dx;
+                r3 += r6*dy + r5*dx;
 
-            M[x*5]   = r4*r4 + r6*r6; // G(1,1)
-            M[x*5+1] = (r4 + r5)*r6;  // G(1,2)=G(2,1)
-            M[x*5+2] = r5*r5 + r6*r6; // G(2,2)
-            M[x*5+3] = r4*r2 + r6*r3; // h(1)
-            M[x*5+4] = r6*r2 + r5*r3; // h(2)
+                v_float32x4 m0 = r4*r4 + r6*r6, m1 = (r4 + r5)*r6, m2 = r5*r5 + r6*r6, m3 = r4*r2 + r6*r3;
+                v_store_aligned(m4buf, r6*r2 + r5*r3);
+                v_transpose4x4(m0, m1, m2, m3, r[0], r[1], r[2], r[3]);
+                for( int k = 0; k < 4; k++ )
+                {
+                    v_store(M + (x + k)*5, r[k]);
+                    M[(x + k)*5 + 4] = m4buf[k];
+                }
+            }
         }
+#endif
+        for( ; x < width; x++ )
+            FarnebackUpdateMatrixPixel( R0, R1, step1, flow, M, x, y, width, height );
     }
 }
 
+class FarnebackUpdateMatricesInvoker : public ParallelLoopBody
+{
+public:
+    FarnebackUpdateMatricesInvoker( const Mat& _R0, const Mat& _R1, const Mat& _flow, Mat& _matM, int _y0, int _y1 ) :
+        R0(&_R0), R1(&_R1), flow(&_flow), matM(&_matM), y0(_y0), y1(_y1) {}
+
+    void operator()( const Range& range ) const
+    {
+        FarnebackUpdateMatricesRows( *R0, *R1, *flow, *matM, y0 + range.start*FARNEBACK_BAND,
+                                     std::min(y0 + range.end*FARNEBACK_BAND, y1) );
+    }
+
+private:
+    const Mat *R0, *R1, *flow;
+    Mat* matM;
+    int y0, y1;
+};
 
 static void
-FarnebackUpdateFlow_Blur( const Mat& _R0, const Mat& _R1,
-                          Mat& _flow, Mat& matM, int block_size,
-                          bool update_matrices )
+FarnebackUpdateMatrices( const Mat& _R0, const Mat& _R1, const Mat& _flow, Mat& matM, int _y0, int _y1 )
 {
-    int x, y, width = _flow.cols, height = _flow.rows;
-    int m = block_size/2;
-    int y0 = 0, y1;
-    int min_update_stripe = std::max((1 << 10)/width, block_size);
-    double scale = 1./(block_size*block_size);
+    matM.create(_flow.rows, _flow.cols, CV_32FC(5));
+    parallel_for_(Range(0, FarnebackNumBands(_y0, _y1)),
+                  FarnebackUpdateMatricesInvoker(_R0, _R1, _flow, matM, _y0, _y1));
+}
 
-    AutoBuffer<double> _vsum((width+m*2+2)*5);
-    double* vsum = _vsum + (m+1)*5;
 
-    // init vsum
-    const float* srow0 = matM.ptr<float>();
-    for( x = 0; x < width*5; x++ )
-        vsum[x] = srow0[x]*(m+2);
+class FarnebackUpdateFlow_BlurInvoker : public ParallelLoopBody
+{
+public:
+    FarnebackUpdateFlow_BlurInvoker( const Mat& _matM, Mat& _flow, int _block_size ) :
+        matM(&_matM), flow(&_flow), block_size(_block_size) {}
 
-    for( y = 1; y < m; y++ )
+    void operator()( const Range& range ) const
     {
-        srow0 = matM.ptr<float>(std::min(y,height-1));
-        for( x = 0; x < width*5; x++ )
-            vsum[x] += srow0[x];
+        int width = flow->cols, m = block_size/2;
+        AutoBuffer<double> _vsum((width+m*2+2)*5);
+        double* vsum = _vsum + (m+1)*5;
+
+        for( int b = range.start; b < range.end; b++ )
+            blurBand( b*FARNEBACK_BAND, std::min((b + 1)*FARNEBACK_BAND, flow->rows), vsum );
     }
 
-    // compute blur(G)*flow=blur(h)
-    for( y = 0; y < height; y++ )
+    // the running sums are started anew in every band
+    void blurBand( int y0, int y1, double* vsum ) const
     {
-        double g11, g12, g22, h1, h2;
-        float* flow = _flow.ptr<float>(y);
-
-        srow0 = matM.ptr<float>(std::max(y-m-1,0));
-        const float* srow1 = matM.ptr<float>(std::min(y+m,height-1));
+        int x, y, width = flow->cols, height = flow->rows;
+        int m = block_size/2;
+        double scale = 1./(block_size*block_size);
 
-        // vertical blur
+        // init vsum with the rows [y0-m-1, y0+m-1]
+        const float* srow0 = matM->ptr<float>(std::max(y0-m-1,0));
         for( x = 0; x < width*5; x++ )
-            vsum[x] += srow1[x] - srow0[x];
+            vsum[x] = srow0[x];
 
-        // update borders
-        for( x = 0; x < (m+1)*5; x++ )
+        for( y = y0-m; y < y0+m; y++ )
         {
-            vsum[-1-x] = vsum[4-x];
-            vsum[width*5+x] = vsum[width*5+x-5];
+            srow0 = matM->ptr<float>(std::min(std::max(y,0),height-1));
+            for( x = 0; x < width*5; x++ )
+                vsum[x] += srow0[x];
         }
 
-        // init g** and h*
-        g11 = vsum[0]*(m+2);
-        g12 = vsum[1]*(m+2);
-        g22 = vsum[2]*(m+2);
-        h1 = vsum[3]*(m+2);
-        h2 = vsum[4]*(m+2);
-
-        for( x = 1; x < m; x++ )
+        // compute blur(G)*flow=blur(h)
+        for( y = y0; y < y1; y++ )
         {
-            g11 += vsum[x*5];
-            g12 += vsum[x*5+1];
-            g22 += vsum[x*5+2];
-            h1 += vsum[x*5+3];
-            h2 += vsum[x*5+4];
-        }
+            double g11, g12, g22, h1, h2;
+            float* fptr = flow->ptr<float>(y);
 
-        // horizontal blur
-        for( x = 0; x < width; x++ )
-        {
-            g11 += vsum[(x+m)*5] - vsum[(x-m)*5 - 5];
-            g12 += vsum[(x+m)*5 + 1] - vsum[(x-m)*5 - 4];
-            g22 += vsum[(x+m)*5 + 2] - vsum[(x-m)*5 - 3];
-            h1 += vsum[(x+m)*5 + 3] - vsum[(x-m)*5 - 2];
-            h2 += vsum[(x+m)*5 + 4] - vsum[(x-m)*5 - 1];
-
-            double g11_ = g11*scale;
-            double g12_ = g12*scale;
-            double g22_ = g22*scale;
-            double h1_ = h1*scale;
-            double h2_ = h2*scale;
-
-            double idet = 1./(g11_*g22_ - g12_*g12_+1e-3);
-
-            flow[x*2] = (float)((g11_*h2_-g12_*h1_)*idet);
-            flow[x*2+1] = (float)((g22_*h1_-g12_*h2_)*idet);
-        }
+            srow0 = matM->ptr<float>(std::max(y-m-1,0));
+            const float* srow1 = matM->ptr<float>(std::min(y+m,height-1));
 
-        y1 = y == height - 1 ? height : y - block_size;
-        if( update_matrices && (y1 == height || y1 >= y0 + min_update_stripe) )
-        {
-            FarnebackUpdateMatrices( _R0, _R1, _flow, matM, y0, y1 );
-            y0 = y1;
+            // vertical blur
+            x = 0;
+#if CV_SIMD128_64F
+            for( ; x <= width*5 - 4; x += 4 )
+            {
+                v_float32x4 d = v_load(srow1 + x) - v_load(srow0 + x);
+                v_store(vsum + x, v_load(vsum + x) + v_cvt_f64(d));
+                v_store(vsum + x + 2, v_load(vsum + x + 2) + v_cvt_f64_high(d));
+            }
+#endif
+            for( ; x < width*5; x++ )
+                vsum[x] += srow1[x] - srow0[x];
+
+            // update borders
+            for( x = 0; x < (m+1)*5; x++ )
+            {
+                vsum[-1-x] = vsum[4-x];
+                vsum[width*5+x] = vsum[width*5+x-5];
+            }
+
+            // init g** and h*
+            g11 = vsum[0]*(m+2);
+            g12 = vsum[1]*(m+2);
+            g22 = vsum[2]*(m+2);
+            h1 = vsum[3]*(m+2);
+            h2 = vsum[4]*(m+2);
+
+            for( x = 1; x < m; x++ )
+            {
+                g11 += vsum[x*5];
+                g12 += vsum[x*5+1];
+                g22 += vsum[x*5+2];
+                h1 += vsum[x*5+3];
+                h2 += vsum[x*5+4];
+            }
+
+            // horizontal blur
+            for( x = 0; x < width; x++ )
+            {
+                g11 += vsum[(x+m)*5] - vsum[(x-m)*5 - 5];
+                g12 += vsum[(x+m)*5 + 1] - vsum[(x-m)*5 - 4];
+                g22 += vsum[(x+m)*5 + 2] - vsum[(x-m)*5 - 3];
+                h1 += vsum[(x+m)*5 + 3] - vsum[(x-m)*5 - 2];
+                h2 += vsum[(x+m)*5 + 4] - vsum[(x-m)*5 - 1];
+
+                double g11_ = g11*scale;
+                double g12_ = g12*scale;
+                double g22_ = g22*scale;
+                double h1_ = h1*scale;
+                double h2_ = h2*scale;
+
+                double idet = 1./(g11_*g22_ - g12_*g12_+1e-3);
+
+                fptr[x*2] = (float)((g11_*h2_-g12_*h1_)*idet);
+                fptr[x*2+1] = (float)((g22_*h1_-g12_*h2_)*idet);
+            }
         }
     }
-}
 
+private:
+    const Mat* matM;
+    Mat* flow;
+    int block_size;
+};
 
+// The flow is computed from the matrices first, then the matrices are updated from the new flow;
+// each of the passes runs in parallel over the bands of rows
 static void
-FarnebackUpdateFlow_GaussianBlur( const Mat& _R0, const Mat& _R1,
-                                  Mat& _flow, Mat& matM, int block_size,
-                                  bool update_matrices )
+FarnebackUpdateFlow_Blur( const Mat& _R0, const Mat& _R1,
+                          Mat& _flow, Mat& matM, int block_size,
+                          bool update_matrices )
 {
-    int x, y, i, width = _flow.cols, height = _flow.rows;
-    int m = block_size/2;
-    int y0 = 0, y1;
-    int min_update_stripe = std::max((1 << 10)/width, block_size);
-    double sigma = m*0.3, s = 1;
+    parallel_for_(Range(0, FarnebackNumBands(0, _flow.rows)),
+                  FarnebackUpdateFlow_BlurInvoker(matM, _flow, block_size));
 
-    AutoBuffer<float> _vsum((width+m*2+2)*5 + 16), _hsum(width*5 + 16);
-    AutoBuffer<float> _kernel((m+1)*5 + 16);
-    AutoBuffer<float*> _srow(m*2+1);
-    float *vsum = alignPtr((float*)_vsum + (m+1)*5, 16), *hsum = alignPtr((float*)_hsum, 16);
-    float* kernel = (float*)_kernel;
-    const float** srow = (const float**)&_srow[0];
-    kernel[0] = (float)s;
+    if( update_matrices )
+        FarnebackUpdateMatrices( _R0, _R1, _flow, matM, 0, _flow.rows );
+}
 
-    for( i = 1; i <= m; i++ )
-    {
-        float t = (float)std::exp(-i*i/(2*sigma*sigma) );
-        kernel[i] = t;
-        s += t*2;
-    }
 
-    s = 1./s;
-    for( i = 0; i <= m; i++ )
-        kernel[i] = (float)(kernel[i]*s);
+class FarnebackUpdateFlow_GaussianBlurInvoker : public ParallelLoopBody
+{
+public:
+    FarnebackUpdateFlow_GaussianBlurInvoker( const Mat& _matM, Mat& _flow, int _m, const float* _kernel ) :
+        matM(&_matM), flow(&_flow), m(_m), kernel(_kernel) {}
 
-#if CV_SSE2
-    float* simd_kernel = alignPtr(kernel + m+1, 16);
-    volatile bool useSIMD = checkHardwareSupport(CV_CPU_SSE);
-    if( useSIMD )
+    void operator()( const Range& range ) const
     {
-        for( i = 0; i <= m; i++ )
-            _mm_store_ps(simd_kernel + i*4, _mm_set1_ps(kernel[i]));
-    }
-#endif
+        int x, y, i, width = flow->cols, height = flow->rows;
+        int y0 = range.start*FARNEBACK_BAND, y1 = std::min(range.end*FARNEBACK_BAND, height);
 
-    // compute blur(G)*flow=blur(h)
-    for( y = 0; y < height; y++ )
-    {
-        double g11, g12, g22, h1, h2;
-        float* flow = _flow.ptr<float>(y);
+        AutoBuffer<float> _vsum((width+m*2+2)*5 + 16), _hsum(width*5 + 16);
+        AutoBuffer<float*> _srow(m*2+1);
+        float *vsum = alignPtr((float*)_vsum + (m+1)*5, 16), *hsum = alignPtr((float*)_hsum, 16);
+        const float** srow = (const float**)&_srow[0];
 
-        // vertical blur
-        for( i = 0; i <= m; i++ )
+        // compute blur(G)*flow=blur(h)
+        for( y = y0; y < y1; y++ )
         {
-            srow[m-i] = matM.ptr<float>(std::max(y-i,0));
-            srow[m+i] = matM.ptr<float>(std::min(y+i,height-1));
-        }
+            double g11, g12, g22, h1, h2;
+            float* fptr = flow->ptr<float>(y);
 
-        x = 0;
-#if CV_SSE2
-        if( useSIMD )
-        {
+            // vertical blur
+            for( i = 0; i <= m; i++ )
+            {
+                srow[m-i] = matM->ptr<float>(std::max(y-i,0));
+                srow[m+i] = matM->ptr<float>(std::min(y+i,height-1));
+            }
+
+            x = 0;
+#if CV_SIMD128
             for( ; x <= width*5 - 16; x += 16 )
             {
                 const float *sptr0 = srow[m], *sptr1;
-                __m128 g4 = _mm_load_ps(simd_kernel);
-                __m128 s0, s1, s2, s3;
-                s0 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x), g4);
-                s1 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x + 4), g4);
-                s2 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x + 8), g4);
-                s3 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x + 12), g4);
+                v_float32x4 g4 = v_setall_f32(kernel[0]);
+                v_float32x4 s0 = v_load(sptr0 + x)*g4;
+                v_float32x4 s1 = v_load(sptr0 + x + 4)*g4;
+                v_float32x4 s2 = v_load(sptr0 + x + 8)*g4;
+                v_float32x4 s3 = v_load(sptr0 + x + 12)*g4;
 
                 for( i = 1; i <= m; i++ )
                 {
-                    __m128 x0, x1;
                     sptr0 = srow[m+i], sptr1 = srow[m-i];
-                    g4 = _mm_load_ps(simd_kernel + i*4);
-                    x0 = _mm_add_ps(_mm_loadu_ps(sptr0 + x), _mm_loadu_ps(sptr1 + x));
-                    x1 = _mm_add_ps(_mm_loadu_ps(sptr0 + x + 4), _mm_loadu_ps(sptr1 + x + 4));
-                    s0 = _mm_add_ps(s0, _mm_mul_ps(x0, g4));
-                    s1 = _mm_add_ps(s1, _mm_mul_ps(x1, g4));
-                    x0 = _mm_add_ps(_mm_loadu_ps(sptr0 + x + 8), _mm_loadu_ps(sptr1 + x + 8));
-                    x1 = _mm_add_ps(_mm_loadu_ps(sptr0 + x + 12), _mm_loadu_ps(sptr1 + x + 12));
-                    s2 = _mm_add_ps(s2, _mm_mul_ps(x0, g4));
-                    s3 = _mm_add_ps(s3, _mm_mul_ps(x1, g4));
+                    g4 = v_setall_f32(kernel[i]);
+                    s0 += (v_load(sptr0 + x) + v_load(sptr1 + x))*g4;
+                    s1 += (v_load(sptr0 + x + 4) + v_load(sptr1 + x + 4))*g4;
+                    s2 += (v_load(sptr0 + x + 8) + v_load(sptr1 + x + 8))*g4;
+                    s3 += (v_load(sptr0 + x + 12) + v_load(sptr1 + x + 12))*g4;
                 }
 
-                _mm_store_ps(vsum + x, s0);
-                _mm_store_ps(vsum + x + 4, s1);
-                _mm_store_ps(vsum + x + 8, s2);
-                _mm_store_ps(vsum + x + 12, s3);
+                v_store_aligned(vsum + x, s0);
+                v_store_aligned(vsum + x + 4, s1);
+                v_store_aligned(vsum + x + 8, s2);
+                v_store_aligned(vsum + x + 12, s3);
             }
 
             for( ; x <= width*5 - 4; x += 4 )
             {
                 const float *sptr0 = srow[m], *sptr1;
-                __m128 g4 = _mm_load_ps(simd_kernel);
-                __m128 s0 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x), g4);
+                v_float32x4 g4 = v_setall_f32(kernel[0]);
+                v_float32x4 s0 = v_load(sptr0 + x)*g4;
 
                 for( i = 1; i <= m; i++ )
                 {
                     sptr0 = srow[m+i], sptr1 = srow[m-i];
-                    g4 = _mm_load_ps(simd_kernel + i*4);
-                    __m128 x0 = _mm_add_ps(_mm_loadu_ps(sptr0 + x), _mm_loadu_ps(sptr1 + x));
-                    s0 = _mm_add_ps(s0, _mm_mul_ps(x0, g4));
+                    g4 = v_setall_f32(kernel[i]);
+                    s0 += (v_load(sptr0 + x) + v_load(sptr1 + x))*g4;
                 }
-                _mm_store_ps(vsum + x, s0);
+                v_store_aligned(vsum + x, s0);
             }
-        }
 #endif
-        for( ; x < width*5; x++ )
-        {
-            float s0 = srow[m][x]*kernel[0];
-            for( i = 1; i <= m; i++ )
-                s0 += (srow[m+i][x] + srow[m-i][x])*kernel[i];
-            vsum[x] = s0;
-        }
+            for( ; x < width*5; x++ )
+            {
+                float s0 = srow[m][x]*kernel[0];
+                for( i = 1; i <= m; i++ )
+                    s0 += (srow[m+i][x] + srow[m-i][x])*kernel[i];
+                vsum[x] = s0;
+            }
 
-        // update borders
-        for( x = 0; x < m*5; x++ )
-        {
-            vsum[-1-x] = vsum[4-x];
-            vsum[width*5+x] = vsum[width*5+x-5];
-        }
+            // update borders
+            for( x = 0; x < m*5; x++ )
+            {
+                vsum[-1-x] = vsum[4-x];
+                vsum[width*5+x] = vsum[width*5+x-5];
+            }
 
-        // horizontal blur
-        x = 0;
-#if CV_SSE2
-        if( useSIMD )
-        {
+            // horizontal blur
+            x = 0;
+#if CV_SIMD128
             for( ; x <= width*5 - 8; x += 8 )
             {
-                __m128 g4 = _mm_load_ps(simd_kernel);
-                __m128 s0 = _mm_mul_ps(_mm_loadu_ps(vsum + x), g4);
-                __m128 s1 = _mm_mul_ps(_mm_loadu_ps(vsum + x + 4), g4);
+                v_float32x4 g4 = v_setall_f32(kernel[0]);
+                v_float32x4 s0 = v_load(vsum + x)*g4;
+                v_float32x4 s1 = v_load(vsum + x + 4)*g4;
 
                 for( i = 1; i <= m; i++ )
                 {
-                    g4 = _mm_load_ps(simd_kernel + i*4);
-                    __m128 x0 = _mm_add_ps(_mm_loadu_ps(vsum + x - i*5),
-                                           _mm_loadu_ps(vsum + x + i*5));
-                    __m128 x1 = _mm_add_ps(_mm_loadu_ps(vsum + x - i*5 + 4),
-                                           _mm_loadu_ps(vsum + x + i*5 + 4));
-                    s0 = _mm_add_ps(s0, _mm_mul_ps(x0, g4));
-                    s1 = _mm_add_ps(s1, _mm_mul_ps(x1, g4));
+                    g4 = v_setall_f32(kernel[i]);
+                    s0 += (v_load(vsum + x - i*5) + v_load(vsum + x + i*5))*g4;
+                    s1 += (v_load(vsum + x - i*5 + 4) + v_load(vsum + x + i*5 + 4))*g4;
                 }
 
-                _mm_store_ps(hsum + x, s0);
-                _mm_store_ps(hsum + x + 4, s1);
+                v_store_aligned(hsum + x, s0);
+                v_store_aligned(hsum + x + 4, s1);
             }
-        }
 #endif
-        for( ; x < width*5; x++ )
-        {
-            float sum = vsum[x]*kernel[0];
-            for( i = 1; i <= m; i++ )
-                sum += kernel[i]*(vsum[x - i*5] + vsum[x + i*5]);
-            hsum[x] = sum;
-        }
+            for( ; x < width*5; x++ )
+            {
+                float sum = vsum[x]*kernel[0];
+                for( i = 1; i <= m; i++ )
+                    sum += kernel[i]*(vsum[x - i*5] + vsum[x + i*5]);
+                hsum[x] = sum;
+            }
 
-        for( x = 0; x < width; x++ )
-        {
-            g11 = hsum[x*5];
-            g12 = hsum[x*5+1];
-            g22 = hsum[x*5+2];
-            h1 = hsum[x*5+3];
-            h2 = hsum[x*5+4];
+            for( x = 0; x < width; x++ )
+            {
+                g11 = hsum[x*5];
+                g12 = hsum[x*5+1];
+                g22 = hsum[x*5+2];
+                h1 = hsum[x*5+3];
+                h2 = hsum[x*5+4];
 
-            double idet = 1./(g11*g22 - g12*g12 + 1e-3);
+                double idet = 1./(g11*g22 - g12*g12 + 1e-3);
 
-            flow[x*2] = (float)((g11*h2-g12*h1)*idet);
-            flow[x*2+1] = (float)((g22*h1-g12*h2)*idet);
+                fptr[x*2] = (float)((g11*h2-g12*h1)*idet);
+                fptr[x*2+1] = (float)((g22*h1-g12*h2)*idet);
+            }
         }
+    }
 
-        y1 = y == height - 1 ? height : y - block_size;
-        if( update_matrices && (y1 == height || y1 >= y0 + min_update_stripe) )
-        {
-            FarnebackUpdateMatrices( _R0, _R1, _flow, matM, y0, y1 );
-            y0 = y1;
-        }
+private:
+    const Mat* matM;
+    Mat* flow;
+    int m;
+    const float* kernel;
+};
+
+static void
+FarnebackUpdateFlow_GaussianBlur( const Mat& _R0, const Mat& _R1,
+                                  Mat& _flow, Mat& matM, int block_size,
+                                  bool update_matrices )
+{
+    int i, m = block_size/2;
+    double sigma = m*0.3, s = 1;
+
+    AutoBuffer<float> _kernel(m+1);
+    float* kernel = (float*)_kernel;
+    kernel[0] = (float)s;
+
+    for( i = 1; i <= m; i++ )
+    {
+        float t = (float)std::exp(-i*i/(2*sigma*sigma) );
+        kernel[i] = t;
+        s += t*2;
     }
+
+    s = 1./s;
+    for( i = 0; i <= m; i++ )
+        kernel[i] = (float)(kernel[i]*s);
+
+    parallel_for_(Range(0, FarnebackNumBands(0, _flow.rows)),
+                  FarnebackUpdateFlow_GaussianBlurInvoker(matM, _flow, m, kernel));
+
+    if( update_matrices )
+        FarnebackUpdateMatrices( _R0, _R1, _flow, matM, 0, _flow.rows );
 }
 
 }
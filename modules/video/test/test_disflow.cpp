@@ -0,0 +1,56 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+TEST(Video_DISOpticalFlow, translation)
+{
+    Point2f shift(5.5f, -3.25f);
+    Mat frame0, frame1;
+    cvtest::makeShiftedPair(Size(320, 240), shift, frame0, frame1);
+
+    for( int preset = DISOpticalFlow::PRESET_ULTRAFAST; preset <= DISOpticalFlow::PRESET_MEDIUM; preset++ )
+    {
+        Ptr<DISOpticalFlow> dis = DISOpticalFlow::create(preset);
+        Mat flow;
+        dis->calc(frame0, frame1, flow);
+        ASSERT_EQ(CV_32FC2, flow.type());
+        ASSERT_EQ(frame0.size(), flow.size());
+
+        // the fast presets stop at the quarter resolution, where the texture is barely sampled
+        double eps = preset == DISOpticalFlow::PRESET_MEDIUM ? 0.1 : 0.2;
+        Scalar m = mean(flow(Rect(32, 32, flow.cols - 64, flow.rows - 64)));
+        EXPECT_NEAR(shift.x, m[0], eps) << "preset=" << preset;
+        EXPECT_NEAR(shift.y, m[1], eps) << "preset=" << preset;
+    }
+}
+
+TEST(Video_DISOpticalFlow, initialFlow)
+{
+    Point2f shift(2.5f, 1.5f);
+    Mat frame0, frame1;
+    cvtest::makeShiftedPair(Size(320, 240), shift, frame0, frame1);
+
+    Ptr<DISOpticalFlow> dis = DISOpticalFlow::create(DISOpticalFlow::PRESET_FAST);
+    dis->setUseInitialFlow(true);
+    Mat flow(frame0.size(), CV_32FC2, Scalar(shift.x, shift.y));
+    dis->calc(frame0, frame1, flow);
+
+    Scalar m = mean(flow(Rect(32, 32, flow.cols - 64, flow.rows - 64)));
+    EXPECT_NEAR(shift.x, m[0], 0.1);
+    EXPECT_NEAR(shift.y, m[1], 0.1);
+}
+
+TEST(Video_DISOpticalFlow, threads)
+{
+    // the image size is not a multiple of the patch stride and of the bands processed in parallel
+    Mat frame0, frame1;
+    cvtest::makeShiftedPair(Size(333, 251), Point2f(-2.25f, 1.25f), frame0, frame1);
+
+    for( int preset = DISOpticalFlow::PRESET_ULTRAFAST; preset <= DISOpticalFlow::PRESET_MEDIUM; preset++ )
+        cvtest::checkFlowThreads(DISOpticalFlow::create(preset), frame0, frame1, format("preset=%d", preset));
+}
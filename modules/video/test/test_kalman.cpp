@@ -122,4 +122,84 @@ void CV_KalmanTest::run( int )
 
 TEST(Video_Kalman, accuracy) { CV_KalmanTest test; test.safe_run(); }
 
+static Mat randomCov( RNG& rng, int n )
+{
+    Mat M(n, n, CV_32F);
+    rng.fill(M, RNG::UNIFORM, -1, 1);
+    return M*M.t() + Mat::eye(n, n, CV_32F);
+}
+
+TEST(Video_BatchKalmanFilter, accuracy)
+{
+    // the specialized dimensions and the generic ones, the count is not a multiple of the SIMD width
+    const int dims[][3] = { {2, 1, 0}, {4, 2, 0}, {6, 2, 1}, {8, 4, 0}, {5, 3, 2} };
+    const int count = 37;
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(dims)/sizeof(dims[0])); t++ )
+    {
+        int DP = dims[t][0], MP = dims[t][1], CP = dims[t][2];
+        BatchKalmanFilter batch(count, DP, MP, CP);
+        Mat A = Mat::eye(DP, DP, CV_32F), dA(DP, DP, CV_32F), H(MP, DP, CV_32F), B(DP, std::max(CP, 1), CV_32F);
+        rng.fill(dA, RNG::UNIFORM, -0.1, 0.1);
+        A += dA;
+        rng.fill(H, RNG::UNIFORM, -1, 1);
+        rng.fill(B, RNG::UNIFORM, -1, 1);
+        A.copyTo(batch.transitionMatrix);
+        H.copyTo(batch.measurementMatrix);
+        randomCov(rng, DP).copyTo(batch.processNoiseCov);
+        randomCov(rng, MP).copyTo(batch.measurementNoiseCov);
+        if( CP > 0 )
+            B.copyTo(batch.controlMatrix);
+        rng.fill(batch.statePost, RNG::UNIFORM, -10, 10);
+
+        std::vector<KalmanFilter> kfs(count);
+        for( int i = 0; i < count; i++ )
+        {
+            Mat P0 = randomCov(rng, DP);
+            P0.reshape(1, DP*DP).copyTo(batch.errorCovPost.col(i));
+
+            kfs[i].init(DP, MP, CP, CV_32F);
+            batch.transitionMatrix.copyTo(kfs[i].transitionMatrix);
+            batch.measurementMatrix.copyTo(kfs[i].measurementMatrix);
+            batch.processNoiseCov.copyTo(kfs[i].processNoiseCov);
+            batch.measurementNoiseCov.copyTo(kfs[i].measurementNoiseCov);
+            if( CP > 0 )
+                batch.controlMatrix.copyTo(kfs[i].controlMatrix);
+            batch.statePost.col(i).copyTo(kfs[i].statePost);
+            P0.copyTo(kfs[i].errorCovPost);
+        }
+
+        for( int step = 0; step < 6; step++ )
+        {
+            // every other step updates a random subset of the filters
+            Mat mask(1, count, CV_8U, Scalar(1)), control(std::max(CP, 1), count, CV_32F), z(MP, count, CV_32F);
+            if( step % 2 )
+                rng.fill(mask, RNG::UNIFORM, 0, 2);
+            rng.fill(control, RNG::UNIFORM, -1, 1);
+            rng.fill(z, RNG::UNIFORM, -10, 10);
+
+            batch.predict(CP > 0 ? control : Mat(), step % 2 ? mask : Mat());
+            batch.correct(z, step % 2 ? mask : Mat());
+
+            for( int i = 0; i < count; i++ )
+            {
+                if( !mask.at<uchar>(i) )
+                    continue;
+                kfs[i].predict(CP > 0 ? Mat(control.col(i)) : Mat());
+                kfs[i].correct(z.col(i));
+            }
+        }
+
+        for( int i = 0; i < count; i++ )
+        {
+            Mat x = batch.statePost.col(i), P = batch.errorCovPost.col(i).clone().reshape(1, DP);
+            EXPECT_LE(cvtest::norm(x, kfs[i].statePost, NORM_INF), 1e-3*(1 + cvtest::norm(x, NORM_INF)))
+                << "DP=" << DP << " MP=" << MP << " CP=" << CP << " i=" << i;
+            EXPECT_LE(cvtest::norm(P, kfs[i].errorCovPost, NORM_INF), 1e-3*(1 + cvtest::norm(P, NORM_INF)))
+                << "DP=" << DP << " MP=" << MP << " CP=" << CP << " i=" << i;
+        }
+    }
+}
+
 /* End of file. */
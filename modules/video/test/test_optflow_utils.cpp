@@ -0,0 +1,35 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+void cvtest::makeShiftedPair( Size size, Point2f shift, Mat& frame0, Mat& frame1 )
+{
+    RNG& rng = theRNG();
+    frame0.create(size, CV_8UC1);
+    rng.fill(frame0, RNG::UNIFORM, 0, 256);
+    GaussianBlur(frame0, frame0, Size(0, 0), 2.0);
+    normalize(frame0, frame0, 0, 255, NORM_MINMAX);
+
+    Mat M = (Mat_<double>(2, 3) << 1, 0, shift.x, 0, 1, shift.y);
+    warpAffine(frame0, frame1, M, size, INTER_LINEAR, BORDER_REFLECT);
+}
+
+void cvtest::checkFlowThreads( const Ptr<DenseOpticalFlow>& algo, const Mat& frame0,
+                               const Mat& frame1, const string& info )
+{
+    int nthreads = getNumThreads();
+    Mat flow1, flowN;
+
+    setNumThreads(1);
+    algo->calc(frame0, frame1, flow1);
+    setNumThreads(std::max(nthreads, 4));
+    algo->calc(frame0, frame1, flowN);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, cvtest::norm(flow1, flowN, NORM_INF)) << info;
+}
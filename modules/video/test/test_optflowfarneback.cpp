@@ -0,0 +1,41 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+TEST(Video_Farneback, translation)
+{
+    Point2f shift(1.5f, -0.75f);
+    Mat frame0, frame1;
+    cvtest::makeShiftedPair(Size(320, 240), shift, frame0, frame1);
+
+    for( int gaussian = 0; gaussian < 2; gaussian++ )
+    {
+        Mat flow;
+        calcOpticalFlowFarneback(frame0, frame1, flow, 0.5, 3, 15, 5, 5, 1.1,
+                                 gaussian ? OPTFLOW_FARNEBACK_GAUSSIAN : 0);
+        ASSERT_EQ(CV_32FC2, flow.type());
+
+        Scalar m = mean(flow(Rect(32, 32, flow.cols - 64, flow.rows - 64)));
+        EXPECT_NEAR(shift.x, m[0], 0.1) << "gaussian=" << gaussian;
+        EXPECT_NEAR(shift.y, m[1], 0.1) << "gaussian=" << gaussian;
+    }
+}
+
+TEST(Video_Farneback, threads)
+{
+    // the image height is not a multiple of the bands processed in parallel
+    Mat frame0, frame1;
+    cvtest::makeShiftedPair(Size(333, 251), Point2f(-2.25f, 1.25f), frame0, frame1);
+
+    for( int gaussian = 0; gaussian < 2; gaussian++ )
+    {
+        int flags = gaussian ? OPTFLOW_FARNEBACK_GAUSSIAN : 0;
+        cvtest::checkFlowThreads(FarnebackOpticalFlow::create(3, 0.5, false, 13, 5, 7, 1.5, flags),
+                                 frame0, frame1, format("gaussian=%d", gaussian));
+    }
+}
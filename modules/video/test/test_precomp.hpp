@@ -15,4 +15,14 @@
 #include "opencv2/video.hpp"
 #include "opencv2/imgcodecs.hpp"
 
+namespace cvtest
+{
+    // a smooth random texture and its copy translated by shift, for the dense optical flow tests
+    void makeShiftedPair( cv::Size size, cv::Point2f shift, cv::Mat& frame0, cv::Mat& frame1 );
+
+    // computes the flow with one thread and with several ones, the results must be the same
+    void checkFlowThreads( const cv::Ptr<cv::DenseOpticalFlow>& algo, const cv::Mat& frame0,
+                           const cv::Mat& frame1, const std::string& info );
+}
+
 #endif